@@ -32,6 +32,23 @@ enum backing_store_flags {
 	BACKING_STORE_NONE = 0,
 	/** data is metadata */
 	BACKING_STORE_META = 1,
+	/** data is of a type which is worth compressing */
+	BACKING_STORE_COMPRESSIBLE = 2,
+};
+
+/**
+ * backing store statistics
+ */
+struct backing_store_stats {
+	uint64_t total_alloc; /**< size of all elements in storage */
+	uint64_t raw_alloc; /**< size of all elements before compression */
+	size_t hit_count; /**< number of cache hits */
+	size_t miss_count; /**< number of cache misses */
+	size_t compress_count; /**< number of elements compressed */
+	uint64_t compress_in; /**< size of compressed elements before */
+	uint64_t compress_out; /**< size of compressed elements after */
+	size_t decompress_count; /**< number of elements decompressed */
+	uint64_t decompress_us; /**< time spent decompressing in microseconds */
 };
 
 /**
@@ -71,6 +88,10 @@ struct gui_llcache_table {
 	 * The caller may not assume that the persistent storage has
 	 *  been completely written on return.
 	 *
+	 * If the store is too busy to accept the object it returns
+	 *  NSERROR_NOSPACE without taking a reference and the data
+	 *  remains the caller's to free.
+	 *
 	 * @param[in] url The url is used as the unique primary key for the data.
 	 * @param[in] flags The flags to control how the object is stored.
 	 * @param[in] data The objects data.
@@ -121,6 +142,16 @@ struct gui_llcache_table {
 	 */
 	nserror (*invalidate)(struct nsurl *url);
 
+	/**
+	 * Retrieve backing store statistics.
+	 *
+	 * This operation is optional.
+	 *
+	 * @param[out] stats The statistics to fill in.
+	 * @return NSERROR_OK on success or error code on failure.
+	 */
+	nserror (*stats)(struct backing_store_stats *stats);
+
 };
 
 extern struct gui_llcache_table* null_llcache_table;
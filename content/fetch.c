@@ -28,7 +28,8 @@
  * Active fetches are held in the circular linked list ::fetch_ring. There may
  * be at most nsoption max_fetchers_per_host active requests per Host: header.
  * There may be at most nsoption max_fetchers active requests overall. Inactive
- * fetches are stored in the ::queue_ring waiting for use.
+ * fetches are stored in the ::queue_rings, one ring per priority class,
+ * waiting for use.
  */
 
 #include <stdlib.h>
@@ -73,6 +74,18 @@
 /** The fdset timeout in ms */
 #define FDSET_TIMEOUT 1000
 
+/** The delay in ms after initialisation before popular hosts are connected */
+#define PRECONNECT_POPULAR_DELAY 2000
+
+/**
+ * Fraction of max_fetchers kept free of deferred and prefetch fetches.
+ *
+ * Those classes only start while more than max_fetchers divided by
+ * this value are idle so a document or blocking resource discovered
+ * later does not wait for a slot.
+ */
+#define FETCH_RESERVE_DIVISOR 4
+
 /**
  * Information about a fetcher for a given scheme.
  */
@@ -98,12 +111,24 @@ struct fetch {
 	void *fetcher_handle;	/**< The handle for the fetcher. */
 	bool fetch_is_active;	/**< This fetch is active. */
 	fetch_msg_type last_msg;/**< The last message sent for this fetch */
+	enum fetch_priority priority; /**< Priority class of this fetch */
 	struct fetch *r_prev;	/**< Previous active fetch in ::fetch_ring. */
 	struct fetch *r_next;	/**< Next active fetch in ::fetch_ring. */
 };
 
 static struct fetch *fetch_ring = NULL;	/**< Ring of active fetches. */
-static struct fetch *queue_ring = NULL;	/**< Ring of queued fetches */
+/** Rings of queued fetches for each priority class */
+static struct fetch *queue_rings[FETCH_PRIORITY_COUNT];
+
+/** Most visited hosts gathered from the url database */
+struct fetch_popular_host {
+	nsurl *url; /**< Most visited url on the host */
+	unsigned int url_visits; /**< Visits to url */
+	unsigned int visits; /**< Total visits to urls on the host */
+};
+static struct fetch_popular_host *popular_hosts;
+static int popular_host_count; /**< Number of entries in popular_hosts */
+static int popular_host_max; /**< Size of popular_hosts */
 
 /******************************************************************************
  * fetch internals							      *
@@ -147,14 +172,15 @@ static int get_fetcher_for_scheme(lwc_string *scheme)
  */
 static bool fetch_dispatch_job(struct fetch *fetch)
 {
-	RING_REMOVE(queue_ring, fetch);
+	RING_REMOVE(queue_rings[fetch->priority], fetch);
 	NSLOG(fetch, DEBUG,
 	      "Attempting to start fetch %p, fetcher %p, url %s", fetch,
 	      fetch->fetcher_handle,
 	      nsurl_access(fetch->url));
 
 	if (!fetchers[fetch->fetcherd].ops.start(fetch->fetcher_handle)) {
-		RING_INSERT(queue_ring, fetch); /* Put it back on the end of the queue */
+		/* Put it back on the end of the queue */
+		RING_INSERT(queue_rings[fetch->priority], fetch);
 		return false;
 	} else {
 		RING_INSERT(fetch_ring, fetch);
@@ -164,17 +190,32 @@ static bool fetch_dispatch_job(struct fetch *fetch)
 }
 
 /**
- * Choose and dispatch a single job. Return false if we failed to dispatch
- * anything.
+ * Get the maximum number of active fetches from a fetch's host.
+ */
+static int fetch_host_limit(struct fetch *fetch)
+{
+	if (fetchers[fetch->fetcherd].ops.host_limit != NULL) {
+		return fetchers[fetch->fetcherd].ops.host_limit(fetch->host);
+	}
+	return nsoption_int(max_fetchers_per_host);
+}
+
+/**
+ * Choose a job from a queue whose host has room for another fetch.
  *
- * We don't check the overall dispatch size here because we're not called unless
- * there is room in the fetch queue for us.
+ * \param queue The queue to choose from
+ * \return The fetch to dispatch or NULL if there is none
  */
-static bool fetch_choose_and_dispatch(void)
+static struct fetch *fetch_choose_from_queue(struct fetch *queue)
 {
 	bool same_host;
 	struct fetch *queueitem;
-	queueitem = queue_ring;
+
+	if (queue == NULL) {
+		return NULL;
+	}
+
+	queueitem = queue;
 	do {
 		/* We can dispatch the selected item if there is room in the
 		 * fetch ring
@@ -182,13 +223,13 @@ static bool fetch_choose_and_dispatch(void)
 		int countbyhost;
 		RING_COUNTBYLWCHOST(struct fetch, fetch_ring, countbyhost,
 				    queueitem->host);
-		if (countbyhost < nsoption_int(max_fetchers_per_host)) {
+		if (countbyhost < fetch_host_limit(queueitem)) {
 			/* We can dispatch this item in theory */
-			return fetch_dispatch_job(queueitem);
+			return queueitem;
 		}
 		/* skip over other items with the same host */
 		same_host = true;
-		while (same_host == true && queueitem->r_next != queue_ring) {
+		while (same_host == true && queueitem->r_next != queue) {
 			if (lwc_string_isequal(queueitem->host,
 					       queueitem->r_next->host, &same_host) ==
 			    lwc_error_ok && same_host == true) {
@@ -196,22 +237,136 @@ static bool fetch_choose_and_dispatch(void)
 			}
 		}
 		queueitem = queueitem->r_next;
-	} while (queueitem != queue_ring);
+	} while (queueitem != queue);
+	return NULL;
+}
+
+/**
+ * Choose and dispatch a single job. Return false if we failed to dispatch
+ * anything.
+ *
+ * The queues are examined in priority class order. Deferred and
+ * prefetch class jobs are only dispatched while the reserved slots
+ * remain idle.
+ *
+ * We don't check the overall dispatch size here because we're not called unless
+ * there is room in the fetch queue for us.
+ *
+ * \param all_active The number of active fetches
+ */
+static bool fetch_choose_and_dispatch(int all_active)
+{
+	int priority;
+	int reserve;
+	struct fetch *queueitem;
+
+	reserve = nsoption_int(max_fetchers) / FETCH_RESERVE_DIVISOR;
+
+	for (priority = FETCH_PRIORITY_DOCUMENT;
+	     priority < FETCH_PRIORITY_COUNT;
+	     priority++) {
+		if ((priority >= FETCH_PRIORITY_DEFERRED) &&
+		    (all_active >= (nsoption_int(max_fetchers) - reserve))) {
+			break;
+		}
+
+		queueitem = fetch_choose_from_queue(queue_rings[priority]);
+		if (queueitem != NULL) {
+			return fetch_dispatch_job(queueitem);
+		}
+	}
 	return false;
 }
 
+/**
+ * Count the fetches waiting in all the queues.
+ */
+static int fetch_queued_count(void)
+{
+	int priority;
+	int queued;
+	int all_queued = 0;
+
+	for (priority = 0; priority < FETCH_PRIORITY_COUNT; priority++) {
+		RING_GETSIZE(struct fetch, queue_rings[priority], queued);
+		all_queued += queued;
+	}
+	return all_queued;
+}
+
+/** Fetch counts for a single host */
+struct fetch_host_count {
+	lwc_string *host; /**< Host, may be NULL */
+	unsigned int active; /**< Active fetches for host */
+	unsigned int queued; /**< Queued fetches for host */
+};
+
+/**
+ * Account a ring of fetches into the per host counts.
+ *
+ * \param ring The ring to count.
+ * \param counts The per host counts, large enough for every fetch.
+ * \param count The number of entries in use in counts, updated.
+ * \param active true if the ring holds active fetches.
+ */
+static void
+fetch_count_hosts(struct fetch *ring,
+		  struct fetch_host_count *counts,
+		  size_t *count,
+		  bool active)
+{
+	struct fetch *f = ring;
+	size_t idx;
+	bool match;
+
+	if (f == NULL) {
+		return;
+	}
+
+	do {
+		for (idx = 0; idx < *count; idx++) {
+			if (counts[idx].host == f->host) {
+				break;
+			}
+			if ((counts[idx].host != NULL) &&
+			    (f->host != NULL) &&
+			    (lwc_string_isequal(counts[idx].host,
+						f->host,
+						&match) == lwc_error_ok) &&
+			    (match == true)) {
+				break;
+			}
+		}
+		if (idx == *count) {
+			counts[idx].host = f->host;
+			counts[idx].active = 0;
+			counts[idx].queued = 0;
+			(*count)++;
+		}
+		if (active) {
+			counts[idx].active++;
+		} else {
+			counts[idx].queued++;
+		}
+		f = f->r_next;
+	} while (f != ring);
+}
+
 static void dump_rings(void)
 {
 	struct fetch *q;
 	struct fetch *f;
-
-	q = queue_ring;
-	if (q) {
-		do {
-			NSLOG(fetch, DEBUG, "queue_ring: %s",
-			      nsurl_access(q->url));
-			q = q->r_next;
-		} while (q != queue_ring);
+	int priority;
+
+	for (priority = 0; priority < FETCH_PRIORITY_COUNT; priority++) {
+		q = queue_rings[priority];
+		if (q) {
+			do {
+				NSLOG(fetch, DEBUG, "queue_rings[%d]: %s",
+				      priority, nsurl_access(q->url));
+				q = q->r_next;
+			} while (q != queue_rings[priority]);
+		}
 	}
 	f = fetch_ring;
 	if (f) {
@@ -233,20 +388,20 @@ static bool fetch_dispatch_jobs(void)
 	int all_active;
 	int all_queued;
 
-	RING_GETSIZE(struct fetch, queue_ring, all_queued);
+	all_queued = fetch_queued_count();
 	RING_GETSIZE(struct fetch, fetch_ring, all_active);
 
 	write_to_log("fetch: dispatch_jobs start queued=%d active=%d\n", all_queued, all_active);
 
 	NSLOG(fetch, DEBUG,
-	      "queue_ring %i, fetch_ring %i",
+	      "queue_rings %i, fetch_ring %i",
 	      all_queued,
 	      all_active);
 	dump_rings();
 
 	while ((all_queued != 0) &&
 	       (all_active < nsoption_int(max_fetchers)) &&
-	       fetch_choose_and_dispatch()) {
+	       fetch_choose_and_dispatch(all_active)) {
 			all_queued--;
 			all_active++;
 			NSLOG(fetch, DEBUG,
@@ -285,6 +440,107 @@ static void fetcher_poll(void *unused)
 	}
 }
 
+/**
+ * url database iterator callback gathering the most visited hosts
+ */
+static bool fetch_popular_host_cb(nsurl *url, const struct url_data *data)
+{
+	enum nsurl_scheme_type type = nsurl_get_scheme_type(url);
+	struct fetch_popular_host *host;
+	int idx;
+
+	if ((type != NSURL_SCHEME_HTTP && type != NSURL_SCHEME_HTTPS) ||
+	    (data->visits == 0)) {
+		return true;
+	}
+
+	for (idx = 0; idx < popular_host_count; idx++) {
+		host = &popular_hosts[idx];
+		if (nsurl_compare(host->url, url,
+				  NSURL_SCHEME | NSURL_HOST | NSURL_PORT)) {
+			host->visits += data->visits;
+			if (data->visits > host->url_visits) {
+				nsurl_unref(host->url);
+				host->url = nsurl_ref(url);
+				host->url_visits = data->visits;
+			}
+			return true;
+		}
+	}
+
+	if (popular_host_count < popular_host_max) {
+		host = &popular_hosts[popular_host_count++];
+	} else {
+		/* replace the least visited host if this url beats it */
+		host = &popular_hosts[0];
+		for (idx = 1; idx < popular_host_count; idx++) {
+			if (popular_hosts[idx].visits < host->visits) {
+				host = &popular_hosts[idx];
+			}
+		}
+		if (host->visits >= data->visits) {
+			return true;
+		}
+		nsurl_unref(host->url);
+	}
+
+	host->url = nsurl_ref(url);
+	host->url_visits = data->visits;
+	host->visits = data->visits;
+
+	return true;
+}
+
+/**
+ * Connect speculatively to the most visited hosts in the url database.
+ *
+ * The candidate list is kept at twice the requested size while
+ * iterating so hosts with many lightly visited urls are not lost
+ * to early replacement.
+ */
+static void fetch_preconnect_popular(void *unused)
+{
+	int count = nsoption_int(preconnect_hosts);
+	int idx;
+
+	if (count <= 0) {
+		return;
+	}
+
+	popular_host_max = count * 2;
+	popular_hosts = calloc(popular_host_max, sizeof(*popular_hosts));
+	if (popular_hosts == NULL) {
+		return;
+	}
+	popular_host_count = 0;
+
+	urldb_iterate_entries(fetch_popular_host_cb);
+
+	while (count > 0 && popular_host_count > 0) {
+		struct fetch_popular_host *best = &popular_hosts[0];
+		for (idx = 1; idx < popular_host_count; idx++) {
+			if (popular_hosts[idx].visits > best->visits) {
+				best = &popular_hosts[idx];
+			}
+		}
+
+		NSLOG(fetch, DEBUG, "preconnecting %s with %u visits",
+		      nsurl_access(best->url), best->visits);
+		(void)fetch_preconnect(best->url, false);
+		count--;
+
+		nsurl_unref(best->url);
+		*best = popular_hosts[--popular_host_count];
+	}
+
+	for (idx = 0; idx < popular_host_count; idx++) {
+		nsurl_unref(popular_hosts[idx].url);
+	}
+	free(popular_hosts);
+	popular_hosts = NULL;
+	popular_host_count = 0;
+}
+
 /******************************************************************************
  * Public API								      *
  ******************************************************************************/
@@ -322,6 +578,15 @@ nserror fetcher_init(void)
 	}
 
 	ret = fetch_javascript_register();
+	if (ret != NSERROR_OK) {
+		return ret;
+	}
+
+	/* warm the connections for the most visited hosts once the
+	 * url database has been loaded
+	 */
+	guit->misc->schedule(PRECONNECT_POPULAR_DELAY,
+			     fetch_preconnect_popular, NULL);
 
 	return ret;
 }
@@ -330,6 +595,9 @@ nserror fetcher_init(void)
 void fetcher_quit(void)
 {
 	int fetcherd; /* fetcher index */
+
+	guit->misc->schedule(-1, fetch_preconnect_popular, NULL);
+
 	for (fetcherd = 0; fetcherd < MAX_FETCHERS; fetcherd++) {
 		if (fetchers[fetcherd].refcount > 1) {
 			/* fetcher still has reference at quit. This
@@ -464,6 +732,7 @@ fetch_start(nsurl *url,
 	    bool verifiable,
 	    bool downgrade_tls,
 	    const char *headers[],
+	    enum fetch_priority priority,
 	    struct fetch **fetch_out)
 {
 	struct fetch *fetch;
@@ -494,6 +763,7 @@ fetch_start(nsurl *url,
 	fetch->verifiable = verifiable;
 	fetch->p = p;
 	fetch->host = nsurl_get_component(url, NSURL_HOST);
+	fetch->priority = priority;
 
 	if (referer != NULL) {
 		fetch->referer = nsurl_ref(referer);
@@ -527,8 +797,8 @@ fetch_start(nsurl *url,
 	/* Rah, got it, so ref the fetcher. */
 	fetch_ref_fetcher(fetch->fetcherd);
 
-	/* Dump new fetch in the queue. */
-	RING_INSERT(queue_ring, fetch);
+	/* Dump new fetch in the queue for its class. */
+	RING_INSERT(queue_rings[fetch->priority], fetch);
 
 	/* Ask the queue to run. */
 	if (fetch_dispatch_jobs()) {
@@ -541,6 +811,89 @@ fetch_start(nsurl *url,
 	return NSERROR_OK;
 }
 
+/* exported interface documented in content/fetch.h */
+void fetch_raise_priority(struct fetch *fetch, enum fetch_priority priority)
+{
+	if (priority >= fetch->priority) {
+		return;
+	}
+
+	NSLOG(fetch, DEBUG, "fetch %p priority %d to %d",
+	      fetch, fetch->priority, priority);
+
+	if (fetch->fetch_is_active) {
+		fetch->priority = priority;
+		return;
+	}
+
+	RING_REMOVE(queue_rings[fetch->priority], fetch);
+	fetch->priority = priority;
+	RING_INSERT(queue_rings[fetch->priority], fetch);
+}
+
+/* exported interface documented in content/fetch.h */
+nserror fetch_preconnect(nsurl *url, bool dns_only)
+{
+	lwc_string *scheme;
+	lwc_string *host;
+	int fetcherd;
+	int countbyhost;
+	int all_active;
+
+	scheme = nsurl_get_component(url, NSURL_SCHEME);
+	if (scheme == NULL) {
+		return NSERROR_BAD_URL;
+	}
+	fetcherd = get_fetcher_for_scheme(scheme);
+	lwc_string_unref(scheme);
+	if (fetcherd == -1) {
+		return NSERROR_NO_FETCH_HANDLER;
+	}
+
+	if (fetchers[fetcherd].ops.preconnect == NULL) {
+		return NSERROR_NOT_IMPLEMENTED;
+	}
+
+	host = nsurl_get_component(url, NSURL_HOST);
+	if (host == NULL) {
+		return NSERROR_BAD_URL;
+	}
+
+	/* A host with an active fetch is already connected and the
+	 * speculative connection must not take a slot from real fetches
+	 * so it is only made while the host and fetch limits have room.
+	 */
+	RING_COUNTBYLWCHOST(struct fetch, fetch_ring, countbyhost, host);
+	RING_GETSIZE(struct fetch, fetch_ring, all_active);
+	lwc_string_unref(host);
+
+	if ((countbyhost > 0) ||
+	    (nsoption_int(max_fetchers_per_host) < 1) ||
+	    (all_active >= nsoption_int(max_fetchers))) {
+		return NSERROR_OK;
+	}
+
+	NSLOG(fetch, DEBUG, "%s %s",
+	      dns_only ? "resolve" : "preconnect", nsurl_access(url));
+
+	return fetchers[fetcherd].ops.preconnect(url, dns_only);
+}
+
+/* exported interface documented in content/fetch.h */
+nserror fetch_pause(struct fetch *f, bool paused)
+{
+	if (fetchers[f->fetcherd].ops.pause == NULL) {
+		return NSERROR_NOT_IMPLEMENTED;
+	}
+
+	NSLOG(fetch, DEBUG, "fetch %p, fetcher %p, %s", f, f->fetcher_handle,
+	      paused ? "paused" : "resumed");
+
+	fetchers[f->fetcherd].ops.pause(f->fetcher_handle, paused);
+
+	return NSERROR_OK;
+}
+
 /* exported interface documented in content/fetch.h */
 void fetch_abort(struct fetch *f)
 {
@@ -606,6 +959,45 @@ bool fetch_can_fetch(const nsurl *url)
 	return fetchers[fetcherd].ops.acceptable(url);
 }
 
+/* exported interface documented in content/fetch.h */
+nserror fetch_get_host_stats(fetch_host_stats_cb cb, void *pw)
+{
+	struct fetch_host_count *counts;
+	size_t count = 0;
+	size_t idx;
+	int all_active;
+	int total;
+	int priority;
+
+	RING_GETSIZE(struct fetch, fetch_ring, all_active);
+	total = all_active + fetch_queued_count();
+	if (total == 0) {
+		return NSERROR_OK;
+	}
+
+	counts = malloc(total * sizeof(*counts));
+	if (counts == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	fetch_count_hosts(fetch_ring, counts, &count, true);
+	for (priority = 0; priority < FETCH_PRIORITY_COUNT; priority++) {
+		fetch_count_hosts(queue_rings[priority], counts, &count, false);
+	}
+
+	for (idx = 0; idx < count; idx++) {
+		cb(counts[idx].host != NULL ?
+		   lwc_string_data(counts[idx].host) : "",
+		   counts[idx].active,
+		   counts[idx].queued,
+		   pw);
+	}
+
+	free(counts);
+
+	return NSERROR_OK;
+}
+
 /* exported interface documented in content/fetch.h */
 void fetch_change_callback(struct fetch *fetch,
 			   fetch_callback callback,
@@ -622,6 +1014,12 @@ long fetch_http_code(struct fetch *fetch)
 	return fetch->http_code;
 }
 
+/* exported interface documented in content/fetch.h */
+enum fetch_priority fetch_get_priority(struct fetch *fetch)
+{
+	return fetch->priority;
+}
+
 
 /* exported interface documented in content/fetch.h */
 struct fetch_multipart_data *
@@ -760,6 +1158,79 @@ fetch_multipart_data_new_kv(struct fetch_multipart_data **list,
 }
 
 
+/* exported interface documented in content/fetch.h */
+nserror fetch_chunk_create(size_t length, struct fetch_chunk **chunk_out)
+{
+	struct fetch_chunk *chunk;
+
+	chunk = malloc(sizeof(*chunk));
+	if (chunk == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	/* always allocate so a zero length chunk has a valid buffer */
+	chunk->data = malloc(length > 0 ? length : 1);
+	if (chunk->data == NULL) {
+		free(chunk);
+		return NSERROR_NOMEM;
+	}
+
+	chunk->refcnt = 1;
+	chunk->length = length;
+
+	*chunk_out = chunk;
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in content/fetch.h */
+struct fetch_chunk *fetch_chunk_ref(struct fetch_chunk *chunk)
+{
+	chunk->refcnt++;
+
+	return chunk;
+}
+
+
+/* exported interface documented in content/fetch.h */
+void fetch_chunk_unref(struct fetch_chunk *chunk)
+{
+	assert(chunk->refcnt > 0);
+
+	if (--chunk->refcnt == 0) {
+		free(chunk->data);
+		free(chunk);
+	}
+}
+
+
+/* exported interface documented in content/fetch.h */
+nserror fetch_chunk_steal(struct fetch_chunk *chunk, uint8_t **data_out)
+{
+	uint8_t *data;
+
+	assert(chunk->refcnt > 0);
+
+	if (chunk->refcnt == 1) {
+		/* sole owner so the buffer can be handed over as is */
+		data = chunk->data;
+		free(chunk);
+	} else {
+		data = malloc(chunk->length > 0 ? chunk->length : 1);
+		if (data == NULL) {
+			return NSERROR_NOMEM;
+		}
+		memcpy(data, chunk->data, chunk->length);
+		chunk->refcnt--;
+	}
+
+	*data_out = data;
+
+	return NSERROR_OK;
+}
+
+
 /* exported interface documented in content/fetch.h */
 void
 fetch_send_callback(const fetch_msg *msg, struct fetch *fetch)
@@ -786,12 +1257,12 @@ void fetch_remove_from_queues(struct fetch *fetch)
 	if (fetch->fetch_is_active) {
 		RING_REMOVE(fetch_ring, fetch);
 	} else {
-		RING_REMOVE(queue_ring, fetch);
+		RING_REMOVE(queue_rings[fetch->priority], fetch);
 	}
 
 
 	RING_GETSIZE(struct fetch, fetch_ring, all_active);
-	RING_GETSIZE(struct fetch, queue_ring, all_queued);
+	all_queued = fetch_queued_count();
 
 	NSLOG(fetch, DEBUG, "Fetch ring is now %d elements.", all_active);
 	NSLOG(fetch, DEBUG, "Queue ring is now %d elements.", all_queued);
@@ -42,6 +42,7 @@ typedef enum {
 	FETCH_CERTS,
 	FETCH_HEADER,
 	FETCH_DATA,
+	FETCH_DATA_CHUNK,
 	/* Anything after here is a completed fetch of some kind. */
 	FETCH_FINISHED,
 	FETCH_TIMEDOUT,
@@ -66,6 +67,37 @@ typedef enum {
  */
 #define FETCH__INTERNAL_ABORTED FETCH_ERROR
 
+/**
+ * Fetch priority classes.
+ *
+ * Queued fetches are dispatched in class order, most important first.
+ * The deferred and prefetch classes may not occupy the last few fetch
+ * slots so a more important fetch never waits behind them.
+ */
+enum fetch_priority {
+	FETCH_PRIORITY_DOCUMENT = 0, /**< Top level document */
+	FETCH_PRIORITY_BLOCKING,     /**< Render blocking stylesheet or script */
+	FETCH_PRIORITY_FONT,         /**< Font */
+	FETCH_PRIORITY_IMAGE,        /**< Image or object in the document */
+	FETCH_PRIORITY_DEFERRED,     /**< Deferred or asynchronous resource */
+	FETCH_PRIORITY_PREFETCH,     /**< Speculative fetch */
+
+	FETCH_PRIORITY_COUNT         /**< Number of priority classes */
+};
+
+/**
+ * Reference counted immutable fetch data buffer.
+ *
+ * A fetcher which reads data into a buffer of its own may pass it with
+ * a FETCH_DATA_CHUNK message. The receiver may retain the chunk by
+ * taking a reference instead of copying the data out of it.
+ */
+struct fetch_chunk {
+	unsigned int refcnt; /**< Number of references to the chunk */
+	size_t length; /**< Length of data */
+	uint8_t *data; /**< Chunk data */
+};
+
 /**
  * Fetcher message data
  */
@@ -80,6 +112,9 @@ typedef struct fetch_msg {
 			size_t len;
 		} header_or_data;
 
+		/** Data chunk if type is FETCH_DATA_CHUNK */
+		struct fetch_chunk *chunk;
+
 		const char *error;
 
 		/** \todo Use nsurl */
@@ -145,7 +180,8 @@ typedef void (*fetch_callback)(const fetch_msg *msg, void *p);
  * The caller must supply a callback function which is called when anything
  * interesting happens. The callback function is first called with msg
  * FETCH_HEADER, with the header in data, then one or more times
- * with FETCH_DATA with some data for the url, and finally with
+ * with FETCH_DATA or FETCH_DATA_CHUNK with some data for the url, and
+ * finally with
  * FETCH_FINISHED. Alternatively, FETCH_ERROR indicates an error occurred:
  * data contains an error message. FETCH_REDIRECT may replace the FETCH_HEADER,
  * FETCH_DATA, FETCH_FINISHED sequence if the server sends a replacement URL.
@@ -160,6 +196,7 @@ typedef void (*fetch_callback)(const fetch_msg *msg, void *p);
  * \param verifiable
  * \param downgrade_tls
  * \param headers
+ * \param priority The priority class of the fetch
  * \param fetch_out ponter to recive new fetch object.
  * \return NSERROR_OK and fetch_out updated else appropriate error code
  */
@@ -167,13 +204,54 @@ nserror fetch_start(nsurl *url, nsurl *referer, fetch_callback callback,
 		    void *p, bool only_2xx, const char *post_urlenc,
 		    const struct fetch_multipart_data *post_multipart,
 		    bool verifiable, bool downgrade_tls,
-		    const char *headers[], struct fetch **fetch_out);
+		    const char *headers[], enum fetch_priority priority,
+		    struct fetch **fetch_out);
+
+/**
+ * Raise the priority class of a fetch.
+ *
+ * A fetch still waiting in the queue is moved to the queue for the
+ * new class. The priority of a fetch is never lowered.
+ *
+ * \param fetch The fetch to change
+ * \param priority The priority class required
+ */
+void fetch_raise_priority(struct fetch *fetch, enum fetch_priority priority);
+
+/**
+ * Speculatively warm the connection to a URL's host.
+ *
+ * The host name is resolved and, unless \a dns_only is set, a
+ * connection opened so a later fetch from the host starts sooner.
+ * Nothing is done if the host already has active fetches or the
+ * fetch limits leave no room for another connection.
+ *
+ * \param url URL whose host to connect to
+ * \param dns_only Only resolve the host name
+ * \return NSERROR_OK on success or if nothing was required,
+ *         NSERROR_NOT_IMPLEMENTED if the fetcher cannot perform the
+ *         request else appropriate error code
+ */
+nserror fetch_preconnect(nsurl *url, bool dns_only);
 
 /**
  * Abort a fetch.
  */
 void fetch_abort(struct fetch *f);
 
+/**
+ * Pause or resume delivery of a fetch's data.
+ *
+ * Used by a consumer which is not keeping up to stop data arriving
+ * until it has caught up.
+ *
+ * \param f The fetch to change
+ * \param paused true to pause the fetch, false to resume it
+ * \return NSERROR_OK on success or NSERROR_NOT_IMPLEMENTED if the
+ *         fetcher cannot pause
+ */
+nserror fetch_pause(struct fetch *f, bool paused);
+
 
 /**
  * Check if a URL's scheme can be fetched.
@@ -193,6 +271,31 @@ void fetch_change_callback(struct fetch *fetch, fetch_callback callback, void *p
  */
 long fetch_http_code(struct fetch *fetch);
 
+/**
+ * Get the priority class of a fetch.
+ */
+enum fetch_priority fetch_get_priority(struct fetch *fetch);
+
+/**
+ * Callback reporting the fetches for a host.
+ *
+ * \param host The host name, or the empty string for fetches without one.
+ * \param active The number of active fetches for the host.
+ * \param queued The number of fetches for the host waiting in a queue.
+ * \param pw The context passed to fetch_get_host_stats().
+ */
+typedef void (*fetch_host_stats_cb)(const char *host,
+		unsigned int active, unsigned int queued, void *pw);
+
+/**
+ * Report the active and queued fetches for each host with fetches.
+ *
+ * \param cb The callback to call for each host.
+ * \param pw The context to pass to the callback.
+ * \return NSERROR_OK on success or NSERROR_NOMEM on memory exhaustion.
+ */
+nserror fetch_get_host_stats(fetch_host_stats_cb cb, void *pw);
+
 
 /**
  * Free a linked list of fetch_multipart_data.
@@ -233,6 +336,49 @@ nserror fetch_multipart_data_new_kv(struct fetch_multipart_data **list,
 				    const char *name,
 				    const char *value);
 
+/**
+ * Create a fetch data chunk.
+ *
+ * The chunk is returned holding a single reference and with
+ * uninitialised data which the caller fills before sending it.
+ *
+ * \param length The length of the chunk data.
+ * \param chunk_out Updated with the new chunk.
+ * \return NSERROR_OK and \a chunk_out updated else NSERROR_NOMEM
+ */
+nserror fetch_chunk_create(size_t length, struct fetch_chunk **chunk_out);
+
+/**
+ * Take a reference to a fetch data chunk.
+ *
+ * \param chunk The chunk to reference.
+ * \return The referenced chunk.
+ */
+struct fetch_chunk *fetch_chunk_ref(struct fetch_chunk *chunk);
+
+/**
+ * Release a reference to a fetch data chunk.
+ *
+ * The chunk and its data are freed when the last reference is released.
+ *
+ * \param chunk The chunk to release.
+ */
+void fetch_chunk_unref(struct fetch_chunk *chunk);
+
+/**
+ * Take ownership of the data of a fetch data chunk.
+ *
+ * If the caller holds the only reference the chunk is destroyed and
+ * its data buffer returned without copying, otherwise a copy of the
+ * data is made and the callers reference released.
+ *
+ * \param chunk The chunk to release.
+ * \param data_out Updated with the data which must be freed with free().
+ * \return NSERROR_OK and \a data_out updated else NSERROR_NOMEM in
+ *         which case the callers reference is retained.
+ */
+nserror fetch_chunk_steal(struct fetch_chunk *chunk, uint8_t **data_out);
+
 /**
  * send message to fetch
  */
@@ -96,6 +96,40 @@ struct fetcher_operation_table {
 	int (*fdset)(lwc_string *scheme, fd_set *read_set, fd_set *write_set,
 		     fd_set *error_set);
 
+	/**
+	 * Speculatively warm the connection to a url's host.
+	 *
+	 * This operation is optional.
+	 *
+	 * \param url The url whose host to connect to.
+	 * \param dns_only Only resolve the host name, do not connect.
+	 * \return NSERROR_OK on success or error code on failure.
+	 */
+	nserror (*preconnect)(struct nsurl *url, bool dns_only);
+
+	/**
+	 * Maximum number of simultaneous fetches from a host.
+	 *
+	 * This operation is optional, without it the max_fetchers_per_host
+	 * option applies. A fetcher which multiplexes fetches over one
+	 * connection may permit more.
+	 *
+	 * \param host The host name.
+	 * \return The number of fetches which may be active.
+	 */
+	int (*host_limit)(lwc_string *host);
+
+	/**
+	 * Pause or resume delivery of a fetch's data.
+	 *
+	 * This operation is optional. While paused the fetcher must not
+	 * send any further data for the fetch.
+	 *
+	 * \param fetch The fetcher's handle for the fetch.
+	 * \param paused true to pause delivery, false to resume it.
+	 */
+	void (*pause)(void *fetch, bool paused);
+
 	/**
 	 * Finalise the fetcher.
 	 */
@@ -51,8 +51,10 @@
 #include "config.h"
 #include "chart.h"
 #include "choices.h"
+#include "fontcache.h"
 #include "imagecache.h"
 #include "nscolours.h"
+#include "perf.h"
 #include "query.h"
 #include "query_auth.h"
 #include "query_fetcherror.h"
@@ -426,6 +428,22 @@ struct about_handlers about_handler_list[] = {
 		fetch_about_imagecache_handler,
 		true
 	},
+	{
+		/* details about the text measurement cache */
+		"fontcache",
+		SLEN("fontcache"),
+		NULL,
+		fetch_about_fontcache_handler,
+		true
+	},
+	{
+		/* cache, fetch, document and javascript counters */
+		"perf",
+		SLEN("perf"),
+		NULL,
+		fetch_about_perf_handler,
+		true
+	},
 	{
 		/* The default blank page */
 		"blank",
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * content generator for the about scheme fontcache page
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <libcss/libcss.h>
+
+#include "netsurf/types.h"
+
+#include "html/font.h"
+
+#include "private.h"
+#include "fontcache.h"
+
+/**
+ * Compute a percentage of a total avoiding division by zero.
+ */
+static unsigned int percent(unsigned long part, unsigned long total)
+{
+	if (total == 0) {
+		return 0;
+	}
+	return (unsigned int)((part * 100) / total);
+}
+
+/* exported interface documented in about/fontcache.h */
+bool fetch_about_fontcache_handler(struct fetch_about_context *ctx)
+{
+	struct html_font_cache_stats stats;
+	unsigned long total;
+	nserror res;
+
+	html_font_cache_get_stats(&stats);
+	total = stats.hit + stats.ascii_hit + stats.miss + stats.bypass;
+
+	/* content is going to return ok */
+	fetch_about_set_http_code(ctx, 200);
+
+	/* content type */
+	if (fetch_about_send_header(ctx, "Content-Type: text/html"))
+		goto fetch_about_fontcache_handler_aborted;
+
+	res = fetch_about_ssenddataf(ctx,
+		"<html>\n<head>\n"
+		"<title>Font Measurement Cache Status</title>\n"
+		"<link rel=\"stylesheet\" type=\"text/css\" "
+		"href=\"resource:internal.css\">\n"
+		"</head>\n"
+		"<body class=\"ns-even-bg ns-even-fg ns-border\">\n"
+		"<h1 class=\"ns-border\">Font Measurement Cache Status</h1>\n"
+		"<p>Cached measurements %u in %u font styles</p>\n"
+		"<p>Cache total/hit/advance/miss/bypass (counts) "
+		"%lu/%lu/%lu/%lu/%lu (%u%%/%u%%/%u%%/%u%%)"
+		"<img width=200 height=100 src=\"about:chart?type=pie&width=200&height=100&labels=hit,advance,miss,bypass&values=%lu,%lu,%lu,%lu\" />"
+		"</p>\n"
+		"<p>Cache flushes %lu</p>\n"
+		"</body>\n</html>\n",
+		stats.entries, stats.styles,
+		total, stats.hit, stats.ascii_hit, stats.miss, stats.bypass,
+		percent(stats.hit, total), percent(stats.ascii_hit, total),
+		percent(stats.miss, total), percent(stats.bypass, total),
+		stats.hit, stats.ascii_hit, stats.miss, stats.bypass,
+		stats.flush);
+	if (res != NSERROR_OK) {
+		goto fetch_about_fontcache_handler_aborted;
+	}
+
+	fetch_about_send_finished(ctx);
+
+	return true;
+
+fetch_about_fontcache_handler_aborted:
+	return false;
+}
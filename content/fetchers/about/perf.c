@@ -0,0 +1,460 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * content generator for the about scheme perf page
+ *
+ * Gathers the counters kept by the caches, the fetch queues, HTML
+ * documents, the javascript engine and, when built with allocation
+ * tracking, the memory used by each subsystem onto a single page.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "netsurf/types.h"
+#include "netsurf/inttypes.h"
+#include "utils/nsurl.h"
+#include "utils/memtrack.h"
+#include "content/fetch.h"
+#include "content/llcache.h"
+#include "content/hlcache.h"
+#include "content/mempressure.h"
+#include "image/image_cache.h"
+#include "html/html.h"
+#include "javascript/js.h"
+
+#include "private.h"
+#include "perf.h"
+
+/**
+ * State shared with the enumeration callbacks
+ */
+struct perf_ctx {
+	struct fetch_about_context *ctx; /**< The fetcher context */
+	nserror res; /**< First error sending data */
+	bool even; /**< Row parity */
+	unsigned int count; /**< Number of rows output */
+};
+
+/**
+ * Compute a percentage of a total avoiding division by zero.
+ */
+static unsigned int percent(unsigned long part, unsigned long total)
+{
+	if (total == 0) {
+		return 0;
+	}
+	return (unsigned int)((part * 100) / total);
+}
+
+/**
+ * Output the llcache summary and backing store latency histograms
+ */
+static nserror perf_llcache(struct fetch_about_context *ctx)
+{
+	struct llcache_stats stats;
+	unsigned long total;
+	unsigned int bucket;
+	nserror res;
+
+	llcache_get_stats(&stats);
+	total = stats.hit + stats.revalidate + stats.miss + stats.uncached;
+
+	res = fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">Low level cache</h2>\n"
+		"<p>%u objects using %"PRIsizet" bytes of a "
+		"%"PRIsizet" byte limit</p>\n"
+		"<p>Retrievals total/hit/revalidate/miss/uncached "
+		"%lu/%lu/%lu/%lu/%lu (%u%%/%u%%/%u%%/%u%%)"
+		"<img width=200 height=100 src=\"about:chart?type=pie&width=200&height=100&labels=hit,revalidate,miss,uncached&values=%lu,%lu,%lu,%lu\" />"
+		"</p>\n"
+		"<table class=\"config\">\n"
+		"<tr><th>Backing store</th>",
+		stats.objects, stats.size, stats.limit,
+		total, stats.hit, stats.revalidate, stats.miss, stats.uncached,
+		percent(stats.hit, total), percent(stats.revalidate, total),
+		percent(stats.miss, total), percent(stats.uncached, total),
+		stats.hit, stats.revalidate, stats.miss, stats.uncached);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	for (bucket = 0; bucket < LLCACHE_LATENCY_BUCKETS - 1; bucket++) {
+		res = fetch_about_ssenddataf(ctx, "<th>&lt;%ums</th>",
+					     1U << bucket);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+	}
+	res = fetch_about_ssenddataf(ctx, "<th>slower</th></tr>\n<tr><th>read</th>");
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	for (bucket = 0; bucket < LLCACHE_LATENCY_BUCKETS; bucket++) {
+		res = fetch_about_ssenddataf(ctx, "<td>%lu</td>",
+					     stats.fetch_latency[bucket]);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+	}
+	res = fetch_about_ssenddataf(ctx, "</tr>\n<tr><th>write</th>");
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	for (bucket = 0; bucket < LLCACHE_LATENCY_BUCKETS; bucket++) {
+		res = fetch_about_ssenddataf(ctx, "<td>%lu</td>",
+					     stats.store_latency[bucket]);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+	}
+
+	return fetch_about_ssenddataf(ctx, "</tr>\n</table>\n");
+}
+
+/**
+ * Output the hlcache summary
+ */
+static nserror perf_hlcache(struct fetch_about_context *ctx)
+{
+	struct hlcache_stats stats;
+	unsigned int lookups, probes;
+	unsigned long time_us;
+	unsigned long total;
+
+	hlcache_get_stats(&stats);
+	hlcache_get_lookup_stats(&lookups, &probes, &time_us);
+	total = stats.hit + stats.miss;
+
+	return fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">High level cache</h2>\n"
+		"<p>%u contents, %u unused contents retained using "
+		"%"PRIsizet" bytes of a %"PRIsizet" byte limit</p>\n"
+		"<p>Retrievals total/hit/miss %lu/%u/%u (%u%%/%u%%)"
+		"<img width=200 height=100 src=\"about:chart?type=pie&width=200&height=100&labels=hit,miss&values=%u,%u\" />"
+		"</p>\n"
+		"<p>%u lookups examined %u entries in %luus</p>\n",
+		stats.contents, stats.retained,
+		stats.retained_size, stats.limit,
+		total, stats.hit, stats.miss,
+		percent(stats.hit, total), percent(stats.miss, total),
+		stats.hit, stats.miss,
+		lookups, probes, time_us);
+}
+
+/**
+ * Output the image cache summary
+ */
+static nserror perf_imagecache(struct fetch_about_context *ctx)
+{
+	char buffer[1024];
+	int slen;
+
+	slen = image_cache_snsummaryf(buffer, sizeof(buffer),
+		"<h2 class=\"ns-border\">Image cache</h2>\n"
+		"<p>Total bitmap size in use %c (in %d) of a limit of %a</p>\n"
+		"<p>Cache total/hit/miss/fail (counts) %j/%k/%l/%m "
+		"(%pj%%/%pk%%/%pl%%/%pm%%)"
+		"<img width=200 height=100 src=\"about:chart?type=pie&width=200&height=100&labels=hit,miss,fail&values=%k,%l,%m\" />"
+		"</p>\n"
+		"<p><a href=\"about:imagecache\">Image cache contents</a></p>\n");
+	if ((slen < 0) || (slen >= (int)sizeof(buffer))) {
+		return NSERROR_NOSPACE;
+	}
+
+	return fetch_about_senddata(ctx, (const uint8_t *)buffer, slen);
+}
+
+/**
+ * Output a row of the fetch queue table
+ */
+static void
+perf_fetch_host(const char *host,
+		unsigned int active,
+		unsigned int queued,
+		void *pw)
+{
+	struct perf_ctx *pctx = pw;
+
+	if (pctx->res != NSERROR_OK) {
+		return;
+	}
+
+	pctx->res = fetch_about_ssenddataf(pctx->ctx,
+		"<tr class=\"ns-%s-bg\"><td>%s</td><td>%u</td><td>%u</td></tr>\n",
+		pctx->even ? "even" : "odd", host, active, queued);
+	pctx->even = !pctx->even;
+	pctx->count++;
+}
+
+/**
+ * Output the fetch queue depths for each host
+ */
+static nserror perf_fetch(struct fetch_about_context *ctx)
+{
+	struct perf_ctx pctx = { ctx, NSERROR_OK, false, 0 };
+	nserror res;
+
+	res = fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">Fetch queues</h2>\n"
+		"<table class=\"config\">\n"
+		"<tr><th>Host</th><th>Active</th><th>Queued</th></tr>\n");
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	res = fetch_get_host_stats(perf_fetch_host, &pctx);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+	if (pctx.res != NSERROR_OK) {
+		return pctx.res;
+	}
+
+	if (pctx.count == 0) {
+		res = fetch_about_ssenddataf(ctx,
+			"<tr><td colspan=\"3\">No fetches</td></tr>\n");
+		if (res != NSERROR_OK) {
+			return res;
+		}
+	}
+
+	return fetch_about_ssenddataf(ctx, "</table>\n");
+}
+
+/**
+ * Output a row of the document table
+ */
+static void
+perf_html_document(struct nsurl *url,
+		   const struct html_perf_stats *stats,
+		   void *pw)
+{
+	struct perf_ctx *pctx = pw;
+
+	if (pctx->res != NSERROR_OK) {
+		return;
+	}
+
+	pctx->res = fetch_about_ssenddataf(pctx->ctx,
+		"<tr class=\"ns-%s-bg\">"
+		"<td><a href=\"%s\">%s</a></td>"
+		"<td>%lums</td><td>%"PRIsizet"</td>"
+		"<td>%u</td><td>%luus</td><td>%luus</td>"
+		"<td>%u</td><td>%luus</td>"
+		"</tr>\n",
+		pctx->even ? "even" : "odd",
+		nsurl_access(url), nsurl_access(url),
+		stats->box_convert_ms, stats->box_tree_size,
+		stats->layout_count, stats->layout_last_us,
+		stats->layout_time_us,
+		stats->redraw_count, stats->redraw_time_us);
+	pctx->even = !pctx->even;
+	pctx->count++;
+}
+
+/**
+ * Output the per document timings
+ */
+static nserror perf_html(struct fetch_about_context *ctx)
+{
+	struct perf_ctx pctx = { ctx, NSERROR_OK, false, 0 };
+	nserror res;
+
+	res = fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">Documents</h2>\n"
+		"<table class=\"config\">\n"
+		"<tr><th>Document</th><th>Box construction</th>"
+		"<th>Box tree bytes</th><th>Layouts</th>"
+		"<th>Last layout</th><th>Total layout</th>"
+		"<th>Redraws</th><th>Total redraw</th></tr>\n");
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	html_enumerate_perf_stats(perf_html_document, &pctx);
+	if (pctx.res != NSERROR_OK) {
+		return pctx.res;
+	}
+
+	if (pctx.count == 0) {
+		res = fetch_about_ssenddataf(ctx,
+			"<tr><td colspan=\"8\">No documents</td></tr>\n");
+		if (res != NSERROR_OK) {
+			return res;
+		}
+	}
+
+	return fetch_about_ssenddataf(ctx, "</table>\n");
+}
+
+/**
+ * Output the javascript heap summary
+ */
+static nserror perf_js(struct fetch_about_context *ctx)
+{
+	struct js_stats stats;
+
+	js_get_stats(&stats);
+
+	return fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">Javascript</h2>\n"
+		"<p>%u heaps using %"PRIsizet" bytes "
+		"(peak %"PRIsizet" bytes)</p>\n",
+		stats.heaps, stats.size, stats.peak);
+}
+
+/**
+ * Output the memory accounted to each subsystem
+ */
+static nserror perf_memtrack(struct fetch_about_context *ctx)
+{
+	struct memtrack_stats stats;
+	enum memtrack_subsystem subsystem;
+	bool even = false;
+	nserror res;
+
+	static const char *level_names[] = {
+		[MEMPRESSURE_NONE] = "none",
+		[MEMPRESSURE_MODERATE] = "moderate",
+		[MEMPRESSURE_CRITICAL] = "critical",
+	};
+
+	res = fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">Memory</h2>\n"
+		"<p>Memory pressure %s</p>\n",
+		level_names[mempressure_get_level()]);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	if (memtrack_get_stats(MEMTRACK_LLCACHE, &stats) ==
+	    NSERROR_NOT_IMPLEMENTED) {
+		return fetch_about_ssenddataf(ctx,
+			"<p>Allocation tracking is not enabled in this "
+			"build.</p>\n");
+	}
+
+	res = fetch_about_ssenddataf(ctx,
+		"<table class=\"config\">\n"
+		"<tr><th>Subsystem</th><th>Current bytes</th>"
+		"<th>Peak bytes</th><th>Allocations</th>"
+		"<th>Releases</th></tr>\n");
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	for (subsystem = 0;
+	     subsystem < MEMTRACK_SUBSYSTEM_COUNT;
+	     subsystem++) {
+		res = memtrack_get_stats(subsystem, &stats);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+		res = fetch_about_ssenddataf(ctx,
+			"<tr class=\"ns-%s-bg\"><td>%s</td>"
+			"<td>%"PRIsizet"</td><td>%"PRIsizet"</td>"
+			"<td>%lu</td><td>%lu</td></tr>\n",
+			even ? "even" : "odd",
+			memtrack_subsystem_name(subsystem),
+			stats.current, stats.peak,
+			stats.allocs, stats.frees);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+		even = !even;
+	}
+
+	return fetch_about_ssenddataf(ctx, "</table>\n");
+}
+
+/* exported interface documented in about/perf.h */
+bool fetch_about_perf_handler(struct fetch_about_context *ctx)
+{
+	nserror res;
+
+	/* content is going to return ok */
+	fetch_about_set_http_code(ctx, 200);
+
+	/* content type */
+	if (fetch_about_send_header(ctx, "Content-Type: text/html"))
+		goto fetch_about_perf_handler_aborted;
+
+	res = fetch_about_ssenddataf(ctx,
+		"<html>\n<head>\n"
+		"<title>Performance Status</title>\n"
+		"<link rel=\"stylesheet\" type=\"text/css\" "
+		"href=\"resource:internal.css\">\n"
+		"</head>\n"
+		"<body id=\"configlist\" class=\"ns-even-bg ns-even-fg ns-border\">\n"
+		"<h1 class=\"ns-border\">Performance Status</h1>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	res = perf_llcache(ctx);
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	res = perf_hlcache(ctx);
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	res = perf_imagecache(ctx);
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	res = perf_fetch(ctx);
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	res = perf_html(ctx);
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	res = perf_js(ctx);
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	res = perf_memtrack(ctx);
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	res = fetch_about_ssenddataf(ctx, "</body>\n</html>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	fetch_about_send_finished(ctx);
+
+	return true;
+
+fetch_about_perf_handler_aborted:
+	return false;
+}
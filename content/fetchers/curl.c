@@ -46,6 +46,7 @@
 #include "utils/hashmap.h"
 #include "utils/nsoption.h"
 #include "utils/log.h"
+#include "utils/memtrack.h"
 #include "utils/messages.h"
 #include "utils/utils.h"
 #include "utils/ring.h"
@@ -66,6 +67,26 @@
  */
 #define UPDATES_PER_SECOND 2
 
+/**
+ * time in ms a speculative connection to a host suppresses another
+ */
+#define PRECONNECT_EXPIRE_MS (60 * 1000)
+
+/**
+ * maximum number of speculative connections tracked at once
+ */
+#define PRECONNECT_MAX 16
+
+/**
+ * time in ms between polls while only speculative connections are active
+ */
+#define PRECONNECT_POLL_MS 10
+
+/**
+ * maximum number of hosts remembered as multiplexing over HTTP/2
+ */
+#define MULTIPLEX_HOSTS_MAX 64
+
 /**
  * The ciphersuites the browser is prepared to use for TLS1.3
  */
@@ -232,6 +253,12 @@ struct cert_info {
 #define NSCURL_PROGRESS_T double
 #endif
 
+/* HTTP/2 support is experimental and must be enabled at build time */
+#if defined(WITH_CURL_HTTP2) && \
+    (LIBCURL_VERSION_NUM >= 0x072f00) /* 7.47.0 added CURL_HTTP_VERSION_2TLS */
+#define NSCURL_HTTP2
+#endif
+
 #if LIBCURL_VERSION_NUM >= 0x073800 /* 7.56.0 depricated curl_formadd */
 #define NSCURL_POSTDATA_T curl_mime
 #define NSCURL_POSTDATA_CURLOPT CURLOPT_MIMEPOST
@@ -252,6 +279,7 @@ struct curl_fetch_info {
 	bool stopped;		/**< Download stopped on purpose. */
 	bool only_2xx;		/**< Only HTTP 2xx responses acceptable. */
 	bool downgrade_tls;	/**< Downgrade to TLS 1.2 */
+	bool paused;		/**< Consumer asked for data to be held. */
 	nsurl *url;		/**< URL of this fetch. */
 	lwc_string *host;	/**< The hostname of this fetch. */
 	struct curl_slist *headers;	/**< List of request headers. */
@@ -278,15 +306,56 @@ struct cache_handle {
 	struct cache_handle *r_next; /**< Next cached handle in ring. */
 };
 
+/** Speculative connection entry */
+struct curl_preconnect {
+	CURL *handle; /**< The connecting cURL handle, or NULL when complete */
+	lwc_string *host; /**< The host being connected to */
+	uint64_t started; /**< Time the connection was started in ms */
+
+	struct curl_preconnect *r_prev; /**< Previous entry in ring. */
+	struct curl_preconnect *r_next; /**< Next entry in ring. */
+};
+
+/** Host known to multiplex fetches over one HTTP/2 connection */
+struct curl_multiplex_host {
+	lwc_string *host; /**< The host name */
+
+	struct curl_multiplex_host *r_prev; /**< Previous entry in ring. */
+	struct curl_multiplex_host *r_next; /**< Next entry in ring. */
+};
+
 /** Global cURL multi handle. */
 CURLM *fetch_curl_multi;
 
+#if LIBCURL_VERSION_NUM >= 0x071700
+/** cURL share handle for DNS and TLS session caches of all handles */
+static CURLSH *fetch_curl_share;
+#endif
+
 /** Curl handle with default options set; not used for transfers. */
 static CURL *fetch_blank_curl;
 
 /** Ring of cached handles */
 static struct cache_handle *curl_handle_ring = 0;
 
+/** Ring of speculative connections */
+static struct curl_preconnect *curl_preconnect_ring = NULL;
+
+/** Ring of hosts which have answered over HTTP/2 */
+static struct curl_multiplex_host *curl_multiplex_ring = NULL;
+
+#ifdef NSCURL_HTTP2
+/** HTTP/2 stream weight of each fetch priority class */
+static const long curl_stream_weight[FETCH_PRIORITY_COUNT] = {
+	[FETCH_PRIORITY_DOCUMENT] = 256,
+	[FETCH_PRIORITY_BLOCKING] = 220,
+	[FETCH_PRIORITY_FONT] = 183,
+	[FETCH_PRIORITY_IMAGE] = 110,
+	[FETCH_PRIORITY_DEFERRED] = 32,
+	[FETCH_PRIORITY_PREFETCH] = 1,
+};
+#endif
+
 /** Count of how many schemes the curl fetcher is handling */
 static int curl_fetchers_registered = 0;
 
@@ -327,12 +396,43 @@ static void fetch_curl_finalise(lwc_string *scheme)
 	curl_fetchers_registered--;
 	NSLOG(netsurf, INFO, "Finalise cURL fetcher %s",
 	      lwc_string_data(scheme));
+
+	/* Free anything remaining in the cached curl handle ring. The
+	 * handles use the share so must be cleaned up before it is.
+	 */
+	while (curl_handle_ring != NULL) {
+		h = curl_handle_ring;
+		RING_REMOVE(curl_handle_ring, h);
+		lwc_string_unref(h->host);
+		curl_easy_cleanup(h->handle);
+		free(h);
+	}
+
 	if (curl_fetchers_registered == 0) {
 		CURLMcode codem;
 		/* All the fetchers have been finalised. */
 		NSLOG(netsurf, INFO,
 		      "All cURL fetchers finalised, closing down cURL");
 
+		while (curl_preconnect_ring != NULL) {
+			struct curl_preconnect *p = curl_preconnect_ring;
+			RING_REMOVE(curl_preconnect_ring, p);
+			if (p->handle != NULL) {
+				curl_multi_remove_handle(fetch_curl_multi,
+							 p->handle);
+				curl_easy_cleanup(p->handle);
+			}
+			lwc_string_unref(p->host);
+			free(p);
+		}
+
+		while (curl_multiplex_ring != NULL) {
+			struct curl_multiplex_host *m = curl_multiplex_ring;
+			RING_REMOVE(curl_multiplex_ring, m);
+			lwc_string_unref(m->host);
+			free(m);
+		}
+
 		curl_easy_cleanup(fetch_blank_curl);
 
 		codem = curl_multi_cleanup(fetch_curl_multi);
@@ -340,21 +440,20 @@ static void fetch_curl_finalise(lwc_string *scheme)
 			NSLOG(netsurf, INFO,
 			      "curl_multi_cleanup failed: ignoring");
 
+#if LIBCURL_VERSION_NUM >= 0x071700
+		if ((fetch_curl_share != NULL) &&
+		    (curl_share_cleanup(fetch_curl_share) != CURLSHE_OK))
+			NSLOG(netsurf, INFO,
+			      "curl_share_cleanup failed: ignoring");
+		fetch_curl_share = NULL;
+#endif
+
 		curl_global_cleanup();
 
 		NSLOG(netsurf, DEBUG, "Cleaning up SSL cert chain hashmap");
 		hashmap_destroy(curl_fetch_ssl_hashmap);
 		curl_fetch_ssl_hashmap = NULL;
 	}
-
-	/* Free anything remaining in the cached curl handle ring */
-	while (curl_handle_ring != NULL) {
-		h = curl_handle_ring;
-		RING_REMOVE(curl_handle_ring, h);
-		lwc_string_unref(h->host);
-		curl_easy_cleanup(h->handle);
-		free(h);
-	}
 }
 
 
@@ -441,6 +540,7 @@ static struct curl_fetch_info *fetch_alloc(void)
 	fetch->stopped = false;
 	fetch->only_2xx = false;
 	fetch->downgrade_tls = false;
+	fetch->paused = false;
 	fetch->headers = NULL;
 	fetch->url = NULL;
 	fetch->host = NULL;
@@ -1169,6 +1269,58 @@ static CURLcode fetch_curl_set_postdata(struct curl_fetch_info *f)
 	return code;
 }
 
+/**
+ * Set proxy options on a cURL handle for a url.
+ *
+ * \param handle The cURL handle to set options on.
+ * \param url The url the handle will connect to.
+ * \return CURLE_OK on success or cURL error code on failure.
+ */
+static CURLcode fetch_curl_set_proxy(CURL *handle, const nsurl *url)
+{
+	CURLcode code;
+
+#undef SETOPT
+#define SETOPT(option, value) { \
+	code = curl_easy_setopt(handle, option, value);	\
+	if (code != CURLE_OK)				\
+		return code;				\
+	}
+
+	/* set up proxy options */
+	if (nsoption_bool(http_proxy) &&
+	    (nsoption_charp(http_proxy_host) != NULL) &&
+	    (strncmp(nsurl_access(url), "file:", 5) != 0)) {
+		SETOPT(CURLOPT_PROXY, nsoption_charp(http_proxy_host));
+		SETOPT(CURLOPT_PROXYPORT, (long) nsoption_int(http_proxy_port));
+
+#if LIBCURL_VERSION_NUM >= 0x071304
+		/* Added in 7.19.4 */
+		/* setup the omission list */
+		SETOPT(CURLOPT_NOPROXY, nsoption_charp(http_proxy_noproxy));
+#endif
+
+		if (nsoption_int(http_proxy_auth) != OPTION_HTTP_PROXY_AUTH_NONE) {
+			SETOPT(CURLOPT_PROXYAUTH,
+			       nsoption_int(http_proxy_auth) ==
+					OPTION_HTTP_PROXY_AUTH_BASIC ?
+					(long) CURLAUTH_BASIC :
+					(long) CURLAUTH_NTLM);
+			snprintf(fetch_proxy_userpwd,
+					sizeof fetch_proxy_userpwd,
+					"%s:%s",
+				 nsoption_charp(http_proxy_auth_user),
+				 nsoption_charp(http_proxy_auth_pass));
+			SETOPT(CURLOPT_PROXYUSERPWD, fetch_proxy_userpwd);
+		}
+	} else {
+		SETOPT(CURLOPT_PROXY, NULL);
+	}
+
+	return CURLE_OK;
+}
+
+
 /**
  * Set options specific for a fetch.
  *
@@ -1213,38 +1365,25 @@ static CURLcode fetch_curl_set_options(struct curl_fetch_info *f)
 	}
 
 	/* set up proxy options */
-	if (nsoption_bool(http_proxy) &&
-	    (nsoption_charp(http_proxy_host) != NULL) &&
-	    (strncmp(nsurl_access(f->url), "file:", 5) != 0)) {
-		SETOPT(CURLOPT_PROXY, nsoption_charp(http_proxy_host));
-		SETOPT(CURLOPT_PROXYPORT, (long) nsoption_int(http_proxy_port));
-
-#if LIBCURL_VERSION_NUM >= 0x071304
-		/* Added in 7.19.4 */
-		/* setup the omission list */
-		SETOPT(CURLOPT_NOPROXY, nsoption_charp(http_proxy_noproxy));
-#endif
-
-		if (nsoption_int(http_proxy_auth) != OPTION_HTTP_PROXY_AUTH_NONE) {
-			SETOPT(CURLOPT_PROXYAUTH,
-			       nsoption_int(http_proxy_auth) ==
-					OPTION_HTTP_PROXY_AUTH_BASIC ?
-					(long) CURLAUTH_BASIC :
-					(long) CURLAUTH_NTLM);
-			snprintf(fetch_proxy_userpwd,
-					sizeof fetch_proxy_userpwd,
-					"%s:%s",
-				 nsoption_charp(http_proxy_auth_user),
-				 nsoption_charp(http_proxy_auth_pass));
-			SETOPT(CURLOPT_PROXYUSERPWD, fetch_proxy_userpwd);
-		}
-	} else {
-		SETOPT(CURLOPT_PROXY, NULL);
+	code = fetch_curl_set_proxy(f->curl_handle, f->url);
+	if (code != CURLE_OK) {
+		return code;
 	}
 
 	/* Force-enable SSL session ID caching, as some distros are odd. */
 	SETOPT(CURLOPT_SSL_SESSIONID_CACHE, 1);
 
+#ifdef NSCURL_HTTP2
+	if (nsoption_bool(http2)) {
+		/* Wait for a connection able to multiplex rather than
+		 * opening another to the same host.
+		 */
+		SETOPT(CURLOPT_PIPEWAIT, 1L);
+		SETOPT(CURLOPT_STREAM_WEIGHT,
+		       curl_stream_weight[fetch_get_priority(f->fetch_handle)]);
+	}
+#endif
+
 	if (urldb_get_cert_permissions(f->url)) {
 		/* Disable certificate verification */
 		SETOPT(CURLOPT_SSL_VERIFYPEER, 0L);
@@ -1386,6 +1525,214 @@ static void fetch_curl_cache_handle(CURL *handle, lwc_string *host)
 }
 
 
+/**
+ * Complete a speculative connection.
+ *
+ * The handle is removed from the multi handle and offered to the
+ * handle cache. The entry remains in the ring until it expires to
+ * suppress repeated connections to the host.
+ *
+ * \param p The speculative connection entry.
+ * \param result The result of the connection.
+ */
+static void
+fetch_curl_preconnect_done(struct curl_preconnect *p, CURLcode result)
+{
+	CURLMcode codem;
+
+	NSLOG(netsurf, DEBUG, "preconnected %s: %s",
+	      lwc_string_data(p->host), curl_easy_strerror(result));
+
+	codem = curl_multi_remove_handle(fetch_curl_multi, p->handle);
+	assert(codem == CURLM_OK);
+
+	/* restore the options a cached handle is expected to have */
+	curl_easy_setopt(p->handle, CURLOPT_CONNECT_ONLY, 0L);
+	curl_easy_setopt(p->handle, CURLOPT_NOPROGRESS, 0L);
+	fetch_curl_cache_handle(p->handle, p->host);
+	p->handle = NULL;
+}
+
+
+/**
+ * Find the speculative connection using a cURL handle.
+ *
+ * \param handle The cURL handle to look for.
+ * \return The speculative connection entry or NULL if not found.
+ */
+static struct curl_preconnect *fetch_curl_preconnect_find(CURL *handle)
+{
+	struct curl_preconnect *p = curl_preconnect_ring;
+
+	if (p != NULL) {
+		do {
+			if (p->handle == handle) {
+				return p;
+			}
+			p = p->r_next;
+		} while (p != curl_preconnect_ring);
+	}
+	return NULL;
+}
+
+
+/**
+ * Remove completed speculative connections which have expired.
+ *
+ * \param now The current time in ms.
+ * \return The number of speculative connections still in progress.
+ */
+static int fetch_curl_preconnect_expire(uint64_t now)
+{
+	struct curl_preconnect *p;
+	struct curl_preconnect *next;
+	int active = 0;
+	int count;
+
+	RING_GETSIZE(struct curl_preconnect, curl_preconnect_ring, count);
+
+	p = curl_preconnect_ring;
+	while (count-- > 0) {
+		next = p->r_next;
+		if (p->handle != NULL) {
+			active++;
+		} else if ((now - p->started) > PRECONNECT_EXPIRE_MS) {
+			RING_REMOVE(curl_preconnect_ring, p);
+			lwc_string_unref(p->host);
+			free(p);
+		}
+		p = next;
+	}
+
+	return active;
+}
+
+
+static void fetch_curl_poll(lwc_string *scheme_ignored);
+
+/**
+ * Poll speculative connections.
+ *
+ * The fetch machinery only polls fetchers while fetches are active so
+ * speculative connections schedule their own polling until complete.
+ */
+static void fetch_curl_preconnect_poll(void *unused)
+{
+	uint64_t now;
+
+	fetch_curl_poll(NULL);
+
+	nsu_getmonotonic_ms(&now);
+	if (fetch_curl_preconnect_expire(now) > 0) {
+		guit->misc->schedule(PRECONNECT_POLL_MS,
+				     fetch_curl_preconnect_poll, NULL);
+	}
+}
+
+
+/**
+ * Speculatively warm the connection to a url's host.
+ *
+ * A connect only transfer is made to the host. This populates the
+ * shared DNS cache and, for TLS hosts, the shared session cache so the
+ * later fetch skips resolution and resumes the TLS session.
+ *
+ * libcurl cannot resolve a host name without also connecting to it so
+ * DNS only requests are not supported.
+ *
+ * \param url The url whose host to connect to.
+ * \param dns_only Only resolve the host name.
+ * \return NSERROR_OK on success, NSERROR_NOT_IMPLEMENTED for DNS only
+ *         requests or error code on failure.
+ */
+static nserror fetch_curl_preconnect(nsurl *url, bool dns_only)
+{
+	struct curl_preconnect *p;
+	lwc_string *host;
+	CURL *handle;
+	CURLcode code;
+	CURLMcode codem;
+	uint64_t now;
+	int count;
+
+	if (dns_only) {
+		return NSERROR_NOT_IMPLEMENTED;
+	}
+
+	if (inside_curl) {
+		/* handles cannot be added from within cURL callbacks */
+		return NSERROR_OK;
+	}
+
+	host = nsurl_get_component(url, NSURL_HOST);
+	if (host == NULL) {
+		return NSERROR_BAD_URL;
+	}
+
+	nsu_getmonotonic_ms(&now);
+	fetch_curl_preconnect_expire(now);
+
+	RING_FINDBYLWCHOST(curl_preconnect_ring, p, host);
+	if (p != NULL) {
+		/* connection in progress or recently made */
+		lwc_string_unref(host);
+		return NSERROR_OK;
+	}
+
+	RING_GETSIZE(struct curl_preconnect, curl_preconnect_ring, count);
+	if (count >= PRECONNECT_MAX) {
+		lwc_string_unref(host);
+		return NSERROR_OK;
+	}
+
+	p = calloc(1, sizeof(*p));
+	if (p == NULL) {
+		lwc_string_unref(host);
+		return NSERROR_NOMEM;
+	}
+	p->host = host;
+	p->started = now;
+	RING_INSERT(curl_preconnect_ring, p);
+
+	handle = curl_easy_duphandle(fetch_blank_curl);
+	if (handle == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	code = curl_easy_setopt(handle, CURLOPT_URL, nsurl_access(url));
+	if (code == CURLE_OK)
+		code = curl_easy_setopt(handle, CURLOPT_CONNECT_ONLY, 1L);
+	if (code == CURLE_OK)
+		code = curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 1L);
+	if (code == CURLE_OK)
+		code = curl_easy_setopt(handle, CURLOPT_PRIVATE, p);
+	if ((code == CURLE_OK) && urldb_get_cert_permissions(url)) {
+		code = curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+		if (code == CURLE_OK)
+			code = curl_easy_setopt(handle,
+						CURLOPT_SSL_VERIFYHOST, 0L);
+	}
+	if (code == CURLE_OK)
+		code = fetch_curl_set_proxy(handle, url);
+	if (code != CURLE_OK) {
+		curl_easy_cleanup(handle);
+		return NSERROR_INVALID;
+	}
+
+	codem = curl_multi_add_handle(fetch_curl_multi, handle);
+	if (codem != CURLM_OK && codem != CURLM_CALL_MULTI_PERFORM) {
+		curl_easy_cleanup(handle);
+		return NSERROR_INVALID;
+	}
+	p->handle = handle;
+
+	guit->misc->schedule(PRECONNECT_POLL_MS,
+			     fetch_curl_preconnect_poll, NULL);
+
+	return NSERROR_OK;
+}
+
+
 /**
  * Clean up the provided fetch object and free it.
  *
@@ -1437,6 +1784,33 @@ static void fetch_curl_abort(void *vf)
 }
 
 
+/**
+ * Pause or resume delivery of a fetch's data.
+ *
+ * Pausing takes effect at the next write, which returns
+ * CURL_WRITEFUNC_PAUSE so cURL holds the data and stops reading from
+ * the connection.
+ */
+static void fetch_curl_pause(void *vf, bool paused)
+{
+	struct curl_fetch_info *f = (struct curl_fetch_info *)vf;
+	bool was_inside_curl;
+
+	f->paused = paused;
+
+	if ((paused == false) && (f->curl_handle != NULL)) {
+		/* Unpausing may deliver the held data immediately through
+		 * the write callback, so handle an abort from the consumer
+		 * there as a deferred one, as within fetch_curl_poll.
+		 */
+		was_inside_curl = inside_curl;
+		inside_curl = true;
+		curl_easy_pause(f->curl_handle, CURLPAUSE_CONT);
+		inside_curl = was_inside_curl;
+	}
+}
+
+
 /**
  * Free a fetch structure and associated resources.
  */
@@ -1652,6 +2026,7 @@ static void fetch_curl_poll(lwc_string *scheme_ignored)
 	int running, queue;
 	CURLMcode codem;
 	CURLMsg *curl_msg;
+	struct curl_preconnect *preconnect;
 
 	write_to_log("fetch_curl: poll enter\n");
 
@@ -1713,8 +2088,15 @@ static void fetch_curl_poll(lwc_string *scheme_ignored)
 		switch (curl_msg->msg) {
 			case CURLMSG_DONE:
 				write_to_log("fetch_curl: CURLMSG_DONE handle=%p result=%d\n", curl_msg->easy_handle, curl_msg->data.result);
-				fetch_curl_done(curl_msg->easy_handle,
+				preconnect = fetch_curl_preconnect_find(
+						curl_msg->easy_handle);
+				if (preconnect != NULL) {
+					fetch_curl_preconnect_done(preconnect,
 						curl_msg->data.result);
+				} else {
+					fetch_curl_done(curl_msg->easy_handle,
+							curl_msg->data.result);
+				}
 				break;
 			default:
 				break;
@@ -1833,6 +2215,11 @@ static size_t fetch_curl_data(char *data, size_t size, size_t nmemb, void *_f)
 		return 0;
 	}
 
+	if (f->paused) {
+		/* leave the data with cURL until the consumer catches up */
+		return CURL_WRITEFUNC_PAUSE;
+	}
+
 	/* send data to the caller */
 	msg.type = FETCH_DATA;
 	msg.data.header_or_data.buf = (const uint8_t *) data;
@@ -1848,6 +2235,68 @@ static size_t fetch_curl_data(char *data, size_t size, size_t nmemb, void *_f)
 }
 
 
+/**
+ * Record a host as multiplexing fetches over HTTP/2.
+ *
+ * Once the ring is full the oldest host is replaced.
+ *
+ * \param host The host name.
+ */
+static void fetch_curl_multiplex_host(lwc_string *host)
+{
+	struct curl_multiplex_host *m = NULL;
+	int count;
+
+	RING_FINDBYLWCHOST(curl_multiplex_ring, m, host);
+	if (m != NULL) {
+		return;
+	}
+
+	RING_GETSIZE(struct curl_multiplex_host, curl_multiplex_ring, count);
+	if (count >= MULTIPLEX_HOSTS_MAX) {
+		/* rotate the ring and reuse the oldest entry */
+		m = curl_multiplex_ring;
+		curl_multiplex_ring = m->r_next;
+		lwc_string_unref(m->host);
+		m->host = lwc_string_ref(host);
+		return;
+	}
+
+	m = malloc(sizeof(*m));
+	if (m == NULL) {
+		return;
+	}
+	m->host = lwc_string_ref(host);
+	RING_INSERT(curl_multiplex_ring, m);
+
+	NSLOG(netsurf, INFO, "%s multiplexes over HTTP/2",
+	      lwc_string_data(host));
+}
+
+/**
+ * Maximum number of simultaneous fetches from a host.
+ *
+ * A host which has answered over HTTP/2 carries every fetch as a
+ * stream on one connection so the stream limit applies to it.
+ *
+ * \param host The host name.
+ * \return The number of fetches which may be active.
+ */
+static int fetch_curl_host_limit(lwc_string *host)
+{
+	struct curl_multiplex_host *m = NULL;
+
+	if (nsoption_bool(http2)) {
+		RING_FINDBYLWCHOST(curl_multiplex_ring, m, host);
+		if ((m != NULL) &&
+		    (nsoption_int(max_streams_per_host) >
+		     nsoption_int(max_fetchers_per_host))) {
+			return nsoption_int(max_streams_per_host);
+		}
+	}
+	return nsoption_int(max_fetchers_per_host);
+}
+
 /**
  * Callback function for headers.
  *
@@ -1875,6 +2324,11 @@ fetch_curl_header(char *data, size_t size, size_t nmemb, void *_f)
 	msg.data.header_or_data.len = size;
 	fetch_send_callback(&msg, f->fetch_handle);
 
+	if (6 < size && strncmp(data, "HTTP/2", 6) == 0) {
+		/* status line of a response on a multiplexed connection */
+		fetch_curl_multiplex_host(f->host);
+	}
+
 #define SKIP_ST(o) for (i = (o); i < (int) size && (data[i] == ' ' || data[i] == '\t'); i++)
 
 	if (12 < size && strncasecmp(data, "Location:", 9) == 0) {
@@ -1953,6 +2407,105 @@ static int fetch_curl_fdset(lwc_string *scheme, fd_set *read_set,
 }
 
 
+#if defined(WITH_MEMTRACK) && defined(HAVE_PTHREADS)
+/* curl allocation functions which account memory used by the library.
+ *
+ * The threaded resolver allocates from its own thread so the library
+ * is only hooked when the accounting is serialised by a mutex.
+ */
+
+/**
+ * Header prefixed to every curl allocation to record its size.
+ *
+ * The union keeps the allocation that follows aligned for any type.
+ */
+typedef union {
+	size_t size;
+	long double ld;
+	long long ll;
+	void *p;
+} fetch_curl_mem_header;
+
+static void *fetch_curl_mem_malloc(size_t size)
+{
+	fetch_curl_mem_header *hdr;
+
+	hdr = malloc(sizeof(*hdr) + size);
+	if (hdr == NULL) {
+		return NULL;
+	}
+
+	hdr->size = size;
+	memtrack_alloc(MEMTRACK_CURL, size);
+
+	return hdr + 1;
+}
+
+static void fetch_curl_mem_free(void *ptr)
+{
+	fetch_curl_mem_header *hdr;
+
+	if (ptr != NULL) {
+		hdr = (fetch_curl_mem_header *)ptr - 1;
+		memtrack_free(MEMTRACK_CURL, hdr->size);
+		free(hdr);
+	}
+}
+
+static void *fetch_curl_mem_realloc(void *ptr, size_t size)
+{
+	fetch_curl_mem_header *hdr;
+	size_t old_size;
+
+	if (ptr == NULL) {
+		return fetch_curl_mem_malloc(size);
+	}
+
+	hdr = (fetch_curl_mem_header *)ptr - 1;
+	old_size = hdr->size;
+
+	hdr = realloc(hdr, sizeof(*hdr) + size);
+	if (hdr == NULL) {
+		return NULL;
+	}
+
+	hdr->size = size;
+	memtrack_resize(MEMTRACK_CURL, old_size, size);
+
+	return hdr + 1;
+}
+
+static char *fetch_curl_mem_strdup(const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *ret;
+
+	ret = fetch_curl_mem_malloc(len);
+	if (ret != NULL) {
+		memcpy(ret, str, len);
+	}
+
+	return ret;
+}
+
+static void *fetch_curl_mem_calloc(size_t nmemb, size_t size)
+{
+	void *ret;
+
+	if ((size != 0) &&
+	    (nmemb > ((size_t)-1 - sizeof(fetch_curl_mem_header)) / size)) {
+		return NULL;
+	}
+
+	ret = fetch_curl_mem_malloc(nmemb * size);
+	if (ret != NULL) {
+		memset(ret, 0, nmemb * size);
+	}
+
+	return ret;
+}
+#endif
+
 
 /* exported function documented in content/fetchers/curl.h */
 nserror fetch_curl_register(void)
@@ -1967,9 +2520,12 @@ nserror fetch_curl_register(void)
 		.setup = fetch_curl_setup,
 		.start = fetch_curl_start,
 		.abort = fetch_curl_abort,
+		.pause = fetch_curl_pause,
 		.free = fetch_curl_free,
 		.poll = fetch_curl_poll,
 		.fdset = fetch_curl_fdset,
+		.preconnect = fetch_curl_preconnect,
+		.host_limit = fetch_curl_host_limit,
 		.finalise = fetch_curl_finalise
 	};
 
@@ -1987,7 +2543,16 @@ nserror fetch_curl_register(void)
 
 	NSLOG(netsurf, INFO, "curl_version %s", curl_version());
 
+#if defined(WITH_MEMTRACK) && defined(HAVE_PTHREADS)
+	code = curl_global_init_mem(CURL_GLOBAL_ALL,
+				    fetch_curl_mem_malloc,
+				    fetch_curl_mem_free,
+				    fetch_curl_mem_realloc,
+				    fetch_curl_mem_strdup,
+				    fetch_curl_mem_calloc);
+#else
 	code = curl_global_init(CURL_GLOBAL_ALL);
+#endif
 	if (code != CURLE_OK) {
 		NSLOG(netsurf, INFO, "curl_global_init failed.");
 		return NSERROR_INIT_FAILED;
@@ -2017,6 +2582,28 @@ nserror fetch_curl_register(void)
 		SETOPT(CURLMOPT_MAXCONNECTS, maxconnects);
 		SETOPT(CURLMOPT_MAX_TOTAL_CONNECTIONS, maxconnects);
 		SETOPT(CURLMOPT_MAX_HOST_CONNECTIONS, nsoption_int(max_fetchers_per_host));
+#ifdef NSCURL_HTTP2
+		if (nsoption_bool(http2)) {
+			SETOPT(CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#if LIBCURL_VERSION_NUM >= 0x074300 /* 7.67.0 */
+			SETOPT(CURLMOPT_MAX_CONCURRENT_STREAMS,
+			       (long)nsoption_int(max_streams_per_host));
+#endif
+		}
+#endif
+	}
+#endif
+
+#if LIBCURL_VERSION_NUM >= 0x071700
+	/* Share DNS and TLS session caches between all handles so a
+	 * speculative connection benefits the fetch that follows it.
+	 */
+	fetch_curl_share = curl_share_init();
+	if (fetch_curl_share != NULL) {
+		curl_share_setopt(fetch_curl_share,
+				  CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(fetch_curl_share,
+				  CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
 	}
 #endif
 
@@ -2045,8 +2632,16 @@ nserror fetch_curl_register(void)
 		SETOPT(CURLOPT_VERBOSE, 1);
 	}
 
-	/* Currently we explode if curl uses HTTP2, so force 1.1. */
-	SETOPT(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+#ifdef NSCURL_HTTP2
+	if (nsoption_bool(http2)) {
+		/* Offer HTTP/2 through ALPN, plain http stays on 1.1 */
+		SETOPT(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+	} else
+#endif
+	{
+		/* Currently we explode if curl uses HTTP2, so force 1.1. */
+		SETOPT(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+	}
 
 	SETOPT(CURLOPT_WRITEFUNCTION, fetch_curl_data);
 	SETOPT(CURLOPT_HEADERFUNCTION, fetch_curl_header);
@@ -2058,6 +2653,11 @@ nserror fetch_curl_register(void)
 	SETOPT(CURLOPT_LOW_SPEED_TIME, 180L);
 	SETOPT(CURLOPT_NOSIGNAL, 1L);
 	SETOPT(CURLOPT_CONNECTTIMEOUT, nsoption_uint(curl_fetch_timeout));
+#if LIBCURL_VERSION_NUM >= 0x071700
+	if (fetch_curl_share != NULL) {
+		SETOPT(CURLOPT_SHARE, fetch_curl_share);
+	}
+#endif
 
 	if (nsoption_charp(ca_bundle) &&
 	    strcmp(nsoption_charp(ca_bundle), "")) {
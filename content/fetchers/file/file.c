@@ -39,9 +39,6 @@
 #include <time.h>
 #include <stdio.h>
 #include <stdarg.h>
-#ifdef HAVE_MMAP
-#include <sys/mman.h>
-#endif
 #include <libwapcaplet/libwapcaplet.h>
 
 #include "netsurf/inttypes.h"
@@ -63,7 +60,7 @@
 #include "file.h"
 
 /* Maximum size of read buffer */
-#define FETCH_FILE_MAX_BUF_SIZE (1024 * 1024)
+#define FETCH_FILE_MAX_BUF_SIZE (32 * 1024 * 1024)
 
 /** Context for a fetch */
 struct fetch_file_context {
@@ -73,11 +70,16 @@ struct fetch_file_context {
 
 	bool aborted; /**< Flag indicating fetch has been aborted */
 	bool locked; /**< Flag indicating entry is already entered */
+	bool paused; /**< Flag indicating consumer asked for data to be held */
 
 	nsurl *url; /**< The full url the fetch refers to */
 	char *path; /**< The actual path to be used with open() */
 
 	time_t file_etag; /**< Request etag for file (previous st.m_time) */
+
+	FILE *infile; /**< Plain file being read, NULL when not started or done */
+	off_t file_size; /**< Size of the plain file */
+	off_t file_read; /**< Bytes of the plain file sent so far */
 };
 
 static struct fetch_file_context *ring = NULL;
@@ -193,6 +195,9 @@ fetch_file_setup(struct fetch *fetchh,
 static void fetch_file_free(void *ctx)
 {
 	struct fetch_file_context *c = ctx;
+	if (c->infile != NULL) {
+		fclose(c->infile);
+	}
 	nsurl_unref(c->url);
 	free(c->path);
 	free(ctx);
@@ -216,6 +221,17 @@ static void fetch_file_abort(void *ctx)
 	c->aborted = true;
 }
 
+/** callback to pause or resume a file fetch */
+static void fetch_file_pause(void *ctx, bool paused)
+{
+	struct fetch_file_context *c = ctx;
+
+	/* The poll loop stops reading while the fetch is paused and
+	 * carries on from where it left off once resumed.
+	 */
+	c->paused = paused;
+}
+
 static int fetch_file_errno_to_http_code(int error_no)
 {
 	switch (error_no) {
@@ -269,96 +285,90 @@ fetch_file_process_error_aborted:
 
 
 /** Process object as a regular file */
-static void fetch_file_process_plain(struct fetch_file_context *ctx,
-				     struct stat *fdstat)
+/**
+ * Send the next part of the data of a plain file.
+ *
+ * At most one chunk is sent each time so the consumer may process it,
+ * and pause the fetch, before more is read. The poll loop calls again
+ * until the file is exhausted.
+ *
+ * \param ctx The fetch context with the file open.
+ */
+static void fetch_file_process_plain_data(struct fetch_file_context *ctx)
 {
-#ifdef HAVE_MMAP
 	fetch_msg msg;
-	char *buf = NULL;
-	size_t buf_size;
-
-	int fd; /**< The file descriptor of the object */
-
-	/* Check if we can just return not modified */
-	if (ctx->file_etag != 0 && ctx->file_etag == fdstat->st_mtime) {
-		fetch_set_http_code(ctx->fetchh, 304);
-		msg.type = FETCH_NOTMODIFIED;
-		fetch_file_send_callback(&msg, ctx);
-		return;
-	}
-
-	fd = open(ctx->path, O_RDONLY);
-	if (fd < 0) {
-		/* process errors as appropriate */
-		fetch_file_process_error(ctx,
-				fetch_file_errno_to_http_code(errno));
-		return;
-	}
-
-	/* set buffer size */
-	buf_size = fdstat->st_size;
+	struct fetch_chunk *chunk;
+	size_t chunk_size;
+	size_t chunk_read;
+	size_t res;
+
+	/* The file is read into reference counted chunks which are
+	 * handed to the consumer. A file which fits in a single chunk
+	 * is retained by the cache as is, without being copied again.
+	 */
+	if ((ctx->file_read < ctx->file_size) && (ctx->paused == false)) {
+		chunk_size = ctx->file_size - ctx->file_read;
+		if (chunk_size > FETCH_FILE_MAX_BUF_SIZE)
+			chunk_size = FETCH_FILE_MAX_BUF_SIZE;
 
-	/* allocate the buffer storage */
-	if (buf_size > 0) {
-		buf = mmap(NULL, buf_size, PROT_READ, MAP_SHARED, fd, 0);
-		if (buf == MAP_FAILED) {
+		if (fetch_chunk_create(chunk_size, &chunk) != NSERROR_OK) {
 			msg.type = FETCH_ERROR;
-			msg.data.error = "Unable to map memory for file data buffer";
+			msg.data.error =
+				"Unable to allocate memory for file data buffer";
 			fetch_file_send_callback(&msg, ctx);
-			close(fd);
-			return;
+			goto fetch_file_process_aborted;
 		}
-	}
 
-	/* fetch is going to be successful */
-	fetch_set_http_code(ctx->fetchh, 200);
+		for (chunk_read = 0; chunk_read < chunk_size;
+		     chunk_read += res) {
+			res = fread(chunk->data + chunk_read, 1,
+				    chunk_size - chunk_read, ctx->infile);
+			if (res == 0) {
+				break;
+			}
+		}
 
-	/* Any callback can result in the fetch being aborted.
-	 * Therefore, we _must_ check for this after _every_ call to
-	 * fetch_file_send_callback().
-	 */
+		if (chunk_read < chunk_size) {
+			fetch_chunk_unref(chunk);
+			msg.type = FETCH_ERROR;
+			if (feof(ctx->infile)) {
+				msg.data.error = "Unexpected EOF reading file";
+			} else {
+				msg.data.error = "Error reading file";
+			}
+			fetch_file_send_callback(&msg, ctx);
+			goto fetch_file_process_aborted;
+		}
+		ctx->file_read += chunk_read;
 
-	/* content type */
-	if (fetch_file_send_header(ctx, "Content-Type: %s", 
-				   guit->fetch->filetype(ctx->path))) {
-		goto fetch_file_process_aborted;
-	}
+		msg.type = FETCH_DATA_CHUNK;
+		msg.data.chunk = chunk;
+		fetch_file_send_callback(&msg, ctx);
+		fetch_chunk_unref(chunk);
 
-	/* content length */
-	if (fetch_file_send_header(ctx, "Content-Length: %" PRIsizet,
-				   fdstat->st_size)) {
-		goto fetch_file_process_aborted;
+		if (ctx->aborted)
+			goto fetch_file_process_aborted;
 	}
 
-	/* create etag */
-	if (fetch_file_send_header(ctx, "ETag: \"%10" PRId64 "\"",
-				   (int64_t) fdstat->st_mtime)) {
-		goto fetch_file_process_aborted;
+	if (ctx->file_read < ctx->file_size) {
+		/* more to send on a later poll */
+		return;
 	}
 
-	msg.type = FETCH_DATA;
-	msg.data.header_or_data.buf = (const uint8_t *) buf;
-	msg.data.header_or_data.len = buf_size;
+	msg.type = FETCH_FINISHED;
 	fetch_file_send_callback(&msg, ctx);
 
-	if (ctx->aborted == false) {
-		msg.type = FETCH_FINISHED;
-		fetch_file_send_callback(&msg, ctx);
-	}
-
 fetch_file_process_aborted:
 
-	if (buf != NULL)
-		munmap(buf, buf_size);
-	close(fd);
-#else
-	fetch_msg msg;
-	char *buf;
-	size_t buf_size;
-
-	ssize_t tot_read = 0;
-	ssize_t res;
+	fclose(ctx->infile);
+	ctx->infile = NULL;
+	return;
+}
 
+static void fetch_file_process_plain(struct fetch_file_context *ctx,
+				     struct stat *fdstat)
+{
+	fetch_msg msg;
 	FILE *infile;
 
 	/* Check if we can just return not modified */
@@ -377,22 +387,6 @@ fetch_file_process_aborted:
 		return;
 	}
 
-	/* set buffer size */
-	buf_size = fdstat->st_size;
-	if (buf_size > FETCH_FILE_MAX_BUF_SIZE)
-		buf_size = FETCH_FILE_MAX_BUF_SIZE;
-
-	/* allocate the buffer storage */
-	buf = malloc(buf_size);
-	if (buf == NULL) {
-		msg.type = FETCH_ERROR;
-		msg.data.error =
-			"Unable to allocate memory for file data buffer";
-		fetch_file_send_callback(&msg, ctx);
-		fclose(infile);
-		return;
-	}
-
 	/* fetch is going to be successful */
 	fetch_set_http_code(ctx->fetchh, 200);
 
@@ -419,41 +413,16 @@ fetch_file_process_aborted:
 		goto fetch_file_process_aborted;
 	}
 
-	/* main data loop */
-	while (tot_read < fdstat->st_size) {
-		res = fread(buf, 1, buf_size, infile);
-		if (res == 0) {
-			if (feof(infile)) {
-				msg.type = FETCH_ERROR;
-				msg.data.error = "Unexpected EOF reading file";
-				fetch_file_send_callback(&msg, ctx);
-				goto fetch_file_process_aborted;
-			} else {
-				msg.type = FETCH_ERROR;
-				msg.data.error = "Error reading file";
-				fetch_file_send_callback(&msg, ctx);
-				goto fetch_file_process_aborted;
-			}
-		}
-		tot_read += res;
-
-		msg.type = FETCH_DATA;
-		msg.data.header_or_data.buf = (const uint8_t *) buf;
-		msg.data.header_or_data.len = res;
-		if (fetch_file_send_callback(&msg, ctx))
-			break;
-	}
+	ctx->infile = infile;
+	ctx->file_size = fdstat->st_size;
+	ctx->file_read = 0;
 
-	if (ctx->aborted == false) {
-		msg.type = FETCH_FINISHED;
-		fetch_file_send_callback(&msg, ctx);
-	}
+	fetch_file_process_plain_data(ctx);
+	return;
 
 fetch_file_process_aborted:
 
 	fclose(infile);
-	free(buf);
-#endif
 	return;
 }
 
@@ -810,8 +779,18 @@ static void fetch_file_poll(lwc_string *scheme)
 
 		/* Only process non-aborted fetches */
 		if (c->aborted == false) {
-			/* file fetches can be processed in one go */
-			fetch_file_process(c);
+			if (c->infile == NULL) {
+				fetch_file_process(c);
+			} else if (c->paused == false) {
+				/* resume sending the file's data */
+				fetch_file_process_plain_data(c);
+			}
+		}
+
+		/* Plain files being sent stay in the ring until complete */
+		if ((c->aborted == false) && (c->infile != NULL)) {
+			RING_INSERT(save_ring, c);
+			continue;
 		}
 
 		/* And now finish */
@@ -835,6 +814,7 @@ nserror fetch_file_register(void)
 		.setup = fetch_file_setup,
 		.start = fetch_file_start,
 		.abort = fetch_file_abort,
+		.pause = fetch_file_pause,
 		.free = fetch_file_free,
 		.poll = fetch_file_poll,
 		.finalise = fetch_file_finalise
@@ -22,10 +22,21 @@
  *
  * file based backing store.
  *
- * \todo Consider improving eviction sorting to include objects size
- *         and remaining lifetime and other cost metrics.
+ * Eviction order is kept incrementally in a heap ordered by a
+ * priority computed by a selectable policy.
  *
- * \todo Implement mmap retrieval where supported.
+ * \todo Consider including remaining lifetime and other cost metrics
+ *         in the eviction priority.
+ *
+ * \todo Implement mmap retrieval of element data where supported.
+ *
+ * Where threads are available all writes, unlinks and control file
+ * updates are performed by a background I/O thread so the browser
+ * never waits on the disc while storing objects.
+ *
+ * Elements of compressible types are stored deflate compressed when
+ * that makes them usefully smaller and transparently inflated when
+ * fetched.
  *
  * \todo Implement static retrieval for metadata objects as their heap
  *         lifetime is typically very short, though this may be obsoleted
@@ -41,8 +52,17 @@
 #include <errno.h>
 #include <time.h>
 #include <stdlib.h>
+#include <zlib.h>
 #include <nsutils/unistd.h>
 
+#include "utils/config.h"
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "netsurf/inttypes.h"
 #include "utils/filepath.h"
 #include "utils/file.h"
@@ -56,7 +76,7 @@
 #include "content/backing_store.h"
 
 /** Backing store file format version */
-#define CONTROL_VERSION 202
+#define CONTROL_VERSION 204
 
 /**
  * Number of milliseconds after a update before control data
@@ -67,6 +87,12 @@
 /** Filename of serialised entries */
 #define ENTRIES_FNAME "entries"
 
+/** Magic number at the start of the serialised entries ("NSBI") */
+#define ENTRIES_MAGIC 0x4e534249
+
+/** Serialised entries format version */
+#define ENTRIES_VERSION 2
+
 /** Filename of block file index */
 #define BLOCKS_FNAME "blocks"
 
@@ -88,6 +114,33 @@
 /** length in bytes of a block files use map */
 #define BLOCK_USE_MAP_SIZE (1 << (BLOCK_ENTRY_COUNT - 3))
 
+/** Maximum number of element writes queued for the I/O thread */
+#define STORE_IO_QUEUE_MAX 256
+
+/** Maximum number of bytes of element data queued for the I/O thread */
+#define STORE_IO_QUEUE_BYTES (8 * 1024 * 1024)
+
+/**
+ * Number of milliseconds between checks for completed background
+ * I/O operations
+ */
+#define STORE_IO_REAP_TIME 50
+
+/** Smallest element which is considered for compression */
+#define STORE_COMPRESS_MIN 1024
+
+/**
+ * Compression level. Elements are compressed as they are stored so
+ * speed is favoured over ratio.
+ */
+#define STORE_COMPRESS_LEVEL Z_BEST_SPEED
+
+/** Eviction policy in use */
+#define STORE_EVICT_POLICY EVICT_POLICY_LFU
+
+/** Heap index of an entry which is not in the eviction heap */
+#define EVICT_HEAP_NONE UINT32_MAX
+
 /**
  * The type used as a binary identifier for each entry derived from
  * the URL. A larger identifier will have fewer collisions but
@@ -125,8 +178,22 @@ enum store_entry_elem_flags {
 	ENTRY_ELEM_FLAG_MMAP = 0x2,
 	/** entry data allocation is in small object pool */
 	ENTRY_ELEM_FLAG_SMALL = 0x4,
+	/** entry data is deflate compressed on disc */
+	ENTRY_ELEM_FLAG_DEFLATE = 0x8,
 };
 
+/** element flags which are made persistent */
+#define ENTRY_ELEM_FLAG_PERSIST ENTRY_ELEM_FLAG_DEFLATE
+
+
+/**
+ * Eviction policy index values.
+ */
+enum store_evict_policy_idx {
+	EVICT_POLICY_LRU = 0, /**< least recently used */
+	EVICT_POLICY_LFU = 1, /**< least frequently used then oldest */
+	EVICT_POLICY_GDSF = 2, /**< greedy dual size frequency */
+};
 
 enum store_entry_flags {
 	/** entry is normal */
@@ -141,7 +208,7 @@ enum store_entry_flags {
  * An element keeps data about:
  *  - the current memory allocation
  *  - the number of outstanding references to the memory
- *  - the size of the element data
+ *  - the size of the element data on disc and once decompressed
  *  - flags controlling how the memory and element are handled
  *
  * @note Order is important to avoid excessive structure packing overhead.
@@ -149,6 +216,7 @@ enum store_entry_flags {
 struct store_entry_element {
 	uint8_t* data; /**< data allocated */
 	uint32_t size; /**< size of entry element on disc */
+	uint32_t raw_size; /**< size of entry element data */
 	block_index_t block; /**< small object data block */
 	uint8_t ref; /**< element data reference count */
 	uint8_t flags; /**< entry flags */
@@ -165,14 +233,57 @@ struct store_entry_element {
  * @note Order is important to avoid excessive structure packing overhead.
  */
 struct store_entry {
-	nsurl *url; /**< The URL for this entry */
+	nsurl *url; /**< The URL for this entry or NULL until first use */
+	const char *url_str; /**< URL text in the loaded index until first use */
 	int64_t last_used; /**< UNIX time the entry was last used */
+	uint64_t evict_key; /**< eviction priority, lowest is evicted first */
+	entry_ident_t ident; /**< identifier of entry derived from the URL */
+	uint32_t url_len; /**< length of url_str */
+	uint32_t heap_idx; /**< index of entry in the eviction heap */
 	uint16_t use_count; /**< number of times this entry has been accessed */
 	uint8_t flags; /**< entry flags */
 	/** Entry element (data or meta) specific information */
 	struct store_entry_element elem[ENTRY_ELEM_COUNT];
 };
 
+/**
+ * Serialised entries file header.
+ *
+ * The entries file consists of this header followed by entry_count
+ * fixed width store_index_entry records and then a pool of NULL
+ * terminated URL strings the records refer to. The checksum covers
+ * everything after the header. Values are in host byte order as the
+ * store is never shared between machines.
+ */
+struct store_index_header {
+	uint32_t magic; /**< ENTRIES_MAGIC */
+	uint32_t version; /**< ENTRIES_VERSION */
+	uint32_t entry_size; /**< size of each store_index_entry */
+	uint32_t entry_count; /**< number of entry records */
+	uint32_t pool_size; /**< size of URL string pool (multiple of 4) */
+	uint32_t checksum; /**< checksum of records and string pool */
+	uint32_t reserved[2]; /**< pad header to eight byte alignment */
+};
+
+/**
+ * Serialised entry record.
+ *
+ * @note Order is important to avoid excessive structure packing overhead.
+ */
+struct store_index_entry {
+	int64_t last_used; /**< UNIX time the entry was last used */
+	entry_ident_t ident; /**< entry identifier */
+	uint32_t url_offset; /**< offset of URL in string pool */
+	uint32_t url_len; /**< length of URL excluding terminator */
+	uint32_t size[ENTRY_ELEM_COUNT]; /**< size of elements on disc */
+	uint32_t raw_size[ENTRY_ELEM_COUNT]; /**< size of element data */
+	block_index_t block[ENTRY_ELEM_COUNT]; /**< small block of elements */
+	uint16_t use_count; /**< number of times entry has been accessed */
+	uint8_t flags; /**< entry flags */
+	uint8_t elem_flags[ENTRY_ELEM_COUNT]; /**< persistent element flags */
+	uint8_t pad[3]; /**< pad record to eight byte alignment */
+};
+
 /**
  * Small block file.
  */
@@ -183,6 +294,70 @@ struct block_file {
 	uint8_t use_map[BLOCK_USE_MAP_SIZE];
 };
 
+/**
+ * Background I/O operation types.
+ */
+enum store_io_op {
+	STORE_IO_WRITE_BLOCK, /**< write element data into a block file */
+	STORE_IO_WRITE_FILE, /**< write element data to an individual file */
+	STORE_IO_TRUNCATE, /**< set the extent of a block file */
+	STORE_IO_UNLINK, /**< remove an individual file */
+	STORE_IO_REPLACE, /**< atomically replace a control file */
+};
+
+/**
+ * Background I/O operation.
+ *
+ * Operations are immutable once queued. Element data being written
+ * is kept alive by a reference on the element which is dropped when
+ * the completed operation is reaped on the main thread.
+ */
+struct store_io {
+	struct store_io *next; /**< next operation in queue */
+	enum store_io_op op; /**< operation to perform */
+	int fd; /**< block file to write or truncate */
+	off_t offset; /**< offset of write or extent of truncate */
+	char *fname; /**< file to write, unlink or replace */
+	char *tname; /**< temporary file for replace */
+	const uint8_t *data; /**< data to write */
+	size_t size; /**< size of data */
+	uint8_t *owned; /**< allocation freed when operation completes */
+	bool *dirty; /**< flag to set again if a replace fails */
+	entry_ident_t ident; /**< entry holding data reference */
+	int elem_idx; /**< element holding data reference or -1 */
+	nserror res; /**< result of the operation */
+
+	/* outcome recorded by the I/O thread and logged on completion */
+	const char *failed; /**< step of the operation that failed or NULL */
+	ssize_t written; /**< bytes written by the operation */
+	int err; /**< errno of the failed step */
+};
+
+/**
+ * Background I/O queue.
+ */
+struct store_io_queue {
+	unsigned int count; /**< number of outstanding operations */
+	size_t bytes; /**< element data held by outstanding operations */
+	bool reap_scheduled; /**< completion callback is scheduled */
+	bool running; /**< I/O thread is running */
+
+#ifdef HAVE_PTHREADS
+	pthread_t thread; /**< I/O thread */
+	pthread_mutex_t lock; /**< protects following members */
+	pthread_cond_t cond; /**< signalled when work is queued */
+	bool quit; /**< I/O thread should exit when queue is empty */
+	struct store_io *head; /**< queued operations */
+	struct store_io **tail; /**< end of queued operations */
+	struct store_io *done; /**< completed operations */
+	struct store_io **done_tail; /**< end of completed operations */
+
+	/* only used by the I/O thread */
+	int sync_fd[ENTRY_ELEM_COUNT * BLOCK_FILE_COUNT]; /**< unsynced fds */
+	unsigned int sync_count; /**< number of unsynced fds */
+#endif
+};
+
 /**
  * log2 of block size.
  */
@@ -191,6 +366,29 @@ static const unsigned int log2_block_size[ENTRY_ELEM_COUNT] = {
 	BLOCK_META_SIZE  /**< Metadata block size */
 };
 
+struct store_state;
+
+/**
+ * Eviction policy.
+ *
+ * A policy computes the eviction priority of an entry. Entries with
+ * the lowest priority are evicted first. The priority is recomputed
+ * whenever an entry is used or stored.
+ */
+struct store_evict_policy {
+	const char *name; /**< policy name for logging */
+
+	/**
+	 * Compute the eviction priority of an entry.
+	 *
+	 * @param state The store state.
+	 * @param bse The entry to compute the priority of.
+	 * @return The eviction priority.
+	 */
+	uint64_t (*priority)(const struct store_state *state,
+			     const struct store_entry *bse);
+};
+
 /**
  * Parameters controlling the backing store.
  */
@@ -210,6 +408,19 @@ struct store_state {
 	 */
 	bool entries_dirty;
 
+	/** serialised entries loaded at initialisation. Entries which
+	 * have not been used since refer to URL strings within it.
+	 */
+	uint8_t *index;
+
+	/** size of the loaded serialised entries */
+	size_t index_size;
+
+	/** flag indicating if the loaded entries are mapped, otherwise
+	 * they are on the heap.
+	 */
+	bool index_mapped;
+
 	/** small block indexes */
 	struct block_file blocks[ENTRY_ELEM_COUNT][BLOCK_FILE_COUNT];
 
@@ -223,14 +434,37 @@ struct store_state {
 	 */
 	bool blocks_opened;
 
+	/** background I/O */
+	struct store_io_queue io;
+
+	/** eviction policy */
+	const struct store_evict_policy *policy;
+
+	/** eviction heap, lowest priority entry first */
+	struct store_entry **evict_heap;
+	uint32_t evict_count; /**< number of entries in the eviction heap */
+	uint32_t evict_alloc; /**< allocated size of the eviction heap */
+
+	/** priority of the most recently evicted entry used by policies
+	 * which age entries by inflating priorities of new entries.
+	 */
+	uint64_t evict_inflation;
+
 
 	/* stats */
 	uint64_t total_alloc; /**< total size of all allocated storage. */
+	uint64_t raw_alloc; /**< total size of all stored data uncompressed */
 
 	size_t hit_count; /**< number of cache hits */
 	uint64_t hit_size; /**< size of storage served */
 	size_t miss_count; /**< number of cache misses */
 
+	size_t compress_count; /**< number of elements stored compressed */
+	uint64_t compress_in; /**< size of compressed elements before */
+	uint64_t compress_out; /**< size of compressed elements after */
+	size_t decompress_count; /**< number of elements decompressed */
+	clock_t decompress_time; /**< processor time spent decompressing */
+
 };
 
 /**
@@ -241,15 +475,38 @@ struct store_state {
  */
 struct store_state *storestate;
 
+/** Convert an entry identifier to an entries hashmap key */
+#define ENTRY_KEY(ident) ((void *)(uintptr_t)(ident))
+
 /* Entries hashmap parameters
  *
- * Our hashmap has nsurl keys and store_entry values
+ * Our hashmap has entry identifier keys and store_entry values. The
+ * identifiers are stored directly in the key pointer so entries
+ * loaded from the serialised index need no URL object until they are
+ * first used.
  */
 
+static void *
+entries_hashmap_key_clone(void *key)
+{
+	return key;
+}
+
+static void
+entries_hashmap_key_destroy(void *key)
+{
+}
+
+static uint32_t
+entries_hashmap_key_hash(void *key)
+{
+	return (uint32_t)(uintptr_t)key;
+}
+
 static bool
 entries_hashmap_key_eq(void *key1, void *key2)
 {
-	return nsurl_compare((nsurl *)key1, (nsurl *)key2, NSURL_COMPLETE);
+	return key1 == key2;
 }
 
 static void *
@@ -257,7 +514,8 @@ entries_hashmap_value_alloc(void *key)
 {
 	struct store_entry *ent = calloc(1, sizeof(struct store_entry));
 	if (ent != NULL) {
-		ent->url = nsurl_ref(key);
+		ent->ident = (entry_ident_t)(uintptr_t)key;
+		ent->heap_idx = EVICT_HEAP_NONE;
 	}
 	return ent;
 }
@@ -267,19 +525,95 @@ entries_hashmap_value_destroy(void *value)
 {
 	struct store_entry *ent = value;
 	/** \todo Do we need to do any disk cleanup here?  if so, meep! */
-	nsurl_unref(ent->url);
+	if (ent->url != NULL) {
+		nsurl_unref(ent->url);
+	}
 	free(ent);
 }
 
 static hashmap_parameters_t entries_hashmap_parameters = {
-	.key_clone = (hashmap_key_clone_t)nsurl_ref,
-	.key_destroy = (hashmap_key_destroy_t)nsurl_unref,
-	.key_hash = (hashmap_key_hash_t)nsurl_hash,
+	.key_clone = entries_hashmap_key_clone,
+	.key_destroy = entries_hashmap_key_destroy,
+	.key_hash = entries_hashmap_key_hash,
 	.key_eq = entries_hashmap_key_eq,
 	.value_alloc = entries_hashmap_value_alloc,
 	.value_destroy = entries_hashmap_value_destroy,
 };
 
+/**
+ * Compute the entry identifier for a URL.
+ *
+ * The identifier is used as the entries hashmap key and to name the
+ * files on disc.
+ *
+ * @param url The URL to compute the identifier for.
+ * @return The entry identifier.
+ */
+static inline entry_ident_t store_ident(nsurl *url)
+{
+	entry_ident_t ident = nsurl_hash(url);
+
+	/* zero is reserved as the hashmap cannot hold a NULL key */
+	return (ident == 0) ? 1 : ident;
+}
+
+/**
+ * Get the URL text of an entry.
+ *
+ * @param bse The entry to get the URL of.
+ * @return The URL string.
+ */
+static inline const char *store_entry_url(const struct store_entry *bse)
+{
+	if (bse->url != NULL) {
+		return nsurl_access(bse->url);
+	}
+	return bse->url_str;
+}
+
+/**
+ * Get the length of the URL of an entry.
+ *
+ * @param bse The entry to get the URL length of.
+ * @return The URL length.
+ */
+static inline size_t store_entry_url_len(const struct store_entry *bse)
+{
+	if (bse->url != NULL) {
+		return nsurl_length(bse->url);
+	}
+	return bse->url_len;
+}
+
+/**
+ * Check if an entry is for a URL.
+ *
+ * Several URLs may share an identifier so the entry found for an
+ * identifier must be checked against the URL being looked up. Entries
+ * loaded from the serialised index are compared by their URL text and
+ * take a reference to the URL object on the first match.
+ *
+ * @param bse The entry to check.
+ * @param url The URL to check against.
+ * @return true if the entry is for \a url else false.
+ */
+static bool store_entry_match(struct store_entry *bse, nsurl *url)
+{
+	if (bse->url != NULL) {
+		return nsurl_compare(bse->url, url, NSURL_COMPLETE);
+	}
+
+	if ((nsurl_length(url) != bse->url_len) ||
+	    (memcmp(nsurl_access(url), bse->url_str, bse->url_len) != 0)) {
+		return false;
+	}
+
+	bse->url = nsurl_ref(url);
+	bse->url_str = NULL;
+
+	return true;
+}
+
 /**
  * Generate a filename for an object.
  *
@@ -406,6 +740,549 @@ store_fname(struct store_state *state,
 	return fname;
 }
 
+/**
+ * Note a block file written by an I/O operation needs syncing.
+ *
+ * @param q The I/O queue.
+ * @param fd The file descriptor written to.
+ */
+static void store_io_mark_sync(struct store_io_queue *q, int fd)
+{
+#ifdef HAVE_PTHREADS
+	unsigned int idx;
+
+	for (idx = 0; idx < q->sync_count; idx++) {
+		if (q->sync_fd[idx] == fd) {
+			return;
+		}
+	}
+	if (q->sync_count < (ENTRY_ELEM_COUNT * BLOCK_FILE_COUNT)) {
+		q->sync_fd[q->sync_count++] = fd;
+	}
+#endif
+}
+
+/**
+ * Sync block files written since the last control file update.
+ *
+ * Syncing is batched so each block file is synced at most once per
+ * control file update, before the update which refers to its data.
+ *
+ * @param q The I/O queue.
+ */
+static void store_io_sync(struct store_io_queue *q)
+{
+#ifdef HAVE_PTHREADS
+	unsigned int idx;
+
+	for (idx = 0; idx < q->sync_count; idx++) {
+		fsync(q->sync_fd[idx]);
+	}
+	q->sync_count = 0;
+#endif
+}
+
+/**
+ * Write data to an individual file.
+ *
+ * @param io The write operation.
+ * @return NSERROR_OK on success or error code.
+ */
+static nserror store_io_write_file(struct store_io *io)
+{
+	ssize_t wr;
+	int fd;
+	int err;
+
+	/* ensure all path elements to file exist */
+	if (netsurf_mkdir_all(io->fname) != NSERROR_OK) {
+		io->failed = "Path creation";
+		io->err = errno;
+		return NSERROR_SAVE_FAILED;
+	}
+
+	fd = open(io->fname, O_CREAT | O_WRONLY, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		io->failed = "Open";
+		io->err = errno;
+		return NSERROR_SAVE_FAILED;
+	}
+
+	wr = write(fd, io->data, io->size);
+	err = errno; /* close can change errno */
+
+	close(fd);
+	io->written = wr;
+	if (wr != (ssize_t)io->size) {
+		io->failed = "Write";
+		io->err = err;
+
+		/** @todo Delete the file? */
+		return NSERROR_SAVE_FAILED;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Atomically replace a control file.
+ *
+ * @param q The I/O queue.
+ * @param io The replace operation.
+ * @return NSERROR_OK on success or error code.
+ */
+static nserror store_io_replace(struct store_io_queue *q, struct store_io *io)
+{
+	size_t tot = 0;
+	ssize_t wr;
+	int fd;
+
+#ifdef HAVE_PTHREADS
+	/* data the control file refers to must reach the disc first */
+	if (q->running) {
+		store_io_sync(q);
+	}
+#endif
+
+	fd = open(io->tname, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		io->failed = "Open";
+		io->err = errno;
+		return NSERROR_SAVE_FAILED;
+	}
+
+	while (tot < io->size) {
+		wr = write(fd, io->data + tot, io->size - tot);
+		if (wr <= 0) {
+			io->err = errno;
+			break;
+		}
+		tot += wr;
+	}
+	io->written = tot;
+
+#ifdef HAVE_PTHREADS
+	if (q->running) {
+		fsync(fd);
+	}
+#endif
+	close(fd);
+
+	if (tot != io->size) {
+		io->failed = "Write";
+		unlink(io->tname);
+		return NSERROR_SAVE_FAILED;
+	}
+
+	/* remove() call is to handle non-POSIX rename() implementations */
+	(void)remove(io->fname);
+	if (rename(io->tname, io->fname) != 0) {
+		io->failed = "Rename";
+		io->err = errno;
+		unlink(io->tname);
+		return NSERROR_SAVE_FAILED;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Perform an I/O operation.
+ *
+ * This is called on the I/O thread when it is running and must not
+ * access the store state or log, the outcome is recorded in the
+ * operation and logged when it is completed on the main thread.
+ *
+ * @param q The I/O queue.
+ * @param io The operation to perform, its result is updated.
+ */
+static void store_io_perform(struct store_io_queue *q, struct store_io *io)
+{
+	ssize_t wr;
+
+	io->res = NSERROR_OK;
+
+	switch (io->op) {
+	case STORE_IO_WRITE_BLOCK:
+		wr = nsu_pwrite(io->fd, io->data, io->size, io->offset);
+		io->written = wr;
+		if (wr != (ssize_t)io->size) {
+			io->failed = "Write";
+			io->err = errno;
+			io->res = NSERROR_SAVE_FAILED;
+			break;
+		}
+		store_io_mark_sync(q, io->fd);
+		break;
+
+	case STORE_IO_WRITE_FILE:
+		io->res = store_io_write_file(io);
+		break;
+
+	case STORE_IO_TRUNCATE:
+		if (ftruncate(io->fd, io->offset) == -1) {
+			io->failed = "Truncate";
+			io->err = errno;
+		}
+		break;
+
+	case STORE_IO_UNLINK:
+		unlink(io->fname);
+		break;
+
+	case STORE_IO_REPLACE:
+		io->res = store_io_replace(q, io);
+		break;
+	}
+}
+
+#ifdef HAVE_PTHREADS
+/**
+ * Background I/O thread.
+ *
+ * Performs queued operations in order, placing them on the completed
+ * list for the main thread to reap, until asked to quit and the
+ * queue is empty.
+ *
+ * @param p The I/O queue.
+ * @return NULL
+ */
+static void *store_io_thread(void *p)
+{
+	struct store_io_queue *q = p;
+	struct store_io *io;
+
+	pthread_mutex_lock(&q->lock);
+	for (;;) {
+		while ((q->head == NULL) && (q->quit == false)) {
+			pthread_cond_wait(&q->cond, &q->lock);
+		}
+		if (q->head == NULL) {
+			break;
+		}
+
+		io = q->head;
+		q->head = io->next;
+		if (q->head == NULL) {
+			q->tail = &q->head;
+		}
+		pthread_mutex_unlock(&q->lock);
+
+		store_io_perform(q, io);
+
+		pthread_mutex_lock(&q->lock);
+		io->next = NULL;
+		*q->done_tail = io;
+		q->done_tail = &io->next;
+	}
+	pthread_mutex_unlock(&q->lock);
+
+	return NULL;
+}
+#endif
+
+static void store_io_complete(struct store_state *state, struct store_io *io);
+static void store_io_reap(void *s);
+
+/**
+ * Check if the I/O queue can accept more element data.
+ *
+ * @param state The store state to use.
+ * @param size The size of the element data.
+ * @return true if the data may be queued else false.
+ */
+static bool store_io_space(struct store_state *state, size_t size)
+{
+	if (state->io.count == 0) {
+		/* an empty queue always accepts a write */
+		return true;
+	}
+	return (state->io.count < STORE_IO_QUEUE_MAX) &&
+		((state->io.bytes + size) <= STORE_IO_QUEUE_BYTES);
+}
+
+/**
+ * Submit an I/O operation.
+ *
+ * The operation is queued for the I/O thread when it is running,
+ * otherwise it is performed and completed immediately.
+ *
+ * @param state The store state to use.
+ * @param io The operation, ownership passes to the queue.
+ */
+static void store_io_submit(struct store_state *state, struct store_io *io)
+{
+	io->next = NULL;
+	state->io.count++;
+	state->io.bytes += io->size;
+
+#ifdef HAVE_PTHREADS
+	if (state->io.running) {
+		pthread_mutex_lock(&state->io.lock);
+		*state->io.tail = io;
+		state->io.tail = &io->next;
+		pthread_cond_signal(&state->io.cond);
+		pthread_mutex_unlock(&state->io.lock);
+
+		if (state->io.reap_scheduled == false) {
+			state->io.reap_scheduled = true;
+			guit->misc->schedule(STORE_IO_REAP_TIME,
+					     store_io_reap,
+					     state);
+		}
+		return;
+	}
+#endif
+
+	store_io_perform(&state->io, io);
+	store_io_complete(state, io);
+}
+
+/**
+ * Create an I/O operation.
+ *
+ * @param op The operation type.
+ * @return The new operation or NULL on allocation failure.
+ */
+static struct store_io *store_io_create(enum store_io_op op)
+{
+	struct store_io *io;
+
+	io = calloc(1, sizeof(struct store_io));
+	if (io != NULL) {
+		io->op = op;
+		io->fd = -1;
+		io->elem_idx = -1;
+	}
+	return io;
+}
+
+/**
+ * Least recently used eviction priority.
+ */
+static uint64_t
+evict_lru_priority(const struct store_state *state,
+		   const struct store_entry *bse)
+{
+	return bse->last_used;
+}
+
+/**
+ * Least frequently used eviction priority.
+ *
+ * Entries with the same use count are ordered by age.
+ */
+static uint64_t
+evict_lfu_priority(const struct store_state *state,
+		   const struct store_entry *bse)
+{
+	return ((uint64_t)bse->use_count << 48) |
+		((uint64_t)bse->last_used & ((UINT64_C(1) << 48) - 1));
+}
+
+/**
+ * Greedy dual size frequency eviction priority.
+ *
+ * Frequently used small entries are retained in preference to large
+ * ones. The priority of every entry is inflated by that of the last
+ * evicted entry so entries which are no longer used age out.
+ */
+static uint64_t
+evict_gdsf_priority(const struct store_state *state,
+		    const struct store_entry *bse)
+{
+	uint64_t size;
+
+	size = (uint64_t)bse->elem[ENTRY_ELEM_DATA].size +
+		bse->elem[ENTRY_ELEM_META].size + 1;
+
+	return state->evict_inflation +
+		(((uint64_t)bse->use_count << 32) / size);
+}
+
+/**
+ * Eviction policies.
+ */
+static const struct store_evict_policy evict_policies[] = {
+	[EVICT_POLICY_LRU] = {
+		.name = "LRU",
+		.priority = evict_lru_priority,
+	},
+	[EVICT_POLICY_LFU] = {
+		.name = "LFU",
+		.priority = evict_lfu_priority,
+	},
+	[EVICT_POLICY_GDSF] = {
+		.name = "GDSF",
+		.priority = evict_gdsf_priority,
+	},
+};
+
+/**
+ * Place an entry at a position in the eviction heap.
+ */
+static inline void
+evict_heap_set(struct store_state *state, uint32_t idx, struct store_entry *bse)
+{
+	state->evict_heap[idx] = bse;
+	bse->heap_idx = idx;
+}
+
+/**
+ * Move an entry towards the top of the eviction heap.
+ */
+static void evict_heap_up(struct store_state *state, uint32_t idx)
+{
+	struct store_entry *bse = state->evict_heap[idx];
+	uint32_t parent;
+
+	while (idx > 0) {
+		parent = (idx - 1) / 2;
+		if (state->evict_heap[parent]->evict_key <= bse->evict_key) {
+			break;
+		}
+		evict_heap_set(state, idx, state->evict_heap[parent]);
+		idx = parent;
+	}
+	evict_heap_set(state, idx, bse);
+}
+
+/**
+ * Move an entry towards the bottom of the eviction heap.
+ */
+static void evict_heap_down(struct store_state *state, uint32_t idx)
+{
+	struct store_entry *bse = state->evict_heap[idx];
+	uint32_t child;
+
+	for (;;) {
+		child = (idx * 2) + 1;
+		if (child >= state->evict_count) {
+			break;
+		}
+		if (((child + 1) < state->evict_count) &&
+		    (state->evict_heap[child + 1]->evict_key <
+		     state->evict_heap[child]->evict_key)) {
+			child++;
+		}
+		if (bse->evict_key <= state->evict_heap[child]->evict_key) {
+			break;
+		}
+		evict_heap_set(state, idx, state->evict_heap[child]);
+		idx = child;
+	}
+	evict_heap_set(state, idx, bse);
+}
+
+/**
+ * Ensure the eviction heap has space for a number of entries.
+ *
+ * @param state The store state.
+ * @param count The number of entries required.
+ * @return NSERROR_OK on success or NSERROR_NOMEM.
+ */
+static nserror evict_heap_reserve(struct store_state *state, uint32_t count)
+{
+	struct store_entry **heap;
+	uint32_t alloc;
+
+	if (count <= state->evict_alloc) {
+		return NSERROR_OK;
+	}
+
+	alloc = (state->evict_alloc == 0) ? 1024 : state->evict_alloc;
+	while (alloc < count) {
+		alloc *= 2;
+	}
+
+	heap = realloc(state->evict_heap, alloc * sizeof(*heap));
+	if (heap == NULL) {
+		return NSERROR_NOMEM;
+	}
+	state->evict_heap = heap;
+	state->evict_alloc = alloc;
+
+	return NSERROR_OK;
+}
+
+/**
+ * Add an entry to the eviction heap.
+ *
+ * @param state The store state.
+ * @param bse The entry to add.
+ * @return NSERROR_OK on success or NSERROR_NOMEM.
+ */
+static nserror evict_heap_insert(struct store_state *state, struct store_entry *bse)
+{
+	nserror ret;
+
+	ret = evict_heap_reserve(state, state->evict_count + 1);
+	if (ret != NSERROR_OK) {
+		return ret;
+	}
+
+	bse->evict_key = state->policy->priority(state, bse);
+	evict_heap_set(state, state->evict_count++, bse);
+	evict_heap_up(state, bse->heap_idx);
+
+	return NSERROR_OK;
+}
+
+/**
+ * Remove an entry from the eviction heap.
+ *
+ * @param state The store state.
+ * @param bse The entry to remove.
+ */
+static void evict_heap_remove(struct store_state *state, struct store_entry *bse)
+{
+	struct store_entry *last;
+	uint32_t idx = bse->heap_idx;
+
+	if (idx == EVICT_HEAP_NONE) {
+		return;
+	}
+	bse->heap_idx = EVICT_HEAP_NONE;
+
+	last = state->evict_heap[--state->evict_count];
+	if (last != bse) {
+		evict_heap_set(state, idx, last);
+		evict_heap_up(state, idx);
+		evict_heap_down(state, last->heap_idx);
+	}
+}
+
+/**
+ * Recompute the eviction priority of an entry after it is used.
+ *
+ * @param state The store state.
+ * @param bse The entry to update.
+ */
+static void evict_heap_update(struct store_state *state, struct store_entry *bse)
+{
+	if (bse->heap_idx == EVICT_HEAP_NONE) {
+		return;
+	}
+
+	bse->evict_key = state->policy->priority(state, bse);
+	evict_heap_up(state, bse->heap_idx);
+	evict_heap_down(state, bse->heap_idx);
+}
+
+/**
+ * Establish heap order after entries were appended without ordering.
+ *
+ * @param state The store state.
+ */
+static void evict_heap_build(struct store_state *state)
+{
+	uint32_t idx;
+
+	for (idx = state->evict_count / 2; idx > 0; idx--) {
+		evict_heap_down(state, idx - 1);
+	}
+}
+
 /**
  * invalidate an element of an entry
  *
@@ -433,18 +1310,23 @@ invalidate_element(struct store_state *state,
 		/* clear bit in use map */
 		state->blocks[elem_idx][bf].use_map[bi >> 3] &= ~(1U << (bi & 7));
 	} else {
-		char *fname;
+		struct store_io *io;
 
 		/* unlink the file from disc */
-		fname = store_fname(state, nsurl_hash(bse->url), elem_idx);
-		if (fname == NULL) {
+		io = store_io_create(STORE_IO_UNLINK);
+		if (io == NULL) {
 			return NSERROR_NOMEM;
 		}
-		unlink(fname);
-		free(fname);
+		io->fname = store_fname(state, bse->ident, elem_idx);
+		if (io->fname == NULL) {
+			free(io);
+			return NSERROR_NOMEM;
+		}
+		store_io_submit(state, io);
 	}
 
 	state->total_alloc -= bse->elem[elem_idx].size;
+	state->raw_alloc -= bse->elem[elem_idx].raw_size;
 
 	return NSERROR_OK;
 }
@@ -478,7 +1360,7 @@ invalidate_entry(struct store_state *state, struct store_entry *bse)
 		return NSERROR_OK;
 	}
 
-	NSLOG(netsurf, VERBOSE, "Removing entry for %s", nsurl_access(bse->url));
+	NSLOG(netsurf, VERBOSE, "Removing entry for %s", store_entry_url(bse));
 
 	ret = invalidate_element(state, bse, ENTRY_ELEM_META);
 	if (ret != NSERROR_OK) {
@@ -491,7 +1373,8 @@ invalidate_entry(struct store_state *state, struct store_entry *bse)
 	}
 
 	/* As our final act we remove bse from the cache */
-	hashmap_remove(state->entries, bse->url);
+	evict_heap_remove(state, bse);
+	hashmap_remove(state->entries, ENTRY_KEY(bse->ident));
 	/* From now, bse is invalid memory */
 
 	return NSERROR_OK;
@@ -499,67 +1382,180 @@ invalidate_entry(struct store_state *state, struct store_entry *bse)
 
 
 /**
- * Quick sort comparison.
+ * release any allocation for an entry
  */
-static int compar(const void *va, const void *vb)
+static nserror entry_release_alloc(struct store_entry_element *elem)
 {
-	const struct store_entry *a = *(const struct store_entry **)va;
-	const struct store_entry *b = *(const struct store_entry **)vb;
-
-	/* consider the allocation flags - if an entry has an
-	 * allocation it is considered more valuable as it cannot be
-	 * freed.
-	 */
-	if ((a->elem[ENTRY_ELEM_DATA].flags == ENTRY_ELEM_FLAG_NONE) &&
-	    (b->elem[ENTRY_ELEM_DATA].flags != ENTRY_ELEM_FLAG_NONE)) {
-		return -1;
-	} else if ((a->elem[ENTRY_ELEM_DATA].flags != ENTRY_ELEM_FLAG_NONE) &&
-		   (b->elem[ENTRY_ELEM_DATA].flags == ENTRY_ELEM_FLAG_NONE)) {
-		return 1;
+	if ((elem->flags & ENTRY_ELEM_FLAG_HEAP) != 0) {
+		elem->ref--;
+		if (elem->ref == 0) {
+			NSLOG(netsurf, DEEPDEBUG, "freeing %p", elem->data);
+			free(elem->data);
+			elem->flags &= ~ENTRY_ELEM_FLAG_HEAP;
+		}
 	}
+	return NSERROR_OK;
+}
 
-	if ((a->elem[ENTRY_ELEM_META].flags == ENTRY_ELEM_FLAG_NONE) &&
-	    (b->elem[ENTRY_ELEM_META].flags != ENTRY_ELEM_FLAG_NONE)) {
-		return -1;
-	} else if ((a->elem[ENTRY_ELEM_META].flags != ENTRY_ELEM_FLAG_NONE) &&
-		   (b->elem[ENTRY_ELEM_META].flags == ENTRY_ELEM_FLAG_NONE)) {
-		return 1;
-	}
+/**
+ * Complete an I/O operation on the main thread.
+ *
+ * Releases the element data reference held by the operation. An
+ * entry whose data could not be written is invalidated.
+ *
+ * @param state The store state to use.
+ * @param io The completed operation which is freed.
+ */
+static void store_io_complete(struct store_state *state, struct store_io *io)
+{
+	struct store_entry *bse;
 
-	if (a->use_count < b->use_count) {
-		return -1;
-	} else if (a->use_count > b->use_count) {
-		return 1;
+	state->io.count--;
+	state->io.bytes -= io->size;
+
+	if (io->failed != NULL) {
+		NSLOG(netsurf, ERROR,
+		      "%s failed for %s wrote %"PRIssizet" of %"PRIsizet" bytes at %"PRIsizet" errno %d",
+		      io->failed,
+		      io->fname != NULL ? io->fname : "block file",
+		      io->written, io->size, (size_t)io->offset, io->err);
+	} else if (io->op == STORE_IO_WRITE_BLOCK) {
+		NSLOG(netsurf, INFO,
+		      "Wrote %"PRIssizet" bytes at %"PRIsizet,
+		      io->written, (size_t)io->offset);
+	} else if (io->op == STORE_IO_WRITE_FILE) {
+		NSLOG(netsurf, VERBOSE, "Wrote %"PRIssizet" bytes to %s",
+		      io->written, io->fname);
+	}
+
+	if ((io->res != NSERROR_OK) && (io->dirty != NULL)) {
+		*io->dirty = true;
+	}
+
+	if (io->elem_idx != -1) {
+		/* the data reference keeps the entry from being removed */
+		bse = hashmap_lookup(state->entries, ENTRY_KEY(io->ident));
+		if (bse != NULL) {
+			entry_release_alloc(&bse->elem[io->elem_idx]);
+			if (io->res != NSERROR_OK) {
+				invalidate_entry(state, bse);
+			} else if ((bse->flags & ENTRY_FLAGS_INVALID) != 0) {
+				invalidate_entry(state, bse);
+			}
+		}
 	}
-	/* use count is the same - now consider last use time */
 
-	if (a->last_used < b->last_used) {
-		return -1;
-	} else if (a->last_used > b->last_used) {
-		return 1;
+	free(io->owned);
+	free(io->fname);
+	free(io->tname);
+	free(io);
+}
+
+/**
+ * Reap completed background I/O operations.
+ *
+ * Scheduled while operations are outstanding.
+ *
+ * @param s The store state.
+ */
+static void store_io_reap(void *s)
+{
+	struct store_state *state = s;
+	struct store_io *done = NULL;
+	struct store_io *io;
+
+	state->io.reap_scheduled = false;
+
+#ifdef HAVE_PTHREADS
+	pthread_mutex_lock(&state->io.lock);
+	done = state->io.done;
+	state->io.done = NULL;
+	state->io.done_tail = &state->io.done;
+	pthread_mutex_unlock(&state->io.lock);
+#endif
+
+	while (done != NULL) {
+		io = done;
+		done = io->next;
+		store_io_complete(state, io);
 	}
 
-	/* they are the same */
-	return 0;
+	if ((state->io.count > 0) && state->io.running) {
+		state->io.reap_scheduled = true;
+		guit->misc->schedule(STORE_IO_REAP_TIME, store_io_reap, state);
+	}
 }
 
-typedef struct {
-	struct store_entry **elist;
-	size_t ent_count;
-} eviction_state_t;
+/**
+ * Start the background I/O thread.
+ *
+ * If the thread cannot be started operations are performed
+ * synchronously.
+ *
+ * @param state The store state.
+ */
+static void store_io_start(struct store_state *state)
+{
+#ifdef HAVE_PTHREADS
+	state->io.head = NULL;
+	state->io.tail = &state->io.head;
+	state->io.done = NULL;
+	state->io.done_tail = &state->io.done;
+	state->io.quit = false;
+
+	if (pthread_mutex_init(&state->io.lock, NULL) != 0) {
+		return;
+	}
+	if (pthread_cond_init(&state->io.cond, NULL) != 0) {
+		pthread_mutex_destroy(&state->io.lock);
+		return;
+	}
+
+	state->io.running = true;
+	if (pthread_create(&state->io.thread, NULL,
+			   store_io_thread, &state->io) != 0) {
+		NSLOG(netsurf, WARNING, "Unable to start I/O thread");
+		state->io.running = false;
+		pthread_cond_destroy(&state->io.cond);
+		pthread_mutex_destroy(&state->io.lock);
+	}
+#endif
+}
 
 /**
- * Iterator for gathering entries to compute eviction order
+ * Stop the background I/O thread.
+ *
+ * Waits for all queued operations to be performed and completes
+ * them. Any subsequent operations are performed synchronously.
+ *
+ * @param state The store state.
  */
-static bool
-entry_eviction_iterator_cb(void *key, void *value, void *ctx)
+static void store_io_stop(struct store_state *state)
 {
-	eviction_state_t *estate = ctx;
-	struct store_entry *ent = value;
-	estate->elist[estate->ent_count++] = ent;
-	return false;
+	if (state->io.reap_scheduled) {
+		guit->misc->schedule(-1, store_io_reap, state);
+	}
+
+#ifdef HAVE_PTHREADS
+	if (state->io.running) {
+		pthread_mutex_lock(&state->io.lock);
+		state->io.quit = true;
+		pthread_cond_signal(&state->io.cond);
+		pthread_mutex_unlock(&state->io.lock);
+
+		pthread_join(state->io.thread, NULL);
+		state->io.running = false;
+
+		store_io_reap(state);
+
+		pthread_cond_destroy(&state->io.cond);
+		pthread_mutex_destroy(&state->io.lock);
+	}
+#endif
+	state->io.reap_scheduled = false;
 }
 
+
 /**
  * Evict entries from backing store as per configuration.
  *
@@ -567,9 +1563,10 @@ entry_eviction_iterator_cb(void *key, void *value, void *ctx)
  * configured limits on size and number of entries.
  *
  * The approach is to check if the cache limits have been exceeded and
- * if so build and sort list of entries to evict. The list is sorted
- * by use count and then by age, so oldest object with least number of uses
- * get evicted first.
+ * if so remove entries from the top of the eviction heap, which the
+ * eviction policy keeps ordered, until the hysteresis has been
+ * reached. Entries with an allocation are more valuable as they
+ * cannot be freed so they are set aside and returned to the heap.
  *
  * @param state The store state to use.
  * @return NSERROR_OK on success or error code on failure.
@@ -579,8 +1576,12 @@ static nserror store_evict(struct store_state *state)
 	size_t ent = 0;
 	size_t removed = 0; /* size of removed entries */
 	nserror ret = NSERROR_OK;
-	size_t old_count;
-	eviction_state_t estate;
+	struct store_entry *bse;
+	struct store_entry **held = NULL; /* entries with an allocation */
+	struct store_entry **newheld;
+	size_t held_count = 0;
+	size_t held_alloc = 0;
+	size_t idx;
 
 	/* check if the cache has exceeded configured limit */
 	if (state->total_alloc < state->limit) {
@@ -593,32 +1594,28 @@ static nserror store_evict(struct store_state *state)
 	      state->total_alloc,
 	      state->hysteresis);
 
-	/* allocate storage for the list */
-	old_count = hashmap_count(state->entries);
-	estate.ent_count = 0;
-	estate.elist = malloc(sizeof(struct state_entry*) * old_count);
-	if (estate.elist == NULL) {
-		return NSERROR_NOMEM;
-	}
-
-	if (hashmap_iterate(state->entries, entry_eviction_iterator_cb, &estate)) {
-		NSLOG(netsurf, WARNING, "Unexpected termination of eviction iterator");
-		free(estate.elist);
-		return NSERROR_UNKNOWN;
-	}
-
-	if (old_count != estate.ent_count) {
-		NSLOG(netsurf, WARNING, "Incorrect entry count after eviction iterator");
-		free(estate.elist);
-		return NSERROR_UNKNOWN;
-	}
-
-	qsort(estate.elist, estate.ent_count, sizeof(struct state_entry*), compar);
+	while ((state->evict_count > 0) && (removed <= state->hysteresis)) {
+		bse = state->evict_heap[0];
+
+		if (((bse->elem[ENTRY_ELEM_DATA].flags |
+		      bse->elem[ENTRY_ELEM_META].flags) &
+		     (ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP)) != 0) {
+			/* set entry aside until eviction is complete */
+			if (held_count == held_alloc) {
+				held_alloc = (held_alloc == 0) ? 16 : held_alloc * 2;
+				newheld = realloc(held, held_alloc * sizeof(*held));
+				if (newheld == NULL) {
+					ret = NSERROR_NOMEM;
+					break;
+				}
+				held = newheld;
+			}
+			evict_heap_remove(state, bse);
+			held[held_count++] = bse;
+			continue;
+		}
 
-	/* evict entries in listed order */
-	removed = 0;
-	for (ent = 0; ent < estate.ent_count; ent++) {
-		struct store_entry *bse = estate.elist[ent];
+		state->evict_inflation = bse->evict_key;
 
 		removed += bse->elem[ENTRY_ELEM_DATA].size;
 		removed += bse->elem[ENTRY_ELEM_META].size;
@@ -627,50 +1624,65 @@ static nserror store_evict(struct store_state *state)
 		if (ret != NSERROR_OK) {
 			break;
 		}
-
-		if (removed > state->hysteresis) {
-			break;
-		}
+		ent++;
 	}
 
-	free(estate.elist);
+	/* return entries set aside to the heap, space is already reserved */
+	for (idx = 0; idx < held_count; idx++) {
+		evict_heap_insert(state, held[idx]);
+	}
+	free(held);
 
 	NSLOG(netsurf, INFO,
 	      "removed %"PRIsizet" in %"PRIsizet" entries, %"PRIu64" remaining in %"PRIsizet" entries",
-	      removed, ent, state->total_alloc, old_count - ent);
+	      removed, ent, state->total_alloc, hashmap_count(state->entries));
 
 	return ret;
 }
 
 /**
- * Write a single store entry to disk
+ * Compute the checksum of serialised entries.
  *
- * To serialise a single store entry for now we write out a 32bit int
- * which is the length of the url, then that many bytes of the url.
- * Then we write out the full store entry struct as-is, which includes
- * a useless nsurl pointer.
+ * @param data The serialised entry records and string pool.
+ * @param count The number of 32bit words in \a data.
+ * @return The checksum.
  */
-static nserror
-write_entry(struct store_entry *ent, int fd)
+static uint32_t index_checksum(const uint32_t *data, size_t count)
 {
-	uint32_t len = strlen(nsurl_access(ent->url));
-	if (write(fd, &len, sizeof(len)) != sizeof(len))
-		return NSERROR_SAVE_FAILED;
-	if (write(fd, nsurl_access(ent->url), len) != (ssize_t)len)
-		return NSERROR_SAVE_FAILED;
-	if (write(fd, ent, sizeof(*ent)) != sizeof(*ent))
-		return NSERROR_SAVE_FAILED;
+	uint32_t a = 1;
+	uint32_t b = 0;
 
-	return NSERROR_OK;
+	while (count-- > 0) {
+		a += *data++;
+		b += a;
+	}
+
+	return a ^ (b << 16) ^ (b >> 16);
 }
 
 typedef struct {
-	int fd;
-	size_t written;
+	struct store_index_entry *table; /**< entry records */
+	char *pool; /**< URL string pool */
+	size_t written; /**< number of records written */
+	size_t pool_used; /**< bytes of string pool used */
 } write_entry_iteration_state;
 
 /**
- * Callback for iterating the entries hashmap
+ * Callback for iterating the entries hashmap to size the string pool
+ */
+static bool
+size_entry_iterator(void *key, void *value, void *ctx)
+{
+	struct store_entry *ent = value;
+	size_t *pool_size = ctx;
+
+	*pool_size += store_entry_url_len(ent) + 1;
+
+	return false;
+}
+
+/**
+ * Callback for iterating the entries hashmap to serialise each entry
  */
 static bool
 write_entry_iterator(void *key, void *value, void *ctx)
@@ -678,9 +1690,30 @@ write_entry_iterator(void *key, void *value, void *ctx)
 	/* We ignore the key */
 	struct store_entry *ent = value;
 	write_entry_iteration_state *state = ctx;
-	state->written++;
-	/* We stop early if we fail to write this entry */
-	return write_entry(ent, state->fd) != NSERROR_OK;
+	struct store_index_entry *rec = &state->table[state->written++];
+	size_t len = store_entry_url_len(ent);
+
+	rec->last_used = ent->last_used;
+	rec->ident = ent->ident;
+	rec->url_offset = state->pool_used;
+	rec->url_len = len;
+	rec->size[ENTRY_ELEM_DATA] = ent->elem[ENTRY_ELEM_DATA].size;
+	rec->size[ENTRY_ELEM_META] = ent->elem[ENTRY_ELEM_META].size;
+	rec->raw_size[ENTRY_ELEM_DATA] = ent->elem[ENTRY_ELEM_DATA].raw_size;
+	rec->raw_size[ENTRY_ELEM_META] = ent->elem[ENTRY_ELEM_META].raw_size;
+	rec->block[ENTRY_ELEM_DATA] = ent->elem[ENTRY_ELEM_DATA].block;
+	rec->block[ENTRY_ELEM_META] = ent->elem[ENTRY_ELEM_META].block;
+	rec->use_count = ent->use_count;
+	rec->flags = ent->flags;
+	rec->elem_flags[ENTRY_ELEM_DATA] = ent->elem[ENTRY_ELEM_DATA].flags &
+		ENTRY_ELEM_FLAG_PERSIST;
+	rec->elem_flags[ENTRY_ELEM_META] = ent->elem[ENTRY_ELEM_META].flags &
+		ENTRY_ELEM_FLAG_PERSIST;
+
+	memcpy(state->pool + state->pool_used, store_entry_url(ent), len + 1);
+	state->pool_used += len + 1;
+
+	return false;
 }
 
 extern int loading_timeout; //arczi
@@ -694,9 +1727,13 @@ extern int loading_timeout; //arczi
  */
 static nserror write_entries(struct store_state *state)
 {
-	char *tname = NULL; /* temporary file name for atomic replace */
-	char *fname = NULL; /* target filename */
 	write_entry_iteration_state weistate;
+	struct store_index_header *hdr;
+	struct store_io *io;
+	uint8_t *index;
+	size_t index_size;
+	size_t count;
+	size_t pool_size = 0;
 	nserror ret;
 
 	memset(&weistate, 0, sizeof(weistate));
@@ -706,42 +1743,59 @@ static nserror write_entries(struct store_state *state)
 		return NSERROR_OK;
 	}
 
-	ret = netsurf_mkpath(&tname, NULL, 2, state->path, "t"ENTRIES_FNAME);
-	if (ret != NSERROR_OK) {
-		return ret;
-	}
-
-	weistate.fd = open(tname, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-	if (weistate.fd == -1) {
-		free(tname);
+	/* size the serialised index */
+	count = hashmap_count(state->entries);
+	hashmap_iterate(state->entries, size_entry_iterator, &pool_size);
+	pool_size = (pool_size + 3) & ~(size_t)3;
+	if ((count > (UINT32_MAX / sizeof(struct store_index_entry))) ||
+	    (pool_size > UINT32_MAX)) {
 		return NSERROR_SAVE_FAILED;
 	}
+	index_size = sizeof(struct store_index_header) +
+		(count * sizeof(struct store_index_entry)) +
+		pool_size;
 
-	if (hashmap_iterate(state->entries, write_entry_iterator, &weistate)) {
-		/* The iteration ended early, so we failed */
-		close(weistate.fd);
-		unlink(tname);
-		free(tname);
-		return NSERROR_SAVE_FAILED;
+	/* serialise the index in memory for the I/O thread to write */
+	index = calloc(1, index_size);
+	if (index == NULL) {
+		return NSERROR_NOMEM;
 	}
+	hdr = (struct store_index_header *)index;
+	weistate.table = (struct store_index_entry *)(index + sizeof(*hdr));
+	weistate.pool = (char *)(weistate.table + count);
 
-	close(weistate.fd);
+	hashmap_iterate(state->entries, write_entry_iterator, &weistate);
 
-	ret = netsurf_mkpath(&fname, NULL, 2, state->path, ENTRIES_FNAME);
+	hdr->magic = ENTRIES_MAGIC;
+	hdr->version = ENTRIES_VERSION;
+	hdr->entry_size = sizeof(struct store_index_entry);
+	hdr->entry_count = count;
+	hdr->pool_size = pool_size;
+	hdr->checksum = index_checksum((uint32_t *)weistate.table,
+				       (index_size - sizeof(*hdr)) / 4);
+
+	io = store_io_create(STORE_IO_REPLACE);
+	if (io == NULL) {
+		free(index);
+		return NSERROR_NOMEM;
+	}
+	io->data = io->owned = index;
+	io->size = index_size;
+	io->dirty = &state->entries_dirty;
+
+	ret = netsurf_mkpath(&io->tname, NULL, 2, state->path, "t"ENTRIES_FNAME);
+	if (ret == NSERROR_OK) {
+		ret = netsurf_mkpath(&io->fname, NULL, 2, state->path, ENTRIES_FNAME);
+	}
 	if (ret != NSERROR_OK) {
-		unlink(tname);
-		free(tname);
+		free(io->tname);
+		free(io);
+		free(index);
 		return ret;
 	}
 
-	/* remove() call is to handle non-POSIX rename() implementations */
-	(void)remove(fname);
-	if (rename(tname, fname) != 0) {
-		unlink(tname);
-		free(tname);
-		free(fname);
-		return NSERROR_SAVE_FAILED;
-	}
+	state->entries_dirty = false;
+	store_io_submit(state, io);
 
 	NSLOG(netsurf, INFO, "Wrote out %"PRIsizet" entries", weistate.written);
 	//printf("Wrote out %"PRIsizet" entries ************\n", weistate.written);
@@ -760,12 +1814,9 @@ static nserror write_entries(struct store_state *state)
  */
 static nserror write_blocks(struct store_state *state)
 {
-	int fd;
-	char *tname = NULL; /* temporary file name for atomic replace */
-	char *fname = NULL; /* target filename */
+	struct store_io *io;
+	uint8_t *maps;
 	size_t blocks_size;
-	size_t written = 0;
-	size_t wr;
 	nserror ret;
 	int bfidx; /* block file index */
 	int elem_idx;
@@ -775,59 +1826,43 @@ static nserror write_blocks(struct store_state *state)
 		return NSERROR_OK;
 	}
 
-	ret = netsurf_mkpath(&tname, NULL, 2, state->path, "t"BLOCKS_FNAME);
-	if (ret != NSERROR_OK) {
-		return ret;
-	}
-
-	fd = open(tname, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-	if (fd == -1) {
-		free(tname);
-		return NSERROR_SAVE_FAILED;
-	}
-
+	/* snapshot the use maps for the I/O thread to write */
 	blocks_size = (BLOCK_FILE_COUNT * ENTRY_ELEM_COUNT) * BLOCK_USE_MAP_SIZE;
-
+	maps = malloc(blocks_size);
+	if (maps == NULL) {
+		return NSERROR_NOMEM;
+	}
 	for (elem_idx = 0; elem_idx < ENTRY_ELEM_COUNT; elem_idx++) {
 		for (bfidx = 0; bfidx < BLOCK_FILE_COUNT; bfidx++) {
-			wr = write(fd,
-				   &state->blocks[elem_idx][bfidx].use_map[0],
-				   BLOCK_USE_MAP_SIZE);
-			if (wr != BLOCK_USE_MAP_SIZE) {
-				NSLOG(netsurf, DEBUG,
-				      "writing block file %d use index on file number %d failed",
-				      elem_idx,
-				      bfidx);
-				goto wr_err;
-			}
-			written += wr;
+			memcpy(maps + (((elem_idx * BLOCK_FILE_COUNT) + bfidx) *
+				       BLOCK_USE_MAP_SIZE),
+			       &state->blocks[elem_idx][bfidx].use_map[0],
+			       BLOCK_USE_MAP_SIZE);
 		}
 	}
-wr_err:
-	close(fd);
 
-	/* check all data was written */
-	if (written != blocks_size) {
-		unlink(tname);
-		free(tname);
-		return NSERROR_SAVE_FAILED;
+	io = store_io_create(STORE_IO_REPLACE);
+	if (io == NULL) {
+		free(maps);
+		return NSERROR_NOMEM;
 	}
+	io->data = io->owned = maps;
+	io->size = blocks_size;
+	io->dirty = &state->blocks_dirty;
 
-	ret = netsurf_mkpath(&fname, NULL, 2, state->path, BLOCKS_FNAME);
+	ret = netsurf_mkpath(&io->tname, NULL, 2, state->path, "t"BLOCKS_FNAME);
+	if (ret == NSERROR_OK) {
+		ret = netsurf_mkpath(&io->fname, NULL, 2, state->path, BLOCKS_FNAME);
+	}
 	if (ret != NSERROR_OK) {
-		unlink(tname);
-		free(tname);
+		free(io->tname);
+		free(io);
+		free(maps);
 		return ret;
 	}
 
-	/* remove() call is to handle non-POSIX rename() implementations */
-	(void)remove(fname);
-	if (rename(tname, fname) != 0) {
-		unlink(tname);
-		free(tname);
-		free(fname);
-		return NSERROR_SAVE_FAILED;
-	}
+	state->blocks_dirty = false;
+	store_io_submit(state, io);
 
 	return NSERROR_OK;
 }
@@ -846,7 +1881,7 @@ static nserror set_block_extents(struct store_state *state)
 {
 	int bfidx; /* block file index */
 	int elem_idx;
-	int ftr;
+	struct store_io *io;
 
 	if (state->blocks_opened == false) {
 		/* no blocks have been opened since last write */
@@ -858,12 +1893,13 @@ static nserror set_block_extents(struct store_state *state)
 		for (bfidx = 0; bfidx < BLOCK_FILE_COUNT; bfidx++) {
 			if (state->blocks[elem_idx][bfidx].fd != -1) {
 				/* ensure block file is correct extent */
-				ftr = ftruncate(state->blocks[elem_idx][bfidx].fd, 1U << (log2_block_size[elem_idx] + BLOCK_ENTRY_COUNT));
-				if (ftr == -1) {
-					NSLOG(netsurf, ERROR,
-					      "Truncate failed errno:%d",
-					      errno);
+				io = store_io_create(STORE_IO_TRUNCATE);
+				if (io == NULL) {
+					return NSERROR_NOMEM;
 				}
+				io->fd = state->blocks[elem_idx][bfidx].fd;
+				io->offset = 1U << (log2_block_size[elem_idx] + BLOCK_ENTRY_COUNT);
+				store_io_submit(state, io);
 			}
 		}
 	}
@@ -911,9 +1947,9 @@ get_store_entry(struct store_state *state, nsurl *url, struct store_entry **bse)
 {
 	struct store_entry *ent;
 
-	ent = hashmap_lookup(state->entries, url);
+	ent = hashmap_lookup(state->entries, ENTRY_KEY(store_ident(url)));
 
-	if (ent == NULL) {
+	if ((ent == NULL) || (store_entry_match(ent, url) == false)) {
 		return NSERROR_NOT_FOUND;
 	}
 
@@ -921,6 +1957,7 @@ get_store_entry(struct store_state *state, nsurl *url, struct store_entry **bse)
 
 	ent->last_used = time(NULL);
 	ent->use_count++;
+	evict_heap_update(state, ent);
 
 	state->entries_dirty = true;
 
@@ -970,6 +2007,8 @@ static block_index_t alloc_block(struct store_state *state, int elem_idx)
  * @param elem_idx The index of the entry element to use.
  * @param data The data to store
  * @param datalen The length of data in \a data
+ * @param zlen The length of the data once compressed or zero if it is
+ *             stored uncompressed.
  * @param bse Pointer used to return value.
  * @return NSERROR_OK and \a bse updated on success or NSERROR_NOT_FOUND
  *         if no entry corresponds to the url.
@@ -980,9 +2019,11 @@ set_store_entry(struct store_state *state,
 		int elem_idx,
 		uint8_t *data,
 		const size_t datalen,
+		const size_t zlen,
 		struct store_entry **bse)
 {
 	struct store_entry *se;
+	entry_ident_t ident;
 	nserror ret;
 	struct store_entry_element *elem;
 
@@ -996,12 +2037,30 @@ set_store_entry(struct store_state *state,
 		return ret;
 	}
 
-	se = hashmap_lookup(state->entries, url);
-	if (se == NULL) {
-		se = hashmap_insert(state->entries, url);
+	ident = store_ident(url);
+	se = hashmap_lookup(state->entries, ENTRY_KEY(ident));
+	if ((se != NULL) && (store_entry_match(se, url) == false)) {
+		/* the identifier is used by the entry for another URL */
+		if (((se->elem[ENTRY_ELEM_DATA].flags |
+		      se->elem[ENTRY_ELEM_META].flags) &
+		     (ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP)) != 0) {
+			NSLOG(netsurf, INFO,
+			      "identifier collision with in use entry");
+			return NSERROR_PERMISSION;
+		}
+		invalidate_entry(state, se);
+		se = NULL;
 	}
 	if (se == NULL) {
-		return NSERROR_NOMEM;
+		se = hashmap_insert(state->entries, ENTRY_KEY(ident));
+		if (se == NULL) {
+			return NSERROR_NOMEM;
+		}
+		if (evict_heap_insert(state, se) != NSERROR_OK) {
+			hashmap_remove(state->entries, ENTRY_KEY(ident));
+			return NSERROR_NOMEM;
+		}
+		se->url = nsurl_ref(url);
 	}
 
 	/* the entry element */
@@ -1028,14 +2087,26 @@ set_store_entry(struct store_state *state,
 
 	/* account for size of entry element */
 	state->total_alloc -= elem->size;
-	elem->size = datalen;
+	state->raw_alloc -= elem->raw_size;
+	if (zlen != 0) {
+		elem->flags |= ENTRY_ELEM_FLAG_DEFLATE;
+		elem->size = zlen;
+	} else {
+		elem->flags &= ~ENTRY_ELEM_FLAG_DEFLATE;
+		elem->size = datalen;
+	}
+	elem->raw_size = datalen;
 	state->total_alloc += elem->size;
+	state->raw_alloc += elem->raw_size;
 
 	/* if the element will fit in a small block attempt to allocate one */
 	if (elem->size <= (1U << log2_block_size[elem_idx])) {
 		elem->block = alloc_block(state, elem_idx);
 	}
 
+	/* the use and size of the entry have changed */
+	evict_heap_update(state, se);
+
 	/* ensure control maintenance scheduled. */
 	state->entries_dirty = true;
 	guit->misc->schedule(CONTROL_MAINT_TIME, control_maintenance, state);
@@ -1118,6 +2189,211 @@ unlink_entries(struct store_state *state)
 	return NSERROR_OK;
 }
 
+/**
+ * Release the serialised entries loaded at initialisation.
+ *
+ * @param state The backing store state.
+ */
+static void
+release_index(struct store_state *state)
+{
+	if (state->index == NULL) {
+		return;
+	}
+
+#ifdef HAVE_MMAP
+	if (state->index_mapped) {
+		munmap(state->index, state->index_size);
+	} else {
+		free(state->index);
+	}
+#else
+	free(state->index);
+#endif
+
+	state->index = NULL;
+	state->index_size = 0;
+	state->index_mapped = false;
+}
+
+/**
+ * Load the serialised entries.
+ *
+ * The entries file is mapped into memory where supported, otherwise
+ * it is read into a heap allocation with as few reads as possible.
+ *
+ * @param state The backing store state to load the entries into.
+ * @param fd The open entries file.
+ * @return NSERROR_OK on success or error code on faliure.
+ */
+static nserror
+load_index(struct store_state *state, int fd)
+{
+	struct stat sb;
+	size_t tot = 0;
+	ssize_t rd;
+
+	if (fstat(fd, &sb) != 0) {
+		return NSERROR_INIT_FAILED;
+	}
+
+	if (sb.st_size == 0) {
+		return NSERROR_OK;
+	}
+	state->index_size = sb.st_size;
+
+#ifdef HAVE_MMAP
+	state->index = mmap(NULL, state->index_size, PROT_READ,
+			    MAP_PRIVATE, fd, 0);
+	if (state->index != MAP_FAILED) {
+		state->index_mapped = true;
+		return NSERROR_OK;
+	}
+	NSLOG(netsurf, INFO, "mapping entries failed errno %d", errno);
+#endif
+
+	state->index = malloc(state->index_size);
+	if (state->index == NULL) {
+		state->index_size = 0;
+		return NSERROR_NOMEM;
+	}
+
+	while (tot < state->index_size) {
+		rd = read(fd, state->index + tot, state->index_size - tot);
+		if (rd <= 0) {
+			release_index(state);
+			return NSERROR_INIT_FAILED;
+		}
+		tot += rd;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Check the element sizes and flags of a serialised entry are consistent.
+ *
+ * @param rec The serialised entry.
+ * @param elem_idx The element index to check.
+ * @return true if the element is valid else false.
+ */
+static bool
+index_elem_valid(const struct store_index_entry *rec, int elem_idx)
+{
+	if ((rec->elem_flags[elem_idx] & ~ENTRY_ELEM_FLAG_PERSIST) != 0) {
+		return false;
+	}
+	if ((rec->elem_flags[elem_idx] & ENTRY_ELEM_FLAG_DEFLATE) == 0) {
+		return rec->raw_size[elem_idx] == rec->size[elem_idx];
+	}
+	return (rec->size[elem_idx] != 0) && (rec->raw_size[elem_idx] != 0);
+}
+
+/**
+ * Create entries from the loaded serialised entries.
+ *
+ * The entries refer to their URL text within the loaded index until
+ * they are first used so no URL objects are created here.
+ *
+ * @param state The backing store state with the loaded index.
+ * @return NSERROR_OK on success or error code on faliure.
+ */
+static nserror
+index_entries(struct store_state *state)
+{
+	const struct store_index_header *hdr;
+	const struct store_index_entry *table;
+	const struct store_index_entry *rec;
+	const char *pool;
+	struct store_entry *ent;
+	uint32_t idx;
+
+	if (state->index_size < sizeof(*hdr)) {
+		NSLOG(netsurf, ERROR, "entries truncated");
+		return NSERROR_INIT_FAILED;
+	}
+
+	hdr = (const struct store_index_header *)state->index;
+	if ((hdr->magic != ENTRIES_MAGIC) ||
+	    (hdr->version != ENTRIES_VERSION) ||
+	    (hdr->entry_size != sizeof(struct store_index_entry)) ||
+	    ((hdr->pool_size & 3) != 0)) {
+		NSLOG(netsurf, ERROR, "entries header invalid");
+		return NSERROR_INIT_FAILED;
+	}
+
+	if ((hdr->entry_count >
+	     (UINT32_MAX / sizeof(struct store_index_entry))) ||
+	    (state->index_size != (sizeof(*hdr) +
+				   ((size_t)hdr->entry_count *
+				    sizeof(struct store_index_entry)) +
+				   hdr->pool_size))) {
+		NSLOG(netsurf, ERROR, "entries size mismatch");
+		return NSERROR_INIT_FAILED;
+	}
+
+	table = (const struct store_index_entry *)(state->index + sizeof(*hdr));
+	pool = (const char *)(table + hdr->entry_count);
+
+	if (index_checksum((const uint32_t *)table,
+			   (state->index_size - sizeof(*hdr)) / 4) !=
+	    hdr->checksum) {
+		NSLOG(netsurf, ERROR, "entries checksum mismatch");
+		return NSERROR_INIT_FAILED;
+	}
+
+	if (evict_heap_reserve(state, hdr->entry_count) != NSERROR_OK) {
+		return NSERROR_NOMEM;
+	}
+
+	for (idx = 0; idx < hdr->entry_count; idx++) {
+		rec = &table[idx];
+
+		if ((rec->ident == 0) ||
+		    (rec->url_offset >= hdr->pool_size) ||
+		    (rec->url_len >= (hdr->pool_size - rec->url_offset)) ||
+		    (pool[rec->url_offset + rec->url_len] != 0) ||
+		    (index_elem_valid(rec, ENTRY_ELEM_DATA) == false) ||
+		    (index_elem_valid(rec, ENTRY_ELEM_META) == false)) {
+			NSLOG(netsurf, ERROR, "entry %"PRIu32" invalid", idx);
+			return NSERROR_INIT_FAILED;
+		}
+
+		ent = hashmap_insert(state->entries, ENTRY_KEY(rec->ident));
+		if (ent == NULL) {
+			return NSERROR_NOMEM;
+		}
+
+		ent->url_str = pool + rec->url_offset;
+		ent->url_len = rec->url_len;
+		ent->last_used = rec->last_used;
+		ent->use_count = rec->use_count;
+		ent->flags = rec->flags;
+		ent->elem[ENTRY_ELEM_DATA].size = rec->size[ENTRY_ELEM_DATA];
+		ent->elem[ENTRY_ELEM_DATA].raw_size = rec->raw_size[ENTRY_ELEM_DATA];
+		ent->elem[ENTRY_ELEM_DATA].block = rec->block[ENTRY_ELEM_DATA];
+		ent->elem[ENTRY_ELEM_DATA].flags = rec->elem_flags[ENTRY_ELEM_DATA];
+		ent->elem[ENTRY_ELEM_META].size = rec->size[ENTRY_ELEM_META];
+		ent->elem[ENTRY_ELEM_META].raw_size = rec->raw_size[ENTRY_ELEM_META];
+		ent->elem[ENTRY_ELEM_META].block = rec->block[ENTRY_ELEM_META];
+		ent->elem[ENTRY_ELEM_META].flags = rec->elem_flags[ENTRY_ELEM_META];
+
+		/* Note the size allocation */
+		state->total_alloc += ent->elem[ENTRY_ELEM_DATA].size;
+		state->total_alloc += ent->elem[ENTRY_ELEM_META].size;
+		state->raw_alloc += ent->elem[ENTRY_ELEM_DATA].raw_size;
+		state->raw_alloc += ent->elem[ENTRY_ELEM_META].raw_size;
+
+		/* heap order is established once all entries are loaded */
+		ent->evict_key = state->policy->priority(state, ent);
+		evict_heap_set(state, state->evict_count++, ent);
+	}
+
+	evict_heap_build(state);
+
+	return NSERROR_OK;
+}
+
 /**
  * Read description entries into memory.
  *
@@ -1128,11 +2404,7 @@ static nserror
 read_entries(struct store_state *state)
 {
 	char *fname = NULL;
-	char *url;
-	nsurl *nsurl;
 	nserror ret;
-	size_t read_entries = 0;
-	struct store_entry *ent;
 	int fd;
 
 	ret = netsurf_mkpath(&fname, NULL, 2, state->path, ENTRIES_FNAME);
@@ -1146,65 +2418,33 @@ read_entries(struct store_state *state)
 		return NSERROR_NOMEM;
 	}
 
-	fd = open(fname, O_RDWR);
+	fd = open(fname, O_RDONLY);
+	free(fname);
 	if (fd != -1) {
-		uint32_t urllen;
-		while (read(fd, &urllen, sizeof(urllen)) == sizeof(urllen)) {
-			url = calloc(1, urllen+1);
-			if (url == NULL) {
-				close(fd);
-				free(fname);
-				return NSERROR_NOMEM;
-			}
-			if (read(fd, url, urllen) != (ssize_t)urllen) {
-				free(url);
-				close(fd);
-				free(fname);
-				return NSERROR_INIT_FAILED;
-			}
-			ret = nsurl_create(url, &nsurl);
-			if (ret != NSERROR_OK) {
-				free(url);
-				close(fd);
-				free(fname);
-				return ret;
-			}
-			free(url);
-			/* We have to be careful here about nsurl refs */
-			ent = hashmap_insert(state->entries, nsurl);
-			if (ent == NULL) {
-				nsurl_unref(nsurl);
-				close(fd);
-				free(fname);
-				return NSERROR_NOMEM;
-			}
-			/* At this point, ent actually owns a ref of nsurl */
-			if (read(fd, ent, sizeof(*ent)) != sizeof(*ent)) {
-				/* The read failed, so reset the ptr */
-				ent->url = nsurl; /* It already had a ref */
-				nsurl_unref(nsurl);
-				close(fd);
-				free(fname);
-				return NSERROR_INIT_FAILED;
-			}
-			ent->url = nsurl; /* It already owns a ref */
-			nsurl_unref(nsurl);
-			NSLOG(netsurf, DEBUG, "Successfully read entry for %s", nsurl_access(ent->url));
-			read_entries++;
-			/* Note the size allocation */
-			state->total_alloc += ent->elem[ENTRY_ELEM_DATA].size;
-			state->total_alloc += ent->elem[ENTRY_ELEM_META].size;
-			/* And ensure we don't pretend to have this in memory yet */
-			ent->elem[ENTRY_ELEM_DATA].flags &= ~(ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP);
-			ent->elem[ENTRY_ELEM_META].flags &= ~(ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP);
+		ret = load_index(state, fd);
+		close(fd);
 
+		if ((ret == NSERROR_OK) && (state->index != NULL)) {
+			ret = index_entries(state);
+		}
+
+		if (ret != NSERROR_OK) {
+			hashmap_destroy(state->entries);
+			state->entries = NULL;
+			release_index(state);
+			free(state->evict_heap);
+			state->evict_heap = NULL;
+			state->evict_count = 0;
+			state->evict_alloc = 0;
+			state->total_alloc = 0;
+			state->raw_alloc = 0;
+			return ret;
 		}
-		close(fd);
 	}
 
-	NSLOG(netsurf, INFO, "Read %"PRIsizet" entries from cache", read_entries);
+	NSLOG(netsurf, INFO, "Read %"PRIsizet" entries from cache",
+	      hashmap_count(state->entries));
 
-	free(fname);
 	return NSERROR_OK;
 }
 
@@ -1449,6 +2689,7 @@ initialise(const struct llcache_store_parameters *parameters)
 	newstate->path = strdup(parameters->path);
 	newstate->limit = parameters->limit;
 	newstate->hysteresis = parameters->hysteresis;
+	newstate->policy = &evict_policies[STORE_EVICT_POLICY];
 
 	/* read store control and create new if required */
 	ret = read_control(newstate);
@@ -1496,20 +2737,25 @@ initialise(const struct llcache_store_parameters *parameters)
 	if (ret != NSERROR_OK) {
 		/* oh dear */
 		hashmap_destroy(newstate->entries);
+		release_index(newstate);
+		free(newstate->evict_heap);
 		free(newstate->path);
 		free(newstate);
 		return ret;
 	}
 
+	store_io_start(newstate);
+
 	storestate = newstate;
 
 	NSLOG(netsurf, INFO, "FS backing store init successful");
 
 	NSLOG(netsurf, INFO,
-	      "path:%s limit:%"PRIsizet" hyst:%"PRIsizet,
+	      "path:%s limit:%"PRIsizet" hyst:%"PRIsizet" policy:%s",
 	      newstate->path,
 	      newstate->limit,
-	      newstate->hysteresis);
+	      newstate->hysteresis,
+	      newstate->policy->name);
 	NSLOG(netsurf, INFO, "Using %"PRIu64"/%"PRIsizet,
 	      newstate->total_alloc, newstate->limit);
 
@@ -1517,6 +2763,17 @@ initialise(const struct llcache_store_parameters *parameters)
 }
 
 
+/**
+ * Time spent decompressing elements.
+ *
+ * @param state The backing store state.
+ * @return The processor time in microseconds.
+ */
+static uint64_t store_decompress_us(const struct store_state *state)
+{
+	return ((uint64_t)state->decompress_time * 1000000) / CLOCKS_PER_SEC;
+}
+
 /**
  * Finalise the backing store.
  *
@@ -1536,6 +2793,9 @@ finalise(void)
 		write_entries(storestate);
 		write_blocks(storestate);
 
+		/* wait for all outstanding writes */
+		store_io_stop(storestate);
+
 		/* ensure all block files are closed */
 		for (bf = 0; bf < BLOCK_FILE_COUNT; bf++) {
 			if (storestate->blocks[ENTRY_ELEM_DATA][bf].fd != -1) {
@@ -1561,7 +2821,25 @@ finalise(void)
 			      0);
 		}
 
+		if (storestate->compress_in > 0) {
+			NSLOG(netsurf, INFO,
+			      "Compressed %"PRIsizet" elements %"PRIu64" to %"PRIu64" bytes (%"PRIu64"%%)",
+			      storestate->compress_count,
+			      storestate->compress_in,
+			      storestate->compress_out,
+			      (storestate->compress_out * 100) /
+			      storestate->compress_in);
+		}
+		if (storestate->decompress_count > 0) {
+			NSLOG(netsurf, INFO,
+			      "Decompressed %"PRIsizet" elements in %"PRIu64"us",
+			      storestate->decompress_count,
+			      store_decompress_us(storestate));
+		}
+
 		hashmap_destroy(storestate->entries);
+		release_index(storestate);
+		free(storestate->evict_heap);
 		free(storestate->path);
 		free(storestate);
 		storestate = NULL;
@@ -1576,17 +2854,19 @@ finalise(void)
  * \param state The backing store state to use.
  * \param bse The entry to store
  * \param elem_idx The element index within the entry.
+ * \param zdata The compressed element data or NULL if the element is
+ *              stored uncompressed. Ownership passes to the write.
  * \return NSERROR_OK on success or error code.
  */
 static nserror store_write_block(struct store_state *state,
 			 struct store_entry *bse,
-			 int elem_idx)
+			 int elem_idx,
+			 uint8_t *zdata)
 {
 	block_index_t bf = (bse->elem[elem_idx].block >> BLOCK_ENTRY_COUNT) &
 		((1 << BLOCK_FILE_COUNT) - 1); /* block file block resides in */
 	block_index_t bi = bse->elem[elem_idx].block & ((1U << BLOCK_ENTRY_COUNT) -1); /* block index in file */
-	ssize_t wr;
-	off_t offst;
+	struct store_io *io;
 
 	/* ensure the block file fd is good */
 	if (state->blocks[elem_idx][bf].fd == -1) {
@@ -1594,6 +2874,7 @@ static nserror store_write_block(struct store_state *state,
 				elem_idx + ENTRY_ELEM_COUNT, O_CREAT | O_RDWR);
 		if (state->blocks[elem_idx][bf].fd == -1) {
 			NSLOG(netsurf, ERROR, "Open failed errno %d", errno);
+			free(zdata);
 			return NSERROR_SAVE_FAILED;
 		}
 
@@ -1601,28 +2882,23 @@ static nserror store_write_block(struct store_state *state,
 		state->blocks_opened = true;
 	}
 
-	offst = (unsigned int)bi << log2_block_size[elem_idx];
-
-	wr = nsu_pwrite(state->blocks[elem_idx][bf].fd,
-			bse->elem[elem_idx].data,
-			bse->elem[elem_idx].size,
-			offst);
-	if (wr != (ssize_t)bse->elem[elem_idx].size) {
-		NSLOG(netsurf, ERROR,
-		      "Write failed %"PRIssizet" of %"PRId32" bytes from %p at %"PRIsizet" block %"PRIu16" errno %d",
-		      wr,
-		      bse->elem[elem_idx].size,
-		      bse->elem[elem_idx].data,
-		      (size_t)offst,
-		      bse->elem[elem_idx].block,
-		      errno);
-		return NSERROR_SAVE_FAILED;
+	io = store_io_create(STORE_IO_WRITE_BLOCK);
+	if (io == NULL) {
+		free(zdata);
+		return NSERROR_NOMEM;
 	}
+	io->fd = state->blocks[elem_idx][bf].fd;
+	io->offset = (unsigned int)bi << log2_block_size[elem_idx];
+	io->data = (zdata != NULL) ? zdata : bse->elem[elem_idx].data;
+	io->owned = zdata;
+	io->size = bse->elem[elem_idx].size;
+	io->ident = bse->ident;
+	io->elem_idx = elem_idx;
 
-	NSLOG(netsurf, INFO,
-	      "Wrote %"PRIssizet" bytes from %p at %"PRIsizet" block %d", wr,
-	      bse->elem[elem_idx].data, (size_t)offst,
-	      bse->elem[elem_idx].block);
+	/* the operation holds a reference to the element data */
+	bse->elem[elem_idx].ref++;
+
+	store_io_submit(state, io);
 
 	return NSERROR_OK;
 }
@@ -1633,43 +2909,76 @@ static nserror store_write_block(struct store_state *state,
  * \param state The backing store state to use.
  * \param bse The entry to store
  * \param elem_idx The element index within the entry.
+ * \param zdata The compressed element data or NULL if the element is
+ *              stored uncompressed. Ownership passes to the write.
  * \return NSERROR_OK on success or error code.
  */
 static nserror store_write_file(struct store_state *state,
 			 struct store_entry *bse,
-			 int elem_idx)
+			 int elem_idx,
+			 uint8_t *zdata)
 {
-	ssize_t wr;
-	int fd;
-	int err;
+	struct store_io *io;
 
-	fd = store_open(state, nsurl_hash(bse->url), elem_idx, O_CREAT | O_WRONLY);
-	if (fd < 0) {
-		perror("");
-		NSLOG(netsurf, ERROR, "Open failed %d errno %d", fd, errno);
-		return NSERROR_SAVE_FAILED;
+	io = store_io_create(STORE_IO_WRITE_FILE);
+	if (io == NULL) {
+		free(zdata);
+		return NSERROR_NOMEM;
+	}
+	io->fname = store_fname(state, bse->ident, elem_idx);
+	if (io->fname == NULL) {
+		free(io);
+		free(zdata);
+		return NSERROR_NOMEM;
 	}
+	io->data = (zdata != NULL) ? zdata : bse->elem[elem_idx].data;
+	io->owned = zdata;
+	io->size = bse->elem[elem_idx].size;
+	io->ident = bse->ident;
+	io->elem_idx = elem_idx;
 
-	wr = write(fd, bse->elem[elem_idx].data, bse->elem[elem_idx].size);
-	err = errno; /* close can change errno */
+	/* the operation holds a reference to the element data */
+	bse->elem[elem_idx].ref++;
 
-	close(fd);
-	if (wr != (ssize_t)bse->elem[elem_idx].size) {
-		NSLOG(netsurf, ERROR,
-		      "Write failed %"PRIssizet" of %"PRId32" bytes from %p errno %d",
-		      wr,
-		      bse->elem[elem_idx].size,
-		      bse->elem[elem_idx].data,
-		      err);
+	store_io_submit(state, io);
 
-		/** @todo Delete the file? */
-		return NSERROR_SAVE_FAILED;
+	return NSERROR_OK;
+}
+
+/**
+ * Compress element data.
+ *
+ * Compression is only worthwhile if it makes the element usefully
+ * smaller so the output is limited to seven eighths of the input.
+ *
+ * \param data The data to compress.
+ * \param datalen The length of \a data.
+ * \param zlen_out The length of the compressed data.
+ * \return The compressed data or NULL if it is not worth compressing.
+ */
+static uint8_t *
+store_compress(const uint8_t *data, size_t datalen, size_t *zlen_out)
+{
+	uint8_t *zdata;
+	uLongf zlen;
+	int res;
+
+	zlen = datalen - (datalen / 8);
+	zdata = malloc(zlen);
+	if (zdata == NULL) {
+		return NULL;
 	}
 
-	NSLOG(netsurf, VERBOSE, "Wrote %"PRIssizet" bytes from %p", wr,
-	      bse->elem[elem_idx].data);
+	res = compress2(zdata, &zlen, data, datalen, STORE_COMPRESS_LEVEL);
+	if (res != Z_OK) {
+		/* Z_BUF_ERROR if the data did not compress well enough */
+		free(zdata);
+		return NULL;
+	}
 
-	return NSERROR_OK;
+	*zlen_out = zlen;
+
+	return zdata;
 }
 
 /**
@@ -1692,6 +3001,8 @@ store(nsurl *url,
 	nserror ret;
 	struct store_entry *bse;
 	int elem_idx;
+	uint8_t *zdata = NULL;
+	size_t zlen = 0;
 
 	/* check backing store is initialised */
 	if (storestate == NULL) {
@@ -1705,40 +3016,46 @@ store(nsurl *url,
 		elem_idx = ENTRY_ELEM_DATA;
 	}
 
+	/* rather than wait for the disc refuse the object if the
+	 * background writes are too far behind. The data has not been
+	 * taken so remains the caller's.
+	 */
+	if (store_io_space(storestate, datalen) == false) {
+		NSLOG(netsurf, INFO, "I/O queue full");
+		return NSERROR_NOSPACE;
+	}
+
+	/* compress the element if it is of a suitable type and size */
+	if (((bsflags & BACKING_STORE_COMPRESSIBLE) != 0) &&
+	    (datalen >= STORE_COMPRESS_MIN)) {
+		zdata = store_compress(data, datalen, &zlen);
+	}
+
 	/* set the store entry up */
-	ret = set_store_entry(storestate, url, elem_idx, data, datalen, &bse);
+	ret = set_store_entry(storestate, url, elem_idx, data, datalen, zlen, &bse);
 	if (ret != NSERROR_OK) {
 		NSLOG(netsurf, ERROR, "store entry setting failed");
+		free(zdata);
 		return ret;
 	}
 
+	if (zdata != NULL) {
+		storestate->compress_count++;
+		storestate->compress_in += datalen;
+		storestate->compress_out += zlen;
+	}
+
 	if (bse->elem[elem_idx].block != 0) {
 		/* small block storage */
-		ret = store_write_block(storestate, bse, elem_idx);
+		ret = store_write_block(storestate, bse, elem_idx, zdata);
 	} else {
 		/* separate file in backing store */
-		ret = store_write_file(storestate, bse, elem_idx);
+		ret = store_write_file(storestate, bse, elem_idx, zdata);
 	}
 
 	return ret;
 }
 
-/**
- * release any allocation for an entry
- */
-static nserror entry_release_alloc(struct store_entry_element *elem)
-{
-	if ((elem->flags & ENTRY_ELEM_FLAG_HEAP) != 0) {
-		elem->ref--;
-		if (elem->ref == 0) {
-			NSLOG(netsurf, DEEPDEBUG, "freeing %p", elem->data);
-			free(elem->data);
-			elem->flags &= ~ENTRY_ELEM_FLAG_HEAP;
-		}
-	}
-	return NSERROR_OK;
-}
-
 
 /**
  * Read an element of an entry from a small block file in the backing storage.
@@ -1746,11 +3063,13 @@ static nserror entry_release_alloc(struct store_entry_element *elem)
  * \param state The backing store state to use.
  * \param bse The entry to read.
  * \param elem_idx The element index within the entry.
+ * \param buf The buffer to read the element on disc into.
  * \return NSERROR_OK on success or error code.
  */
 static nserror store_read_block(struct store_state *state,
 			 struct store_entry *bse,
-			 int elem_idx)
+			 int elem_idx,
+			 uint8_t *buf)
 {
 	block_index_t bf = (bse->elem[elem_idx].block >> BLOCK_ENTRY_COUNT) &
 		((1 << BLOCK_FILE_COUNT) - 1); /* block file block resides in */
@@ -1774,7 +3093,7 @@ static nserror store_read_block(struct store_state *state,
 	offst = (unsigned int)bi << log2_block_size[elem_idx];
 
 	rd = nsu_pread(state->blocks[elem_idx][bf].fd,
-		       bse->elem[elem_idx].data,
+		       buf,
 		       bse->elem[elem_idx].size,
 		       offst);
 	if (rd != (ssize_t)bse->elem[elem_idx].size) {
@@ -1782,7 +3101,7 @@ static nserror store_read_block(struct store_state *state,
 		      "Failed reading %"PRIssizet" of %"PRId32" bytes into %p from %"PRIsizet" block %"PRIu16" errno %d",
 		      rd,
 		      bse->elem[elem_idx].size,
-		      bse->elem[elem_idx].data,
+		      buf,
 		      (size_t)offst,
 		      bse->elem[elem_idx].block,
 		      errno);
@@ -1791,7 +3110,7 @@ static nserror store_read_block(struct store_state *state,
 
 	NSLOG(netsurf, DEEPDEBUG,
 	      "Read %"PRIssizet" bytes into %p from %"PRIsizet" block %d", rd,
-	      bse->elem[elem_idx].data, (size_t)offst,
+	      buf, (size_t)offst,
 	      bse->elem[elem_idx].block);
 
 	return NSERROR_OK;
@@ -1803,11 +3122,13 @@ static nserror store_read_block(struct store_state *state,
  * \param state The backing store state to use.
  * \param bse The entry to read.
  * \param elem_idx The element index within the entry.
+ * \param buf The buffer to read the element on disc into.
  * \return NSERROR_OK on success or error code.
  */
 static nserror store_read_file(struct store_state *state,
 			 struct store_entry *bse,
-			 int elem_idx)
+			 int elem_idx,
+			 uint8_t *buf)
 {
 	int fd;
 	ssize_t rd; /* return from read */
@@ -1815,7 +3136,7 @@ static nserror store_read_file(struct store_state *state,
 	size_t tot = 0; /* total size */
 
 	/* separate file in backing store */
-	fd = store_open(storestate, nsurl_hash(bse->url), elem_idx, O_RDONLY);
+	fd = store_open(storestate, bse->ident, elem_idx, O_RDONLY);
 	if (fd < 0) {
 		NSLOG(netsurf, ERROR, "Open failed %d errno %d", fd, errno);
 		/** @todo should this invalidate the entry? */
@@ -1824,7 +3145,7 @@ static nserror store_read_file(struct store_state *state,
 
 	while (tot < bse->elem[elem_idx].size) {
 		rd = read(fd,
-			  bse->elem[elem_idx].data + tot,
+			  buf + tot,
 			  bse->elem[elem_idx].size - tot);
 		if (rd <= 0) {
 			NSLOG(netsurf, ERROR,
@@ -1840,7 +3161,71 @@ static nserror store_read_file(struct store_state *state,
 	close(fd);
 
 	NSLOG(netsurf, DEEPDEBUG, "Read %"PRIsizet" bytes into %p", tot,
-	      bse->elem[elem_idx].data);
+	      buf);
+
+	return ret;
+}
+
+/**
+ * Read an element of an entry from the backing storage.
+ *
+ * \param state The backing store state to use.
+ * \param bse The entry to read.
+ * \param elem_idx The element index within the entry.
+ * \param buf The buffer to read the element on disc into.
+ * \return NSERROR_OK on success or error code.
+ */
+static nserror store_read_elem(struct store_state *state,
+			 struct store_entry *bse,
+			 int elem_idx,
+			 uint8_t *buf)
+{
+	if (bse->elem[elem_idx].block != 0) {
+		return store_read_block(state, bse, elem_idx, buf);
+	}
+	return store_read_file(state, bse, elem_idx, buf);
+}
+
+/**
+ * Read and decompress a compressed element of an entry.
+ *
+ * \param state The backing store state to use.
+ * \param bse The entry to read.
+ * \param elem_idx The element index within the entry.
+ * \return NSERROR_OK on success or error code.
+ */
+static nserror store_read_deflate(struct store_state *state,
+			 struct store_entry *bse,
+			 int elem_idx)
+{
+	struct store_entry_element *elem = &bse->elem[elem_idx];
+	uint8_t *zdata;
+	uLongf rawlen = elem->raw_size;
+	clock_t start;
+	nserror ret;
+	int res;
+
+	zdata = malloc(elem->size);
+	if (zdata == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	ret = store_read_elem(state, bse, elem_idx, zdata);
+	if (ret == NSERROR_OK) {
+		start = clock();
+		res = uncompress(elem->data, &rawlen, zdata, elem->size);
+		state->decompress_time += clock() - start;
+		state->decompress_count++;
+
+		if ((res != Z_OK) || (rawlen != elem->raw_size)) {
+			NSLOG(netsurf, ERROR,
+			      "Failed decompressing %"PRIu32" bytes to %"PRIu32" bytes zlib error %d",
+			      elem->size, elem->raw_size, res);
+			ret = NSERROR_NOT_FOUND;
+		}
+	}
+
+	free(zdata);
 
 	return ret;
 }
@@ -1901,7 +3286,7 @@ fetch(nsurl *url,
 
 	} else {
 		/* allocate from the heap */
-		elem->data = malloc(elem->size);
+		elem->data = malloc(elem->raw_size);
 		if (elem->data == NULL) {
 			NSLOG(netsurf, ERROR,
 			      "Failed to create new heap allocation");
@@ -1915,10 +3300,11 @@ fetch(nsurl *url,
 		elem->ref = 1;
 
 		/* fill the new block */
-		if (elem->block != 0) {
-			ret = store_read_block(storestate, bse, elem_idx);
+		if ((elem->flags & ENTRY_ELEM_FLAG_DEFLATE) != 0) {
+			ret = store_read_deflate(storestate, bse, elem_idx);
 		} else {
-			ret = store_read_file(storestate, bse, elem_idx);
+			ret = store_read_elem(storestate, bse, elem_idx,
+					      elem->data);
 		}
 	}
 
@@ -1927,10 +3313,10 @@ fetch(nsurl *url,
 		entry_release_alloc(elem);
 	} else {
 		/* update stats and setup return pointers */
-		storestate->hit_size += elem->size;
+		storestate->hit_size += elem->raw_size;
 
 		*data_out = elem->data;
-		*datalen_out = elem->size;
+		*datalen_out = elem->raw_size;
 	}
 
 	return ret;
@@ -2012,6 +3398,34 @@ invalidate(nsurl *url)
 }
 
 
+/**
+ * Retrieve backing store statistics.
+ *
+ * @param[out] stats The statistics to fill in.
+ * @return NSERROR_OK on success or error code on failure.
+ */
+static nserror
+stats(struct backing_store_stats *stats)
+{
+	/* check backing store is initialised */
+	if (storestate == NULL) {
+		return NSERROR_INIT_FAILED;
+	}
+
+	stats->total_alloc = storestate->total_alloc;
+	stats->raw_alloc = storestate->raw_alloc;
+	stats->hit_count = storestate->hit_count;
+	stats->miss_count = storestate->miss_count;
+	stats->compress_count = storestate->compress_count;
+	stats->compress_in = storestate->compress_in;
+	stats->compress_out = storestate->compress_out;
+	stats->decompress_count = storestate->decompress_count;
+	stats->decompress_us = store_decompress_us(storestate);
+
+	return NSERROR_OK;
+}
+
+
 static struct gui_llcache_table llcache_table = {
 	.initialise = initialise,
 	.finalise = finalise,
@@ -2019,6 +3433,7 @@ static struct gui_llcache_table llcache_table = {
 	.fetch = fetch,
 	.invalidate = invalidate,
 	.release = release,
+	.stats = stats,
 };
 
 struct gui_llcache_table *filesystem_llcache_table = &llcache_table;
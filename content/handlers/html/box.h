@@ -88,7 +88,8 @@ typedef enum {
 	REPLACE_DIM = 1 << 9,	/* replaced element has given dimensions */
 	IFRAME      = 1 << 10,	/* box contains an iframe */
 	CONVERT_CHILDREN = 1 << 11,  /* wanted children converting */
-	IS_REPLACED = 1 << 12	/* box is a replaced element */
+	IS_REPLACED = 1 << 12,	/* box is a replaced element */
+	RELEASED    = 1 << 13	/* box references have been released */
 } box_flags;
 
 
@@ -171,6 +172,69 @@ struct object_params {
 };
 
 
+/**
+ * Box data which only some boxes have.
+ *
+ * This is kept out of struct box so the fields layout and redraw walk
+ * for every box are packed together.
+ */
+struct box_extension {
+	/**
+	 * Link, or NULL.
+	 */
+	struct nsurl *href;
+
+	/**
+	 * Link target, or NULL.
+	 */
+	const char *target;
+
+	/**
+	 * Title, or NULL.
+	 */
+	const char *title;
+
+	/**
+	 * Horizontal scroll.
+	 */
+	struct scrollbar *scroll_x;
+
+	/**
+	 * Vertical scroll.
+	 */
+	struct scrollbar *scroll_y;
+
+	/**
+	 * Array of table column data for TABLE only.
+	 */
+	struct column *col;
+
+	/**
+	 * (Image)map to use with this object, or NULL if none
+	 */
+	char *usemap;
+
+	/**
+	 * Parameters for the object, or NULL.
+	 */
+	struct object_params *object_params;
+
+	/**
+	 * Iframe's browser_window, or NULL if none
+	 */
+	struct browser_window *iframe;
+};
+
+
+/**
+ * Extension shared by all boxes without any extension data.
+ *
+ * This must never be written to, use box_extend() to obtain an
+ * extension which may be modified.
+ */
+extern struct box_extension box_no_extension;
+
+
 /**
  * Node in box tree. All dimensions are in pixels.
  */
@@ -209,6 +273,12 @@ struct box {
 	 */
 	lwc_string *id;
 
+	/**
+	 * Rarely used box data. Never NULL, boxes without any of this
+	 * data share box_no_extension.
+	 */
+	struct box_extension *ext;
+
 
 	/**
 	 * Next sibling box, or NULL.
@@ -326,16 +396,6 @@ struct box {
 	 */
 	struct box_border border[4];
 
-	/**
-	 * Horizontal scroll.
-	 */
-	struct scrollbar *scroll_x;
-
-	/**
-	 * Vertical scroll.
-	 */
-	struct scrollbar *scroll_y;
-
 	/**
 	 * Width of box taking all line breaks (including margins
 	 * etc). Must be non-negative.
@@ -370,22 +430,6 @@ struct box {
 	size_t byte_offset;
 
 
-	/**
-	 * Link, or NULL.
-	 */
-	struct nsurl *href;
-
-	/**
-	 * Link target, or NULL.
-	 */
-	const char *target;
-
-	/**
-	 * Title, or NULL.
-	 */
-	const char *title;
-
-
 	/**
 	 * Number of columns for TABLE / TABLE_CELL.
 	 */
@@ -401,11 +445,6 @@ struct box {
 	 */
 	unsigned int start_column;
 
-	/**
-	 * Array of table column data for TABLE only.
-	 */
-	struct column *col;
-
 	/**
 	 * List item value.
 	 */
@@ -423,12 +462,6 @@ struct box {
 	struct form_control* gadget;
 
 
-	/**
-	 * (Image)map to use with this object, or NULL if none
-	 */
-	char *usemap;
-
-
 	/**
 	 * Background image for this box, or NULL if none
 	 */
@@ -439,18 +472,6 @@ struct box {
 	 * Object in this box (usually an image), or NULL if none.
 	 */
 	struct hlcache_handle* object;
-
-	/**
-	 * Parameters for the object, or NULL.
-	 */
-	struct object_params *object_params;
-
-
-	/**
-	 * Iframe's browser_window, or NULL if none
-	 */
-	struct browser_window *iframe;
-
 };
 
 
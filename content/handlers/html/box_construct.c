@@ -32,6 +32,7 @@
 #include "utils/nsoption.h"
 #include "utils/corestrings.h"
 #include "utils/talloc.h"
+#include "utils/arena.h"
 #include "utils/string.h"
 #include "utils/ascii.h"
 #include "utils/nsurl.h"
@@ -60,7 +61,7 @@ struct box_construct_ctx {
 
 	box_construct_complete_cb cb;	/**< Callback to invoke on completion */
 
-	int *bctx;			/**< talloc context */
+	struct arena *arena;		/**< Arena for box tree allocations */
 };
 
 /**
@@ -340,7 +341,7 @@ box_construct_generate(dom_node *n,
 
 		/** \todo Not wise to drop const from the computed style */
 		gen = box_create(NULL, (css_computed_style *) style,
-				false, NULL, NULL, NULL, NULL, content->bctx);
+				false, NULL, NULL, NULL, NULL, content->box_arena);
 		if (gen == NULL) {
 			return;
 		}
@@ -374,7 +375,7 @@ box_construct_marker(struct box *box,
 	enum css_list_style_type_e list_style_type;
 
 	marker = box_create(NULL, box->style, false, NULL, NULL, title,
-			NULL, ctx->bctx);
+			NULL, ctx->arena);
 	if (marker == false)
 		return false;
 
@@ -513,7 +514,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 		if (t == NULL)
 			return false;
 
-		props.title = talloc_strdup(ctx->bctx, t);
+		props.title = arena_strdup(ctx->arena, t);
 
 		free(t);
 
@@ -536,7 +537,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 
 	box = box_create(styles, styles->styles[CSS_PSEUDO_ELEMENT_NONE], false,
 			props.href, props.target, props.title, id,
-			ctx->bctx);
+			ctx->arena);
 	if (box == NULL)
 		return false;
 
@@ -637,8 +638,8 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 		}
 
 		/* Can't do this, because the lifetimes of boxes and gadgets
-		 * are inextricably linked. Fortunately, talloc will save us
-		 * (for now) */
+		 * are inextricably linked. Fortunately, the box is released
+		 * with the rest of the arena (for now) */
 		/* box_free_box(box); */
 
 		*convert_children = false;
@@ -671,7 +672,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 				"Box must have containing block.");
 
 		props.inline_container = box_create(NULL, NULL, false, NULL,
-				NULL, NULL, NULL, ctx->bctx);
+				NULL, NULL, NULL, ctx->arena);
 		if (props.inline_container == NULL)
 			return false;
 
@@ -735,7 +736,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 			/* Float: insert a float between the parent and box. */
 			struct box *flt = box_create(NULL, NULL, false,
 					props.href, props.target, props.title,
-					NULL, ctx->bctx);
+					NULL, ctx->arena);
 			if (flt == NULL)
 				return false;
 
@@ -795,7 +796,7 @@ static void box_construct_element_after(dom_node *n, html_content *content)
 		if (props.inline_container == NULL) {
 			/* Create inline container if we don't have one */
 			props.inline_container = box_create(NULL, NULL, false,
-					NULL, NULL, NULL, NULL, content->bctx);
+					NULL, NULL, NULL, NULL, content->box_arena);
 			if (props.inline_container == NULL)
 				return;
 
@@ -806,9 +807,10 @@ static void box_construct_element_after(dom_node *n, html_content *content)
 		}
 
 		inline_end = box_create(NULL, box->style, false,
-				box->href, box->target, box->title,
+				box->ext->href, box->ext->target,
+				box->ext->title,
 				box->id == NULL ? NULL :
-				lwc_string_ref(box->id), content->bctx);
+				lwc_string_ref(box->id), content->box_arena);
 		if (inline_end != NULL) {
 			inline_end->type = BOX_INLINE_END;
 
@@ -1037,7 +1039,7 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 			 * (i.e. this box is the first child of its parent, or
 			 * was preceded by block-level siblings) */
 			props.inline_container = box_create(NULL, NULL, false,
-					NULL, NULL, NULL, NULL, ctx->bctx);
+					NULL, NULL, NULL, NULL, ctx->arena);
 			if (props.inline_container == NULL) {
 				free(text);
 				return false;
@@ -1053,7 +1055,7 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 		box = box_create(NULL,
 				(css_computed_style *) props.parent_style,
 				false, props.href, props.target, props.title,
-				NULL, ctx->bctx);
+				NULL, ctx->arena);
 		if (box == NULL) {
 			free(text);
 			return false;
@@ -1061,7 +1063,7 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 
 		box->type = BOX_TEXT;
 
-		box->text = talloc_strdup(ctx->bctx, text);
+		box->text = arena_strdup(ctx->arena, text);
 		free(text);
 		if (box->text == NULL)
 			return false;
@@ -1155,7 +1157,7 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 				 * siblings) */
 				props.inline_container = box_create(NULL, NULL,
 						false, NULL, NULL, NULL, NULL,
-						ctx->bctx);
+						ctx->arena);
 				if (props.inline_container == NULL) {
 					free(text);
 					return false;
@@ -1172,7 +1174,7 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 			box = box_create(NULL,
 				(css_computed_style *) props.parent_style,
 				false, props.href, props.target, props.title,
-				NULL, ctx->bctx);
+				NULL, ctx->arena);
 			if (box == NULL) {
 				free(text);
 				return false;
@@ -1180,7 +1182,7 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 
 			box->type = BOX_TEXT;
 
-			box->text = talloc_strdup(ctx->bctx, current);
+			box->text = arena_strdup(ctx->arena, current);
 			if (box->text == NULL) {
 				free(text);
 				return false;
@@ -1198,7 +1200,7 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 				/* Linebreak: create new inline container */
 				props.inline_container = box_create(NULL, NULL,
 						false, NULL, NULL, NULL, NULL,
-						ctx->bctx);
+						ctx->arena);
 				if (props.inline_container == NULL) {
 					free(text);
 					return false;
@@ -1286,6 +1288,7 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 			memset(&root, 0, sizeof(root));
 
 			root.type = BOX_BLOCK;
+			root.ext = &box_no_extension;
 			root.children = root.last = ctx->root_box;
 			root.children->parent = &root;
 
@@ -1331,6 +1334,14 @@ dom_to_box(dom_node *n,
 		}
 	}
 
+	if (c->box_arena == NULL) {
+		/* create the arena the box tree is allocated from */
+		c->box_arena = box_arena_create();
+		if (c->box_arena == NULL) {
+			return NSERROR_NOMEM;
+		}
+	}
+
 	ctx = malloc(sizeof(*ctx));
 	if (ctx == NULL) {
 		return NSERROR_NOMEM;
@@ -1340,7 +1351,7 @@ dom_to_box(dom_node *n,
 	ctx->n = dom_node_ref(n);
 	ctx->root_box = NULL;
 	ctx->cb = cb;
-	ctx->bctx = c->bctx;
+	ctx->arena = c->box_arena;
 
 	*box_conversion_context = ctx;
 
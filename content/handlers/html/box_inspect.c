@@ -500,14 +500,14 @@ box_nearest_text_box(struct box *box,
 		if (child->type == BOX_FLOAT_LEFT ||
 		    child->type == BOX_FLOAT_RIGHT) {
 			c_bx = fx + child->x -
-				scrollbar_get_offset(child->scroll_x);
+				scrollbar_get_offset(child->ext->scroll_x);
 			c_by = fy + child->y -
-				scrollbar_get_offset(child->scroll_y);
+				scrollbar_get_offset(child->ext->scroll_y);
 		} else {
 			c_bx = bx + child->x -
-				scrollbar_get_offset(child->scroll_x);
+				scrollbar_get_offset(child->ext->scroll_x);
 			c_by = by + child->y -
-				scrollbar_get_offset(child->scroll_y);
+				scrollbar_get_offset(child->ext->scroll_y);
 		}
 		if (child->float_children) {
 			c_fx = c_bx;
@@ -556,8 +556,8 @@ void box_coords(struct box *box, int *x, int *y)
 		} else {
 			box = box->parent;
 		}
-		*x += box->x - scrollbar_get_offset(box->scroll_x);
-		*y += box->y - scrollbar_get_offset(box->scroll_y);
+		*x += box->x - scrollbar_get_offset(box->ext->scroll_x);
+		*y += box->y - scrollbar_get_offset(box->ext->scroll_y);
 	}
 }
 
@@ -593,8 +593,8 @@ box_at_point(const css_unit_ctx *unit_len_ctx,
 	while ((box = box_next_xy(box, box_x, box_y, skip_children))) {
 		if (box_contains_point(unit_len_ctx, box, x - *box_x, y - *box_y,
 				       &physically)) {
-			*box_x -= scrollbar_get_offset(box->scroll_x);
-			*box_y -= scrollbar_get_offset(box->scroll_y);
+			*box_x -= scrollbar_get_offset(box->ext->scroll_x);
+			*box_y -= scrollbar_get_offset(box->ext->scroll_y);
 
 			if (physically)
 				return box;
@@ -745,19 +745,19 @@ void box_dump(FILE *stream, struct box *box, unsigned int depth, bool style)
 		fprintf(stream, "(object '%s') ",
 			nsurl_access(hlcache_handle_get_url(box->object)));
 	}
-	if (box->iframe) {
+	if (box->ext->iframe) {
 		fprintf(stream, "(iframe) ");
 	}
 	if (box->gadget)
 		fprintf(stream, "(gadget) ");
 	if (style && box->style)
 		nscss_dump_computed_style(stream, box->style);
-	if (box->href)
-		fprintf(stream, " -> '%s'", nsurl_access(box->href));
-	if (box->target)
-		fprintf(stream, " |%s|", box->target);
-	if (box->title)
-		fprintf(stream, " [%s]", box->title);
+	if (box->ext->href)
+		fprintf(stream, " -> '%s'", nsurl_access(box->ext->href));
+	if (box->ext->target)
+		fprintf(stream, " |%s|", box->ext->target);
+	if (box->ext->title)
+		fprintf(stream, " [%s]", box->ext->title);
 	if (box->id)
 		fprintf(stream, " ID:%s", lwc_string_data(box->id));
 	if (box->type == BOX_INLINE || box->type == BOX_INLINE_END)
@@ -768,7 +768,7 @@ void box_dump(FILE *stream, struct box *box, unsigned int depth, bool style)
 		fprintf(stream, " next_float %p", box->next_float);
 	if (box->float_container)
 		fprintf(stream, " float_container %p", box->float_container);
-	if (box->col) {
+	if (box->ext->col) {
 		fprintf(stream, " (columns");
 		for (i = 0; i != box->columns; i++) {
 			fprintf(stream, " (%s %s %i %i %i)",
@@ -779,13 +779,13 @@ void box_dump(FILE *stream, struct box *box, unsigned int depth, bool style)
 					"PERCENT",
 					"RELATIVE"
 						})
-				[box->col[i].type],
+				[box->ext->col[i].type],
 				((const char *[]) {
 					"normal",
 					"positioned"})
-				[box->col[i].positioned],
-				box->col[i].width,
-				box->col[i].min, box->col[i].max);
+				[box->ext->col[i].positioned],
+				box->ext->col[i].width,
+				box->ext->col[i].min, box->ext->col[i].max);
 		}
 		fprintf(stream, ")");
 	}
@@ -27,7 +27,7 @@
 
 
 #include "utils/errors.h"
-#include "utils/talloc.h"
+#include "utils/arena.h"
 #include "utils/nsurl.h"
 #include "netsurf/types.h"
 #include "netsurf/mouse.h"
@@ -39,17 +39,31 @@
 #include "html/box.h"
 #include "html/box_manipulate.h"
 
+/** Size of the chunks box tree arenas are allocated in */
+#define BOX_ARENA_CHUNK_SIZE (64 * 1024)
+
+/* exported interface documented in html/box.h */
+struct box_extension box_no_extension;
+
 
 /**
- * Destructor for box nodes which own styles
+ * Release the references held by a box.
+ *
+ * This is the arena finaliser for boxes so may be called for a box
+ * which has already been released by box_free_box().
  *
- * \param b The box being destroyed.
- * \return 0 to allow talloc to continue destroying the tree.
+ * \param p The box being destroyed.
  */
-static int box_talloc_destructor(struct box *b)
+static void box_arena_finaliser(void *p)
 {
+	struct box *b = p;
 	struct html_scrollbar_data *data;
 
+	if (b->flags & RELEASED) {
+		return;
+	}
+	b->flags |= RELEASED;
+
 	if ((b->flags & STYLE_OWNED) && b->style != NULL) {
 		css_computed_style_destroy(b->style);
 		b->style = NULL;
@@ -60,8 +74,8 @@ static int box_talloc_destructor(struct box *b)
 		b->styles = NULL;
 	}
 
-	if (b->href != NULL)
-		nsurl_unref(b->href);
+	if (b->ext->href != NULL)
+		nsurl_unref(b->ext->href);
 
 	if (b->id != NULL) {
 		lwc_string_unref(b->id);
@@ -71,19 +85,31 @@ static int box_talloc_destructor(struct box *b)
 		dom_node_unref(b->node);
 	}
 
-	if (b->scroll_x != NULL) {
-		data = scrollbar_get_data(b->scroll_x);
-		scrollbar_destroy(b->scroll_x);
+	if (b->ext->scroll_x != NULL) {
+		data = scrollbar_get_data(b->ext->scroll_x);
+		scrollbar_destroy(b->ext->scroll_x);
 		free(data);
 	}
 
-	if (b->scroll_y != NULL) {
-		data = scrollbar_get_data(b->scroll_y);
-		scrollbar_destroy(b->scroll_y);
+	if (b->ext->scroll_y != NULL) {
+		data = scrollbar_get_data(b->ext->scroll_y);
+		scrollbar_destroy(b->ext->scroll_y);
 		free(data);
 	}
+}
+
+
+/* Exported function documented in html/box_manipulate.h */
+struct arena *box_arena_create(void)
+{
+	struct arena *arena;
+
+	arena = arena_create(BOX_ARENA_CHUNK_SIZE, box_arena_finaliser);
+	if (arena != NULL) {
+		arena_memtrack(arena, MEMTRACK_BOX);
+	}
 
-	return 0;
+	return arena;
 }
 
 
@@ -96,17 +122,31 @@ box_create(css_select_results *styles,
 	   const char *target,
 	   const char *title,
 	   lwc_string *id,
-	   void *context)
+	   struct arena *arena)
 {
 	unsigned int i;
 	struct box *box;
+	struct box_extension *ext = &box_no_extension;
+
+	if (href != NULL || target != NULL || title != NULL) {
+		/* link information lives in the extension */
+		ext = arena_alloc(arena, sizeof(struct box_extension));
+		if (ext == NULL) {
+			return 0;
+		}
+		*ext = box_no_extension;
+		ext->target = target;
+		ext->title = title;
+	}
 
-	box = talloc(context, struct box);
+	box = arena_alloc_object(arena, sizeof(struct box));
 	if (!box) {
 		return 0;
 	}
 
-	talloc_set_destructor(box, box_talloc_destructor);
+	if (href != NULL) {
+		ext->href = nsurl_ref(href);
+	}
 
 	box->type = BOX_INLINE;
 	box->flags = 0;
@@ -120,16 +160,13 @@ box_create(css_select_results *styles,
 	box->descendant_x1 = box->descendant_y1 = 0;
 	for (i = 0; i != 4; i++)
 		box->margin[i] = box->padding[i] = box->border[i].width = 0;
-	box->scroll_x = box->scroll_y = NULL;
 	box->min_width = 0;
 	box->max_width = UNKNOWN_MAX_WIDTH;
 	box->byte_offset = 0;
 	box->text = NULL;
 	box->length = 0;
 	box->space = 0;
-	box->href = (href == NULL) ? NULL : nsurl_ref(href);
-	box->target = target;
-	box->title = title;
+	box->ext = ext;
 	box->columns = 1;
 	box->rows = 1;
 	box->start_column = 0;
@@ -145,20 +182,37 @@ box_create(css_select_results *styles,
 	box->cached_place_below_level = 0;
 	box->list_value = 1;
 	box->list_marker = NULL;
-	box->col = NULL;
 	box->gadget = NULL;
-	box->usemap = NULL;
 	box->id = id;
 	box->background = NULL;
 	box->object = NULL;
-	box->object_params = NULL;
-	box->iframe = NULL;
 	box->node = NULL;
 
 	return box;
 }
 
 
+/* Exported function documented in html/box_manipulate.h */
+struct box_extension *box_extend(struct box *box, struct arena *arena)
+{
+	struct box_extension *ext;
+
+	if (box->ext != &box_no_extension) {
+		return box->ext;
+	}
+
+	ext = arena_alloc(arena, sizeof(struct box_extension));
+	if (ext == NULL) {
+		return NULL;
+	}
+
+	*ext = box_no_extension;
+	box->ext = ext;
+
+	return ext;
+}
+
+
 /* Exported function documented in html/box.h */
 void box_add_child(struct box *parent, struct box *child)
 {
@@ -237,15 +291,10 @@ void box_free_box(struct box *box)
 	if (!(box->flags & CLONE)) {
 		if (box->gadget)
 			form_free_control(box->gadget);
-		if (box->scroll_x != NULL)
-			scrollbar_destroy(box->scroll_x);
-		if (box->scroll_y != NULL)
-			scrollbar_destroy(box->scroll_y);
-		if (box->styles != NULL)
-			css_select_results_destroy(box->styles);
+		box_arena_finaliser(box);
 	}
 
-	talloc_free(box);
+	/* the box memory is returned with the rest of the arena */
 }
 
 
@@ -257,28 +306,34 @@ box_handle_scrollbars(struct content *c,
 		      bool right)
 {
 	struct html_scrollbar_data *data;
+	struct box_extension *ext;
 	int visible_width, visible_height;
 	int full_width, full_height;
 	nserror res;
 
-	if (!bottom && box->scroll_x != NULL) {
-		data = scrollbar_get_data(box->scroll_x);
-		scrollbar_destroy(box->scroll_x);
+	if (!bottom && box->ext->scroll_x != NULL) {
+		data = scrollbar_get_data(box->ext->scroll_x);
+		scrollbar_destroy(box->ext->scroll_x);
 		free(data);
-		box->scroll_x = NULL;
+		box->ext->scroll_x = NULL;
 	}
 
-	if (!right && box->scroll_y != NULL) {
-		data = scrollbar_get_data(box->scroll_y);
-		scrollbar_destroy(box->scroll_y);
+	if (!right && box->ext->scroll_y != NULL) {
+		data = scrollbar_get_data(box->ext->scroll_y);
+		scrollbar_destroy(box->ext->scroll_y);
 		free(data);
-		box->scroll_y = NULL;
+		box->ext->scroll_y = NULL;
 	}
 
 	if (!bottom && !right) {
 		return NSERROR_OK;
 	}
 
+	ext = box_extend(box, ((html_content *)c)->box_arena);
+	if (ext == NULL) {
+		return NSERROR_NOMEM;
+	}
+
 	visible_width = box->width + box->padding[RIGHT] + box->padding[LEFT];
 	visible_height = box->height + box->padding[TOP] + box->padding[BOTTOM];
 
@@ -292,7 +347,7 @@ box_handle_scrollbars(struct content *c,
 			visible_height;
 
 	if (right) {
-		if (box->scroll_y == NULL) {
+		if (ext->scroll_y == NULL) {
 			data = malloc(sizeof(struct html_scrollbar_data));
 			if (data == NULL) {
 				return NSERROR_NOMEM;
@@ -305,19 +360,19 @@ box_handle_scrollbars(struct content *c,
 					       visible_height,
 					       data,
 					       html_overflow_scroll_callback,
-					       &(box->scroll_y));
+					       &(ext->scroll_y));
 			if (res != NSERROR_OK) {
 				return res;
 			}
 		} else  {
-			scrollbar_set_extents(box->scroll_y,
+			scrollbar_set_extents(ext->scroll_y,
 					      visible_height,
 					      visible_height,
 					      full_height);
 		}
 	}
 	if (bottom) {
-		if (box->scroll_x == NULL) {
+		if (ext->scroll_x == NULL) {
 			data = malloc(sizeof(struct html_scrollbar_data));
 			if (data == NULL) {
 				return NSERROR_OK;
@@ -330,12 +385,12 @@ box_handle_scrollbars(struct content *c,
 					       visible_width,
 					       data,
 					       html_overflow_scroll_callback,
-					       &box->scroll_x);
+					       &ext->scroll_x);
 			if (res != NSERROR_OK) {
 				return res;
 			}
 		} else {
-			scrollbar_set_extents(box->scroll_x,
+			scrollbar_set_extents(ext->scroll_x,
 					visible_width -
 					(right ? SCROLLBAR_WIDTH : 0),
 					visible_width, full_width);
@@ -343,7 +398,7 @@ box_handle_scrollbars(struct content *c,
 	}
 
 	if (right && bottom) {
-		scrollbar_make_pair(box->scroll_x, box->scroll_y);
+		scrollbar_make_pair(ext->scroll_x, ext->scroll_y);
 	}
 
 	return NSERROR_OK;
@@ -25,6 +25,18 @@
 #ifndef NETSURF_HTML_BOX_MANIPULATE_H
 #define NETSURF_HTML_BOX_MANIPULATE_H
 
+struct arena;
+
+/**
+ * Create an arena for allocating a box tree from.
+ *
+ * Boxes created from the arena have their references released when
+ * the arena is destroyed.
+ *
+ * \return new arena, or NULL on memory exhaustion
+ */
+struct arena *box_arena_create(void);
+
 
 /**
  * Create a box tree node.
@@ -36,13 +48,23 @@
  * \param  target       target for the box (not copied), or 0
  * \param  title        title for the box (not copied), or 0
  * \param  id           id for the box (not copied), or 0
- * \param  context      context for allocations
+ * \param  arena        arena to allocate the box from
  * \return  allocated and initialised box, or 0 on memory exhaustion
  *
  * styles is always owned by the box, if it is set.
  * style is only owned by the box in the case of implied boxes.
  */
-struct box * box_create(css_select_results *styles, css_computed_style *style, bool style_owned, struct nsurl *href, const char *target, const char *title, lwc_string *id, void *context);
+struct box * box_create(css_select_results *styles, css_computed_style *style, bool style_owned, struct nsurl *href, const char *target, const char *title, lwc_string *id, struct arena *arena);
+
+
+/**
+ * Get a box's own extension, creating it if required.
+ *
+ * \param  box    box to get the extension of
+ * \param  arena  arena the box was allocated from
+ * \return  extension which may be modified, or NULL on memory exhaustion
+ */
+struct box_extension *box_extend(struct box *box, struct arena *arena);
 
 
 /**
@@ -84,6 +106,9 @@ void box_free(struct box *box);
 /**
  * Free the data in a single box structure.
  *
+ * The references held by the box are released immediately, the memory
+ * itself is returned when the box tree's arena is destroyed.
+ *
  * \param box box to free
  */
 void box_free_box(struct box *box);
@@ -196,8 +196,9 @@ box_normalise_table_row(struct box *row,
 			if (style == NULL)
 				return false;
 
-			cell = box_create(NULL, style, true, row->href,
-					row->target, NULL, NULL, c->bctx);
+			cell = box_create(NULL, style, true, row->ext->href,
+					row->ext->target,
+					NULL, NULL, c->box_arena);
 			if (cell == NULL) {
 				css_computed_style_destroy(style);
 				return false;
@@ -336,8 +337,10 @@ box_normalise_table_row_group(struct box *row_group,
 			if (style == NULL)
 				return false;
 
-			row = box_create(NULL, style, true, row_group->href,
-					row_group->target, NULL, NULL, c->bctx);
+			row = box_create(NULL, style, true,
+					row_group->ext->href,
+					row_group->ext->target,
+					NULL, NULL, c->box_arena);
 			if (row == NULL) {
 				css_computed_style_destroy(style);
 				return false;
@@ -416,8 +419,10 @@ box_normalise_table_row_group(struct box *row_group,
 			return false;
 		}
 
-		row = box_create(NULL, style, true, row_group->href,
-				row_group->target, NULL, NULL, c->bctx);
+		row = box_create(NULL, style, true,
+				row_group->ext->href,
+				row_group->ext->target,
+				NULL, NULL, c->box_arena);
 		if (row == NULL) {
 			css_computed_style_destroy(style);
 			return false;
@@ -548,9 +553,9 @@ box_normalise_table_spans(struct box *table,
 						return false;
 
 					cell = box_create(NULL, style, true,
-							table_row->href,
-							table_row->target,
-							NULL, NULL, c->bctx);
+							table_row->ext->href,
+							table_row->ext->target,
+							NULL, NULL, c->box_arena);
 					if (cell == NULL) {
 						css_computed_style_destroy(
 								style);
@@ -675,8 +680,10 @@ box_normalise_table(struct box *table, const struct box *root, html_content * c)
 				return false;
 			}
 
-			row_group = box_create(NULL, style, true, table->href,
-					table->target, NULL, NULL, c->bctx);
+			row_group = box_create(NULL, style, true,
+					table->ext->href,
+					table->ext->target,
+					NULL, NULL, c->box_arena);
 			if (row_group == NULL) {
 				css_computed_style_destroy(style);
 				free(col_info.spans);
@@ -765,8 +772,10 @@ box_normalise_table(struct box *table, const struct box *root, html_content * c)
 			return false;
 		}
 
-		row_group = box_create(NULL, style, true, table->href,
-				table->target, NULL, NULL, c->bctx);
+		row_group = box_create(NULL, style, true,
+				table->ext->href,
+				table->ext->target,
+				NULL, NULL, c->box_arena);
 		if (row_group == NULL) {
 			css_computed_style_destroy(style);
 			free(col_info.spans);
@@ -782,8 +791,10 @@ box_normalise_table(struct box *table, const struct box *root, html_content * c)
 			return false;
 		}
 
-		row = box_create(NULL, style, true, row_group->href,
-				row_group->target, NULL, NULL, c->bctx);
+		row = box_create(NULL, style, true,
+				row_group->ext->href,
+				row_group->ext->target,
+				NULL, NULL, c->box_arena);
 		if (row == NULL) {
 			css_computed_style_destroy(style);
 			box_free(row_group);
@@ -873,9 +884,9 @@ static bool box_normalise_flex(
 				return false;
 
 			implied_flex_item = box_create(NULL, style, true,
-					flex_container->href,
-					flex_container->target,
-					NULL, NULL, c->bctx);
+					flex_container->ext->href,
+					flex_container->ext->target,
+					NULL, NULL, c->box_arena);
 			if (implied_flex_item == NULL) {
 				css_computed_style_destroy(style);
 				return false;
@@ -944,9 +955,9 @@ static bool box_normalise_flex(
 				return false;
 
 			implied_flex_item = box_create(NULL, style, true,
-					flex_container->href,
-					flex_container->target,
-					NULL, NULL, c->bctx);
+					flex_container->ext->href,
+					flex_container->ext->target,
+					NULL, NULL, c->box_arena);
 			if (implied_flex_item == NULL) {
 				css_computed_style_destroy(style);
 				return false;
@@ -1160,8 +1171,9 @@ box_normalise_block(struct box *block, const struct box *root, html_content *c)
 			if (style == NULL)
 				return false;
 
-			table = box_create(NULL, style, true, block->href,
-					block->target, NULL, NULL, c->bctx);
+			table = box_create(NULL, style, true, block->ext->href,
+					block->ext->target,
+					NULL, NULL, c->box_arena);
 			if (table == NULL) {
 				css_computed_style_destroy(style);
 				return false;
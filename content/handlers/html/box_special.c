@@ -35,6 +35,7 @@
 #include "utils/log.h"
 #include "utils/messages.h"
 #include "utils/talloc.h"
+#include "utils/arena.h"
 #include "utils/string.h"
 #include "utils/ascii.h"
 #include "utils/nsurl.h"
@@ -550,6 +551,37 @@ box_get_attribute(dom_node *n,
 }
 
 
+/**
+ * Get the imagemap a dom element uses, if any.
+ *
+ * \param  n        dom element node
+ * \param  content  html content being converted
+ * \param  box      box to set the imagemap for
+ * \return  true on success, false on memory exhaustion
+ */
+static bool
+box_get_usemap(dom_node *n, html_content *content, struct box *box)
+{
+	char *usemap = NULL;
+	struct box_extension *ext;
+
+	if (box_get_attribute(n, "usemap", content->bctx, &usemap) == false)
+		return false;
+	if (usemap == NULL)
+		return true;
+
+	ext = box_extend(box, content->box_arena);
+	if (ext == NULL)
+		return false;
+
+	if (usemap[0] == '#')
+		usemap++;
+	ext->usemap = usemap;
+
+	return true;
+}
+
+
 /**
  * Helper function for adding textarea widget to box.
  *
@@ -573,16 +605,16 @@ box_input_text(html_content *html, struct box *box, struct dom_node *node)
 		break;
 	}
 
-	inline_container = box_create(NULL, 0, false, 0, 0, 0, 0, html->bctx);
+	inline_container = box_create(NULL, 0, false, 0, 0, 0, 0, html->box_arena);
 	if (!inline_container)
 		return false;
 	inline_container->type = BOX_INLINE_CONTAINER;
-	inline_box = box_create(NULL, box->style, false, 0, 0, box->title, 0,
-			html->bctx);
+	inline_box = box_create(NULL, box->style, false, 0, 0,
+			box->ext->title, 0, html->box_arena);
 	if (!inline_box)
 		return false;
 	inline_box->type = BOX_TEXT;
-	inline_box->text = talloc_strdup(html->bctx, "");
+	inline_box->text = arena_strdup(html->box_arena, "");
 
 	box_add_child(inline_container, inline_box);
 	box_add_child(box, inline_container);
@@ -689,6 +721,12 @@ box_a(dom_node *n,
 	nsurl *url;
 	dom_string *s;
 	dom_exception err;
+	struct box_extension *ext;
+
+	/* anchors carry link information in the box extension */
+	ext = box_extend(box, content->box_arena);
+	if (ext == NULL)
+		return false;
 
 	err = dom_element_get_attribute(n, corestring_dom_href, &s);
 	if (err == DOM_NO_ERR && s != NULL) {
@@ -697,9 +735,9 @@ box_a(dom_node *n,
 		if (!ok)
 			return false;
 		if (url) {
-			if (box->href != NULL)
-				nsurl_unref(box->href);
-			box->href = url;
+			if (ext->href != NULL)
+				nsurl_unref(ext->href);
+			ext->href = url;
 		}
 	}
 
@@ -727,24 +765,24 @@ box_a(dom_node *n,
 	if (err == DOM_NO_ERR && s != NULL) {
 		if (dom_string_caseless_lwc_isequal(s,
 				corestring_lwc__blank))
-			box->target = "_blank";
+			ext->target = "_blank";
 		else if (dom_string_caseless_lwc_isequal(s,
 				corestring_lwc__top))
-			box->target = "_top";
+			ext->target = "_top";
 		else if (dom_string_caseless_lwc_isequal(s,
 				corestring_lwc__parent))
-			box->target = "_parent";
+			ext->target = "_parent";
 		else if (dom_string_caseless_lwc_isequal(s,
 				corestring_lwc__self))
 			/* the default may have been overridden by a
 			 * <base target=...>, so this is different to 0 */
-			box->target = "_self";
+			ext->target = "_self";
 		else {
 			/* 6.16 says that frame names must begin with [a-zA-Z]
 			 * This doesn't match reality, so just take anything */
-			box->target = talloc_strdup(content->bctx,
+			ext->target = arena_strdup(content->box_arena,
 					dom_string_data(s));
-			if (!box->target) {
+			if (!ext->target) {
 				dom_string_unref(s);
 				return false;
 			}
@@ -857,6 +895,7 @@ box_embed(dom_node *n,
 	  bool *convert_children)
 {
 	struct object_params *params;
+	struct box_extension *ext;
 	struct object_param *param;
 	dom_namednodemap *attrs;
 	unsigned long idx;
@@ -973,7 +1012,10 @@ box_embed(dom_node *n,
 
 	dom_namednodemap_unref(attrs);
 
-	box->object_params = params;
+	ext = box_extend(box, content->box_arena);
+	if (ext == NULL)
+		return false;
+	ext->object_params = params;
 
 	/* start fetch */
 	box->flags |= IS_REPLACED;
@@ -1065,6 +1107,12 @@ box_iframe(dom_node *n,
 		return true;
 	}
 
+	/* the iframe's browser window is kept in the box extension */
+	if (box_extend(box, content->box_arena) == NULL) {
+		nsurl_unref(url);
+		return false;
+	}
+
 	/* create a new iframe */
 	iframe = talloc(content->bctx, struct content_html_iframe);
 	if (iframe == NULL) {
@@ -1175,7 +1223,7 @@ box_image(dom_node *n,
 		dom_string_unref(s);
 		if (alt == NULL)
 			return false;
-		box->text = talloc_strdup(content->bctx, alt);
+		box->text = arena_strdup(content->box_arena, alt);
 		free(alt);
 		if (box->text == NULL)
 			return false;
@@ -1187,10 +1235,8 @@ box_image(dom_node *n,
 	}
 
 	/* imagemap associated with this image */
-	if (!box_get_attribute(n, "usemap", content->bctx, &box->usemap))
+	if (!box_get_usemap(n, content, box))
 		return false;
-	if (box->usemap && box->usemap[0] == '#')
-		box->usemap++;
 
 	/* get image URL */
 	err = dom_element_get_attribute(n, corestring_dom_src, &s);
@@ -1293,30 +1339,30 @@ box_input(dom_node *n,
 			goto no_memory;
 
 		inline_container = box_create(NULL, 0, false, 0, 0, 0, 0,
-				content->bctx);
+				content->box_arena);
 		if (inline_container == NULL)
 			goto no_memory;
 
 		inline_container->type = BOX_INLINE_CONTAINER;
 
 		inline_box = box_create(NULL, box->style, false, 0, 0,
-				box->title, 0, content->bctx);
+				box->ext->title, 0, content->box_arena);
 		if (inline_box == NULL)
 			goto no_memory;
 
 		inline_box->type = BOX_TEXT;
 
 		if (box->gadget->value != NULL)
-			inline_box->text = talloc_strdup(content->bctx,
+			inline_box->text = arena_strdup(content->box_arena,
 					box->gadget->value);
 		else if (box->gadget->type == GADGET_SUBMIT)
-			inline_box->text = talloc_strdup(content->bctx,
+			inline_box->text = arena_strdup(content->box_arena,
 					messages_get("Form_Submit"));
 		else if (box->gadget->type == GADGET_RESET)
-			inline_box->text = talloc_strdup(content->bctx,
+			inline_box->text = arena_strdup(content->box_arena,
 					messages_get("Form_Reset"));
 		else
-			inline_box->text = talloc_strdup(content->bctx,
+			inline_box->text = arena_strdup(content->box_arena,
 							 "Button");
 
 		if (inline_box->text == NULL)
@@ -1409,6 +1455,7 @@ box_object(dom_node *n,
 	   bool *convert_children)
 {
 	struct object_params *params;
+	struct box_extension *ext;
 	struct object_param *param;
 	dom_string *codebase, *classid, *data;
 	dom_node *c;
@@ -1418,11 +1465,8 @@ box_object(dom_node *n,
 			box_is_root(n)) == CSS_DISPLAY_NONE)
 		return true;
 
-	if (box_get_attribute(n, "usemap", content->bctx, &box->usemap) ==
-			false)
+	if (box_get_usemap(n, content, box) == false)
 		return false;
-	if (box->usemap && box->usemap[0] == '#')
-		box->usemap++;
 
 	params = talloc(content->bctx, struct object_params);
 	if (params == NULL)
@@ -1626,7 +1670,10 @@ box_object(dom_node *n,
 		c = next;
 	}
 
-	box->object_params = params;
+	ext = box_extend(box, content->box_arena);
+	if (ext == NULL)
+		return false;
+	ext->object_params = params;
 
 	/* start fetch (MIME type is ok or not specified) */
 	box->flags |= IS_REPLACED;
@@ -1776,12 +1823,12 @@ box_select(dom_node *n,
 	box->flags |= IS_REPLACED;
 	gadget->box = box;
 
-	inline_container = box_create(NULL, 0, false, 0, 0, 0, 0, content->bctx);
+	inline_container = box_create(NULL, 0, false, 0, 0, 0, 0, content->box_arena);
 	if (inline_container == NULL)
 		goto no_memory;
 	inline_container->type = BOX_INLINE_CONTAINER;
-	inline_box = box_create(NULL, box->style, false, 0, 0, box->title, 0,
-			content->bctx);
+	inline_box = box_create(NULL, box->style, false, 0, 0,
+			box->ext->title, 0, content->box_arena);
 	if (inline_box == NULL)
 		goto no_memory;
 	inline_box->type = BOX_TEXT;
@@ -1799,13 +1846,13 @@ box_select(dom_node *n,
 	}
 
 	if (gadget->data.select.num_selected == 0)
-		inline_box->text = talloc_strdup(content->bctx,
+		inline_box->text = arena_strdup(content->box_arena,
 				messages_get("Form_None"));
 	else if (gadget->data.select.num_selected == 1)
-		inline_box->text = talloc_strdup(content->bctx,
+		inline_box->text = arena_strdup(content->box_arena,
 				gadget->data.select.current->text);
 	else
-		inline_box->text = talloc_strdup(content->bctx,
+		inline_box->text = arena_strdup(content->box_arena,
 				messages_get("Form_Many"));
 	if (inline_box->text == NULL)
 		goto no_memory;
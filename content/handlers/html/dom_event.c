@@ -32,6 +32,7 @@
 #include "utils/string.h"
 #include "utils/nsurl.h"
 #include "content/content.h"
+#include "content/fetch.h"
 #include "javascript/js.h"
 
 #include "netsurf/bitmap.h"
@@ -199,6 +200,14 @@ static bool html_process_inserted_link(html_content *c, dom_node *node)
 		return false;
 	}
 
+	/* Speculatively warm connections to hosts the document will use */
+	if (strcasestr(lwc_string_data(link.rel), "preconnect") != NULL) {
+		(void)fetch_preconnect(link.href, false);
+	} else if (strcasestr(lwc_string_data(link.rel),
+			      "dns-prefetch") != NULL) {
+		(void)fetch_preconnect(link.href, true);
+	}
+
 	/* look for optional properties -- we don't care if internment fails */
 
 	exc = dom_element_get_attribute(node,
@@ -22,12 +22,573 @@
  * HTML internal font handling implementation.
  */
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/errors.h"
+#include "utils/log.h"
 #include "utils/nsoption.h"
 #include "netsurf/plot_style.h"
+#include "netsurf/layout.h"
 #include "css/utils.h"
 
+#include "desktop/gui_internal.h"
+
 #include "html/font.h"
 
+/** Number of hash chains in the text measurement cache. */
+#define FONT_CACHE_BUCKETS 4096
+
+/** Maximum number of measurements held before the cache is flushed. */
+#define FONT_CACHE_MAX_ENTRIES 16384
+
+/** Maximum number of distinct font styles held by the cache. */
+#define FONT_CACHE_MAX_STYLES 256
+
+/** Longest text run, in bytes, that will be memoised. */
+#define FONT_CACHE_MAX_LENGTH 256
+
+/** Marker for split measurement value meaning a plain width measurement. */
+#define FONT_CACHE_WIDTH_ONLY -1
+
+/**
+ * Font style as seen by the text measurement cache.
+ *
+ * Only the parts of a plot style which alter glyph metrics are
+ * recorded; colours are ignored.
+ */
+struct font_cache_style {
+	struct font_cache_style *next; /**< next style in list */
+
+	lwc_string **families; /**< referenced copy of families or NULL */
+	plot_font_generic_family_t family; /**< generic family */
+	plot_style_fixed size; /**< font size */
+	int weight; /**< font weight */
+	plot_font_flags_t flags; /**< font flags */
+
+	/** advance of each single ASCII character, -1 when not measured */
+	int ascii_width[128];
+};
+
+/**
+ * Memoised text measurement.
+ */
+struct font_cache_entry {
+	struct font_cache_entry *next; /**< next entry in hash chain */
+	const struct font_cache_style *style; /**< style of measurement */
+	uint32_t hash; /**< full hash of style and text */
+	int x; /**< split width or FONT_CACHE_WIDTH_ONLY */
+	int width; /**< measured width or actual_x of split */
+	size_t offset; /**< split offset */
+	size_t length; /**< length of text */
+	char text[]; /**< measured text */
+};
+
+/** Number of font family name options. */
+#define FONT_CACHE_FAMILY_OPTIONS 5
+
+/**
+ * Font options the memoised measurements were taken with.
+ *
+ * The frontends map plot styles to glyphs using these, so a change to
+ * any of them invalidates every memoised width.
+ */
+struct font_cache_options {
+	bool valid; /**< options have been recorded */
+	int size; /**< font_size option */
+	int min_size; /**< font_min_size option */
+	int deflt; /**< font_default option */
+	char *family[FONT_CACHE_FAMILY_OPTIONS]; /**< family name options */
+};
+
+/**
+ * Text measurement cache state.
+ */
+static struct font_cache {
+	struct font_cache_entry *chain[FONT_CACHE_BUCKETS];
+	struct font_cache_style *styles;
+	unsigned int entry_count;
+	unsigned int style_count;
+
+	struct font_cache_options options;
+
+	struct html_font_cache_stats stats;
+} font_cache;
+
+/**
+ * Compare a plot style with a cached font style.
+ */
+static bool
+font_cache_style_match(const struct font_cache_style *cs,
+		       const plot_font_style_t *fstyle)
+{
+	lwc_string * const *a;
+	lwc_string * const *b;
+
+	if ((cs->family != fstyle->family) ||
+	    (cs->size != fstyle->size) ||
+	    (cs->weight != fstyle->weight) ||
+	    (cs->flags != fstyle->flags)) {
+		return false;
+	}
+
+	a = cs->families;
+	b = fstyle->families;
+	if ((a == NULL) || (b == NULL)) {
+		return ((a == NULL || *a == NULL) && (b == NULL || *b == NULL));
+	}
+
+	/* family names are interned so pointer comparison is sufficient */
+	while ((*a != NULL) && (*a == *b)) {
+		a++;
+		b++;
+	}
+
+	return (*a == *b);
+}
+
+/**
+ * Find or create the cache style for a plot style.
+ *
+ * \param fstyle The plot style to find.
+ * \return The cache style or NULL on memory exhaustion.
+ */
+static struct font_cache_style *
+font_cache_style_get(const plot_font_style_t *fstyle)
+{
+	struct font_cache_style *cs;
+	unsigned int count = 0;
+	unsigned int idx;
+
+	for (cs = font_cache.styles; cs != NULL; cs = cs->next) {
+		if (font_cache_style_match(cs, fstyle)) {
+			return cs;
+		}
+	}
+
+	if (font_cache.style_count >= FONT_CACHE_MAX_STYLES) {
+		html_font_cache_flush();
+	}
+
+	cs = malloc(sizeof(*cs));
+	if (cs == NULL) {
+		return NULL;
+	}
+
+	cs->families = NULL;
+	if (fstyle->families != NULL) {
+		while (fstyle->families[count] != NULL) {
+			count++;
+		}
+		if (count > 0) {
+			cs->families = malloc((count + 1) * sizeof(lwc_string *));
+			if (cs->families == NULL) {
+				free(cs);
+				return NULL;
+			}
+			for (idx = 0; idx < count; idx++) {
+				cs->families[idx] =
+					lwc_string_ref(fstyle->families[idx]);
+			}
+			cs->families[count] = NULL;
+		}
+	}
+	cs->family = fstyle->family;
+	cs->size = fstyle->size;
+	cs->weight = fstyle->weight;
+	cs->flags = fstyle->flags;
+	for (idx = 0; idx < 128; idx++) {
+		cs->ascii_width[idx] = -1;
+	}
+
+	cs->next = font_cache.styles;
+	font_cache.styles = cs;
+	font_cache.style_count++;
+
+	return cs;
+}
+
+/**
+ * Hash a measurement key.
+ *
+ * Fowler Noll Vo over the text seeded with the style identity and
+ * split width.
+ */
+static inline uint32_t
+font_cache_hash(const struct font_cache_style *cs,
+		const char *string,
+		size_t length,
+		int x)
+{
+	uint32_t z = 0x811c9dc5;
+	uintptr_t sid = (uintptr_t)cs;
+
+	z = (z ^ (uint32_t)(sid >> 4)) * 0x01000193;
+	z = (z ^ (uint32_t)x) * 0x01000193;
+	while (length-- > 0) {
+		z = (z ^ (uint8_t)*string++) * 0x01000193;
+	}
+
+	return z;
+}
+
+/**
+ * Look up a measurement in the cache.
+ */
+static struct font_cache_entry *
+font_cache_find(const struct font_cache_style *cs,
+		uint32_t hash,
+		const char *string,
+		size_t length,
+		int x)
+{
+	struct font_cache_entry *entry;
+
+	entry = font_cache.chain[hash % FONT_CACHE_BUCKETS];
+	while (entry != NULL) {
+		if ((entry->hash == hash) &&
+		    (entry->style == cs) &&
+		    (entry->x == x) &&
+		    (entry->length == length) &&
+		    (memcmp(entry->text, string, length) == 0)) {
+			return entry;
+		}
+		entry = entry->next;
+	}
+
+	return NULL;
+}
+
+/**
+ * Record a measurement in the cache.
+ *
+ * Failure to allocate is not an error, the measurement is simply not
+ * memoised.
+ */
+static void
+font_cache_insert(const struct font_cache_style *cs,
+		  uint32_t hash,
+		  const char *string,
+		  size_t length,
+		  int x,
+		  int width,
+		  size_t offset)
+{
+	struct font_cache_entry *entry;
+	unsigned int bucket = hash % FONT_CACHE_BUCKETS;
+
+	if (font_cache.entry_count >= FONT_CACHE_MAX_ENTRIES) {
+		/* the style may be freed by the flush so do not cache */
+		html_font_cache_flush();
+		return;
+	}
+
+	entry = malloc(sizeof(*entry) + length);
+	if (entry == NULL) {
+		return;
+	}
+
+	entry->style = cs;
+	entry->hash = hash;
+	entry->x = x;
+	entry->width = width;
+	entry->offset = offset;
+	entry->length = length;
+	memcpy(entry->text, string, length);
+
+	entry->next = font_cache.chain[bucket];
+	font_cache.chain[bucket] = entry;
+	font_cache.entry_count++;
+}
+
+/**
+ * Measure the width of a string through the text measurement cache.
+ *
+ * Implements gui_layout_table::width
+ */
+static nserror
+html_font_cache_width(const plot_font_style_t *fstyle,
+		      const char *string,
+		      size_t length,
+		      int *width)
+{
+	struct font_cache_style *cs;
+	struct font_cache_entry *entry;
+	uint32_t hash;
+	nserror res;
+
+	if ((length == 0) || (length > FONT_CACHE_MAX_LENGTH)) {
+		font_cache.stats.bypass++;
+		return guit->layout->width(fstyle, string, length, width);
+	}
+
+	cs = font_cache_style_get(fstyle);
+	if (cs == NULL) {
+		font_cache.stats.bypass++;
+		return guit->layout->width(fstyle, string, length, width);
+	}
+
+	/* single ASCII characters (mostly spaces) use the advance table */
+	if ((length == 1) && ((uint8_t)string[0] < 128)) {
+		int *advance = &cs->ascii_width[(uint8_t)string[0]];
+		if (*advance >= 0) {
+			font_cache.stats.ascii_hit++;
+			*width = *advance;
+			return NSERROR_OK;
+		}
+		font_cache.stats.miss++;
+		res = guit->layout->width(fstyle, string, length, width);
+		if (res == NSERROR_OK) {
+			*advance = *width;
+		}
+		return res;
+	}
+
+	hash = font_cache_hash(cs, string, length, FONT_CACHE_WIDTH_ONLY);
+	entry = font_cache_find(cs, hash, string, length,
+				FONT_CACHE_WIDTH_ONLY);
+	if (entry != NULL) {
+		font_cache.stats.hit++;
+		*width = entry->width;
+		return NSERROR_OK;
+	}
+
+	font_cache.stats.miss++;
+	res = guit->layout->width(fstyle, string, length, width);
+	if (res == NSERROR_OK) {
+		font_cache_insert(cs, hash, string, length,
+				  FONT_CACHE_WIDTH_ONLY, *width, length);
+	}
+
+	return res;
+}
+
+/**
+ * Find a character position through the frontend.
+ *
+ * Positions are only requested in response to user interaction so
+ * they are not memoised.
+ *
+ * Implements gui_layout_table::position
+ */
+static nserror
+html_font_cache_position(const plot_font_style_t *fstyle,
+			 const char *string,
+			 size_t length,
+			 int x,
+			 size_t *char_offset,
+			 int *actual_x)
+{
+	return guit->layout->position(fstyle, string, length, x,
+				      char_offset, actual_x);
+}
+
+/**
+ * Find a split point through the text measurement cache.
+ *
+ * Implements gui_layout_table::split
+ */
+static nserror
+html_font_cache_split(const plot_font_style_t *fstyle,
+		      const char *string,
+		      size_t length,
+		      int x,
+		      size_t *char_offset,
+		      int *actual_x)
+{
+	struct font_cache_style *cs;
+	struct font_cache_entry *entry;
+	uint32_t hash;
+	nserror res;
+
+	if ((length == 0) || (length > FONT_CACHE_MAX_LENGTH) || (x < 0)) {
+		font_cache.stats.bypass++;
+		return guit->layout->split(fstyle, string, length, x,
+					   char_offset, actual_x);
+	}
+
+	cs = font_cache_style_get(fstyle);
+	if (cs == NULL) {
+		font_cache.stats.bypass++;
+		return guit->layout->split(fstyle, string, length, x,
+					   char_offset, actual_x);
+	}
+
+	hash = font_cache_hash(cs, string, length, x);
+	entry = font_cache_find(cs, hash, string, length, x);
+	if (entry != NULL) {
+		font_cache.stats.hit++;
+		*char_offset = entry->offset;
+		*actual_x = entry->width;
+		return NSERROR_OK;
+	}
+
+	font_cache.stats.miss++;
+	res = guit->layout->split(fstyle, string, length, x,
+				  char_offset, actual_x);
+	if (res == NSERROR_OK) {
+		font_cache_insert(cs, hash, string, length,
+				  x, *actual_x, *char_offset);
+	}
+
+	return res;
+}
+
+/* exported interface documented in html/font.h */
+const struct gui_layout_table html_font_cache_layout_table = {
+	.width = html_font_cache_width,
+	.position = html_font_cache_position,
+	.split = html_font_cache_split,
+};
+
+/**
+ * Get the current family name options.
+ *
+ * \param family Updated with the family name options, entries may be NULL.
+ */
+static void font_cache_family_options(const char **family)
+{
+	family[0] = nsoption_charp(font_sans);
+	family[1] = nsoption_charp(font_serif);
+	family[2] = nsoption_charp(font_mono);
+	family[3] = nsoption_charp(font_cursive);
+	family[4] = nsoption_charp(font_fantasy);
+}
+
+/**
+ * Check whether the font options differ from those recorded.
+ *
+ * \return true if the options have changed or were not recorded.
+ */
+static bool font_cache_options_changed(void)
+{
+	const struct font_cache_options *opts = &font_cache.options;
+	const char *family[FONT_CACHE_FAMILY_OPTIONS];
+	unsigned int idx;
+
+	if ((opts->valid == false) ||
+	    (opts->size != nsoption_int(font_size)) ||
+	    (opts->min_size != nsoption_int(font_min_size)) ||
+	    (opts->deflt != nsoption_int(font_default))) {
+		return true;
+	}
+
+	font_cache_family_options(family);
+	for (idx = 0; idx < FONT_CACHE_FAMILY_OPTIONS; idx++) {
+		if ((opts->family[idx] == NULL) || (family[idx] == NULL)) {
+			if (opts->family[idx] != family[idx]) {
+				return true;
+			}
+		} else if (strcmp(opts->family[idx], family[idx]) != 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Discard the recorded font options.
+ */
+static void font_cache_options_release(void)
+{
+	struct font_cache_options *opts = &font_cache.options;
+	unsigned int idx;
+
+	for (idx = 0; idx < FONT_CACHE_FAMILY_OPTIONS; idx++) {
+		free(opts->family[idx]);
+		opts->family[idx] = NULL;
+	}
+	opts->valid = false;
+}
+
+/**
+ * Record the current font options.
+ *
+ * If any family name cannot be copied the options are left unrecorded
+ * so the next check flushes the cache again.
+ */
+static void font_cache_options_record(void)
+{
+	struct font_cache_options *opts = &font_cache.options;
+	const char *family[FONT_CACHE_FAMILY_OPTIONS];
+	unsigned int idx;
+
+	font_cache_options_release();
+
+	font_cache_family_options(family);
+	for (idx = 0; idx < FONT_CACHE_FAMILY_OPTIONS; idx++) {
+		if (family[idx] != NULL) {
+			opts->family[idx] = strdup(family[idx]);
+			if (opts->family[idx] == NULL) {
+				font_cache_options_release();
+				return;
+			}
+		}
+	}
+	opts->size = nsoption_int(font_size);
+	opts->min_size = nsoption_int(font_min_size);
+	opts->deflt = nsoption_int(font_default);
+	opts->valid = true;
+}
+
+/* exported interface documented in html/font.h */
+void html_font_cache_check_options(void)
+{
+	if (font_cache_options_changed()) {
+		html_font_cache_flush();
+		font_cache_options_record();
+	}
+}
+
+/* exported interface documented in html/font.h */
+void html_font_cache_flush(void)
+{
+	struct font_cache_entry *entry;
+	struct font_cache_style *cs;
+	unsigned int bucket;
+	lwc_string **family;
+
+	/* measurements may be taken before the options are checked again */
+	font_cache_options_release();
+
+	for (bucket = 0; bucket < FONT_CACHE_BUCKETS; bucket++) {
+		while (font_cache.chain[bucket] != NULL) {
+			entry = font_cache.chain[bucket];
+			font_cache.chain[bucket] = entry->next;
+			free(entry);
+		}
+	}
+
+	while (font_cache.styles != NULL) {
+		cs = font_cache.styles;
+		font_cache.styles = cs->next;
+		if (cs->families != NULL) {
+			for (family = cs->families; *family != NULL; family++) {
+				lwc_string_unref(*family);
+			}
+			free(cs->families);
+		}
+		free(cs);
+	}
+
+	if (font_cache.entry_count > 0) {
+		font_cache.stats.flush++;
+	}
+	font_cache.entry_count = 0;
+	font_cache.style_count = 0;
+}
+
+/* exported interface documented in html/font.h */
+void html_font_cache_get_stats(struct html_font_cache_stats *stats)
+{
+	*stats = font_cache.stats;
+	stats->entries = font_cache.entry_count;
+	stats->styles = font_cache.style_count;
+}
+
 /**
  * Map a generic CSS font family to a generic plot font family
  *
@@ -28,6 +28,53 @@
 #define NETSURF_HTML_FONT_H
 
 struct plot_font_style;
+struct gui_layout_table;
+
+/**
+ * Text measurement cache statistics
+ */
+struct html_font_cache_stats {
+	unsigned int entries; /**< number of memoised measurements */
+	unsigned int styles; /**< number of distinct font styles */
+	unsigned long hit; /**< measurements answered from the hash */
+	unsigned long ascii_hit; /**< measurements from the advance tables */
+	unsigned long miss; /**< measurements passed to the frontend */
+	unsigned long bypass; /**< measurements too long to memoise */
+	unsigned long flush; /**< number of times the cache was emptied */
+};
+
+/**
+ * Memoising layout table.
+ *
+ * Wraps the frontend layout table, remembering the width and split
+ * results for each font style and text run so repeated measurement
+ * during minmax, layout and reflow does not reach the frontend.
+ */
+extern const struct gui_layout_table html_font_cache_layout_table;
+
+/**
+ * Discard all memoised text measurements.
+ *
+ * Must be called if the frontend changes how font styles are mapped
+ * to glyphs, as cached widths would otherwise be stale.
+ */
+void html_font_cache_flush(void);
+
+/**
+ * Discard memoised text measurements if the font options have changed.
+ *
+ * The font family and size options alter how the frontend maps font
+ * styles to glyphs. Called before each layout so measurements taken
+ * with previous options are not reused.
+ */
+void html_font_cache_check_options(void);
+
+/**
+ * Get the text measurement cache statistics.
+ *
+ * \param stats Structure to fill with the current statistics.
+ */
+void html_font_cache_get_stats(struct html_font_cache_stats *stats);
 
 /**
  * Populate a font style using data from a computed CSS style
@@ -36,7 +36,7 @@
 #include "utils/corestrings.h"
 #include "utils/log.h"
 #include "utils/messages.h"
-#include "utils/talloc.h"
+#include "utils/arena.h"
 #include "utils/url.h"
 #include "utils/utf8.h"
 #include "utils/ascii.h"
@@ -1362,17 +1362,17 @@ form__select_process_selection(html_content *html,
 		}
 	}
 
-	talloc_free(inline_box->text);
+	/* the previous text is released along with the box tree */
 	inline_box->text = 0;
 
 	if (control->data.select.num_selected == 0) {
-		inline_box->text = talloc_strdup(html->bctx,
+		inline_box->text = arena_strdup(html->box_arena,
 				messages_get("Form_None"));
 	} else if (control->data.select.num_selected == 1) {
-		inline_box->text = talloc_strdup(html->bctx,
+		inline_box->text = arena_strdup(html->box_arena,
 				control->data.select.current->text);
 	} else {
-		inline_box->text = talloc_strdup(html->bctx,
+		inline_box->text = arena_strdup(html->box_arena,
 				messages_get("Form_Many"));
 	}
 
@@ -27,6 +27,7 @@
 #include <string.h>
 #include <strings.h>
 #include <stdlib.h>
+#include <time.h>
 #include <nsutils/time.h>
 
 #include "utils/utils.h"
@@ -37,10 +38,13 @@
 #include "utils/log.h"
 #include "utils/messages.h"
 #include "utils/talloc.h"
+#include "utils/arena.h"
 #include "utils/utf8.h"
 #include "utils/nsoption.h"
 #include "utils/string.h"
 #include "utils/ascii.h"
+#include "utils/ring.h"
+#include "netsurf/inttypes.h"
 #include "netsurf/content.h"
 #include "netsurf/browser_window.h"
 #include "netsurf/utf8.h"
@@ -61,6 +65,7 @@
 #include "html/private.h"
 #include "html/dom_event.h"
 #include "html/css.h"
+#include "html/font.h"
 #include "html/object.h"
 #include "html/html_save.h"
 #include "html/interaction.h"
@@ -85,6 +90,9 @@ static const char *html_types[] = {
 	"text/html"
 };
 
+/** Ring of live HTML documents, for performance reporting */
+static html_content *html_contents = NULL;
+
 /**
  * Fire an event at the DOM
  *
@@ -218,11 +226,15 @@ static void html_box_convert_done(html_content *c, bool success)
 	nserror err;
 	dom_exception exc; /* returned by libdom functions */
 	dom_node *html;
+	uint64_t ms_now;
 
 	NSLOG(netsurf, INFO, "DOM to box conversion complete (content %p)", c);
 
 	c->box_conversion_context = NULL;
 
+	nsu_getmonotonic_ms(&ms_now);
+	c->perf.box_convert_ms = ms_now - c->box_convert_start;
+
 	/* Clean up and report error if unsuccessful or aborted */
 	if ((success == false) || (c->aborted)) {
 		html_object_free_objects(c);
@@ -401,6 +413,7 @@ void html_finish_conversion(html_content *htmlc)
 
 	html_get_dimensions(htmlc);
 
+	nsu_getmonotonic_ms(&htmlc->box_convert_start);
 	error = dom_to_box(html, htmlc, html_box_convert_done, &htmlc->box_conversion_context);
 	if (error != NSERROR_OK) {
 		NSLOG(netsurf, INFO, "box conversion failed");
@@ -474,6 +487,7 @@ html_create_html_data(html_content *c, const http_parameter *params)
 	c->reflowing = false;
 	c->title = NULL;
 	c->bctx = NULL;
+	c->box_arena = NULL;
 	c->layout = NULL;
 	c->background_colour = NS_TRANSPARENT;
 	c->stylesheet_count = 0;
@@ -489,7 +503,7 @@ html_create_html_data(html_content *c, const http_parameter *params)
 	c->frameset = NULL;
 	c->iframe = NULL;
 	c->page = NULL;
-	c->font_func = guit->layout;
+	c->font_func = &html_font_cache_layout_table;
 	c->drag_type = HTML_DRAG_NONE;
 	c->drag_owner.no_owner = true;
 	c->selection_type = HTML_SELECTION_NONE;
@@ -638,6 +652,8 @@ html_create(const content_handler *handler,
 		return error;
 	}
 
+	RING_INSERT(html_contents, html);
+
 	*c = (struct content *) html;
 
 	return NSERROR_OK;
@@ -1057,8 +1073,11 @@ static void html_reformat(struct content *c, int width, int height)
 	uint64_t ms_before;
 	uint64_t ms_after;
 	uint64_t ms_interval;
+	clock_t layout_start;
+	unsigned long layout_us;
 
 	nsu_getmonotonic_ms(&ms_before);
+	layout_start = clock();
 
 	htmlc->reflowing = true;
 
@@ -1068,6 +1087,8 @@ static void html_reformat(struct content *c, int width, int height)
 			INTTOFIX(height), htmlc->unit_len_ctx.device_dpi);
 	htmlc->unit_len_ctx.root_style = htmlc->layout->style;
 
+	htmlc->perf.layout_lines = 0;
+	html_font_cache_check_options();
 	layout_document(htmlc, width, height);
 	layout = htmlc->layout;
 
@@ -1090,6 +1111,12 @@ static void html_reformat(struct content *c, int width, int height)
 	htmlc->reflowing = false;
 	htmlc->had_initial_layout = true;
 
+	layout_us = (unsigned long)((double)(clock() - layout_start) *
+			1000000 / CLOCKS_PER_SEC);
+	htmlc->perf.layout_count++;
+	htmlc->perf.layout_time_us += layout_us;
+	htmlc->perf.layout_last_us = layout_us;
+
 	/* calculate next reflow time at three times what it took to reflow */
 	nsu_getmonotonic_ms(&ms_after);
 
@@ -1187,11 +1214,25 @@ static void html_destroy_iframe(struct content_html_iframe *iframe)
 
 static void html_free_layout(html_content *htmlc)
 {
-	if (htmlc->bctx != NULL) {
-		/* freeing talloc context should let the entire box
-		 * set be destroyed
+	size_t used, reserved, boxes;
+
+	if (htmlc->box_arena != NULL) {
+		arena_get_stats(htmlc->box_arena, &used, &reserved, &boxes);
+		NSLOG(netsurf, INFO,
+		      "content %p box tree %"PRIsizet" boxes of %"PRIsizet" bytes, %"PRIsizet" bytes allocated, %"PRIsizet" bytes peak",
+		      htmlc, boxes, sizeof(struct box), used, reserved);
+
+		/* destroying the arena releases the references held by
+		 * every box and returns the whole tree in one go
 		 */
+		arena_destroy(htmlc->box_arena);
+		htmlc->box_arena = NULL;
+		htmlc->layout = NULL;
+	}
+
+	if (htmlc->bctx != NULL) {
 		talloc_free(htmlc->bctx);
+		htmlc->bctx = NULL;
 	}
 }
 
@@ -1206,6 +1247,8 @@ static void html_destroy(struct content *c)
 
 	NSLOG(netsurf, INFO, "content %p", c);
 
+	RING_REMOVE(html_contents, html);
+
 	/* If we're still converting a layout, cancel it */
 	if (html->box_conversion_context != NULL) {
 		if (cancel_dom_to_box(html->box_conversion_context) != NSERROR_OK) {
@@ -1471,9 +1514,9 @@ html_get_contextual_content(struct content *c, int x, int y,
 			continue;
 		}
 
-		if (box->iframe) {
-			float scale = browser_window_get_scale(box->iframe);
-			browser_window_get_features(box->iframe,
+		if (box->ext->iframe) {
+			float scale = browser_window_get_scale(box->ext->iframe);
+			browser_window_get_features(box->ext->iframe,
 						    (x - box_x) * scale,
 						    (y - box_y) * scale,
 						    data);
@@ -1486,12 +1529,12 @@ html_get_contextual_content(struct content *c, int x, int y,
 		if (box->object)
 			data->object = box->object;
 
-		if (box->href)
-			data->link = box->href;
+		if (box->ext->href)
+			data->link = box->ext->href;
 
-		if (box->usemap) {
+		if (box->ext->usemap) {
 			const char *target = NULL;
-			nsurl *url = imagemap_get(html, box->usemap, box_x,
+			nsurl *url = imagemap_get(html, box->ext->usemap, box_x,
 					box_y, x, y, &target);
 			/* Box might have imagemap, but no actual link area
 			 * at point */
@@ -1551,10 +1594,10 @@ html_scroll_at_point(struct content *c, int x, int y, int scrx, int scry)
 			continue;
 
 		/* Pass into iframe */
-		if (box->iframe) {
-			float scale = browser_window_get_scale(box->iframe);
+		if (box->ext->iframe) {
+			float scale = browser_window_get_scale(box->ext->iframe);
 
-			if (browser_window_scroll_at_point(box->iframe,
+			if (browser_window_scroll_at_point(box->ext->iframe,
 							   (x - box_x) * scale,
 							   (y - box_y) * scale,
 							   scrx, scry) == true)
@@ -1576,10 +1619,12 @@ html_scroll_at_point(struct content *c, int x, int y, int scrx, int scry)
 			return true;
 
 		/* Handle box scrollbars */
-		if (box->scroll_y && scrollbar_scroll(box->scroll_y, scry))
+		if (box->ext->scroll_y &&
+		    scrollbar_scroll(box->ext->scroll_y, scry))
 			handled_scroll = true;
 
-		if (box->scroll_x && scrollbar_scroll(box->scroll_x, scrx))
+		if (box->ext->scroll_x &&
+		    scrollbar_scroll(box->ext->scroll_x, scrx))
 			handled_scroll = true;
 
 		if (handled_scroll == true)
@@ -1699,10 +1744,10 @@ static bool html_drop_file_at_point(struct content *c, int x, int y, char *file)
 		    css_computed_visibility(box->style) == CSS_VISIBILITY_HIDDEN)
 			continue;
 
-		if (box->iframe) {
-			float scale = browser_window_get_scale(box->iframe);
+		if (box->ext->iframe) {
+			float scale = browser_window_get_scale(box->ext->iframe);
 			return browser_window_drop_file_at_point(
-				box->iframe,
+				box->ext->iframe,
 				(x - box_x) * scale,
 				(y - box_y) * scale,
 				file);
@@ -2061,6 +2106,26 @@ const char *html_get_base_target(hlcache_handle *h)
 }
 
 
+/* exported function documented in html/html.h */
+bool html_can_park(hlcache_handle *h)
+{
+	html_content *c = (html_content *) hlcache_handle_get_content(h);
+
+	assert(c != NULL);
+
+	if (content_get_status(h) != CONTENT_STATUS_DONE) {
+		return false;
+	}
+
+	/* Closing the document closes its javascript thread for good */
+	if (c->jsthread != NULL) {
+		return false;
+	}
+
+	return c->frameset == NULL;
+}
+
+
 /**
  * Retrieve layout coordinates of box with given id
  *
@@ -2087,6 +2152,52 @@ bool html_get_id_offset(hlcache_handle *h, lwc_string *frag_id, int *x, int *y)
 	return false;
 }
 
+/**
+ * Fill in the performance counters of a HTML document
+ *
+ * \param htmlc The HTML content to inspect.
+ * \param stats Updated with the performance counters.
+ */
+static void
+html_fill_perf_stats(html_content *htmlc, struct html_perf_stats *stats)
+{
+	*stats = htmlc->perf;
+	stats->box_tree_size = 0;
+	stats->box_count = 0;
+	if (htmlc->box_arena != NULL) {
+		arena_get_stats(htmlc->box_arena,
+				NULL,
+				&stats->box_tree_size,
+				&stats->box_count);
+	}
+}
+
+/* exported function documented in html/html.h */
+void html_enumerate_perf_stats(html_perf_stats_cb cb, void *pw)
+{
+	struct html_perf_stats stats;
+
+	RING_ITERATE_START(html_content, html_contents, htmlc) {
+		html_fill_perf_stats(htmlc, &stats);
+		cb(content_get_url(&htmlc->base), &stats, pw);
+	} RING_ITERATE_END(html_contents, htmlc);
+}
+
+/* exported function documented in html/html.h */
+nserror html_get_perf_stats(hlcache_handle *h, struct html_perf_stats *stats)
+{
+	html_content *htmlc;
+
+	if (content_get_type(h) != CONTENT_HTML) {
+		return NSERROR_BAD_CONTENT;
+	}
+
+	htmlc = (html_content *)hlcache_handle_get_content(h);
+	html_fill_perf_stats(htmlc, stats);
+
+	return NSERROR_OK;
+}
+
 bool html_exec(struct content *c, const char *src, size_t srclen)
 {
 	html_content *htmlc = (html_content *)c;
@@ -2213,6 +2324,7 @@ static content_type html_content_type(void)
 
 static void html_fini(void)
 {
+	html_font_cache_flush();
 	html_css_fini();
 }
 
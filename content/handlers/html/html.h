@@ -27,6 +27,7 @@
 #define NETSURF_HTML_HTML_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "netsurf/types.h"
 #include "netsurf/content_type.h"
@@ -214,10 +215,69 @@ struct html_stylesheet *html_get_stylesheets(struct hlcache_handle *h,
 struct content_html_object *html_get_objects(struct hlcache_handle *h,
 		unsigned int *n);
 
+/**
+ * Determine if a document may be parked for back and forward navigation
+ *
+ * A parked document is closed and later reopened unchanged, which is only
+ * possible for complete documents without frames or a javascript thread.
+ *
+ * used by core browser
+ */
+bool html_can_park(struct hlcache_handle *h);
+
 /**
  * get the offset within the docuemnt of a fragment id
  */
 bool html_get_id_offset(struct hlcache_handle *h, lwc_string *frag_id,
 		int *x, int *y);
 
+/**
+ * Performance counters for a HTML document
+ *
+ * Box construction is spread over several scheduled callbacks so its
+ * elapsed time is measured; layout and redraw are measured as processor
+ * time.
+ */
+struct html_perf_stats {
+	unsigned long box_convert_ms; /**< Elapsed box tree construction */
+	size_t box_tree_size; /**< Memory reserved for the box tree */
+	size_t box_count; /**< Number of boxes in the box tree */
+	unsigned int layout_count; /**< Number of layouts performed */
+	unsigned long layout_time_us; /**< Total time spent in layout */
+	unsigned long layout_last_us; /**< Time taken by the last layout */
+	unsigned int layout_lines; /**< Lines placed by the last layout */
+	unsigned int redraw_count; /**< Number of redraws performed */
+	unsigned long redraw_time_us; /**< Total time spent in redraw */
+};
+
+/**
+ * Callback for html_enumerate_perf_stats()
+ *
+ * \param url The url of the document.
+ * \param stats The performance counters of the document.
+ * \param pw The context passed to html_enumerate_perf_stats().
+ */
+typedef void (*html_perf_stats_cb)(struct nsurl *url,
+		const struct html_perf_stats *stats, void *pw);
+
+/**
+ * Report the performance counters of every live HTML document
+ *
+ * used by about:perf
+ *
+ * \param cb The callback to call for each document.
+ * \param pw The context to pass to the callback.
+ */
+void html_enumerate_perf_stats(html_perf_stats_cb cb, void *pw);
+
+/**
+ * Get the performance counters of a HTML document
+ *
+ * \param h The HTML document to inspect.
+ * \param stats Updated with the performance counters of the document.
+ * \return NSERROR_OK on success or NSERROR_BAD_CONTENT if h is not HTML.
+ */
+nserror html_get_perf_stats(struct hlcache_handle *h,
+		struct html_perf_stats *stats);
+
 #endif
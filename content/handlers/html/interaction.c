@@ -85,7 +85,7 @@ static browser_pointer_shape get_pointer_shape(struct box *box, bool imagemap)
 
 	switch (cursor) {
 	case CSS_CURSOR_AUTO:
-		if (box->href || (box->gadget &&
+		if (box->ext->href || (box->gadget &&
 				(box->gadget->type == GADGET_IMAGE ||
 				box->gadget->type == GADGET_SUBMIT)) ||
 				imagemap) {
@@ -171,20 +171,20 @@ static void html_box_drag_start(struct box *box, int x, int y)
 
 	box_coords(box, &box_x, &box_y);
 
-	if (box->scroll_x != NULL) {
+	if (box->ext->scroll_x != NULL) {
 		scroll_mouse_x = x - box_x ;
 		scroll_mouse_y = y - (box_y + box->padding[TOP] +
 				box->height + box->padding[BOTTOM] -
 				SCROLLBAR_WIDTH);
-		scrollbar_start_content_drag(box->scroll_x,
+		scrollbar_start_content_drag(box->ext->scroll_x,
 				scroll_mouse_x, scroll_mouse_y);
-	} else if (box->scroll_y != NULL) {
+	} else if (box->ext->scroll_y != NULL) {
 		scroll_mouse_x = x - (box_x + box->padding[LEFT] +
 				box->width + box->padding[RIGHT] -
 				SCROLLBAR_WIDTH);
 		scroll_mouse_y = y - box_y;
 
-		scrollbar_start_content_drag(box->scroll_y,
+		scrollbar_start_content_drag(box->ext->scroll_y,
 				scroll_mouse_x, scroll_mouse_y);
 	}
 }
@@ -712,20 +712,20 @@ get_mouse_action_node(html_content *html,
 			}
 		}
 
-		if (box->iframe) {
-			man->iframe = box->iframe;
+		if (box->ext->iframe) {
+			man->iframe = box->ext->iframe;
 		}
 
-		if (box->href) {
-			man->link.url = box->href;
-			man->link.target = box->target;
+		if (box->ext->href) {
+			man->link.url = box->ext->href;
+			man->link.target = box->ext->target;
 			man->link.box = box;
 			man->link.is_imagemap = false;
 		}
 
-		if (box->usemap) {
+		if (box->ext->usemap) {
 			man->link.url = imagemap_get(html,
-						     box->usemap,
+						     box->ext->usemap,
 						     box_x,
 						     box_y,
 						     x, y,
@@ -744,14 +744,14 @@ get_mouse_action_node(html_content *html,
 			}
 		}
 
-		if (box->title) {
-			man->title = box->title;
+		if (box->ext->title) {
+			man->title = box->ext->title;
 		}
 
 		man->result.pointer = get_pointer_shape(box, false);
 
-		if ((box->scroll_x != NULL) ||
-		    (box->scroll_y != NULL)) {
+		if ((box->ext->scroll_x != NULL) ||
+		    (box->ext->scroll_y != NULL)) {
 			int padding_left;
 			int padding_right;
 			int padding_top;
@@ -762,11 +762,11 @@ get_mouse_action_node(html_content *html,
 			}
 
 			padding_left = box_x +
-					scrollbar_get_offset(box->scroll_x);
+					scrollbar_get_offset(box->ext->scroll_x);
 			padding_right = padding_left + box->padding[LEFT] +
 					box->width + box->padding[RIGHT];
 			padding_top = box_y +
-					scrollbar_get_offset(box->scroll_y);
+					scrollbar_get_offset(box->ext->scroll_y);
 			padding_bottom = padding_top + box->padding[TOP] +
 					box->height + box->padding[BOTTOM];
 
@@ -776,21 +776,21 @@ get_mouse_action_node(html_content *html,
 			    (y < padding_bottom)) {
 				/* mouse inside padding box */
 
-				if ((box->scroll_y != NULL) &&
+				if ((box->ext->scroll_y != NULL) &&
 				    (x > (padding_right - SCROLLBAR_WIDTH))) {
 					/* mouse above vertical box scroll */
 
-					man->scroll.bar = box->scroll_y;
+					man->scroll.bar = box->ext->scroll_y;
 					man->scroll.mouse_x = x - (padding_right - SCROLLBAR_WIDTH);
 					man->scroll.mouse_y = y - padding_top;
 					break;
 
-				} else if ((box->scroll_x != NULL) &&
+				} else if ((box->ext->scroll_x != NULL) &&
 					   (y > (padding_bottom -
 							SCROLLBAR_WIDTH))) {
 					/* mouse above horizontal box scroll */
 
-					man->scroll.bar = box->scroll_x;
+					man->scroll.bar = box->ext->scroll_x;
 					man->scroll.mouse_x = x - padding_left;
 					man->scroll.mouse_y = y - (padding_bottom - SCROLLBAR_WIDTH);
 					break;
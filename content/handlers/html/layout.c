@@ -44,7 +44,7 @@
 #include <dom/dom.h>
 
 #include "utils/log.h"
-#include "utils/talloc.h"
+#include "utils/arena.h"
 #include "utils/utils.h"
 #include "utils/nsoption.h"
 #include "utils/corestrings.h"
@@ -273,12 +273,13 @@ static void layout_minmax_table(struct box *table,
 	if (table->max_width != UNKNOWN_MAX_WIDTH)
 		return;
 
-	if (table_calculate_column_types(&content->unit_len_ctx, table) == false) {
+	if (table_calculate_column_types(&content->unit_len_ctx,
+			content->box_arena, table) == false) {
 		NSLOG(netsurf, ERROR,
 				"Could not establish table column types.");
 		return;
 	}
-	col = table->col;
+	col = table->ext->col;
 
 	/* start with 0 except for fixed-width columns */
 	for (i = 0; i != table->columns; i++) {
@@ -1654,7 +1655,7 @@ bool layout_table(
 		return false;
 	}
 
-	memcpy(col, table->col, sizeof(col[0]) * columns);
+	memcpy(col, table->ext->col, sizeof(col[0]) * columns);
 
 	/* find margins, paddings, and borders for table and cells */
 	layout_find_dimensions(&content->unit_len_ctx, available_width, -1, table,
@@ -2394,7 +2395,7 @@ layout_text_box_split(html_content *content,
 		space_width = 0;
 
 	/* Create clone of split_box, c2 */
-	c2 = talloc_memdup(content->bctx, split_box, sizeof *c2);
+	c2 = arena_memdup(content->box_arena, split_box, sizeof *c2);
 	if (!c2)
 		return false;
 	c2->flags |= CLONE;
@@ -2767,6 +2768,8 @@ layout_line(struct box *first,
 	      cx,
 	      cy);
 
+	content->perf.layout_lines++;
+
 	/* find sides at top of line */
 	x0 += cx;
 	x1 += cx;
@@ -3871,7 +3874,7 @@ bool layout_block_context(
 		}
 
 		/* Advance to next box. */
-		if (box->type == BOX_BLOCK && !box->object && !(box->iframe) &&
+		if (box->type == BOX_BLOCK && !box->object && !(box->ext->iframe) &&
 				box->children) {
 			/* Down into children. */
 
@@ -4362,7 +4365,7 @@ layout__set_numerical_marker_text(
 		LIST_MARKER_SIZE = 20,
 	};
 
-	marker->text = talloc_array(content->bctx, char, LIST_MARKER_SIZE);
+	marker->text = arena_alloc(content->box_arena, LIST_MARKER_SIZE);
 	if (marker->text == NULL) {
 		return;
 	}
@@ -4373,9 +4376,7 @@ layout__set_numerical_marker_text(
 		if (counter_len > LIST_MARKER_SIZE) {
 			/* Use computed size as marker did not fit in
 			 * default allocation. */
-			marker->text = talloc_realloc(content->bctx,
-					marker->text,
-					char,
+			marker->text = arena_alloc(content->box_arena,
 					counter_len);
 			if (marker->text == NULL) {
 				return;
@@ -5346,14 +5347,14 @@ static void layout_calculate_descendant_bboxes(
 			box->descendant_y1 = content_get_height(box->object);
 	}
 
-	if (box->iframe != NULL) {
+	if (box->ext->iframe != NULL) {
 		int x, y;
 		box_coords(box, &x, &y);
 
-		browser_window_set_position(box->iframe, x, y);
-		browser_window_set_dimensions(box->iframe,
+		browser_window_set_position(box->ext->iframe, x, y);
+		browser_window_set_dimensions(box->ext->iframe,
 				box->width, box->height);
-		browser_window_reformat(box->iframe, true,
+		browser_window_reformat(box->ext->iframe, true,
 				box->width, box->height);
 	}
 
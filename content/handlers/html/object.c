@@ -36,6 +36,7 @@
 #include "netsurf/content.h"
 #include "netsurf/misc.h"
 #include "content/hlcache.h"
+#include "content/fetch.h"
 #include "css/utils.h"
 #include "desktop/scrollbar.h"
 #include "desktop/gui_internal.h"
@@ -171,7 +172,7 @@ html_object_callback(hlcache_handle *object,
 		if (c->base.status != CONTENT_STATUS_LOADING && c->bw != NULL)
 			content_open(object,
 					c->bw, &c->base,
-					box->object_params);
+					box->ext->object_params);
 		break;
 
 	case CONTENT_MSG_READY:
@@ -377,11 +378,11 @@ html_object_callback(hlcache_handle *object,
 		break;
 
 	case CONTENT_MSG_SCROLL:
-		if (box->scroll_x != NULL)
-			scrollbar_set(box->scroll_x, event->data.scroll.x0,
+		if (box->ext->scroll_x != NULL)
+			scrollbar_set(box->ext->scroll_x, event->data.scroll.x0,
 					false);
-		if (box->scroll_y != NULL)
-			scrollbar_set(box->scroll_y, event->data.scroll.y0,
+		if (box->ext->scroll_y != NULL)
+			scrollbar_set(box->ext->scroll_y, event->data.scroll.y0,
 					false);
 		break;
 
@@ -550,7 +551,8 @@ static bool html_replace_object(struct content_html_object *object, nsurl *url)
 	}
 
 	/* initialise fetch */
-	error = hlcache_handle_retrieve(url, HLCACHE_RETRIEVE_SNIFF_TYPE,
+	error = hlcache_handle_retrieve(url, HLCACHE_RETRIEVE_SNIFF_TYPE |
+			LLCACHE_RETRIEVE_PRIORITY(FETCH_PRIORITY_IMAGE),
 			content_get_url(&c->base), NULL,
 			html_object_callback, object, &child,
 			object->permitted_types,
@@ -611,7 +613,7 @@ nserror html_object_open_objects(html_content *html, struct browser_window *bw)
 		content_open(object->content,
 			     bw,
 			     &html->base,
-			     object->box->object_params);
+			     object->box->ext->object_params);
 	}
 	return NSERROR_OK;
 }
@@ -716,6 +718,7 @@ html_fetch_object(html_content *c,
 	struct content_html_object *object;
 	hlcache_handle_callback object_callback;
 	hlcache_child_context child;
+	enum fetch_priority priority;
 	nserror error;
 
 	/* If we've already been aborted, don't bother attempting the fetch */
@@ -730,10 +733,15 @@ html_fetch_object(html_content *c,
 		return false;
 	}
 
+	/* objects without a box are speculative fetches which are
+	 * promoted when the box for the object is built
+	 */
 	if (box == NULL) {
 		object_callback = html_object_nobox_callback;
+		priority = FETCH_PRIORITY_PREFETCH;
 	} else {
 		object_callback = html_object_callback;
+		priority = FETCH_PRIORITY_IMAGE;
 	}
 
 	object->parent = (struct content *) c;
@@ -744,7 +752,8 @@ html_fetch_object(html_content *c,
 	object->background = background;
 
 	error = hlcache_handle_retrieve(url,
-					HLCACHE_RETRIEVE_SNIFF_TYPE,
+					HLCACHE_RETRIEVE_SNIFF_TYPE |
+					LLCACHE_RETRIEVE_PRIORITY(priority),
 					content_get_url(&c->base),
 					NULL,
 					object_callback,
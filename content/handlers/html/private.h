@@ -29,12 +29,14 @@
 #include "netsurf/types.h"
 #include "content/content_protected.h"
 #include "content/handlers/css/utils.h"
+#include "html/html.h"
 
 
 struct gui_layout_table;
 struct scrollbar_msg_data;
 struct content_redraw_data;
 struct selection;
+struct arena;
 
 typedef enum {
 	HTML_DRAG_NONE,			/** No drag */
@@ -130,8 +132,10 @@ typedef struct html_content {
 	/* Title element node */
 	dom_node *title;
 
-	/** A talloc context purely for the render box tree */
+	/** A talloc context for frame, iframe and object parameter data */
 	int *bctx;
+	/** Arena the render box tree is allocated from */
+	struct arena *box_arena;
 	/** A context pointer for the box conversion, NULL if no conversion
 	 * is in progress.
 	 */
@@ -210,6 +214,16 @@ typedef struct html_content {
 	 */
 	struct form_control *visible_select_menu;
 
+	/** Performance counters */
+	struct html_perf_stats perf;
+	/** Time box tree construction started */
+	uint64_t box_convert_start;
+
+	/** Previous document in ring of live documents */
+	struct html_content *r_prev;
+	/** Next document in ring of live documents */
+	struct html_content *r_next;
+
 } html_content;
 
 /**
@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 #include <dom/dom.h>
 
 #include "utils/log.h"
@@ -1192,9 +1193,9 @@ static bool html_redraw_box_children(const html_content *html, struct box *box,
 		if (c->type != BOX_FLOAT_LEFT && c->type != BOX_FLOAT_RIGHT)
 			if (!html_redraw_box(html, c,
 					x_parent + box->x -
-					scrollbar_get_offset(box->scroll_x),
+					scrollbar_get_offset(box->ext->scroll_x),
 					y_parent + box->y -
-					scrollbar_get_offset(box->scroll_y),
+					scrollbar_get_offset(box->ext->scroll_y),
 					clip, scale, current_background_color,
 					ctx))
 				return false;
@@ -1202,9 +1203,9 @@ static bool html_redraw_box_children(const html_content *html, struct box *box,
 	for (c = box->float_children; c; c = c->next_float)
 		if (!html_redraw_box(html, c,
 				x_parent + box->x -
-				scrollbar_get_offset(box->scroll_x),
+				scrollbar_get_offset(box->ext->scroll_x),
 				y_parent + box->y -
-				scrollbar_get_offset(box->scroll_y),
+				scrollbar_get_offset(box->ext->scroll_y),
 				clip, scale, current_background_color,
 				ctx))
 			return false;
@@ -1758,8 +1759,8 @@ bool html_redraw_box(const html_content *html, struct box *box,
 	if (box->object && width != 0 && height != 0) {
 		struct content_redraw_data obj_data;
 
-		x_scrolled = x - scrollbar_get_offset(box->scroll_x) * scale;
-		y_scrolled = y - scrollbar_get_offset(box->scroll_y) * scale;
+		x_scrolled = x - scrollbar_get_offset(box->ext->scroll_x) * scale;
+		y_scrolled = y - scrollbar_get_offset(box->ext->scroll_y) * scale;
 
 		obj_data.x = x_scrolled + padding_left;
 		obj_data.y = y_scrolled + padding_top;
@@ -1824,9 +1825,9 @@ bool html_redraw_box(const html_content *html, struct box *box,
 				      width, height, current_background_color,
 				      BITMAPF_NONE) != NSERROR_OK)
 			return false;
-	} else if (box->iframe) {
+	} else if (box->ext->iframe) {
 		/* Offset is passed to browser window redraw unscaled */
-		browser_window_redraw(box->iframe,
+		browser_window_redraw(box->ext->iframe,
 				x + padding_left,
 				y + padding_top, &r, ctx);
 
@@ -1873,9 +1874,9 @@ bool html_redraw_box(const html_content *html, struct box *box,
 	if (box->list_marker) {
 		if (!html_redraw_box(html, box->list_marker,
 				x_parent + box->x -
-				scrollbar_get_offset(box->scroll_x),
+				scrollbar_get_offset(box->ext->scroll_x),
 				y_parent + box->y -
-				scrollbar_get_offset(box->scroll_y),
+				scrollbar_get_offset(box->ext->scroll_y),
 				clip, scale, current_background_color, ctx))
 			return false;
 	}
@@ -1906,14 +1907,14 @@ bool html_redraw_box(const html_content *html, struct box *box,
 			return false;
 		}
 
-		if (box->scroll_x != NULL)
-			scrollbar_redraw(box->scroll_x,
+		if (box->ext->scroll_x != NULL)
+			scrollbar_redraw(box->ext->scroll_x,
 					x_parent + box->x,
 					y_parent + box->y + box->padding[TOP] +
 					box->height + box->padding[BOTTOM] -
 					SCROLLBAR_WIDTH, clip, scale, ctx);
-		if (box->scroll_y != NULL)
-			scrollbar_redraw(box->scroll_y,
+		if (box->ext->scroll_y != NULL)
+			scrollbar_redraw(box->ext->scroll_y,
 					x_parent + box->x + box->padding[LEFT] +
 					box->width + box->padding[RIGHT] -
 					SCROLLBAR_WIDTH,
@@ -1948,6 +1949,7 @@ bool html_redraw(struct content *c, struct content_redraw_data *data,
 	struct box *box;
 	bool result = true;
 	bool select, select_only;
+	clock_t redraw_start;
 	plot_style_t pstyle_fill_bg = {
 		.fill_type = PLOT_OP_TYPE_SOLID,
 		.fill_colour = data->background_colour,
@@ -1956,6 +1958,8 @@ bool html_redraw(struct content *c, struct content_redraw_data *data,
 	box = html->layout;
 	assert(box);
 
+	redraw_start = clock();
+
 	/* The select menu needs special treating because, when opened, it
 	 * reaches beyond its layout box.
 	 */
@@ -1996,6 +2000,10 @@ bool html_redraw(struct content *c, struct content_redraw_data *data,
 				data->scale, clip, ctx);
 	}
 
+	html->perf.redraw_count++;
+	html->perf.redraw_time_us += (unsigned long)
+		((double)(clock() - redraw_start) * 1000000 / CLOCKS_PER_SEC);
+
 	return result;
 
 }
@@ -386,6 +386,7 @@ exec_src_script(html_content *c,
 	nserror ns_error;
 	nsurl *joined;
 	hlcache_child_context child;
+	enum fetch_priority priority;
 	struct html_script *nscript;
 	bool async;
 	bool defer;
@@ -437,6 +438,7 @@ exec_src_script(html_content *c,
 		/* asyncronous script */
 		script_type = HTML_SCRIPT_ASYNC;
 		script_cb = convert_script_async_cb;
+		priority = FETCH_PRIORITY_DEFERRED;
 
 	} else {
 		exc = dom_element_has_attribute(node,
@@ -449,10 +451,12 @@ exec_src_script(html_content *c,
 			/* defered script */
 			script_type = HTML_SCRIPT_DEFER;
 			script_cb = convert_script_defer_cb;
+			priority = FETCH_PRIORITY_DEFERRED;
 		} else {
 			/* syncronous script */
 			script_type = HTML_SCRIPT_SYNC;
 			script_cb = convert_script_sync_cb;
+			priority = FETCH_PRIORITY_BLOCKING;
 		}
 	}
 
@@ -468,7 +472,7 @@ exec_src_script(html_content *c,
 	child.quirks = c->base.quirks;
 
 	ns_error = hlcache_handle_retrieve(joined,
-					   0,
+					   LLCACHE_RETRIEVE_PRIORITY(priority),
 					   content_get_url(&c->base),
 					   NULL,
 					   script_cb,
@@ -26,10 +26,11 @@
 #include <dom/dom.h>
 
 #include "utils/log.h"
-#include "utils/talloc.h"
+#include "utils/arena.h"
 #include "css/utils.h"
 
 #include "html/box.h"
+#include "html/box_manipulate.h"
 #include "html/table.h"
 
 /* Define to enable verbose table debug */
@@ -809,17 +810,25 @@ table_used_bottom_border_for_cell(const css_unit_ctx *unit_len_ctx,
 
 /* exported interface documented in html/table.h */
 bool
-table_calculate_column_types(const css_unit_ctx *unit_len_ctx, struct box *table)
+table_calculate_column_types(const css_unit_ctx *unit_len_ctx,
+			     struct arena *arena,
+			     struct box *table)
 {
 	unsigned int i, j;
 	struct column *col;
 	struct box *row_group, *row, *cell;
+	struct box_extension *ext;
 
-	if (table->col)
-		/* table->col already constructed, for example frameset table */
+	if (table->ext->col)
+		/* column data already constructed, for example frameset table */
 		return true;
 
-	table->col = col = talloc_array(table, struct column, table->columns);
+	ext = box_extend(table, arena);
+	if (!ext)
+		return false;
+
+	ext->col = col = arena_alloc(arena,
+			sizeof(struct column) * table->columns);
 	if (!col)
 		return false;
 
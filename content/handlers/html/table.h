@@ -28,19 +28,21 @@
 #include <stdbool.h>
 
 struct box;
+struct arena;
 
 
 /**
  * Determine the column width types for a table.
  *
  * \param unit_len_ctx Length conversion context
+ * \param arena Arena the box tree is allocated from
  * \param table box of type BOX_TABLE
  * \return true on success, false on memory exhaustion
  *
- * The table->col array is allocated and type and width are filled in for each
+ * The table->ext->col array is allocated and type and width are filled in for each
  * column.
  */
-bool table_calculate_column_types(const css_unit_ctx *unit_len_ctx,	struct box *table);
+bool table_calculate_column_types(const css_unit_ctx *unit_len_ctx, struct arena *arena, struct box *table);
 
 
 /**
@@ -30,6 +30,7 @@
 #include "netsurf/inttypes.h"
 #include "utils/utils.h"
 #include "utils/log.h"
+#include "utils/memtrack.h"
 #include "netsurf/misc.h"
 #include "netsurf/bitmap.h"
 #include "content/llcache.h"
@@ -188,6 +189,7 @@ static void image_cache_stats_bitmap_add(struct image_cache_entry_s *centry)
 
 	image_cache->total_bitmap_size += centry->bitmap_size;
 	image_cache->bitmap_count++;
+	memtrack_alloc(MEMTRACK_IMAGE_CACHE, centry->bitmap_size);
 
 	if (image_cache->total_bitmap_size > image_cache->max_bitmap_size) {
 		image_cache->max_bitmap_size = image_cache->total_bitmap_size;
@@ -267,6 +269,7 @@ static void image_cache__free_bitmap(struct image_cache_entry_s *centry)
 		centry->bitmap = NULL;
 		image_cache->total_bitmap_size -= centry->bitmap_size;
 		image_cache->bitmap_count--;
+		memtrack_free(MEMTRACK_IMAGE_CACHE, centry->bitmap_size);
 		if (centry->redraw_count == 0) {
 			image_cache->specultive_miss_count++;
 		}
@@ -293,6 +296,7 @@ static void image_cache__free_entry(struct image_cache_entry_s *centry)
 
 	image_cache__unlink(centry);
 
+	memtrack_free(MEMTRACK_IMAGE_CACHE, sizeof(*centry));
 	free(centry);
 }
 
@@ -411,6 +415,19 @@ struct bitmap *image_cache_find_bitmap(struct content *c)
 	return centry->bitmap;
 }
 
+/* exported interface documented in image_cache.h */
+size_t image_cache_get_bitmap_size(const struct content *c)
+{
+	struct image_cache_entry_s *centry;
+
+	centry = image_cache__find(c);
+	if ((centry == NULL) || (centry->bitmap == NULL)) {
+		return 0;
+	}
+
+	return centry->bitmap_size;
+}
+
 /* exported interface documented in image_cache.h */
 nserror
 image_cache_init(const struct image_cache_parameters *image_cache_parameters)
@@ -506,6 +523,57 @@ nserror image_cache_fini(void)
 	return NSERROR_OK;
 }
 
+/* exported interface documented in image_cache.h */
+nserror image_cache_set_limit(size_t limit)
+{
+	if (image_cache == NULL) {
+		return NSERROR_INIT_FAILED;
+	}
+
+	if (image_cache->params.limit > 0) {
+		image_cache->params.hysteresis =
+			(uint64_t)image_cache->params.hysteresis * limit /
+			image_cache->params.limit;
+	} else {
+		image_cache->params.hysteresis = limit / 5;
+	}
+	image_cache->params.limit = limit;
+
+	NSLOG(netsurf, INFO,
+	      "Image cache limit now %"PRIsizet" hysteresis %"PRIsizet,
+	      image_cache->params.limit,
+	      image_cache->params.hysteresis);
+
+	return NSERROR_OK;
+}
+
+/* exported interface documented in image_cache.h */
+size_t image_cache_release_undisplayed(void)
+{
+	struct image_cache_entry_s *centry;
+	size_t released = 0;
+
+	if (image_cache == NULL) {
+		return 0;
+	}
+
+	for (centry = image_cache->entries;
+	     centry != NULL;
+	     centry = centry->next) {
+		if ((centry->bitmap != NULL) &&
+		    ((image_cache->current_age - centry->redraw_age) >=
+		     image_cache->params.bg_clean_time)) {
+			released += centry->bitmap_size;
+			image_cache__free_bitmap(centry);
+		}
+	}
+
+	NSLOG(netsurf, INFO, "Released %"PRIsizet" bytes of undisplayed bitmaps",
+	      released);
+
+	return released;
+}
+
 /* exported interface documented in image_cache.h */
 nserror image_cache_add(struct content *content,
 			struct bitmap *bitmap,
@@ -525,6 +593,7 @@ nserror image_cache_add(struct content *content,
 		if (centry == NULL) {
 			return NSERROR_NOMEM;
 		}
+		memtrack_alloc(MEMTRACK_IMAGE_CACHE, sizeof(*centry));
 		image_cache__link(centry);
 		centry->content = content;
 
@@ -67,6 +67,29 @@ struct image_cache_parameters {
 nserror image_cache_init(const struct image_cache_parameters *image_cache_parameters);
 nserror image_cache_fini(void);
 
+/**
+ * Change the target size of the image cache
+ *
+ * The hysteresis is scaled to keep the same proportion of the limit
+ * as the cache was initialised with. Bitmaps are released by the
+ * background clean as usual.
+ *
+ * \param limit The new target upper bound for the image cache size.
+ * \return NSERROR_OK on success else error code.
+ */
+nserror image_cache_set_limit(size_t limit);
+
+/**
+ * Release the bitmaps of images which are not being displayed
+ *
+ * Every bitmap which has not been redrawn within the background clean
+ * period is freed regardless of the cache limit. The bitmaps are
+ * converted again from the source data if they are redrawn.
+ *
+ * \return The number of bytes of bitmap released.
+ */
+size_t image_cache_release_undisplayed(void);
+
 /** adds an image content to be cached. 
  * 
  * @param content The content handle used as a key
@@ -87,6 +110,9 @@ struct bitmap *image_cache_get_bitmap(const struct content *c);
 /** Obtain a bitmap from a content with no conversion */
 struct bitmap *image_cache_find_bitmap(struct content *c);
 
+/** Obtain the size of the bitmap currently held for a content, 0 if none */
+size_t image_cache_get_bitmap_size(const struct content *c);
+
 /** Decide if a content should be speculatively converted.
  *
  * This allows for image content handlers to ask the cache if a bitmap
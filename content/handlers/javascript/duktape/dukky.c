@@ -32,6 +32,7 @@
 #include "utils/nsoption.h"
 #include "utils/log.h"
 #include "utils/corestrings.h"
+#include "utils/memtrack.h"
 #include "content/content.h"
 
 #include "javascript/js.h"
@@ -540,6 +541,29 @@ dukky_inject_not_ctr(duk_context *ctx, int idx, const char *name)
 
 /* Duktape heap utility functions */
 
+/**
+ * Header prefixed to every heap allocation to record its size.
+ *
+ * The union keeps the allocation that follows aligned for any type.
+ */
+typedef union {
+	size_t size;
+	long double ld;
+	long long ll;
+	void *p;
+} dukky_alloc_header;
+
+/** Memory statistics for all heaps */
+static struct js_stats dukky_stats;
+
+static inline void dukky_stats_add(size_t size)
+{
+	dukky_stats.size += size;
+	if (dukky_stats.size > dukky_stats.peak) {
+		dukky_stats.peak = dukky_stats.size;
+	}
+}
+
 /* We need to override the defaults because not all platforms are fully ANSI
  * compatible.  E.g. RISC OS gets upset if we malloc or realloc a zero byte
  * block, as do debugging tools such as Electric Fence by Bruce Perens.
@@ -547,30 +571,60 @@ dukky_inject_not_ctr(duk_context *ctx, int idx, const char *name)
 
 static void *dukky_alloc_function(void *udata, duk_size_t size)
 {
+	dukky_alloc_header *hdr;
+
 	if (size == 0)
 		return NULL;
 
-	return malloc(size);
+	hdr = malloc(sizeof(*hdr) + size);
+	if (hdr == NULL)
+		return NULL;
+
+	hdr->size = size;
+	dukky_stats_add(size);
+	memtrack_alloc(MEMTRACK_JAVASCRIPT, size);
+
+	return hdr + 1;
+}
+
+static void dukky_free_function(void *udata, void *ptr)
+{
+	dukky_alloc_header *hdr;
+
+	if (ptr != NULL) {
+		hdr = (dukky_alloc_header *)ptr - 1;
+		dukky_stats.size -= hdr->size;
+		memtrack_free(MEMTRACK_JAVASCRIPT, hdr->size);
+		free(hdr);
+	}
 }
 
 static void *dukky_realloc_function(void *udata, void *ptr, duk_size_t size)
 {
-	if (ptr == NULL && size == 0)
-		return NULL;
+	dukky_alloc_header *hdr;
+	size_t old_size;
+
+	if (ptr == NULL)
+		return dukky_alloc_function(udata, size);
 
 	if (size == 0) {
-		free(ptr);
+		dukky_free_function(udata, ptr);
 		return NULL;
 	}
 
-	return realloc(ptr, size);
-}
+	hdr = (dukky_alloc_header *)ptr - 1;
+	old_size = hdr->size;
 
+	hdr = realloc(hdr, sizeof(*hdr) + size);
+	if (hdr == NULL)
+		return NULL;
 
-static void dukky_free_function(void *udata, void *ptr)
-{
-	if (ptr != NULL)
-		free(ptr);
+	hdr->size = size;
+	dukky_stats.size -= old_size;
+	dukky_stats_add(size);
+	memtrack_resize(MEMTRACK_JAVASCRIPT, old_size, size);
+
+	return hdr + 1;
 }
 
 /* exported interface documented in js.h */
@@ -593,6 +647,13 @@ void js_finalise(void)
 }
 
 
+/* exported interface documented in js.h */
+void js_get_stats(struct js_stats *stats)
+{
+	*stats = dukky_stats;
+}
+
+
 /* exported interface documented in js.h */
 nserror
 js_newheap(int timeout, jsheap **heap)
@@ -609,6 +670,7 @@ js_newheap(int timeout, jsheap **heap)
 		ret,
 		NULL);
 	if (ret->ctx == NULL) { free(ret); return NSERROR_NOMEM; }
+	dukky_stats.heaps++;
 	/* Create the prototype stuffs */
 	duk_push_global_object(ctx);
 	duk_push_boolean(ctx, true);
@@ -632,6 +694,7 @@ static void dukky_destroyheap(jsheap *heap)
 	NSLOG(dukky, DEBUG, "Destroying duktape javascript context");
 	duk_destroy_heap(heap->ctx);
 	free(heap);
+	dukky_stats.heaps--;
 }
 
 /* exported interface documented in js.h */
@@ -62,6 +62,22 @@ void js_initialise(void);
  */
 void js_finalise(void);
 
+/**
+ * JavaScript interpreter memory statistics
+ */
+struct js_stats {
+	unsigned int heaps; /**< Number of live heaps */
+	size_t size; /**< Memory currently allocated by all heaps */
+	size_t peak; /**< Largest value size has reached */
+};
+
+/**
+ * Retrieve the javascript interpreter memory statistics
+ *
+ * \param stats Structure to be filled in with the current statistics.
+ */
+void js_get_stats(struct js_stats *stats);
+
 /**
  * Create a new javascript heap.
  *
@@ -36,6 +36,13 @@ void js_finalise(void)
 {
 }
 
+void js_get_stats(struct js_stats *stats)
+{
+	stats->heaps = 0;
+	stats->size = 0;
+	stats->peak = 0;
+}
+
 nserror js_newheap(int timeout, jsheap **heap)
 {
 	*heap = NULL;
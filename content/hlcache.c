@@ -24,6 +24,8 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <nsutils/time.h>
 
 #include "utils/http.h"
 #include "utils/log.h"
@@ -31,6 +33,7 @@
 #include "utils/nsurl.h"
 #include "utils/ring.h"
 #include "utils/utils.h"
+#include "utils/hashmap.h"
 #include "netsurf/inttypes.h"
 #include "netsurf/misc.h"
 #include "netsurf/content.h"
@@ -41,6 +44,7 @@
 // Note, this is *ONLY* so that we can abort cleanly during shutdown of the cache
 #include "content/content_protected.h"
 #include "content/content_factory.h"
+#include "image/image_cache.h"
 
 typedef struct hlcache_entry hlcache_entry;
 typedef struct hlcache_retrieval_ctx hlcache_retrieval_ctx;
@@ -77,6 +81,17 @@ struct hlcache_entry {
 
 	hlcache_entry *next;		/**< Next sibling */
 	hlcache_entry *prev;		/**< Previous sibling */
+
+	uint64_t last_used;		/**< Time content last lost a user (ms) */
+
+	const void *index_key;		/**< Low-level object indexed under */
+	hlcache_entry *index_next;	/**< Next entry with same object */
+	hlcache_entry *index_prev;	/**< Previous entry with same object */
+};
+
+/** Chain of cache entries sharing a low-level object */
+struct hlcache_index_chain {
+	hlcache_entry *head;		/**< First entry in chain */
 };
 
 /** Current state of the cache.
@@ -89,12 +104,18 @@ struct hlcache_s {
 	/** List of cached content objects */
 	hlcache_entry *content_list;
 
+	/** Shareable cached contents indexed by low-level object */
+	hashmap_t *content_index;
+
 	/** Ring of retrieval contexts */
 	hlcache_retrieval_ctx *retrieval_ctx_ring;
 
 	/* statistics */
 	unsigned int hit_count;
 	unsigned int miss_count;
+	unsigned int lookup_count;	/**< Content lookups performed */
+	unsigned int probe_count;	/**< Entries examined by lookups */
+	clock_t lookup_time;		/**< Processor time spent in lookups */
 };
 
 /** high level cache state */
@@ -105,13 +126,228 @@ static struct hlcache_s *hlcache = NULL;
  * High-level cache internals						      *
  ******************************************************************************/
 
+static void *hlcache_index_key_clone(void *key)
+{
+	return key;
+}
+
+static void hlcache_index_key_destroy(void *key)
+{
+}
+
+static uint32_t hlcache_index_key_hash(void *key)
+{
+	uintptr_t k = (uintptr_t)key;
+
+	/* Objects are heap allocated so the low bits carry little entropy */
+	k ^= k >> 16;
+	return (uint32_t)(k >> 3) * 0x9e3779b1u;
+}
+
+static bool hlcache_index_key_eq(void *a, void *b)
+{
+	return a == b;
+}
+
+static void *hlcache_index_value_alloc(void *key)
+{
+	return calloc(1, sizeof(struct hlcache_index_chain));
+}
+
+static void hlcache_index_value_destroy(void *value)
+{
+	free(value);
+}
+
+static hashmap_parameters_t hlcache_index_parameters = {
+	.key_clone = hlcache_index_key_clone,
+	.key_destroy = hlcache_index_key_destroy,
+	.key_hash = hlcache_index_key_hash,
+	.key_eq = hlcache_index_key_eq,
+	.value_alloc = hlcache_index_value_alloc,
+	.value_destroy = hlcache_index_value_destroy,
+};
+
+/**
+ * Add an entry to the content index
+ *
+ * Only shareable contents are indexed as no other content may be
+ * found for reuse.
+ *
+ * \param entry  Entry to index
+ * \return NSERROR_OK on success, appropriate error otherwise
+ */
+static nserror hlcache_index_add(hlcache_entry *entry)
+{
+	struct hlcache_index_chain *chain;
+	const llcache_handle *entry_llcache;
+	void *key;
+
+	entry->index_key = NULL;
+	entry->index_next = NULL;
+	entry->index_prev = NULL;
+
+	if (content_is_shareable(entry->content) == false)
+		return NSERROR_OK;
+
+	entry_llcache = content_get_llcache_handle(entry->content);
+	if (entry_llcache == NULL)
+		return NSERROR_OK;
+
+	key = (void *)llcache_handle_get_object_key(entry_llcache);
+
+	chain = hashmap_lookup(hlcache->content_index, key);
+	if (chain == NULL) {
+		chain = hashmap_insert(hlcache->content_index, key);
+		if (chain == NULL)
+			return NSERROR_NOMEM;
+	}
+
+	entry->index_key = key;
+	entry->index_next = chain->head;
+	if (chain->head != NULL)
+		chain->head->index_prev = entry;
+	chain->head = entry;
+
+	return NSERROR_OK;
+}
+
+/**
+ * Remove an entry from the content index
+ *
+ * \param entry  Entry to remove
+ */
+static void hlcache_index_remove(hlcache_entry *entry)
+{
+	struct hlcache_index_chain *chain;
+
+	if (entry->index_key == NULL)
+		return;
+
+	if (entry->index_prev != NULL) {
+		entry->index_prev->index_next = entry->index_next;
+	} else {
+		chain = hashmap_lookup(hlcache->content_index,
+				(void *)entry->index_key);
+		assert(chain != NULL && chain->head == entry);
+		chain->head = entry->index_next;
+		if (chain->head == NULL) {
+			hashmap_remove(hlcache->content_index,
+					(void *)entry->index_key);
+		}
+	}
+
+	if (entry->index_next != NULL)
+		entry->index_next->index_prev = entry->index_prev;
+
+	entry->index_key = NULL;
+	entry->index_next = NULL;
+	entry->index_prev = NULL;
+}
+
+
+/**
+ * Remove an entry from the cache and destroy its content
+ *
+ * \param entry  Entry to destroy
+ */
+static void hlcache_entry_destroy(hlcache_entry *entry)
+{
+	hlcache_index_remove(entry);
+
+	/* Remove entry from cache */
+	if (entry->prev == NULL)
+		hlcache->content_list = entry->next;
+	else
+		entry->prev->next = entry->next;
+
+	if (entry->next != NULL)
+		entry->next->prev = entry->prev;
+
+	/* Destroy content */
+	content_destroy(entry->content);
+
+	/* Destroy entry */
+	free(entry);
+}
+
+/**
+ * Estimate the memory held by a cache entry's content
+ *
+ * The source data, the handler's own estimate and any bitmap the image
+ * cache holds for the content are all pinned for as long as the content
+ * is kept.
+ *
+ * \param entry  Entry to consider
+ * \return Estimated size of the content in bytes
+ */
+static size_t hlcache_entry_size(hlcache_entry *entry)
+{
+	size_t source_size = 0;
+
+	content__get_source_data(entry->content, &source_size);
+
+	return source_size + entry->content->size +
+		image_cache_get_bitmap_size(entry->content);
+}
+
+/**
+ * Determine if an unused content is worth keeping for reuse
+ *
+ * Only contents which a later retrieval could be handed are kept: they
+ * must be complete, shareable and built on source data the low-level
+ * cache would still return without revalidation.
+ *
+ * \param entry  Entry to consider
+ * \return True if the content may be retained, false otherwise
+ */
+static bool hlcache_entry_is_retainable(hlcache_entry *entry)
+{
+	const llcache_handle *entry_ll;
+
+	if (content__get_status(entry->content) != CONTENT_STATUS_DONE)
+		return false;
+
+	if (content_is_shareable(entry->content) == false)
+		return false;
+
+	entry_ll = content_get_llcache_handle(entry->content);
+	if (entry_ll == NULL)
+		return false;
+
+	return llcache_handle_is_fresh(entry_ll);
+}
+
+/**
+ * Order retained entries by the time they were last used, oldest first
+ */
+static int hlcache_entry_age_cmp(const void *a, const void *b)
+{
+	const hlcache_entry *ea = *(const hlcache_entry * const *) a;
+	const hlcache_entry *eb = *(const hlcache_entry * const *) b;
+
+	if (ea->last_used < eb->last_used)
+		return -1;
+	if (ea->last_used > eb->last_used)
+		return 1;
+	return 0;
+}
 
 /**
  * Attempt to clean the cache
+ *
+ * Unused contents which cannot be reused are destroyed immediately.
+ * Fresh, shareable contents are kept, with the least recently used
+ * being destroyed until the remainder fit within the configured limit.
+ * A forced clean destroys every unused content.
  */
 static void hlcache_clean(void *force_clean_flag)
 {
 	hlcache_entry *entry, *next;
+	hlcache_entry **retained = NULL;
+	size_t retained_count = 0;
+	size_t retained_size = 0;
+	size_t idx;
 	bool force_clean = (force_clean_flag != NULL);
 
 	for (entry = hlcache->content_list; entry != NULL; entry = next) {
@@ -123,6 +359,16 @@ static void hlcache_clean(void *force_clean_flag)
 		uint32_t users = content_count_users(entry->content);
 		if (users != 0)
 			continue;
+
+		if ((force_clean == false) &&
+		    (hlcache->params.limit > 0) &&
+		    hlcache_entry_is_retainable(entry)) {
+			/* Keep for now, subject to the size limit below */
+			retained_size += hlcache_entry_size(entry);
+			retained_count++;
+			continue;
+		}
+
 		const llcache_handle *entry_ll = content_get_llcache_handle(entry->content);
 		const nsurl *entry_url = NULL;
 		if (entry_ll != NULL) {
@@ -144,29 +390,49 @@ static void hlcache_clean(void *force_clean_flag)
 			content_set_error(entry->content);
 		}
 
-		/** \todo This is over-zealous: all unused contents
-		 * will be immediately destroyed. Ideally, we want to
-		 * purge all unused contents that are using stale
-		 * source data, and enough fresh contents such that
-		 * the cache fits in the configured cache size limit.
-		 */
+		hlcache_entry_destroy(entry);
+	}
+
+	if (retained_size > hlcache->params.limit) {
+		/* Purge least recently used contents until within limit */
+		retained = malloc(retained_count * sizeof(hlcache_entry *));
+	}
 
-		/* Remove entry from cache */
-		if (entry->prev == NULL)
-			hlcache->content_list = entry->next;
-		else
-			entry->prev->next = entry->next;
+	if (retained != NULL) {
+		idx = 0;
+		for (entry = hlcache->content_list;
+		     entry != NULL && idx < retained_count;
+		     entry = entry->next) {
+			if ((entry->content != NULL) &&
+			    (content_count_users(entry->content) == 0) &&
+			    hlcache_entry_is_retainable(entry)) {
+				retained[idx++] = entry;
+			}
+		}
+
+		qsort(retained, idx, sizeof(hlcache_entry *),
+		      hlcache_entry_age_cmp);
 
-		if (entry->next != NULL)
-			entry->next->prev = entry->prev;
+		for (retained_count = idx, idx = 0;
+		     idx < retained_count &&
+			     retained_size > hlcache->params.limit;
+		     idx++) {
+			size_t entry_size = hlcache_entry_size(retained[idx]);
 
-		/* Destroy content */
-		content_destroy(entry->content);
+			NSLOG(netsurf, DEBUG,
+			      "hlcache_clean evicting content %p size %"PRIsizet,
+			      retained[idx]->content, entry_size);
+
+			retained_size -= entry_size;
+			hlcache_entry_destroy(retained[idx]);
+		}
 
-		/* Destroy entry */
-		free(entry);
+		free(retained);
 	}
 
+	NSLOG(netsurf, DEBUG, "hlcache retaining %"PRIsizet" bytes of unused contents",
+	      retained_size);
+
 	/* Attempt to clean the llcache */
 	llcache_clean(false);
 
@@ -300,38 +566,43 @@ static nserror hlcache_find_content(hlcache_retrieval_ctx *ctx,
 		lwc_string *effective_type)
 {
 	hlcache_entry *entry;
+	struct hlcache_index_chain *chain;
+	clock_t lookup_start;
 	hlcache_event event;
 	nserror error = NSERROR_OK;
 
-	/* Search list of cached contents for a suitable one */
-	for (entry = hlcache->content_list; entry != NULL; entry = entry->next) {
+	/* Search contents sharing the low-level object for a suitable one */
+	lookup_start = clock();
+	chain = hashmap_lookup(hlcache->content_index,
+			(void *)llcache_handle_get_object_key(ctx->llcache));
+	hlcache->lookup_count++;
+
+	for (entry = (chain != NULL) ? chain->head : NULL; entry != NULL;
+	     entry = entry->index_next) {
 		hlcache_handle entry_handle = { entry, NULL, NULL };
 		const llcache_handle *entry_llcache;
 
-		if (entry->content == NULL)
-			continue;
+		hlcache->probe_count++;
 
 		/* Ignore contents in the error state */
 		if (content_get_status(&entry_handle) == CONTENT_STATUS_ERROR)
 			continue;
 
-		/* Ensure that content is shareable */
-		if (content_is_shareable(entry->content) == false)
-			continue;
-
 		/* Ensure that quirks mode is acceptable */
 		if (content_matches_quirks(entry->content,
 				ctx->child.quirks) == false)
 			continue;
 
-		/* Ensure that content uses same low-level object as
-		 * low-level handle */
+		/* Ensure that content still uses the same low-level object
+		 * as the low-level handle; aborting a content moves it to
+		 * a private object without reindexing it. */
 		entry_llcache = content_get_llcache_handle(entry->content);
 
 		if (llcache_handle_references_same_object(entry_llcache,
 				ctx->llcache))
 			break;
 	}
+	hlcache->lookup_time += clock() - lookup_start;
 
 	if (entry == NULL) {
 		/* No existing entry, so need to create one */
@@ -350,6 +621,14 @@ static nserror hlcache_find_content(hlcache_retrieval_ctx *ctx,
 		NSLOG(netsurf, DEBUG, "hlcache created content %p (entry %p)",
 		      entry->content, entry);
 
+		nsu_getmonotonic_ms(&entry->last_used);
+
+		/* Index for reuse; an unindexed content is simply unshared */
+		if (hlcache_index_add(entry) != NSERROR_OK) {
+			NSLOG(netsurf, INFO, "Unable to index content %p",
+			      entry->content);
+		}
+
 		/* Insert into cache */
 		entry->prev = NULL;
 		entry->next = hlcache->content_list;
@@ -784,6 +1063,14 @@ hlcache_initialise(const struct hlcache_parameters *hlcache_parameters)
 		return ret;
 	}
 
+	hlcache->content_index = hashmap_create(&hlcache_index_parameters);
+	if (hlcache->content_index == NULL) {
+		llcache_finalise();
+		free(hlcache);
+		hlcache = NULL;
+		return NSERROR_NOMEM;
+	}
+
 	hlcache->params = *hlcache_parameters;
 
 	/* Schedule the cache cleanup */
@@ -883,6 +1170,12 @@ void hlcache_finalise(void)
 	NSLOG(netsurf, INFO, "hit/miss %d/%d", hlcache->hit_count,
 	      hlcache->miss_count);
 
+	NSLOG(netsurf, INFO, "%u lookups examined %u entries in %.0fus",
+	      hlcache->lookup_count, hlcache->probe_count,
+	      (double)hlcache->lookup_time * 1000000 / CLOCKS_PER_SEC);
+
+	hashmap_destroy(hlcache->content_index);
+
 	/* De-schedule ourselves */
 	guit->misc->schedule(-1, hlcache_clean, NULL);
 
@@ -1031,12 +1324,64 @@ hlcache_handle_retrieve1(nsurl *url,
 	return error;
 }
 
+/* See hlcache.h for documentation */
+void hlcache_set_limit(size_t limit)
+{
+	hlcache->params.limit = limit;
+
+	NSLOG(netsurf, INFO, "hlcache limit now %"PRIsizet" bytes", limit);
+
+	/* Clean now, this also reschedules the background clean */
+	hlcache_clean(NULL);
+}
+
+/* See hlcache.h for documentation */
+void hlcache_get_stats(struct hlcache_stats *stats)
+{
+	hlcache_entry *entry;
+
+	stats->contents = 0;
+	stats->retained = 0;
+	stats->retained_size = 0;
+	stats->limit = hlcache->params.limit;
+	stats->hit = hlcache->hit_count;
+	stats->miss = hlcache->miss_count;
+
+	for (entry = hlcache->content_list;
+	     entry != NULL;
+	     entry = entry->next) {
+		if (entry->content == NULL)
+			continue;
+
+		stats->contents++;
+
+		if ((content_count_users(entry->content) == 0) &&
+		    hlcache_entry_is_retainable(entry)) {
+			stats->retained++;
+			stats->retained_size += hlcache_entry_size(entry);
+		}
+	}
+}
+
+/* See hlcache.h for documentation */
+void hlcache_get_lookup_stats(unsigned int *lookups, unsigned int *probes,
+		unsigned long *time_us)
+{
+	*lookups = hlcache->lookup_count;
+	*probes = hlcache->probe_count;
+	*time_us = (unsigned long)((double)hlcache->lookup_time * 1000000 /
+			CLOCKS_PER_SEC);
+}
+
 /* See hlcache.h for documentation */
 nserror hlcache_handle_release(hlcache_handle *handle)
 {
 	if (handle->entry != NULL) {
 		content_remove_user(handle->entry->content,
 				hlcache_content_callback, handle);
+
+		/* Age the entry from its last use for cache retention */
+		nsu_getmonotonic_ms(&handle->entry->last_used);
 	} else {
 		RING_ITERATE_START(struct hlcache_retrieval_ctx,
 				   hlcache->retrieval_ctx_ring,
@@ -1138,6 +1483,7 @@ nserror hlcache_handle_abort(hlcache_handle *handle)
 		content_remove_user(c, hlcache_content_callback, handle);
 
 		entry->content = clone;
+		nsu_getmonotonic_ms(&entry->last_used);
 		handle->entry = entry;
 		entry->prev = NULL;
 		entry->next = hlcache->content_list;
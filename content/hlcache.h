@@ -49,6 +49,9 @@ struct hlcache_parameters {
 	/** How frequently the background cache clean process is run (ms) */
 	unsigned int bg_clean_time;
 
+	/** Upper bound on memory held by unused contents kept for reuse */
+	size_t limit;
+
 	struct llcache_parameters llcache;
 };
 
@@ -94,6 +97,45 @@ void hlcache_stop(void);
  */
 void hlcache_finalise(void);
 
+/**
+ * Change the size limit of retained unused contents
+ *
+ * The cache is cleaned immediately so unused contents beyond the new
+ * limit are destroyed, and the low-level cache is cleaned in turn.
+ *
+ * \param limit The new limit on the size of retained contents.
+ */
+void hlcache_set_limit(size_t limit);
+
+/**
+ * High-level cache statistics
+ */
+struct hlcache_stats {
+	unsigned int contents; /**< Number of contents in the cache */
+	unsigned int retained; /**< Unused contents retained for reuse */
+	size_t retained_size; /**< Estimated size of retained contents */
+	size_t limit; /**< Limit on the size of retained contents */
+	unsigned int hit; /**< Retrievals which reused a content */
+	unsigned int miss; /**< Retrievals which created a content */
+};
+
+/**
+ * Retrieve the high-level cache statistics
+ *
+ * \param stats  Structure to be filled in with the current statistics
+ */
+void hlcache_get_stats(struct hlcache_stats *stats);
+
+/**
+ * Retrieve statistics for content lookups made by the high-level cache
+ *
+ * \param lookups  Updated with the number of lookups performed
+ * \param probes   Updated with the number of cache entries examined
+ * \param time_us  Updated with processor time spent in lookups (us)
+ */
+void hlcache_get_lookup_stats(unsigned int *lookups, unsigned int *probes,
+		unsigned long *time_us);
+
 /**
  * Retrieve a high-level cache handle for an object
  *
@@ -46,6 +46,7 @@
 #include "utils/nsurl.h"
 #include "utils/utils.h"
 #include "utils/time.h"
+#include "utils/memtrack.h"
 #include "utils/http.h"
 #include "utils/nsoption.h"
 #include "netsurf/misc.h"
@@ -141,6 +142,8 @@ typedef struct {
 	bool tried_with_tls_downgrade;	/**< Whether we've tried TLS 1.2 */
 
 	bool tainted_tls;		/**< Whether the TLS transport is tainted */
+
+	bool paused;			/**< Whether the fetch has been paused */
 } llcache_fetch_ctx;
 
 /**
@@ -157,6 +160,21 @@ typedef enum {
  */
 #define INVALID_AGE -1
 
+/**
+ * Minimum amount a source buffer grows by when data is appended.
+ */
+#define LLCACHE_SOURCE_ALLOC_MIN (64 * 1024)
+
+/**
+ * Upper bound on a declared content length used to presize a source buffer.
+ */
+#define LLCACHE_SOURCE_PRESIZE_MAX (64 * 1024 * 1024)
+
+/**
+ * Undelivered source data of a streamed object at which its fetch is paused.
+ */
+#define LLCACHE_STREAM_WINDOW (1024 * 1024)
+
 /** Cache control data */
 typedef struct {
 	time_t req_time;	/**< Time of request */
@@ -198,6 +216,11 @@ struct llcache_object {
 	uint8_t *source_data;	     /**< Source data for object */
 	size_t source_len;	     /**< Byte length of source data */
 	size_t source_alloc;	     /**< Allocated size of source buffer */
+	size_t source_tracked;	     /**< Source bytes reported to memtrack */
+	struct fetch_chunk *source_chunk; /**< Fetch chunk holding the
+					   * source data if it was
+					   * retained from the fetcher
+					   */
 
 	struct cert_chain *chain;    /**< Certificate chain from the fetch */
 
@@ -283,6 +306,13 @@ struct llcache_s {
 	 */
 	uint64_t total_elapsed;
 
+	/**
+	 * Retrieval counters and backing store latency histograms.
+	 *
+	 * The object count, size and limit are only filled in when
+	 * the statistics are requested.
+	 */
+	struct llcache_stats stats;
 };
 
 /** low level cache state */
@@ -299,6 +329,79 @@ static void llcache_users_not_caught_up(void);
  * Low-level cache internals						      *
  ******************************************************************************/
 
+/**
+ * Record the duration of a backing store operation in a histogram
+ *
+ * \param histogram The latency histogram to update.
+ * \param startms The monotonic time the operation started at.
+ */
+static void
+llcache_record_latency(unsigned long *histogram, uint64_t startms)
+{
+	uint64_t endms;
+	uint64_t elapsed;
+	unsigned int bucket = 0;
+
+	nsu_getmonotonic_ms(&endms);
+	elapsed = endms - startms;
+
+	while ((elapsed > 0) && (bucket < LLCACHE_LATENCY_BUCKETS - 1)) {
+		elapsed >>= 1;
+		bucket++;
+	}
+	histogram[bucket]++;
+}
+
+/**
+ * Fetch an object's data from the backing store, recording the latency
+ *
+ * \param url The url of the object.
+ * \param flags Backing store flags.
+ * \param data Updated with the retrieved data.
+ * \param datalen Updated with the length of the retrieved data.
+ * \return NSERROR_OK on success or appropriate error code.
+ */
+static nserror
+llcache_backing_fetch(nsurl *url,
+		      enum backing_store_flags flags,
+		      uint8_t **data,
+		      size_t *datalen)
+{
+	nserror res;
+	uint64_t startms = 0;
+
+	nsu_getmonotonic_ms(&startms);
+	res = guit->llcache->fetch(url, flags, data, datalen);
+	llcache_record_latency(llcache->stats.fetch_latency, startms);
+
+	return res;
+}
+
+/**
+ * Place an object's data in the backing store, recording the latency
+ *
+ * \param url The url of the object.
+ * \param flags Backing store flags.
+ * \param data The data to store.
+ * \param datalen The length of data.
+ * \return NSERROR_OK on success or appropriate error code.
+ */
+static nserror
+llcache_backing_store(nsurl *url,
+		      enum backing_store_flags flags,
+		      uint8_t *data,
+		      const size_t datalen)
+{
+	nserror res;
+	uint64_t startms = 0;
+
+	nsu_getmonotonic_ms(&startms);
+	res = guit->llcache->store(url, flags, data, datalen);
+	llcache_record_latency(llcache->stats.store_latency, startms);
+
+	return res;
+}
+
 /**
  * Create a new object user.
  *
@@ -446,6 +549,27 @@ static nserror llcache_send_event_to_users(llcache_object *object,
 	return error;
 }
 
+/**
+ * Update the memory accounted to an object's source data
+ *
+ * Must be called whenever the source buffer of an object changes.
+ *
+ * \param object The object whose source data changed.
+ */
+static inline void llcache_object_memtrack(llcache_object *object)
+{
+	size_t size = 0;
+
+	if (object->source_data != NULL) {
+		/* data read from the backing store has no allocation size */
+		size = (object->store_state == LLCACHE_STATE_DISC) ?
+			object->source_len : object->source_alloc;
+	}
+
+	memtrack_resize(MEMTRACK_LLCACHE, object->source_tracked, size);
+	object->source_tracked = size;
+}
+
 /**
  * Create a new low-level cache object
  *
@@ -459,6 +583,8 @@ static nserror llcache_object_new(nsurl *url, llcache_object **result)
 	if (obj == NULL)
 		return NSERROR_NOMEM;
 
+	memtrack_alloc(MEMTRACK_LLCACHE, sizeof(llcache_object));
+
 	NSLOG(llcache, DEBUG, "Created object %p (%s)", obj, nsurl_access(url));
 
 	obj->url = nsurl_ref(url);
@@ -1008,6 +1134,7 @@ static nserror llcache_object_refetch(llcache_object *object)
 
 	/* Reset fetch state */
 	object->fetch.state = LLCACHE_FETCH_INIT;
+	object->fetch.paused = false;
 
 	NSLOG(llcache, DEBUG, "Re-fetching %p", object);
 
@@ -1022,6 +1149,7 @@ static nserror llcache_object_refetch(llcache_object *object)
 			  object->fetch.flags & LLCACHE_RETRIEVE_VERIFIABLE,
 			  object->fetch.tried_with_tls_downgrade,
 			  (const char **)headers,
+			  LLCACHE_RETRIEVE_GET_PRIORITY(object->fetch.flags),
 			  &object->fetch.fetch);
 
 	/* Clean up cache-control headers */
@@ -1097,7 +1225,9 @@ static nserror llcache_object_destroy(llcache_object *object)
 
 	cert_chain_free(object->chain);
 
-	if (object->source_data != NULL) {
+	if (object->source_chunk != NULL) {
+		fetch_chunk_unref(object->source_chunk);
+	} else if (object->source_data != NULL) {
 		if (object->store_state == LLCACHE_STATE_DISC) {
 			guit->llcache->release(object->url, BACKING_STORE_NONE);
 		} else {
@@ -1134,6 +1264,9 @@ static nserror llcache_object_destroy(llcache_object *object)
 	}
 	free(object->headers);
 
+	memtrack_free(MEMTRACK_LLCACHE,
+		      sizeof(llcache_object) + object->source_tracked);
+
 	free(object);
 
 	return NSERROR_OK;
@@ -1322,6 +1455,8 @@ llcache_object_remove_from_list(llcache_object *object, llcache_object **list)
  */
 static nserror llcache_retrieve_persisted_data(llcache_object *object)
 {
+	nserror res;
+
 	/* ensure the source data is present if necessary */
 	if ((object->source_data != NULL) ||
 	    (object->store_state != LLCACHE_STATE_DISC)) {
@@ -1332,10 +1467,13 @@ static nserror llcache_retrieve_persisted_data(llcache_object *object)
 	}
 
 	/* Source data for the object may be in the persistent store */
-	return guit->llcache->fetch(object->url,
+	res = llcache_backing_fetch(object->url,
 				    BACKING_STORE_NONE,
 				    &object->source_data,
 				    &object->source_len);
+	llcache_object_memtrack(object);
+
+	return res;
 }
 
 /**
@@ -1585,10 +1723,10 @@ llcache_process_metadata(llcache_object *object)
 	NSLOG(llcache, INFO, "Retrieving metadata");
 
 	/* attempt to retrieve object metadata from the backing store */
-	res = guit->llcache->fetch(object->url,
-				   BACKING_STORE_META,
-				   &metadata,
-				   &metadatalen);
+	res = llcache_backing_fetch(object->url,
+				    BACKING_STORE_META,
+				    &metadata,
+				    &metadatalen);
 	if (res != NSERROR_OK) {
 		return res;
 	}
@@ -2015,6 +2153,7 @@ llcache_object_retrieve_from_cache(nsurl *url,
 			/* source data was successfully retrieved from
 			 * persistent store
 			 */
+			llcache->stats.hit++;
 			*result = newest;
 
 			return NSERROR_OK;
@@ -2070,6 +2209,7 @@ llcache_object_retrieve_from_cache(nsurl *url,
 			/* Add new object to cache */
 			llcache_object_add_to_list(obj, &llcache->cached_objects);
 
+			llcache->stats.revalidate++;
 			*result = obj;
 
 			return NSERROR_OK;
@@ -2102,6 +2242,7 @@ llcache_object_retrieve_from_cache(nsurl *url,
 	/* Add new object to cache */
 	llcache_object_add_to_list(obj, &llcache->cached_objects);
 
+	llcache->stats.miss++;
 	*result = obj;
 
 	return NSERROR_OK;
@@ -2172,6 +2313,8 @@ llcache_object_retrieve(nsurl *url,
 
 		/* Add new object to uncached list */
 		llcache_object_add_to_list(obj, &llcache->uncached_objects);
+
+		llcache->stats.uncached++;
 	} else {
 		error = llcache_object_retrieve_from_cache(defragmented_url,
 				flags, referer, post, redirect_count,
@@ -2182,6 +2325,14 @@ llcache_object_retrieve(nsurl *url,
 		}
 
 		/* Returned object is already in the cached list */
+
+		/* A fetch already under way for another user is
+		 * promoted if this user needs the object sooner.
+		 */
+		if (obj->fetch.fetch != NULL) {
+			fetch_raise_priority(obj->fetch.fetch,
+					LLCACHE_RETRIEVE_GET_PRIORITY(flags));
+		}
 	}
 
 	NSLOG(llcache, DEBUG, "Retrieved %p", obj);
@@ -2525,17 +2676,11 @@ static nserror llcache_fetch_notmodified(llcache_object *object,
 }
 
 /**
- * Process a chunk of fetched data
+ * Move an object into the data fetch state
  *
  * \param object  Object being fetched
- * \param data	  Data to process
- * \param len	  Byte length of data
- * \return NSERROR_OK on success, appropriate error otherwise.
  */
-static nserror
-llcache_fetch_process_data(llcache_object *object,
-			   const uint8_t *data,
-			   size_t len)
+static void llcache_fetch_enter_data(llcache_object *object)
 {
 	if (object->fetch.state != LLCACHE_FETCH_DATA) {
 		/**
@@ -2570,10 +2715,86 @@ llcache_fetch_process_data(llcache_object *object,
 
 		object->fetch.state = LLCACHE_FETCH_DATA;
 	}
+}
 
-	/* Resize source buffer if it's too small */
-	if (object->source_len + len >= object->source_alloc) {
-		const size_t new_len = object->source_len + len + 64 * 1024;
+/**
+ * Compute the size to grow an object's source buffer to
+ *
+ * The buffer grows in proportion to the data already held so large
+ * objects are not copied repeatedly as they arrive. The first
+ * allocation is sized from any declared content length.
+ *
+ * \param object  Object being fetched
+ * \param len	  Byte length of data about to be appended
+ * \return The new allocation size for the source buffer.
+ */
+static size_t llcache_source_alloc_size(llcache_object *object, size_t len)
+{
+	const size_t need = object->source_len + len + 1;
+	size_t size;
+	size_t i;
+
+	size = need + object->source_len / 2;
+	if (size < need + LLCACHE_SOURCE_ALLOC_MIN) {
+		size = need + LLCACHE_SOURCE_ALLOC_MIN;
+	}
+
+	if (object->source_len != 0) {
+		return size;
+	}
+
+	for (i = 0; i < object->num_headers; i++) {
+		if (strcasecmp(object->headers[i].name,
+			       "Content-Length") == 0) {
+			char *end;
+			unsigned long long declared;
+
+			declared = strtoull(object->headers[i].value, &end, 10);
+			if ((end != object->headers[i].value) &&
+			    (declared >= need) &&
+			    (declared < LLCACHE_SOURCE_PRESIZE_MAX)) {
+				size = declared + 1;
+			}
+			break;
+		}
+	}
+
+	return size;
+}
+
+/**
+ * Process a chunk of fetched data
+ *
+ * \param object  Object being fetched
+ * \param data	  Data to process
+ * \param len	  Byte length of data
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror
+llcache_fetch_process_data(llcache_object *object,
+			   const uint8_t *data,
+			   size_t len)
+{
+	llcache_fetch_enter_data(object);
+
+	if (object->source_chunk != NULL) {
+		/* Source is a retained fetch chunk which is immutable
+		 * so the data must be moved to a private buffer
+		 */
+		const size_t new_len = llcache_source_alloc_size(object, len);
+		uint8_t *temp = malloc(new_len);
+		if (temp == NULL)
+			return NSERROR_NOMEM;
+
+		memcpy(temp, object->source_data, object->source_len);
+		fetch_chunk_unref(object->source_chunk);
+		object->source_chunk = NULL;
+
+		object->source_data = temp;
+		object->source_alloc = new_len;
+	} else if (object->source_len + len >= object->source_alloc) {
+		/* Resize source buffer as it is too small */
+		const size_t new_len = llcache_source_alloc_size(object, len);
 		uint8_t *temp = realloc(object->source_data, new_len);
 		if (temp == NULL)
 			return NSERROR_NOMEM;
@@ -2582,6 +2803,8 @@ llcache_fetch_process_data(llcache_object *object,
 		object->source_alloc = new_len;
 	}
 
+	llcache_object_memtrack(object);
+
 	/* Append this data chunk to source buffer */
 	memcpy(object->source_data + object->source_len, data, len);
 	object->source_len += len;
@@ -2589,6 +2812,72 @@ llcache_fetch_process_data(llcache_object *object,
 	return NSERROR_OK;
 }
 
+/**
+ * Process a reference counted chunk of fetched data
+ *
+ * If the object holds no source data yet the chunk is retained as
+ * the source buffer, avoiding a copy of the data. Content handlers
+ * are given the data in place from the retained chunk.
+ *
+ * \param object  Object being fetched
+ * \param chunk	  Chunk of data to process
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror
+llcache_fetch_process_chunk(llcache_object *object, struct fetch_chunk *chunk)
+{
+	if (object->source_len != 0) {
+		return llcache_fetch_process_data(object,
+						  chunk->data,
+						  chunk->length);
+	}
+
+	llcache_fetch_enter_data(object);
+
+	/* Any existing buffer holds no data so can be discarded */
+	if (object->source_chunk != NULL) {
+		fetch_chunk_unref(object->source_chunk);
+	} else {
+		free(object->source_data);
+	}
+
+	object->source_chunk = fetch_chunk_ref(chunk);
+	object->source_data = chunk->data;
+	object->source_len = chunk->length;
+	object->source_alloc = chunk->length;
+	llcache_object_memtrack(object);
+
+	return NSERROR_OK;
+}
+
+/**
+ * Ensure an object's source data is held in a private heap buffer
+ *
+ * \param object  Object to update
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror llcache_object_own_source(llcache_object *object)
+{
+	nserror res;
+	uint8_t *data;
+
+	if (object->source_chunk == NULL) {
+		return NSERROR_OK;
+	}
+
+	res = fetch_chunk_steal(object->source_chunk, &data);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	object->source_chunk = NULL;
+	object->source_data = data;
+	object->source_alloc = object->source_len;
+	llcache_object_memtrack(object);
+
+	return NSERROR_OK;
+}
+
 
 /**
  * Handle an authentication request
@@ -2853,6 +3142,65 @@ build_candidate_list(struct llcache_object ***lst_out, int *lst_len_out)
 	return NSERROR_OK;
 }
 
+/**
+ * Determine if an object's source data is worth compressing.
+ *
+ * Textual types compress well whereas most other formats are
+ * already compressed.
+ *
+ * \param object The object to check.
+ * \return true if the object is of a compressible type else false.
+ */
+static bool llcache_object_compressible(const llcache_object *object)
+{
+	static const char *types[] = {
+		"application/javascript",
+		"application/x-javascript",
+		"application/ecmascript",
+		"application/json",
+		"application/xml",
+		"application/xhtml+xml",
+		"image/svg+xml",
+		"image/x-ms-bmp",
+		"image/bmp",
+	};
+	const char *value = NULL;
+	size_t len;
+	size_t i;
+
+	for (i = 0; i < object->num_headers; i++) {
+		if (strcasecmp(object->headers[i].name, "Content-Type") == 0) {
+			value = object->headers[i].value;
+			break;
+		}
+	}
+	if (value == NULL) {
+		return false;
+	}
+
+	/* media type without parameters */
+	value += strspn(value, " \t");
+	len = strcspn(value, " \t;");
+
+	if ((len > 5) && (strncasecmp(value, "text/", 5) == 0)) {
+		return true;
+	}
+	if ((len > 4) && (strncasecmp(value + len - 4, "+xml", 4) == 0)) {
+		return true;
+	}
+	if ((len > 5) && (strncasecmp(value + len - 5, "+json", 5) == 0)) {
+		return true;
+	}
+	for (i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+		if ((strlen(types[i]) == len) &&
+		    (strncasecmp(value, types[i], len) == 0)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /**
  * Write an object to the backing store.
  *
@@ -2874,11 +3222,19 @@ write_backing_store(struct llcache_object *object,
 
 	nsu_getmonotonic_ms(&startms);
 
+	/* the backing store takes ownership of the source buffer */
+	ret = llcache_object_own_source(object);
+	if (ret != NSERROR_OK) {
+		return ret;
+	}
+
 	/* put object data in backing store */
-	ret = guit->llcache->store(object->url,
-				   BACKING_STORE_NONE,
-				   object->source_data,
-				   object->source_len);
+	ret = llcache_backing_store(object->url,
+				    llcache_object_compressible(object) ?
+				    BACKING_STORE_COMPRESSIBLE :
+				    BACKING_STORE_NONE,
+				    object->source_data,
+				    object->source_len);
 	if (ret != NSERROR_OK) {
 		/* unable to put source data in backing store */
 		return ret;
@@ -2893,11 +3249,17 @@ write_backing_store(struct llcache_object *object,
 		return ret;
 	}
 
-	ret = guit->llcache->store(object->url,
-				   BACKING_STORE_META,
-				   metadata,
-				   metadatasize);
-	guit->llcache->release(object->url, BACKING_STORE_META);
+	ret = llcache_backing_store(object->url,
+				    BACKING_STORE_META |
+				    BACKING_STORE_COMPRESSIBLE,
+				    metadata,
+				    metadatasize);
+	if (ret == NSERROR_NOSPACE) {
+		/* the store was too busy to take the metadata */
+		free(metadata);
+	} else {
+		guit->llcache->release(object->url, BACKING_STORE_META);
+	}
 	if (ret != NSERROR_OK) {
 		/* There has been an error putting the metadata in the
 		 * backing store. Ensure the data object is invalidated.
@@ -3075,6 +3437,32 @@ static void llcache_persist(void *p)
 }
 
 
+/**
+ * Pause or resume the fetch of a streamed object.
+ *
+ * Streamed source data is discarded once it has been sent to the
+ * user so holding the fetch while more than a window of data is
+ * waiting bounds memory use by the window rather than the body size.
+ *
+ * \param object The object whose fetch to control
+ */
+static void llcache_fetch_flow_control(llcache_object *object)
+{
+	bool pause;
+
+	if ((object->fetch.fetch == NULL) ||
+	    ((object->fetch.flags & LLCACHE_RETRIEVE_STREAM_DATA) == 0)) {
+		return;
+	}
+
+	pause = (object->source_len >= LLCACHE_STREAM_WINDOW);
+	if ((pause != object->fetch.paused) &&
+	    (fetch_pause(object->fetch.fetch, pause) == NSERROR_OK)) {
+		object->fetch.paused = pause;
+	}
+}
+
+
 /**
  * Handler for fetch events
  *
@@ -3131,6 +3519,13 @@ static void llcache_fetch_callback(const fetch_msg *msg, void *p)
 		error = llcache_fetch_process_data(object,
 				msg->data.header_or_data.buf,
 				msg->data.header_or_data.len);
+		llcache_fetch_flow_control(object);
+		break;
+
+	case FETCH_DATA_CHUNK:
+		/* Received some data in a chunk which may be retained */
+		error = llcache_fetch_process_chunk(object, msg->data.chunk);
+		llcache_fetch_flow_control(object);
 		break;
 
 	case FETCH_FINISHED:
@@ -3142,12 +3537,15 @@ static void llcache_fetch_callback(const fetch_msg *msg, void *p)
 		object->fetch.fetch = NULL;
 
 		/* Shrink source buffer to required size */
-		temp = realloc(object->source_data,
-				object->source_len);
-		/* If source_len is 0, then temp may be NULL */
-		if (temp != NULL || object->source_len == 0) {
-			object->source_data = temp;
-			object->source_alloc = object->source_len;
+		if (object->source_chunk == NULL) {
+			temp = realloc(object->source_data,
+				       object->source_len);
+			/* If source_len is 0, then temp may be NULL */
+			if (temp != NULL || object->source_len == 0) {
+				object->source_data = temp;
+				object->source_alloc = object->source_len;
+				llcache_object_memtrack(object);
+			}
 		}
 
 		llcache_object_cache_update(object);
@@ -3623,6 +4021,7 @@ llcache_object_snapshot(llcache_object *object,	llcache_object **snapshot)
 		}
 		memcpy(newobj->source_data, object->source_data,
 				newobj->source_len);
+		llcache_object_memtrack(newobj);
 	}
 
 	if (object->num_headers > 0) {
@@ -3721,6 +4120,7 @@ static void llcache_catch_up_all_users(void *ignored)
 	for (object = llcache->uncached_objects; object != NULL;
 			object = object->next) {
 		llcache_object_notify_users(object);
+		llcache_fetch_flow_control(object);
 	}
 }
 
@@ -3842,6 +4242,7 @@ void llcache_clean(bool purge)
 			guit->llcache->release(object->url, BACKING_STORE_NONE);
 
 			object->source_data = NULL;
+			llcache_object_memtrack(object);
 
 			llcache_size -=	object->source_len;
 
@@ -3938,6 +4339,39 @@ llcache_initialise(const struct llcache_parameters *prm)
 }
 
 
+/* Exported interface documented in content/llcache.h */
+void llcache_set_limit(size_t limit)
+{
+	if (limit > UINT32_MAX) {
+		limit = UINT32_MAX;
+	}
+	llcache->limit = limit;
+
+	NSLOG(llcache, INFO, "llcache limit now %"PRIu32" bytes",
+	      llcache->limit);
+}
+
+
+/* Exported interface documented in content/llcache.h */
+void llcache_get_stats(struct llcache_stats *stats)
+{
+	llcache_object *object;
+
+	*stats = llcache->stats;
+
+	stats->objects = 0;
+	stats->size = 0;
+	stats->limit = llcache->limit;
+
+	for (object = llcache->cached_objects;
+	     object != NULL;
+	     object = object->next) {
+		stats->objects++;
+		stats->size += total_object_size(object);
+	}
+}
+
+
 /* Exported interface documented in content/llcache.h */
 void llcache_finalise(void)
 {
@@ -4170,6 +4604,21 @@ nserror llcache_handle_release(llcache_handle *handle)
 		}
 	}
 
+	/* Nothing can use the rest of an uncacheable object's data once
+	 * its last user has gone so stop fetching it.
+	 */
+	if ((object->users == NULL) &&
+	    (object->fetch.fetch != NULL) &&
+	    llcache_object_in_list(object, llcache->uncached_objects)) {
+		NSLOG(llcache, DEBUG, "Aborting unused fetch for %p", object);
+
+		fetch_abort(object->fetch.fetch);
+		object->fetch.fetch = NULL;
+		object->fetch.state = LLCACHE_FETCH_COMPLETE;
+
+		llcache_invalidate_cache_control_data(object);
+	}
+
 	return error;
 }
 
@@ -4326,3 +4775,15 @@ bool llcache_handle_references_same_object(const llcache_handle *a,
 {
 	return a->object == b->object;
 }
+
+/* See llcache.h for documentation */
+const void *llcache_handle_get_object_key(const llcache_handle *handle)
+{
+	return handle->object;
+}
+
+/* See llcache.h for documentation */
+bool llcache_handle_is_fresh(const llcache_handle *handle)
+{
+	return llcache_object_is_fresh(handle->object);
+}
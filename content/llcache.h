@@ -60,9 +60,29 @@ enum llcache_retrieve_flag {
 	/**< No error pages */
 	LLCACHE_RETRIEVE_NO_ERROR_PAGES = (1 << 2),
 	/**< Stream data (implies that object is not cacheable) */
-	LLCACHE_RETRIEVE_STREAM_DATA    = (1 << 3)
+	LLCACHE_RETRIEVE_STREAM_DATA    = (1 << 3),
+	/**< Fetch priority class field (see LLCACHE_RETRIEVE_PRIORITY) */
+	LLCACHE_RETRIEVE_PRIORITY_MASK  = (7 << 4)
 };
 
+/** Bit position of the fetch priority class in the retrieval flags */
+#define LLCACHE_RETRIEVE_PRIORITY_SHIFT 4
+
+/**
+ * Retrieval flags requesting a fetch priority class.
+ *
+ * \param p The enum fetch_priority class, the default of zero being
+ *          the top level document class.
+ */
+#define LLCACHE_RETRIEVE_PRIORITY(p) \
+	((((uint32_t)(p)) << LLCACHE_RETRIEVE_PRIORITY_SHIFT) & \
+	 LLCACHE_RETRIEVE_PRIORITY_MASK)
+
+/** Fetch priority class requested by a set of retrieval flags */
+#define LLCACHE_RETRIEVE_GET_PRIORITY(flags) \
+	(((flags) & LLCACHE_RETRIEVE_PRIORITY_MASK) >> \
+	 LLCACHE_RETRIEVE_PRIORITY_SHIFT)
+
 /** Low-level cache event types */
 typedef enum {
 	LLCACHE_EVENT_GOT_CERTS,        /**< SSL certificates arrived */
@@ -177,6 +197,48 @@ void llcache_finalise(void);
  */
 void llcache_clean(bool purge);
 
+/**
+ * Change the target size of the low-level cache
+ *
+ * The new limit is applied by the next cache clean.
+ *
+ * \param limit The new target upper bound for the RAM cache size.
+ */
+void llcache_set_limit(size_t limit);
+
+/** Number of buckets in the backing store latency histograms */
+#define LLCACHE_LATENCY_BUCKETS 12
+
+/**
+ * Low-level cache statistics
+ *
+ * Bucket 0 of the latency histograms counts backing store operations
+ * which took less than 1ms, bucket n those which took less than 2^n ms
+ * and the last bucket all slower operations.
+ */
+struct llcache_stats {
+	unsigned int objects; /**< Number of objects in the cache */
+	size_t size; /**< RAM used by cached objects in bytes */
+	size_t limit; /**< Target upper bound for the RAM cache size */
+
+	unsigned long hit; /**< Retrievals satisfied by a fresh object */
+	unsigned long revalidate; /**< Retrievals requiring validation */
+	unsigned long miss; /**< Retrievals requiring a full fetch */
+	unsigned long uncached; /**< Retrievals which were not cachable */
+
+	/** Backing store read latency histogram */
+	unsigned long fetch_latency[LLCACHE_LATENCY_BUCKETS];
+	/** Backing store write latency histogram */
+	unsigned long store_latency[LLCACHE_LATENCY_BUCKETS];
+};
+
+/**
+ * Retrieve the low-level cache statistics
+ *
+ * \param stats Structure to be filled in with the current statistics.
+ */
+void llcache_get_stats(struct llcache_stats *stats);
+
 /**
  * Retrieve a handle for a low-level cache object
  *
@@ -291,4 +353,26 @@ const char *llcache_handle_get_header(const llcache_handle *handle,
 bool llcache_handle_references_same_object(const llcache_handle *a,
 		const llcache_handle *b);
 
+/**
+ * Retrieve a key identifying the object referenced by a handle
+ *
+ * Handles for which llcache_handle_references_same_object() is true
+ * have equal keys. The key is opaque and must not be dereferenced.
+ *
+ * \param handle  Handle to consider
+ * \return Key for the referenced object
+ */
+const void *llcache_handle_get_object_key(const llcache_handle *handle);
+
+/**
+ * Determine if the object referenced by a handle is still fresh
+ *
+ * A fresh object would be returned by a new retrieval of its URL without
+ * revalidation, so contents built from it may be reused.
+ *
+ * \param handle  Handle to consider
+ * \return True if the object is fresh, false otherwise
+ */
+bool llcache_handle_is_fresh(const llcache_handle *handle);
+
 #endif
@@ -0,0 +1,463 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Memory pressure controller implementation.
+ *
+ * Memory use is sampled from the resident set size of the process and,
+ * on Linux, the cgroup v2 memory controller of the group the process
+ * runs in. The cgroup pressure stall information (PSI) is used as an
+ * early indication that the system as a whole is short of memory.
+ *
+ * Under moderate pressure the cache budgets are halved on every check,
+ * under critical pressure they are reduced to nothing. Each time the
+ * budgets are reduced the caches are shrunk in the order of how cheap
+ * their contents are to recreate: undisplayed image bitmaps first, then
+ * low-level cache source data (written to the backing store before it
+ * is dropped where possible) and finally unused high-level contents.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "netsurf/inttypes.h"
+#include "utils/config.h"
+#include "utils/errors.h"
+#include "utils/log.h"
+#include "netsurf/misc.h"
+#include "desktop/gui_internal.h"
+#include "content/llcache.h"
+#include "content/hlcache.h"
+#include "content/mempressure.h"
+#include "image/image_cache.h"
+
+#ifdef HAVE_LINUX_MEMSTAT
+#include <unistd.h>
+#endif
+
+/** Use of the memory limit at which pressure is moderate (percent) */
+#define MODERATE_USAGE 80
+
+/** Use of the memory limit at which pressure is critical (percent) */
+#define CRITICAL_USAGE 90
+
+/** Use of the memory limit below which budgets are raised (percent) */
+#define RELIEF_USAGE 70
+
+/** Share of time some tasks stalled on memory for moderate pressure */
+#define MODERATE_PSI_SOME 10.0
+
+/** Share of time all tasks stalled on memory for critical pressure */
+#define CRITICAL_PSI_FULL 5.0
+
+/** Share of time some tasks stalled on memory below which budgets are raised */
+#define RELIEF_PSI_SOME 1.0
+
+/** Budget restored on each check without pressure (percent) */
+#define RESTORE_STEP 25
+
+/** Mount point of the cgroup v2 hierarchy */
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+/**
+ * Memory use observed by a single check
+ */
+struct mempressure_sample {
+	/** Highest use of any memory limit (percent) */
+	unsigned int usage;
+
+	/** Ten second average of time some tasks stalled on memory (%) */
+	float some;
+
+	/** Ten second average of time all tasks stalled on memory (%) */
+	float full;
+};
+
+/**
+ * Memory pressure controller state
+ */
+struct mempressure_s {
+	/** Controller parameters */
+	struct mempressure_parameters params;
+
+	/** cgroup directory of the process or NULL if unavailable */
+	char *cgroup;
+
+	/** Percentage of the configured cache budgets in effect */
+	unsigned int scale;
+
+	/** Most recently observed pressure level */
+	enum mempressure_level level;
+};
+
+/** Memory pressure controller context */
+static struct mempressure_s *mempressure = NULL;
+
+
+#ifdef HAVE_LINUX_MEMSTAT
+
+/**
+ * Read a single unsigned value from a file
+ *
+ * \param path The path of the file to read.
+ * \param value Updated with the value read.
+ * \return true if a value was read else false.
+ */
+static bool mempressure_read_value(const char *path, uint64_t *value)
+{
+	FILE *fp;
+	unsigned long long v;
+	int ret;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		return false;
+	}
+
+	ret = fscanf(fp, "%llu", &v);
+	fclose(fp);
+	if (ret != 1) {
+		return false;
+	}
+
+	*value = v;
+	return true;
+}
+
+/**
+ * Find the cgroup v2 directory the process is a member of
+ *
+ * \return The directory path which the caller must free or NULL if the
+ *         process is not in a cgroup v2 hierarchy.
+ */
+static char *mempressure_find_cgroup(void)
+{
+	FILE *fp;
+	char line[4096];
+	char *path = NULL;
+	size_t len;
+
+	fp = fopen("/proc/self/cgroup", "r");
+	if (fp == NULL) {
+		return NULL;
+	}
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		/* the unified hierarchy is listed as "0::<path>" */
+		if (strncmp(line, "0::", 3) != 0) {
+			continue;
+		}
+
+		len = strcspn(line + 3, "\n");
+		path = malloc(sizeof(CGROUP_ROOT) + len);
+		if (path != NULL) {
+			memcpy(path, CGROUP_ROOT, sizeof(CGROUP_ROOT) - 1);
+			memcpy(path + sizeof(CGROUP_ROOT) - 1, line + 3, len);
+			path[sizeof(CGROUP_ROOT) - 1 + len] = '\0';
+		}
+		break;
+	}
+	fclose(fp);
+
+	return path;
+}
+
+/**
+ * Sample the current memory use
+ *
+ * \param sample Updated with the observed memory use.
+ * \return true if any memory information was available else false.
+ */
+static bool mempressure_read_sample(struct mempressure_sample *sample)
+{
+	char path[4096];
+	char line[256];
+	FILE *fp;
+	unsigned long size;
+	unsigned long pages;
+	long page_size;
+	uint64_t current;
+	uint64_t max;
+	float avg10;
+	unsigned int usage;
+	bool available = false;
+
+	memset(sample, 0, sizeof(*sample));
+
+	/* resident set size of the process against the configured limit */
+	if (mempressure->params.limit > 0) {
+		fp = fopen("/proc/self/statm", "r");
+		if (fp != NULL) {
+			page_size = sysconf(_SC_PAGESIZE);
+			if ((fscanf(fp, "%lu %lu", &size, &pages) == 2) &&
+			    (page_size > 0)) {
+				sample->usage = ((uint64_t)pages * page_size *
+						 100) / mempressure->params.limit;
+				available = true;
+			}
+			fclose(fp);
+		}
+	}
+
+	if (mempressure->cgroup == NULL) {
+		return available;
+	}
+
+	/* memory charged to the cgroup against its limit */
+	snprintf(path, sizeof(path), "%s/memory.max", mempressure->cgroup);
+	if (mempressure_read_value(path, &max) && (max > 0)) {
+		snprintf(path, sizeof(path), "%s/memory.current",
+			 mempressure->cgroup);
+		if (mempressure_read_value(path, &current)) {
+			usage = (current * 100) / max;
+			if (usage > sample->usage) {
+				sample->usage = usage;
+			}
+			available = true;
+		}
+	}
+
+	/* pressure stall information for the cgroup */
+	snprintf(path, sizeof(path), "%s/memory.pressure", mempressure->cgroup);
+	fp = fopen(path, "r");
+	if (fp != NULL) {
+		while (fgets(line, sizeof(line), fp) != NULL) {
+			if (sscanf(line, "some avg10=%f", &avg10) == 1) {
+				sample->some = avg10;
+			} else if (sscanf(line, "full avg10=%f", &avg10) == 1) {
+				sample->full = avg10;
+			}
+		}
+		fclose(fp);
+		available = true;
+	}
+
+	return available;
+}
+
+#else
+
+/**
+ * Sample the current memory use
+ *
+ * No memory information is available on this platform.
+ *
+ * \param sample Updated with the observed memory use.
+ * \return false as no memory information is available.
+ */
+static bool mempressure_read_sample(struct mempressure_sample *sample)
+{
+	memset(sample, 0, sizeof(*sample));
+
+	return false;
+}
+
+#endif
+
+
+/**
+ * Determine the pressure level of a sample
+ *
+ * \param sample The memory use sample.
+ * \return The memory pressure level.
+ */
+static enum mempressure_level
+mempressure_assess(const struct mempressure_sample *sample)
+{
+	if ((sample->usage >= CRITICAL_USAGE) ||
+	    (sample->full >= CRITICAL_PSI_FULL)) {
+		return MEMPRESSURE_CRITICAL;
+	}
+
+	if ((sample->usage >= MODERATE_USAGE) ||
+	    (sample->some >= MODERATE_PSI_SOME)) {
+		return MEMPRESSURE_MODERATE;
+	}
+
+	return MEMPRESSURE_NONE;
+}
+
+/**
+ * Compute a cache budget at the current scale
+ *
+ * \param configured The configured cache size.
+ * \return The budget for the cache.
+ */
+static size_t mempressure_budget(size_t configured)
+{
+	return ((uint64_t)configured * mempressure->scale) / 100;
+}
+
+/**
+ * Reduce the cache budgets and shrink the caches to fit
+ *
+ * \param scale The percentage of the configured budgets to allow.
+ */
+static void mempressure_shrink(unsigned int scale)
+{
+	size_t released;
+
+	mempressure->scale = scale;
+
+	/* bitmaps not on screen are regenerated from the source data */
+	image_cache_set_limit(mempressure_budget(mempressure->params.image_cache_limit));
+	released = image_cache_release_undisplayed();
+
+	/* write source data to the backing store and drop it from memory */
+	llcache_set_limit(mempressure_budget(mempressure->params.llcache_limit));
+	llcache_clean(false);
+
+	/* unused contents are the most costly to recreate so go last */
+	hlcache_set_limit(mempressure_budget(mempressure->params.hlcache_limit));
+
+	NSLOG(netsurf, INFO,
+	      "Cache budgets reduced to %u%%, released %"PRIsizet" bytes of bitmaps",
+	      scale, released);
+}
+
+/**
+ * Raise the cache budgets
+ *
+ * \param scale The percentage of the configured budgets to allow.
+ */
+static void mempressure_restore(unsigned int scale)
+{
+	if (scale > 100) {
+		scale = 100;
+	}
+	mempressure->scale = scale;
+
+	image_cache_set_limit(mempressure_budget(mempressure->params.image_cache_limit));
+	llcache_set_limit(mempressure_budget(mempressure->params.llcache_limit));
+	hlcache_set_limit(mempressure_budget(mempressure->params.hlcache_limit));
+
+	NSLOG(netsurf, INFO, "Cache budgets raised to %u%%", scale);
+}
+
+/**
+ * Memory pressure check scheduled callback
+ *
+ * \param p The memory pressure controller context.
+ */
+static void mempressure_poll(void *p)
+{
+	struct mempressure_s *mp = p;
+	struct mempressure_sample sample;
+	enum mempressure_level level;
+
+	mempressure_read_sample(&sample);
+	level = mempressure_assess(&sample);
+
+	if (level != mp->level) {
+		NSLOG(netsurf, INFO,
+		      "Memory pressure level %d usage %u%% stalled some %.2f%% full %.2f%%",
+		      level, sample.usage, sample.some, sample.full);
+		mp->level = level;
+	}
+
+	switch (level) {
+	case MEMPRESSURE_CRITICAL:
+		mempressure_shrink(0);
+		break;
+
+	case MEMPRESSURE_MODERATE:
+		mempressure_shrink(mp->scale / 2);
+		break;
+
+	case MEMPRESSURE_NONE:
+		/* only raise budgets once well clear of the thresholds */
+		if ((mp->scale < 100) &&
+		    (sample.usage < RELIEF_USAGE) &&
+		    (sample.some < RELIEF_PSI_SOME)) {
+			mempressure_restore(mp->scale + RESTORE_STEP);
+		}
+		break;
+	}
+
+	guit->misc->schedule(mp->params.interval, mempressure_poll, mp);
+}
+
+
+/* exported interface documented in content/mempressure.h */
+nserror mempressure_init(const struct mempressure_parameters *parameters)
+{
+	struct mempressure_sample sample;
+
+	if (parameters->interval == 0) {
+		NSLOG(netsurf, INFO, "Memory pressure checks disabled");
+		return NSERROR_OK;
+	}
+
+	mempressure = calloc(1, sizeof(struct mempressure_s));
+	if (mempressure == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	mempressure->params = *parameters;
+	mempressure->scale = 100;
+	mempressure->level = MEMPRESSURE_NONE;
+#ifdef HAVE_LINUX_MEMSTAT
+	mempressure->cgroup = mempressure_find_cgroup();
+#endif
+
+	if (mempressure_read_sample(&sample) == false) {
+		NSLOG(netsurf, INFO, "No memory pressure information available");
+		free(mempressure->cgroup);
+		free(mempressure);
+		mempressure = NULL;
+		return NSERROR_OK;
+	}
+
+	NSLOG(netsurf, INFO, "Memory pressure checked every %ums (cgroup %s)",
+	      mempressure->params.interval,
+	      mempressure->cgroup != NULL ? mempressure->cgroup : "none");
+
+	guit->misc->schedule(mempressure->params.interval,
+			     mempressure_poll,
+			     mempressure);
+
+	return NSERROR_OK;
+}
+
+/* exported interface documented in content/mempressure.h */
+void mempressure_fini(void)
+{
+	if (mempressure == NULL) {
+		return;
+	}
+
+	guit->misc->schedule(-1, mempressure_poll, mempressure);
+
+	free(mempressure->cgroup);
+	free(mempressure);
+	mempressure = NULL;
+}
+
+/* exported interface documented in content/mempressure.h */
+enum mempressure_level mempressure_get_level(void)
+{
+	if (mempressure == NULL) {
+		return MEMPRESSURE_NONE;
+	}
+
+	return mempressure->level;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Memory pressure controller interface.
+ *
+ * The controller periodically samples the memory use of the browser
+ * and, when the system is short of memory, shrinks the budgets of the
+ * image cache, low-level cache and high-level cache in that order. The
+ * budgets are raised back towards their configured sizes once memory
+ * is available again.
+ */
+
+#ifndef NETSURF_CONTENT_MEMPRESSURE_H
+#define NETSURF_CONTENT_MEMPRESSURE_H
+
+#include <stddef.h>
+
+#include "utils/errors.h"
+
+/**
+ * Memory pressure levels
+ */
+enum mempressure_level {
+	MEMPRESSURE_NONE, /**< Memory is available */
+	MEMPRESSURE_MODERATE, /**< Memory is getting short */
+	MEMPRESSURE_CRITICAL, /**< Memory is almost exhausted */
+};
+
+/**
+ * Memory pressure controller parameters
+ */
+struct mempressure_parameters {
+	/** Time between memory pressure checks (ms), 0 disables checks */
+	unsigned int interval;
+
+	/** Resident size above which caches are shrunk, 0 for no limit */
+	size_t limit;
+
+	/** Configured image cache size limit */
+	size_t image_cache_limit;
+
+	/** Configured low-level cache size limit */
+	size_t llcache_limit;
+
+	/** Configured high-level cache retained contents limit */
+	size_t hlcache_limit;
+};
+
+/**
+ * Initialise the memory pressure controller
+ *
+ * Must be called after the image cache and high-level cache have been
+ * initialised.
+ *
+ * \param parameters The controller parameters.
+ * \return NSERROR_OK on success else error code.
+ */
+nserror mempressure_init(const struct mempressure_parameters *parameters);
+
+/**
+ * Finalise the memory pressure controller
+ */
+void mempressure_fini(void);
+
+/**
+ * Get the most recently observed memory pressure level
+ *
+ * \return The memory pressure level.
+ */
+enum mempressure_level mempressure_get_level(void);
+
+#endif
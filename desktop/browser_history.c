@@ -30,12 +30,16 @@
 
 #include "utils/log.h"
 #include "utils/utils.h"
+#include "utils/nsoption.h"
+#include "netsurf/inttypes.h"
 #include "netsurf/layout.h"
 #include "netsurf/content.h"
 #include "netsurf/window.h"
 #include "netsurf/browser_window.h"
 #include "content/hlcache.h"
 #include "content/urldb.h"
+#include "netsurf/ssl_certs.h"
+#include "html/html.h"
 #include "netsurf/bitmap.h"
 #include "utils/corestrings.h"
 
@@ -44,6 +48,112 @@
 #include "desktop/local_history_private.h"
 #include "desktop/browser_history.h"
 
+/**
+ * The DOM and box tree of a parked document are not measured; they are
+ * estimated as this multiple of the source they were built from.
+ */
+#define PARKED_DOCUMENT_EXPANSION 4
+
+/** Documents parked across all windows, in order of parking */
+static struct {
+	struct history_entry *newest; /**< Most recently parked entry */
+	struct history_entry *oldest; /**< Least recently parked entry */
+	size_t size; /**< Estimated memory held by all parked documents */
+} history_parked;
+
+
+/**
+ * Ignore events from a parked content
+ *
+ * A parked content is complete and closed so there is nothing to act on.
+ */
+static nserror
+browser_window_history__parked_callback(struct hlcache_handle *handle,
+					const hlcache_event *event,
+					void *pw)
+{
+	return NSERROR_OK;
+}
+
+
+/**
+ * Estimate the memory a parked document holds
+ *
+ * \param content The document content
+ * \return Estimated size in bytes
+ */
+static size_t browser_window_history__parked_size(struct hlcache_handle *content)
+{
+	struct content_html_object *object;
+	unsigned int count;
+	size_t size = 0;
+	size_t total;
+
+	content_get_source_data(content, &size);
+	total = size * PARKED_DOCUMENT_EXPANSION;
+
+	for (object = html_get_objects(content, &count);
+	     object != NULL;
+	     object = object->next) {
+		if (object->content != NULL) {
+			content_get_source_data(object->content, &size);
+			total += size;
+		}
+	}
+
+	return total;
+}
+
+
+/**
+ * Remove an entry from the parked document list
+ *
+ * \param entry The entry to unlink
+ */
+static void browser_window_history__unlink_parked(struct history_entry *entry)
+{
+	if (entry->parked.newer != NULL) {
+		entry->parked.newer->parked.older = entry->parked.older;
+	} else {
+		history_parked.newest = entry->parked.older;
+	}
+	if (entry->parked.older != NULL) {
+		entry->parked.older->parked.newer = entry->parked.newer;
+	} else {
+		history_parked.oldest = entry->parked.newer;
+	}
+	entry->parked.newer = entry->parked.older = NULL;
+
+	history_parked.size -= entry->parked.size;
+	entry->parked.size = 0;
+}
+
+
+/**
+ * Release a document parked in an entry
+ *
+ * \param entry The entry to release the parked document of
+ */
+static void browser_window_history__release_parked(struct history_entry *entry)
+{
+	if (entry->parked.content == NULL) {
+		return;
+	}
+
+	NSLOG(netsurf, DEBUG, "Releasing parked document for %s",
+	      nsurl_access(entry->page.url));
+
+	browser_window_history__unlink_parked(entry);
+
+	hlcache_handle_release(entry->parked.content);
+	entry->parked.content = NULL;
+
+	if (entry->parked.certs != NULL) {
+		cert_chain_free(entry->parked.certs);
+		entry->parked.certs = NULL;
+	}
+}
+
 /**
  * Clone a history entry
  *
@@ -171,6 +281,8 @@ static void browser_window_history__free_entry(struct history_entry *entry)
 		browser_window_history__free_entry(entry->forward);
 		browser_window_history__free_entry(entry->next);
 
+		browser_window_history__release_parked(entry);
+
 		nsurl_unref(entry->page.url);
 		if (entry->page.frag_id) {
 			lwc_string_unref(entry->page.frag_id);
@@ -333,6 +445,7 @@ nserror browser_window_history_clone(const struct browser_window *existing,
 
 	clone->history = new_history;
 	memcpy(new_history, existing->history, sizeof *new_history);
+	new_history->displayed = NULL;
 
 	new_history->start = browser_window_history__clone_entry(new_history,
 			new_history->start);
@@ -381,6 +494,7 @@ browser_window_history_add(struct browser_window *bw,
 	entry->page.title = title;
 	entry->page.scroll_x = 0.0f;
 	entry->page.scroll_y = 0.0f;
+	memset(&entry->parked, 0, sizeof(entry->parked));
 
 	/* create thumbnail for localhistory view */
 	NSLOG(netsurf, DEBUG,
@@ -514,6 +628,84 @@ void browser_window_history_destroy(struct browser_window *bw)
 
 
 
+/* exported interface documented in desktop/browser_private.h */
+bool browser_window_history_park(struct history_entry *entry,
+		struct hlcache_handle *content, struct cert_chain *certs)
+{
+	size_t limit;
+	size_t size;
+
+	assert(entry->parked.content == NULL);
+
+	if (nsoption_int(bfcache_size) <= 0) {
+		return false;
+	}
+	limit = nsoption_int(bfcache_size);
+
+	/* Only park the document the entry was created for */
+	if (!nsurl_compare(entry->page.url,
+			   hlcache_handle_get_url(content),
+			   NSURL_COMPLETE)) {
+		return false;
+	}
+
+	/* Scripted and incomplete documents cannot be resumed */
+	if (content_get_type(content) != CONTENT_HTML ||
+	    !html_can_park(content)) {
+		return false;
+	}
+
+	size = browser_window_history__parked_size(content);
+	if (size > limit) {
+		return false;
+	}
+
+	/* Evict the least recently parked documents to make room */
+	while (history_parked.oldest != NULL &&
+	       history_parked.size + size > limit) {
+		browser_window_history__release_parked(history_parked.oldest);
+	}
+
+	hlcache_handle_replace_callback(content,
+			browser_window_history__parked_callback, NULL);
+
+	entry->parked.content = content;
+	entry->parked.certs = certs;
+	entry->parked.size = size;
+	entry->parked.newer = NULL;
+	entry->parked.older = history_parked.newest;
+	if (history_parked.newest != NULL) {
+		history_parked.newest->parked.newer = entry;
+	} else {
+		history_parked.oldest = entry;
+	}
+	history_parked.newest = entry;
+	history_parked.size += size;
+
+	NSLOG(netsurf, INFO, "Parked %s (%"PRIsizet" bytes, %"PRIsizet" total)",
+	      nsurl_access(entry->page.url), size, history_parked.size);
+
+	return true;
+}
+
+
+/* exported interface documented in desktop/browser_private.h */
+struct hlcache_handle *browser_window_history_unpark(
+		struct history_entry *entry, struct cert_chain **certs)
+{
+	struct hlcache_handle *content = entry->parked.content;
+
+	if (content != NULL) {
+		browser_window_history__unlink_parked(entry);
+		*certs = entry->parked.certs;
+		entry->parked.content = NULL;
+		entry->parked.certs = NULL;
+	}
+
+	return content;
+}
+
+
 /* exported interface documented in desktop/browser_history.h */
 nserror browser_window_history_back(struct browser_window *bw, bool new_window)
 {
@@ -630,9 +822,14 @@ nserror browser_window_history_go(struct browser_window *bw,
 			browser_window_history_update(bw, bw->current_content);
 		}
 		history->current = entry;
-		error = browser_window_navigate(bw, url, NULL,
-				BW_NAVIGATE_NO_TERMINAL_HISTORY_UPDATE,
-				NULL, NULL, NULL);
+		if (entry->parked.content != NULL) {
+			/* Document is still laid out, display it directly */
+			error = browser_window__restore_parked(bw, entry);
+		} else {
+			error = browser_window_navigate(bw, url, NULL,
+					BW_NAVIGATE_NO_TERMINAL_HISTORY_UPDATE,
+					NULL, NULL, NULL);
+		}
 	}
 
 	nsurl_unref(url);
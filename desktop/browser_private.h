@@ -29,6 +29,7 @@
 #include "desktop/frame_types.h"
 
 struct box;
+struct cert_chain;
 struct hlcache_handle;
 struct gui_window;
 struct selection;
@@ -46,11 +47,23 @@ struct history_page {
 	float scroll_y; /**< Scroll Y offset when visited */
 };
 
+/**
+ * Document parked in a history entry for back and forward navigation
+ */
+struct history_parked {
+	struct hlcache_handle *content; /**< Closed content, or NULL. */
+	struct cert_chain *certs; /**< Certificate chain of content, or NULL. */
+	size_t size; /**< Estimated memory held by content. */
+	struct history_entry *newer; /**< More recently parked entry. */
+	struct history_entry *older; /**< Less recently parked entry. */
+};
+
 /**
  * A node in the history tree.
  */
 struct history_entry {
 	struct history_page page;
+	struct history_parked parked; /**< Parked document, if any. */
 	struct history_entry *back;  /**< Parent. */
 	struct history_entry *next;  /**< Next sibling. */
 	struct history_entry *forward;  /**< First child. */
@@ -70,6 +83,8 @@ struct history {
 	struct history_entry *start;
 	/** Current position in tree. */
 	struct history_entry *current;
+	/** Entry whose document is displayed, or NULL if not from history. */
+	struct history_entry *displayed;
 	/** Width of layout. */
 	int width;
 	/** Height of layout. */
@@ -163,6 +178,9 @@ struct browser_window {
 	/** Internal navigation, do not update URL etc */
 	bool internal_nav;
 
+	/** Phase times of the most recent page load */
+	struct browser_window_load_times load_times;
+
 	/** Fragment identifier for current_content. */
 	lwc_string *frag_id;
 
@@ -417,4 +435,39 @@ typedef nserror (*browser_window_query_callback)(bool proceed, void *pw);
  */
 nserror browser_window__reload_current_parameters(struct browser_window *bw);
 
+/**
+ * Park a document in a history entry for back and forward navigation
+ *
+ * The content must already have been closed.  Parked documents are
+ * released when the memory budget is exceeded or the history is
+ * destroyed.
+ *
+ * \param entry    The history entry the document was displayed for
+ * \param content  The content to park
+ * \param certs    The certificate chain for the content, or NULL
+ * \return true if the entry took ownership of content and certs, else false
+ */
+bool browser_window_history_park(struct history_entry *entry,
+		struct hlcache_handle *content, struct cert_chain *certs);
+
+/**
+ * Take back a document parked in a history entry
+ *
+ * \param entry  The history entry to take the document from
+ * \param certs  Updated with the document's certificate chain, or NULL
+ * \return The parked content, owned by the caller, or NULL if none
+ */
+struct hlcache_handle *browser_window_history_unpark(
+		struct history_entry *entry, struct cert_chain **certs);
+
+/**
+ * Display a document parked in a history entry
+ *
+ * \param bw     The browser window to display the document in
+ * \param entry  The history entry, which must hold a parked document
+ * \return NSERROR_OK or error code on faliure.
+ */
+nserror browser_window__restore_parked(struct browser_window *bw,
+		struct history_entry *entry);
+
 #endif
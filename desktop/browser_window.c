@@ -44,6 +44,7 @@
 #include "netsurf/search.h"
 #include "netsurf/plotters.h"
 #include "content/content.h"
+#include "content/fetch.h"
 #include "content/hlcache.h"
 #include "content/urldb.h"
 #include "content/content_debug.h"
@@ -594,7 +595,9 @@ browser_window_update_favicon(hlcache_handle *c,
 	}
 
 	res = hlcache_handle_retrieve(nsurl,
-				      HLCACHE_RETRIEVE_SNIFF_TYPE,
+				      HLCACHE_RETRIEVE_SNIFF_TYPE |
+				      LLCACHE_RETRIEVE_PRIORITY(
+					      FETCH_PRIORITY_DEFERRED),
 				      nsref,
 				      NULL,
 				      browser_window_favicon_callback,
@@ -903,6 +906,40 @@ static void browser_window_update(struct browser_window *bw, bool scroll_to_top)
 }
 
 
+/**
+ * Close and release the current window content
+ *
+ * When the window is moving to a different history entry the content
+ * is parked in the entry it was displayed for, so that back and forward
+ * navigation can redisplay it without rebuilding it.
+ *
+ * \param bw       browser window
+ * \param leaving  true if the new document belongs to a different entry
+ */
+static void
+browser_window__close_current(struct browser_window *bw, bool leaving)
+{
+	struct history_entry *entry = NULL;
+
+	content_close(bw->current_content);
+
+	if (leaving && bw->history != NULL) {
+		entry = bw->history->displayed;
+	}
+
+	if ((entry != NULL) &&
+	    browser_window_history_park(entry,
+					bw->current_content,
+					bw->current_cert_chain)) {
+		bw->current_cert_chain = NULL;
+	} else {
+		hlcache_handle_release(bw->current_content);
+	}
+
+	bw->current_content = NULL;
+}
+
+
 /**
  * handle message for content ready on browser window
  */
@@ -913,8 +950,11 @@ static nserror browser_window_content_ready(struct browser_window *bw)
 
 	/* close and release the current window content */
 	if (bw->current_content != NULL) {
-		content_close(bw->current_content);
-		hlcache_handle_release(bw->current_content);
+		browser_window__close_current(bw,
+			!bw->internal_nav &&
+			bw->history != NULL &&
+			(bw->history_add ||
+			 bw->history->displayed != bw->history->current));
 	}
 
 	bw->current_content = bw->loading_content;
@@ -936,6 +976,7 @@ static nserror browser_window_content_ready(struct browser_window *bw)
 	width /= bw->scale;
 	height /= bw->scale;
 	content_reformat(bw->current_content, false, width, height);
+	nsu_getmonotonic_ms(&bw->load_times.layout);
 
 	/* history */
 	if (bw->history_add && bw->history && !bw->internal_nav) {
@@ -977,6 +1018,11 @@ static nserror browser_window_content_ready(struct browser_window *bw)
 		browser_window_history_add(bw, bw->current_content, bw->frag_id);
 	}
 
+	if (bw->history != NULL) {
+		bw->history->displayed =
+			bw->internal_nav ? NULL : bw->history->current;
+	}
+
 	browser_window_remove_caret(bw, false);
 
 	if (bw->window != NULL) {
@@ -1639,17 +1685,20 @@ browser_window_callback(hlcache_handle *c, const hlcache_event *event, void *pw)
 			browser_window_set_status(bw,
 						  content_get_status_message(c));
 		}
+		nsu_getmonotonic_ms(&bw->load_times.fetch);
 		break;
 
 	case CONTENT_MSG_READY:
 		assert(bw->loading_content == c);
 
+		nsu_getmonotonic_ms(&bw->load_times.convert);
 		res = browser_window_content_ready(bw);
 		break;
 
 	case CONTENT_MSG_DONE:
 		assert(bw->current_content == c);
 
+		nsu_getmonotonic_ms(&bw->load_times.done);
 		res = browser_window_content_done(bw);
 		break;
 
@@ -2749,6 +2798,7 @@ browser_window_redraw(struct browser_window *bw,
 	content_type content_type;
 	struct content_redraw_data data;
 	struct rect content_clip;
+	uint64_t redraw_start = 0;
 	nserror res;
 
 	if (bw == NULL) {
@@ -2877,10 +2927,21 @@ browser_window_redraw(struct browser_window *bw,
 		if (y1 < content_clip.y1) content_clip.y1 = y1;
 	}
 
+	/* Time the first redraw after layout, excluding whatever the
+	 * frontend did before asking for it */
+	if ((bw->load_times.layout != 0) && (bw->load_times.redraw == 0)) {
+		nsu_getmonotonic_ms(&redraw_start);
+	}
+
 	/* Render the content */
 	plot_ok &= content_redraw(bw->current_content, &data,
 				  &content_clip, &new_ctx);
 
+	if (redraw_start != 0) {
+		bw->load_times.redraw_start = redraw_start;
+		nsu_getmonotonic_ms(&bw->load_times.redraw);
+	}
+
 	/* Back to full clip rect */
 	new_ctx.plot->clip(&new_ctx, clip);
 
@@ -3750,6 +3811,9 @@ navigate_internal_real(struct browser_window *bw,
 	browser_window_set_status(bw, messages_get("Loading"));
 	bw->history_add = (params->flags & BW_NAVIGATE_HISTORY);
 
+	memset(&bw->load_times, 0, sizeof(bw->load_times));
+	nsu_getmonotonic_ms(&bw->load_times.start);
+
 	/* Verifiable fetches may trigger a download */
 	if (!(params->flags & BW_NAVIGATE_UNVERIFIABLE)) {
 		fetch_flags |= HLCACHE_RETRIEVE_MAY_DOWNLOAD;
@@ -4871,6 +4935,96 @@ browser_window__reload_current_parameters(struct browser_window *bw)
 	return browser_window__navigate_internal(bw, &bw->loading_parameters);
 }
 
+/* exported interface documented in desktop/browser_private.h */
+nserror
+browser_window__restore_parked(struct browser_window *bw,
+			       struct history_entry *entry)
+{
+	struct hlcache_handle *content;
+	struct cert_chain *certs = NULL;
+	struct rect rect;
+	int width, height;
+	nserror res;
+
+	content = browser_window_history_unpark(entry, &certs);
+	if (content == NULL) {
+		return NSERROR_INVALID;
+	}
+
+	NSLOG(netsurf, INFO, "bw %p, restoring parked %s", bw,
+	      nsurl_access(hlcache_handle_get_url(content)));
+
+	browser_window_stop(bw);
+	browser_window_remove_caret(bw, false);
+	browser_window_destroy_children(bw);
+	browser_window_destroy_iframes(bw);
+
+	if (bw->current_content != NULL) {
+		browser_window__close_current(bw, true);
+	}
+
+	hlcache_handle_replace_callback(content, browser_window_callback, bw);
+	bw->current_content = content;
+	bw->internal_nav = false;
+	bw->history->displayed = entry;
+
+	/* The parameters of the original fetch were not kept */
+	browser_window__free_fetch_parameters(&bw->current_parameters);
+	bw->current_parameters.url = nsurl_ref(hlcache_handle_get_url(content));
+	bw->current_parameters.flags = BW_NAVIGATE_HISTORY;
+	cert_chain_free(bw->current_cert_chain);
+	bw->current_cert_chain = certs;
+
+	if (bw->frag_id != NULL) {
+		lwc_string_unref(bw->frag_id);
+	}
+	bw->frag_id = NULL;
+	if (entry->page.frag_id != NULL) {
+		bw->frag_id = lwc_string_ref(entry->page.frag_id);
+	}
+
+	/* Only lay the document out again if the window has changed size */
+	browser_window_get_dimensions(bw, &width, &height);
+	width /= bw->scale;
+	height /= bw->scale;
+	if (content_get_available_width(content) != width) {
+		content_reformat(content, false, width, height);
+	}
+
+	if (bw->window != NULL) {
+		guit->window->event(bw->window, GW_EVENT_NEW_CONTENT);
+
+		browser_window_refresh_url_bar(bw);
+	}
+
+	browser_window_update(bw, false);
+	content_open(content, bw, 0, 0);
+
+	/* Return to where the user was on the page */
+	rect.x0 = rect.x1 = (int)((float)content_get_width(content) *
+				  entry->page.scroll_x);
+	rect.y0 = rect.y1 = (int)((float)content_get_height(content) *
+				  entry->page.scroll_y);
+	if (browser_window_set_scroll(bw, &rect) != NSERROR_OK) {
+		NSLOG(netsurf, WARNING,
+		      "Unable to set browser scroll offsets to %d by %d",
+		      rect.x0, rect.y0);
+	}
+
+	browser_window_set_status(bw, content_get_status_message(content));
+	browser_window_update_favicon(content, bw, NULL);
+
+	res = browser_window_create_iframes(bw);
+
+	if (res == NSERROR_OK) {
+		struct browser_window *root = browser_window_get_root(bw);
+		res = guit->window->event(root->window,
+					  GW_EVENT_PAGE_INFO_CHANGE);
+	}
+
+	return res;
+}
+
 /* Exported interface, documented in browser_window.h */
 browser_window_page_info_state browser_window_get_page_info_state(
 		const struct browser_window *bw)
@@ -5013,3 +5167,17 @@ nserror browser_window_show_certificates(struct browser_window *bw)
 
 	return res;
 }
+
+/* Exported interface, documented in browser_window.h */
+nserror
+browser_window_get_load_times(const struct browser_window *bw,
+			      struct browser_window_load_times *times)
+{
+	if (bw == NULL) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	*times = bw->load_times;
+
+	return NSERROR_OK;
+}
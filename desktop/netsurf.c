@@ -40,6 +40,7 @@
 #include "content/content_factory.h"
 #include "content/fetchers.h"
 #include "content/hlcache.h"
+#include "content/mempressure.h"
 #include "content/mimesniff.h"
 #include "content/urldb.h"
 #include "css/css.h"
@@ -120,6 +121,9 @@ nserror netsurf_init(const char *store_path)
 		.bg_clean_time = IMAGE_CACHE_CLEAN_TIME,
 		.speculative_small = SPECULATE_SMALL
 	};
+	struct mempressure_parameters mempressure_parameters = {
+		.interval = nsoption_uint(memory_pressure_interval)
+	};
 	
 #ifdef HAVE_SIGPIPE
 	/* Ignore SIGPIPE - this is necessary as OpenSSL can generate these
@@ -148,6 +152,11 @@ nserror netsurf_init(const char *store_path)
 		      hlcache_parameters.llcache.limit);
 	} 
 
+	/* unused converted contents are retained up to their own limit */
+	if (nsoption_int(content_cache_size) > 0) {
+		hlcache_parameters.limit = nsoption_int(content_cache_size);
+	}
+
 	/* Set up the max attempts made to fetch a timing out resource */
 	hlcache_parameters.llcache.fetch_attempts = nsoption_uint(max_retried_fetches);
 
@@ -196,6 +205,15 @@ nserror netsurf_init(const char *store_path)
 		return ret;
 	/* Initialise the hlcache and allow it to init the llcache for us */
 	ret = hlcache_initialise(&hlcache_parameters);
+	if (ret != NSERROR_OK)
+		return ret;
+
+	/* shrink the caches when the system is short of memory */
+	mempressure_parameters.limit = nsoption_int(memory_pressure_limit);
+	mempressure_parameters.image_cache_limit = image_cache_parameters.limit;
+	mempressure_parameters.llcache_limit = hlcache_parameters.llcache.limit;
+	mempressure_parameters.hlcache_limit = hlcache_parameters.limit;
+	ret = mempressure_init(&mempressure_parameters);
 	if (ret != NSERROR_OK)
 		return ret;
 	/* Initialize system colours */
@@ -217,6 +235,7 @@ nserror netsurf_init(const char *store_path)
 
 void netsurf_exit(void)
 {
+	mempressure_fini();
 	hlcache_stop();
 	
 	NSLOG(netsurf, INFO, "Closing GUI");
@@ -92,6 +92,18 @@ NSOPTION_STRING(accept_charset, NULL)
 /** Preferred maximum size of memory cache / bytes. */
 NSOPTION_INTEGER(memory_cache_size, 12 * 1024 * 1024)
 
+/** Preferred maximum size of unused converted contents kept for reuse / bytes. */
+NSOPTION_INTEGER(content_cache_size, 4 * 1024 * 1024)
+
+/** Memory budget for documents kept for back and forward navigation / bytes. */
+NSOPTION_INTEGER(bfcache_size, 16 * 1024 * 1024)
+
+/** Interval between memory pressure checks / ms, 0 disables them. */
+NSOPTION_UINT(memory_pressure_interval, 2000)
+
+/** Resident size above which caches are shrunk / bytes, 0 for no limit. */
+NSOPTION_INTEGER(memory_pressure_limit, 0)
+
 /** Preferred location of disc cache, or NULL for system provided location */
 NSOPTION_STRING(disc_cache_path, NULL)
 
@@ -205,12 +217,29 @@ NSOPTION_INTEGER(max_fetchers, 24)
  */
 NSOPTION_INTEGER(max_fetchers_per_host, 5)
 
+/** Negotiate HTTP/2 on secure connections and multiplex the fetches
+ * to a host over a single connection. Only effective when built with
+ * NETSURF_USE_CURL_HTTP2.
+ */
+NSOPTION_BOOL(http2, false)
+
+/** Maximum simultaneous fetches per host once the host is known to
+ * multiplex them over one HTTP/2 connection. Replaces
+ * option_max_fetchers_per_host for such hosts.
+ */
+NSOPTION_INTEGER(max_streams_per_host, 32)
+
 /** Maximum number of inactive fetchers cached.  The total number of
  * handles netsurf will therefore have open is this plus
  * option_max_fetchers.
  */
 NSOPTION_INTEGER(max_cached_fetch_handles, 6)
 
+/** Number of most visited hosts to connect to speculatively at startup.
+ * Zero disables the speculative connections.
+ */
+NSOPTION_INTEGER(preconnect_hosts, 0)
+
 /** Number of times to retry timed-out fetches before giving up. */
 NSOPTION_UINT(max_retried_fetches, 1)
 
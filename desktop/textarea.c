@@ -44,6 +44,9 @@
 #define CARET_COLOR 0x0000FF
 #define TA_ALLOC_STEP 512
 
+/** Modification end passed to reflow when all following lines may change */
+#define TA_REFLOW_ALL SIZE_MAX
+
 static plot_style_t pstyle_stroke_caret = {
 	.stroke_type = PLOT_OP_TYPE_SOLID,
 	.stroke_colour = CARET_COLOR,
@@ -206,6 +209,33 @@ static void textarea_normalise_text(struct textarea *ta,
 }
 
 
+/**
+ * Find the line containing a byte offset
+ *
+ * Line start offsets increase monotonically so this is a binary search.
+ *
+ * \param ta		Text area
+ * \param b_off	0-based byte offset in ta->show
+ * \return 0-based index of the last line starting at or before b_off
+ */
+static int textarea_find_line(struct textarea *ta, size_t b_off)
+{
+	int lo = 0;
+	int hi = ta->line_count - 1;
+	int mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo + 1) / 2;
+		if (ta->lines[mid].b_start > b_off)
+			hi = mid - 1;
+		else
+			lo = mid;
+	}
+
+	return lo;
+}
+
+
 /**
  * Reset the selection (no redraw)
  *
@@ -390,9 +420,7 @@ static bool textarea_set_caret_internal(struct textarea *ta, int caret_b)
 		b_off = caret_b;
 
 		/* Now find line in which byte offset appears */
-		for (i = 0; i < ta->line_count - 1; i++)
-			if (ta->lines[i + 1].b_start > b_off)
-				break;
+		i = textarea_find_line(ta, b_off);
 
 		/* Set new caret pos */
 		ta->caret_pos.line = i;
@@ -537,7 +565,7 @@ static bool textarea_select(struct textarea *ta, int b_start, int b_end,
 	} else {
 		/* Try to minimise redraw region */
 		unsigned int b_low, b_high;
-		int line_start = 0, line_end = 0;
+		int line_start, line_end;
 
 		if (!pre_existing_selection) {
 			/* There's a new selection */
@@ -573,14 +601,8 @@ static bool textarea_select(struct textarea *ta, int b_start, int b_end,
 		}
 
 		/* Find redraw start/end lines */
-		for (line_end = 0; line_end < ta->line_count - 1; line_end++)
-			if (ta->lines[line_end + 1].b_start > b_low) {
-				line_start = line_end;
-				break;
-			}
-		for (; line_end < ta->line_count - 1; line_end++)
-			if (ta->lines[line_end + 1].b_start > b_high)
-				break;
+		line_start = textarea_find_line(ta, b_low);
+		line_end = textarea_find_line(ta, b_high);
 
 		/* Set vertical redraw range */
 		msg.data.redraw.y0 = max(ta->border_width,
@@ -904,17 +926,70 @@ static bool textarea_reflow_singleline(struct textarea *ta, size_t b_off,
 
 
 
+/**
+ * Ensure there is room in a textarea's line info for reflowed lines
+ *
+ * The unaffected lines which follow the reflowed ones are kept at the
+ * end of the line info array while reflowing so that they are not
+ * overwritten.
+ *
+ * \param ta		Textarea
+ * \param needed	Number of lines required before the unaffected lines
+ * \param tail_base	Index of the unaffected lines, updated if moved
+ * \param tail_count	Number of unaffected lines
+ * \return true on success false on memory exhaustion
+ */
+static bool textarea_reserve_lines(struct textarea *ta, unsigned int needed,
+		unsigned int *tail_base, unsigned int tail_count)
+{
+	unsigned int alloc = ta->lines_alloc_size;
+
+	if (needed + tail_count > alloc) {
+		struct line_info *temp;
+
+		alloc = needed + tail_count + LINE_CHUNK_SIZE;
+		temp = realloc(ta->lines, alloc * sizeof(struct line_info));
+		if (temp == NULL) {
+			NSLOG(netsurf, INFO, "realloc failed");
+			return false;
+		}
+
+		ta->lines = temp;
+		ta->lines_alloc_size = alloc;
+	}
+
+	if (tail_count > 0 && *tail_base != alloc - tail_count) {
+		memmove(ta->lines + alloc - tail_count, ta->lines + *tail_base,
+				tail_count * sizeof(struct line_info));
+		*tail_base = alloc - tail_count;
+	}
+
+	return true;
+}
+
+
 /**
  * Reflow a multiline textarea from the given line onwards
  *
+ * Paragraphs are wrapped independently, so lines of paragraphs which
+ * start after the modified text are unaffected by the modification.
+ * Reflow stops on reaching them and their existing line info is moved
+ * within the line info array to follow the reflowed lines. The
+ * wrapping work is bounded by the edited paragraphs, though moving
+ * the line info still takes time proportional to the number of lines.
+ *
  * \param ta		Textarea to reflow
  * \param b_start	0-based byte offset in ta->text to start of modification
  * \param b_length	Byte length of change in textarea text
+ * \param b_end	0-based byte offset in ta->text before modification of
+ *			end of modified text (exclusive), or TA_REFLOW_ALL
+ * \param b_delta	Change in byte length of ta->text
  * \param r		Modified/reduced to area where redraw is required
  * \return true on success false otherwise
  */
 static bool textarea_reflow_multiline(struct textarea *ta,
-		const size_t b_start, const int b_length, struct rect *r)
+		const size_t b_start, const int b_length,
+		const size_t b_end, const int b_delta, struct rect *r)
 {
 	char *text;
 	unsigned int len;
@@ -930,6 +1005,11 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 	int v_extent; /* vertical extent */
 	bool restart = false;
 	bool skip_line = false;
+	unsigned int tail_start = 0; /* index of first unaffected line */
+	unsigned int tail_base = 0; /* index of unaffected lines in reflow */
+	unsigned int tail_count = 0; /* number of unaffected lines */
+	size_t tail_b_start = 0; /* new byte offset of first unaffected line */
+	unsigned int tail_reached = 0; /* new index of first unaffected line */
 
 	assert(ta->flags & TEXTAREA_MULTILINE);
 
@@ -944,9 +1024,29 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 	}
 
 	/* Get line of start of changes */
-	for (start = 0; (signed) start < ta->line_count - 1; start++)
-		if (ta->lines[start + 1].b_start > b_start)
-			break;
+	start = textarea_find_line(ta, b_start);
+
+	/* Find the first paragraph start after the end of changes */
+	if (b_end != TA_REFLOW_ALL && ta->line_count > 0) {
+		tail_start = textarea_find_line(ta, b_end) + 1;
+		while ((signed) tail_start < ta->line_count &&
+				ta->text.data[ta->lines[tail_start].b_start +
+						b_delta - 1] != '\n')
+			tail_start++;
+
+		if ((signed) tail_start < ta->line_count) {
+			tail_count = ta->line_count - tail_start;
+			tail_base = tail_start;
+			if (!textarea_reserve_lines(ta, tail_start + 2,
+					&tail_base, tail_count)) {
+				/* Reflow everything instead */
+				tail_count = 0;
+			} else {
+				tail_b_start = ta->lines[tail_base].b_start +
+						b_delta;
+			}
+		}
+	}
 
 	/* Find max number of lines before vertical scrollbar is required */
 	scroll_lines = (ta->vis_height - 2 * ta->border_width -
@@ -968,9 +1068,13 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 	do {
 		/* If a vertical scrollbar has been added or removed, we need
 		 * to restart from the first line in the textarea. */
-		if (restart)
+		if (restart) {
 			start = 0;
 
+			/* Available width has changed so all lines may */
+			tail_count = 0;
+		}
+
 		/* Set current line to the starting line */
 		line = start;
 
@@ -1011,7 +1115,30 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 		}
 
 		restart = false;
+		tail_reached = 0;
 		for (; len > 0; len -= b_off, text += b_off) {
+			if (tail_count > 0 &&
+					(size_t)(text - ta->text.data) ==
+					tail_b_start) {
+				/* Reached the unaffected lines */
+				unsigned int i;
+
+				memmove(ta->lines + line,
+						ta->lines + tail_base,
+						tail_count *
+						sizeof(struct line_info));
+
+				tail_reached = line;
+				for (i = 0; i < tail_count; i++) {
+					ta->lines[line].b_start += b_delta;
+					if (ta->lines[line].width > h_extent) {
+						h_extent = ta->lines[line].width;
+					}
+					line++;
+				}
+				break;
+			}
+
 			/* Find end of paragraph */
 			for (para_end = text; para_end < text + len;
 					para_end++) {
@@ -1047,20 +1174,13 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 						ta->line_height;
 			}
 
-			/* Ensure enough storage for lines data */
-			if (line > ta->lines_alloc_size - 2) {
-				/* Up to two lines my be added in a pass */
-				struct line_info *temp = realloc(ta->lines,
-						(line + 2 + LINE_CHUNK_SIZE) *
-						sizeof(struct line_info));
-				if (temp == NULL) {
-					NSLOG(netsurf, INFO, "realloc failed");
-					return false;
-				}
-
-				ta->lines = temp;
-				ta->lines_alloc_size = line + 2 +
-						LINE_CHUNK_SIZE;
+			/* Ensure enough storage for lines data, up to two
+			 * lines may be added in a pass */
+			if (line + 2 > (tail_count > 0 ? tail_base :
+					ta->lines_alloc_size) &&
+					!textarea_reserve_lines(ta, line + 2,
+					&tail_base, tail_count)) {
+				return false;
 			}
 
 			if (para_end == text + b_off && *para_end == '\n') {
@@ -1184,6 +1304,12 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 	r->y0 = max(r->y0, (signed)(ta->line_height * start +
 			ta->text_y_offset - ta->scroll_y));
 
+	if (tail_reached != 0 && tail_reached == tail_start) {
+		/* Unaffected lines haven't moved, so don't need redraw */
+		r->y1 = min(r->y1, (signed)(ta->line_height * tail_start +
+				ta->text_y_offset - ta->scroll_y));
+	}
+
 	/* Reduce redraw region to single line if possible */
 	if ((skip_line || start == 0) &&
 			ta->lines[start].b_start + ta->lines[start].b_length >=
@@ -1295,6 +1421,39 @@ static bool textarea_set_caret_xy(struct textarea *ta, int x, int y,
 }
 
 
+/**
+ * Ensure a textarea text buffer can hold a given length
+ *
+ * The allocation grows in proportion to the text length, so repeated
+ * edits of a large text don't reallocate it every few keystrokes.
+ *
+ * \param text		Text buffer
+ * \param len		Byte length required, including trailing NULL
+ * \return false on memory exhaustion, true otherwise
+ */
+static bool textarea_text_reserve(struct textarea_utf8 *text,
+		unsigned int len)
+{
+	unsigned int alloc;
+	char *temp;
+
+	if (len < text->alloc)
+		return true;
+
+	alloc = len + TA_ALLOC_STEP + len / 4;
+	temp = realloc(text->data, alloc);
+	if (temp == NULL) {
+		NSLOG(netsurf, INFO, "realloc failed");
+		return false;
+	}
+
+	text->data = temp;
+	text->alloc = alloc;
+
+	return true;
+}
+
+
 /**
  * Insert text into the textarea
  *
@@ -1331,17 +1490,8 @@ static bool textarea_insert_text(struct textarea *ta, const char *text,
 	if (b_off > ta->text.len - 1)
 		b_off = ta->text.len - 1;
 
-	if (b_len + ta->text.len >= ta->text.alloc) {
-		char *temp = realloc(ta->text.data, b_len + ta->text.len +
-				TA_ALLOC_STEP);
-		if (temp == NULL) {
-			NSLOG(netsurf, INFO, "realloc failed");
-			return false;
-		}
-
-		ta->text.data = temp;
-		ta->text.alloc = b_len + ta->text.len + TA_ALLOC_STEP;
-	}
+	if (!textarea_text_reserve(&ta->text, b_len + ta->text.len))
+		return false;
 
 	/* Shift text following up */
 	memmove(ta->text.data + b_off + b_len, ta->text.data + b_off,
@@ -1367,7 +1517,8 @@ static bool textarea_insert_text(struct textarea *ta, const char *text,
 
 	/* See to reflow */
 	if (ta->flags & TEXTAREA_MULTILINE) {
-		if (!textarea_reflow_multiline(ta, show_b_off, b_len, r))
+		if (!textarea_reflow_multiline(ta, show_b_off, b_len,
+				b_off, *byte_delta, r))
 			return false;
 	} else {
 		if (!textarea_reflow_singleline(ta, show_b_off, r))
@@ -1426,6 +1577,7 @@ static bool textarea_replace_text_internal(struct textarea *ta, size_t b_start,
 		bool add_to_clipboard, int *byte_delta, struct rect *r)
 {
 	int char_delta;
+	size_t c_removed;
 	const size_t show_b_off = b_start;
 	*byte_delta = 0;
 
@@ -1480,19 +1632,13 @@ static bool textarea_replace_text_internal(struct textarea *ta, size_t b_start,
 	}
 
 	/* Ensure textarea's text buffer is large enough */
-	if (rep_len + ta->text.len - (b_end - b_start) >= ta->text.alloc) {
-		char *temp = realloc(ta->text.data,
-				rep_len + ta->text.len - (b_end - b_start) +
-					TA_ALLOC_STEP);
-		if (temp == NULL) {
-			NSLOG(netsurf, INFO, "realloc failed");
-			return false;
-		}
+	if (!textarea_text_reserve(&ta->text,
+			rep_len + ta->text.len - (b_end - b_start)))
+		return false;
 
-		ta->text.data = temp;
-		ta->text.alloc = rep_len + ta->text.len - (b_end - b_start) +
-				TA_ALLOC_STEP;
-	}
+	/* Count characters being replaced */
+	c_removed = utf8_bounded_length(ta->text.data + b_start,
+			b_end - b_start);
 
 	/* Shift text following to new position */
 	memmove(ta->text.data + b_start + rep_len, ta->text.data + b_end,
@@ -1506,7 +1652,7 @@ static bool textarea_replace_text_internal(struct textarea *ta, size_t b_start,
 
 	/* Update lengths, and normalise */
 	ta->text.len += (int)rep_len - (b_end - b_start);
-	ta->text.utf8_len = utf8_length(ta->text.data);
+	ta->text.utf8_len += utf8_bounded_length(rep, rep_len) - c_removed;
 	textarea_normalise_text(ta, b_start, rep_len);
 
 	/* Get byte delta */
@@ -1519,7 +1665,8 @@ static bool textarea_replace_text_internal(struct textarea *ta, size_t b_start,
 
 	/* See to reflow */
 	if (ta->flags & TEXTAREA_MULTILINE) {
-		if (!textarea_reflow_multiline(ta, b_start, *byte_delta, r))
+		if (!textarea_reflow_multiline(ta, b_start, *byte_delta,
+				b_end, *byte_delta, r))
 			return false;
 	} else {
 		if (!textarea_reflow_singleline(ta, show_b_off, r))
@@ -1557,18 +1704,9 @@ static bool textarea_copy_to_undo_buffer(struct textarea *ta,
 
 	len = len > rep_len ? len : rep_len;
 
-	if (b_offset + len >= undo->text.alloc) {
-		/* Need more memory for undo buffer */
-		char *temp = realloc(undo->text.data,
-				b_offset + len + TA_ALLOC_STEP);
-		if (temp == NULL) {
-			NSLOG(netsurf, INFO, "realloc failed");
-			return false;
-		}
-
-		undo->text.data = temp;
-		undo->text.alloc = b_offset + len + TA_ALLOC_STEP;
-	}
+	/* Ensure undo buffer is large enough */
+	if (!textarea_text_reserve(&undo->text, b_offset + len))
+		return false;
 
 	if (undo->next_detail >= undo->details_alloc) {
 		/* Need more memory for undo details */
@@ -1963,7 +2101,7 @@ struct textarea *textarea_create(const textarea_flags flags,
 	textarea_setup_text_offsets(ret);
 
 	if (flags & TEXTAREA_MULTILINE)
-		 textarea_reflow_multiline(ret, 0, 0, &r);
+		 textarea_reflow_multiline(ret, 0, 0, TA_REFLOW_ALL, 0, &r);
 	else
 		 textarea_reflow_singleline(ret, 0, &r);
 
@@ -2017,7 +2155,8 @@ bool textarea_set_text(struct textarea *ta, const char *text)
 	textarea_normalise_text(ta, 0, len);
 
 	if (ta->flags & TEXTAREA_MULTILINE) {
-		 if (!textarea_reflow_multiline(ta, 0, len - 1, &r))
+		 if (!textarea_reflow_multiline(ta, 0, len - 1,
+				TA_REFLOW_ALL, 0, &r))
 		 	return false;
 	} else {
 		 if (!textarea_reflow_singleline(ta, 0, &r))
@@ -3205,21 +3344,15 @@ textarea_mouse_status textarea_mouse_action(struct textarea *ta,
 bool textarea_clear_selection(struct textarea *ta)
 {
 	struct textarea_msg msg;
-	int line_end, line_start = 0;
+	int line_start, line_end;
 
 	if (ta->sel_start == -1)
 		/* No selection to clear */
 		return false;
 
 	/* Find selection start & end lines */
-	for (line_end = 0; line_end < ta->line_count - 1; line_end++)
-		if (ta->lines[line_end + 1].b_start > (unsigned)ta->sel_start) {
-			line_start = line_end;
-			break;
-		}
-	for (; line_end < ta->line_count - 1; line_end++)
-		if (ta->lines[line_end + 1].b_start > (unsigned)ta->sel_end)
-			break;
+	line_start = textarea_find_line(ta, ta->sel_start);
+	line_end = textarea_find_line(ta, ta->sel_end);
 
 	/* Clear selection and redraw */
 	textarea_reset_selection(ta);
@@ -3325,7 +3458,8 @@ void textarea_set_dimensions(struct textarea *ta, int width, int height)
 	textarea_setup_text_offsets(ta);
 
 	if (ta->flags & TEXTAREA_MULTILINE) {
-		 textarea_reflow_multiline(ta, 0, ta->show->len -1, &r);
+		 textarea_reflow_multiline(ta, 0, ta->show->len -1,
+				TA_REFLOW_ALL, 0, &r);
 	} else {
 		 textarea_reflow_singleline(ta, 0, &r);
 	}
@@ -3356,7 +3490,8 @@ void textarea_set_layout(
 	textarea_setup_text_offsets(ta);
 
 	if (ta->flags & TEXTAREA_MULTILINE) {
-		 textarea_reflow_multiline(ta, 0, ta->show->len -1, &r);
+		 textarea_reflow_multiline(ta, 0, ta->show->len -1,
+				TA_REFLOW_ALL, 0, &r);
 	} else {
 		 textarea_reflow_singleline(ta, 0, &r);
 	}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of libnsfb, http://www.netsurf-browser.org/
+ * Licenced under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ *
+ * This is the *internal* interface for the 32bpp span kernels.
+ */
+
+#ifndef SPAN_H
+#define SPAN_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Span kernel implementations. */
+enum nsfb_span_impl_e {
+    NSFB_SPAN_SCALAR = 0, /**< portable C */
+    NSFB_SPAN_SSE2, /**< x86 SSE2 */
+    NSFB_SPAN_NEON, /**< ARM NEON */
+    NSFB_SPAN_COUNT
+};
+
+/**
+ * 32bpp span kernels.
+ *
+ * Each kernel processes a single horizontal run of pixels. Source
+ * pixels are netsurf colours (0xAABBGGRR) which are converted to the
+ * destination layout by swapping the red and blue channels when swap
+ * is set. The unused byte of destination pixels is not significant.
+ *
+ * All implementations produce results identical to nsfb_plot_ablend().
+ */
+typedef struct nsfb_span_fns_s {
+    const char *name; /**< implementation name */
+
+    /** Fill count pixels with a destination layout pixel value. */
+    void (*fill)(uint32_t *dst, uint32_t pixel, int count);
+
+    /** Copy count pixels ignoring source alpha. */
+    void (*copy)(uint32_t *dst, const uint32_t *src, int count, bool swap);
+
+    /** Alpha blend count pixels onto the destination. */
+    void (*blend)(uint32_t *dst, const uint32_t *src, int count, bool swap);
+
+    /**
+     * Blend a destination layout pixel value onto count pixels using
+     * an 8bpp coverage mask as alpha.
+     */
+    void (*glyph)(uint32_t *dst, const uint8_t *mask, uint32_t pixel, int count);
+} nsfb_span_fns_t;
+
+/** Span kernels selected for this machine. */
+extern const nsfb_span_fns_t *nsfb_span;
+
+/**
+ * Get a span kernel implementation.
+ *
+ * \param impl The implementation to get.
+ * \return The kernels or NULL if not available on this machine.
+ */
+const nsfb_span_fns_t *nsfb_span_get_fns(enum nsfb_span_impl_e impl);
+
+/**
+ * Select the best span kernels for this machine.
+ *
+ * The NSFB_SPAN environment variable may name an implementation to
+ * use in preference.
+ */
+void nsfb_span_init(void);
+
+#endif
@@ -18,6 +18,7 @@
 #include "cursor.h"
 #include "palette.h"
 #include "surface.h"
+#include "span.h"
 
 /* exported interface documented in libnsfb.h */
 nsfb_t*
@@ -28,6 +29,9 @@ nsfb_new(const enum nsfb_type_e surface_type)
     if (newfb == NULL)
         return NULL;
 
+    /* select plotting kernels for this machine */
+    nsfb_span_init();
+
     /* obtain surface routines */
     newfb->surface_rtns = nsfb_surface_get_rtns(surface_type);
     if (newfb->surface_rtns == NULL) {
@@ -31,6 +31,13 @@ static bool fill(nsfb_t *nsfb, nsfb_bbox_t *rect, nsfb_colour_t c)
 
         pvid = get_xy_loc(nsfb, rect->x0, rect->y0);
 
+#ifdef PLOT_SPAN_SWAP
+        while (height-- > 0) {
+                nsfb_span->fill(pvid, ent, width);
+                pvid += llen + width;
+        }
+#else
+
         while (height-- > 0) {
                 w = width;
                 while (w >= 16) {
@@ -55,6 +62,7 @@ static bool fill(nsfb_t *nsfb, nsfb_bbox_t *rect, nsfb_colour_t c)
                 }
                 pvid += llen;
         }
+#endif
 
         return true;
 }
@@ -41,6 +41,14 @@ static inline uint32_t colour_to_pixel(UNUSED nsfb_t *nsfb, nsfb_colour_t c)
 }
 
 
+#ifdef NSFB_SPAN_KERNELS
+#ifdef __BIG_ENDIAN_BGRA__
+#error The span kernels do not support the big endian BGRA layout
+#endif
+/* plot spans with the vector kernels, colours need red and blue swapped */
+#define PLOT_SPAN_SWAP true
+#endif
+
 #define PLOT_TYPE uint32_t
 #define PLOT_LINELEN(ll) ((ll) >> 2)
 
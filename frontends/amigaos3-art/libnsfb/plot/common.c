@@ -22,6 +22,13 @@
 #include "amigaos3-art/misc.h"
 #include "blitapollo.h"
 
+#ifdef PLOT_SPAN_SWAP
+#include "span.h"
+
+/* number of scaled bitmap pixels gathered for each span operation */
+#define PLOT_SPAN_CHUNK 256
+#endif
+
 #define SIGN(x)  ((x<0) ?  -1  :  ((x>0) ? 1 : 0))
 #define UNUSED __attribute__((unused))
 
@@ -275,6 +282,16 @@ glyph8(nsfb_t *nsfb,
 
         fgcol = c & 0xFFFFFF;
 
+#ifdef PLOT_SPAN_SWAP
+        for (yloop = 0; yloop < height; yloop++) {
+                nsfb_span->glyph(pvideo,
+                                 pixel + ((yoff + yloop) * pitch) + xoff,
+                                 colour_to_pixel(nsfb, fgcol),
+                                 width);
+                pvideo += PLOT_LINELEN(nsfb->linelen);
+        }
+#else
+
         for (yloop = 0; yloop < height; yloop++) {
                 for (xloop = 0; xloop < width; xloop++) {
 						abpixel = ((unsigned)pixel[((yoff + yloop) * pitch) + xloop + xoff] << 24) | fgcol;
@@ -290,6 +307,7 @@ glyph8(nsfb_t *nsfb,
                 }
                 pvideo += PLOT_LINELEN(nsfb->linelen);
         }
+#endif
 
         return true;
 }
@@ -366,6 +384,49 @@ static bool bitmap_scaled(nsfb_t *nsfb, const nsfb_bbox_t *loc,
 	/* plot the image */
 	pvideo = get_xy_loc(nsfb, clipped.x0, clipped.y0);
 	pvideo_limit = pvideo + PLOT_LINELEN(nsfb->linelen) * rheight;
+#ifdef PLOT_SPAN_SWAP
+	{
+		/* gather each row of scaled pixels then plot as spans */
+		nsfb_colour_t span[PLOT_SPAN_CHUNK];
+		int chunk;
+		int sidx;
+
+		for (; pvideo < pvideo_limit;
+				pvideo += PLOT_LINELEN(nsfb->linelen)) {
+			xoff = xoffs;
+			rx = rxs;
+			for (xloop = 0; xloop < rwidth; xloop += chunk) {
+				chunk = rwidth - xloop;
+				if (chunk > PLOT_SPAN_CHUNK)
+					chunk = PLOT_SPAN_CHUNK;
+
+				for (sidx = 0; sidx < chunk; sidx++) {
+					span[sidx] = pixel[yoff + xoff];
+					xoff += dx;
+					rx += dxr;
+					if (rx >= width) {
+						xoff++;
+						rx -= width;
+					}
+				}
+
+				if (alpha) {
+					nsfb_span->blend(pvideo + xloop, span,
+							 chunk, PLOT_SPAN_SWAP);
+				} else {
+					nsfb_span->copy(pvideo + xloop, span,
+							chunk, PLOT_SPAN_SWAP);
+				}
+			}
+			yoff += dy;
+			ry += dyr;
+			if (ry >= height) {
+				yoff += bmp_stride;
+				ry -= height;
+			}
+		}
+	}
+#else
 	if (alpha) {
 		for (; pvideo < pvideo_limit; pvideo += PLOT_LINELEN(nsfb->linelen)) {
 			/* looping through render area vertically */
@@ -457,6 +518,7 @@ static bool bitmap_scaled(nsfb_t *nsfb, const nsfb_bbox_t *loc,
 			}
 		}
 	}
+#endif
 	if ((dither_low_quality) && (Bpp == 8)) {	
 		/* reset dithering to defaults */
 		dither676 = false;
@@ -523,6 +585,19 @@ bitmap(nsfb_t *nsfb,
         /* plot the image */
         pvideo = get_xy_loc(nsfb, clipped.x0, clipped.y0);
 
+#ifdef PLOT_SPAN_SWAP
+        for (yloop = yoff; yloop < height; yloop += bmp_stride) {
+                if (alpha) {
+                        nsfb_span->blend(pvideo, pixel + yloop + xoff,
+                                         width, PLOT_SPAN_SWAP);
+                } else {
+                        nsfb_span->copy(pvideo, pixel + yloop + xoff,
+                                        width, PLOT_SPAN_SWAP);
+                }
+                pvideo += PLOT_LINELEN(nsfb->linelen);
+        }
+#else
+
         if (alpha) {
                 for (yloop = yoff; yloop < height; yloop += bmp_stride) {
                         for (xloop = 0; xloop < width; xloop++) {		
@@ -580,6 +655,7 @@ bitmap(nsfb_t *nsfb,
                         pvideo += PLOT_LINELEN(nsfb->linelen);
                 }
         }
+#endif
 		if ((dither_low_quality) && (Bpp == 8)) {	
 				/* reset dithering to defaults */
 				dither676 = false;
@@ -0,0 +1,488 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of libnsfb, http://www.netsurf-browser.org/
+ * Licenced under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ *
+ * 32bpp span kernels with vector implementations selected at runtime.
+ *
+ * On x86 the SSE2 kernels are built even when the compiler baseline
+ * lacks SSE2 and are only selected if the processor reports support.
+ * The NEON kernels are only built when the compiler targets NEON.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#define SPAN_HAVE_SSE2 1
+#elif defined(__GNUC__) && !defined(__clang__) && \
+	(defined(__i386__) || defined(__x86_64__)) && \
+	((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+/* build the SSE2 kernels for use only if the processor supports them */
+#define SPAN_HAVE_SSE2 1
+#define SPAN_SSE2_TARGET 1
+#endif
+
+#if defined(__ARM_NEON) && defined(__BYTE_ORDER__) && \
+	(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#include <arm_neon.h>
+#define SPAN_HAVE_NEON 1
+#endif
+
+#include "span.h"
+
+/** swap the red and blue channels of a pixel */
+static inline uint32_t span_swap_rb(uint32_t p)
+{
+        return (p & 0xFF00FF00) | ((p >> 16) & 0xFF) | ((p & 0xFF) << 16);
+}
+
+/** blend a source pixel onto a destination, as nsfb_plot_ablend() */
+static inline uint32_t span_ablend(uint32_t s, uint32_t d)
+{
+        uint32_t opacity = s >> 24;
+        uint32_t transp = 0x100 - opacity;
+        uint32_t rb, g;
+
+        rb = ((s & 0xFF00FF) * opacity + (d & 0xFF00FF) * transp) >> 8;
+        g  = ((s & 0x00FF00) * opacity + (d & 0x00FF00) * transp) >> 8;
+
+        return (rb & 0xFF00FF) | (g & 0xFF00);
+}
+
+
+/* portable implementation */
+
+static void scalar_fill(uint32_t *dst, uint32_t pixel, int count)
+{
+        while (count >= 4) {
+                dst[0] = pixel; dst[1] = pixel;
+                dst[2] = pixel; dst[3] = pixel;
+                dst += 4;
+                count -= 4;
+        }
+        while (count-- > 0) {
+                *dst++ = pixel;
+        }
+}
+
+static void
+scalar_copy(uint32_t *dst, const uint32_t *src, int count, bool swap)
+{
+        if (!swap) {
+                memcpy(dst, src, count * sizeof(uint32_t));
+                return;
+        }
+        while (count-- > 0) {
+                *dst++ = span_swap_rb(*src++);
+        }
+}
+
+static void
+scalar_blend(uint32_t *dst, const uint32_t *src, int count, bool swap)
+{
+        uint32_t s;
+
+        while (count-- > 0) {
+                s = *src++;
+                if ((s & 0xFF000000) != 0) {
+                        if (swap) {
+                                s = span_swap_rb(s);
+                        }
+                        if ((s & 0xFF000000) != 0xFF000000) {
+                                s = span_ablend(s, *dst);
+                        }
+                        *dst = s;
+                }
+                dst++;
+        }
+}
+
+static void
+scalar_glyph(uint32_t *dst, const uint8_t *mask, uint32_t pixel, int count)
+{
+        uint32_t a;
+
+        pixel &= 0xFFFFFF;
+        while (count-- > 0) {
+                a = *mask++;
+                if (a == 0xFF) {
+                        *dst = pixel;
+                } else if (a != 0) {
+                        *dst = span_ablend((a << 24) | pixel, *dst);
+                }
+                dst++;
+        }
+}
+
+static const nsfb_span_fns_t span_scalar_fns = {
+        .name = "scalar",
+        .fill = scalar_fill,
+        .copy = scalar_copy,
+        .blend = scalar_blend,
+        .glyph = scalar_glyph,
+};
+
+
+#ifdef SPAN_HAVE_SSE2
+
+#ifdef SPAN_SSE2_TARGET
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+#include <emmintrin.h>
+
+/* SSE2 implementation, four pixels per step */
+
+static inline __m128i sse2_swap_rb(__m128i p)
+{
+        const __m128i ag = _mm_set1_epi32(0xFF00FF00);
+        const __m128i lo = _mm_set1_epi32(0x000000FF);
+
+        return _mm_or_si128(_mm_and_si128(p, ag),
+                            _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16), lo),
+                                         _mm_slli_epi32(_mm_and_si128(p, lo), 16)));
+}
+
+/**
+ * blend four pixels with per pixel alpha in the low byte of a32.
+ *
+ * s * a + d * (256 - a) is computed as s * a + d * (255 - a) + d which
+ * cannot overflow sixteen bits.
+ */
+static inline __m128i sse2_blend4(__m128i s, __m128i d, __m128i a32)
+{
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i c255 = _mm_set1_epi16(255);
+        __m128i a16, a_lo, a_hi, s_lo, s_hi, d_lo, d_hi, r_lo, r_hi, res;
+        __m128i opaque;
+
+        a16 = _mm_or_si128(a32, _mm_slli_epi32(a32, 16));
+        a_lo = _mm_unpacklo_epi32(a16, a16);
+        a_hi = _mm_unpackhi_epi32(a16, a16);
+
+        s_lo = _mm_unpacklo_epi8(s, zero);
+        s_hi = _mm_unpackhi_epi8(s, zero);
+        d_lo = _mm_unpacklo_epi8(d, zero);
+        d_hi = _mm_unpackhi_epi8(d, zero);
+
+        r_lo = _mm_add_epi16(_mm_mullo_epi16(s_lo, a_lo),
+                             _mm_mullo_epi16(d_lo, _mm_sub_epi16(c255, a_lo)));
+        r_lo = _mm_srli_epi16(_mm_add_epi16(r_lo, d_lo), 8);
+        r_hi = _mm_add_epi16(_mm_mullo_epi16(s_hi, a_hi),
+                             _mm_mullo_epi16(d_hi, _mm_sub_epi16(c255, a_hi)));
+        r_hi = _mm_srli_epi16(_mm_add_epi16(r_hi, d_hi), 8);
+
+        res = _mm_packus_epi16(r_lo, r_hi);
+
+        /* fully opaque pixels are copied */
+        opaque = _mm_cmpeq_epi32(a32, _mm_set1_epi32(0xFF));
+
+        return _mm_or_si128(_mm_and_si128(opaque, s),
+                            _mm_andnot_si128(opaque, res));
+}
+
+static void sse2_fill(uint32_t *dst, uint32_t pixel, int count)
+{
+        __m128i p = _mm_set1_epi32(pixel);
+
+        while (count >= 8) {
+                _mm_storeu_si128((__m128i *)dst, p);
+                _mm_storeu_si128((__m128i *)(dst + 4), p);
+                dst += 8;
+                count -= 8;
+        }
+        scalar_fill(dst, pixel, count);
+}
+
+static void
+sse2_copy(uint32_t *dst, const uint32_t *src, int count, bool swap)
+{
+        __m128i s;
+
+        if (!swap) {
+                memcpy(dst, src, count * sizeof(uint32_t));
+                return;
+        }
+        while (count >= 4) {
+                s = _mm_loadu_si128((const __m128i *)src);
+                _mm_storeu_si128((__m128i *)dst, sse2_swap_rb(s));
+                src += 4;
+                dst += 4;
+                count -= 4;
+        }
+        scalar_copy(dst, src, count, swap);
+}
+
+static void
+sse2_blend(uint32_t *dst, const uint32_t *src, int count, bool swap)
+{
+        const __m128i zero = _mm_setzero_si128();
+        __m128i s, d, a32;
+        int amask;
+
+        while (count >= 4) {
+                s = _mm_loadu_si128((const __m128i *)src);
+                a32 = _mm_srli_epi32(s, 24);
+
+                /* each alpha is a 32 bit lane so test lane byte zero */
+                amask = _mm_movemask_epi8(_mm_cmpeq_epi32(a32, zero));
+                if (amask != 0xFFFF) {
+                        if (swap) {
+                                s = sse2_swap_rb(s);
+                        }
+                        amask = _mm_movemask_epi8(
+                                _mm_cmpeq_epi32(a32, _mm_set1_epi32(0xFF)));
+                        if (amask != 0xFFFF) {
+                                d = _mm_loadu_si128((const __m128i *)dst);
+                                s = sse2_blend4(s, d, a32);
+                        }
+                        _mm_storeu_si128((__m128i *)dst, s);
+                }
+                src += 4;
+                dst += 4;
+                count -= 4;
+        }
+        scalar_blend(dst, src, count, swap);
+}
+
+static void
+sse2_glyph(uint32_t *dst, const uint8_t *mask, uint32_t pixel, int count)
+{
+        const __m128i zero = _mm_setzero_si128();
+        __m128i s, d, a32;
+        uint32_t m;
+
+        pixel &= 0xFFFFFF;
+        s = _mm_set1_epi32(pixel);
+
+        while (count >= 4) {
+                memcpy(&m, mask, sizeof(m));
+                if (m == 0xFFFFFFFF) {
+                        _mm_storeu_si128((__m128i *)dst, s);
+                } else if (m != 0) {
+                        a32 = _mm_unpacklo_epi16(
+                                _mm_unpacklo_epi8(_mm_cvtsi32_si128(m), zero),
+                                zero);
+                        d = _mm_loadu_si128((const __m128i *)dst);
+                        _mm_storeu_si128((__m128i *)dst,
+                                         sse2_blend4(s, d, a32));
+                }
+                mask += 4;
+                dst += 4;
+                count -= 4;
+        }
+        scalar_glyph(dst, mask, pixel, count);
+}
+
+static const nsfb_span_fns_t span_sse2_fns = {
+        .name = "sse2",
+        .fill = sse2_fill,
+        .copy = sse2_copy,
+        .blend = sse2_blend,
+        .glyph = sse2_glyph,
+};
+
+#ifdef SPAN_SSE2_TARGET
+#pragma GCC pop_options
+#endif
+
+#endif /* SPAN_HAVE_SSE2 */
+
+
+#ifdef SPAN_HAVE_NEON
+
+/* NEON implementation, eight pixels per step de-interleaved by channel */
+
+static inline uint8x8x4_t
+neon_blend8(uint8x8x4_t s, uint8x8x4_t d, uint8x8_t a)
+{
+        uint8x8_t ia = vsub_u8(vdup_n_u8(255), a);
+        uint8x8_t opaque = vceq_u8(a, vdup_n_u8(255));
+        uint16x8_t r;
+        uint8x8x4_t out;
+        int c;
+
+        for (c = 0; c < 4; c++) {
+                r = vmull_u8(s.val[c], a);
+                r = vmlal_u8(r, d.val[c], ia);
+                r = vaddw_u8(r, d.val[c]);
+                out.val[c] = vbsl_u8(opaque, s.val[c], vshrn_n_u16(r, 8));
+        }
+
+        return out;
+}
+
+static void neon_fill(uint32_t *dst, uint32_t pixel, int count)
+{
+        uint32x4_t p = vdupq_n_u32(pixel);
+
+        while (count >= 8) {
+                vst1q_u32(dst, p);
+                vst1q_u32(dst + 4, p);
+                dst += 8;
+                count -= 8;
+        }
+        scalar_fill(dst, pixel, count);
+}
+
+static void
+neon_copy(uint32_t *dst, const uint32_t *src, int count, bool swap)
+{
+        uint8x8x4_t s;
+        uint8x8_t t;
+
+        if (!swap) {
+                memcpy(dst, src, count * sizeof(uint32_t));
+                return;
+        }
+        while (count >= 8) {
+                s = vld4_u8((const uint8_t *)src);
+                t = s.val[0];
+                s.val[0] = s.val[2];
+                s.val[2] = t;
+                vst4_u8((uint8_t *)dst, s);
+                src += 8;
+                dst += 8;
+                count -= 8;
+        }
+        scalar_copy(dst, src, count, swap);
+}
+
+static void
+neon_blend(uint32_t *dst, const uint32_t *src, int count, bool swap)
+{
+        uint8x8x4_t s, d;
+        uint8x8_t t;
+        uint64_t amax, amin;
+
+        while (count >= 8) {
+                s = vld4_u8((const uint8_t *)src);
+                amax = vget_lane_u64(vreinterpret_u64_u8(s.val[3]), 0);
+                if (amax != 0) {
+                        if (swap) {
+                                t = s.val[0];
+                                s.val[0] = s.val[2];
+                                s.val[2] = t;
+                        }
+                        amin = vget_lane_u64(vreinterpret_u64_u8(
+                                        vmvn_u8(s.val[3])), 0);
+                        if (amin != 0) {
+                                d = vld4_u8((const uint8_t *)dst);
+                                s = neon_blend8(s, d, s.val[3]);
+                        }
+                        vst4_u8((uint8_t *)dst, s);
+                }
+                src += 8;
+                dst += 8;
+                count -= 8;
+        }
+        scalar_blend(dst, src, count, swap);
+}
+
+static void
+neon_glyph(uint32_t *dst, const uint8_t *mask, uint32_t pixel, int count)
+{
+        uint8x8x4_t s, d;
+        uint8x8_t a;
+        uint64_t m;
+
+        pixel &= 0xFFFFFF;
+        s.val[0] = vdup_n_u8(pixel & 0xFF);
+        s.val[1] = vdup_n_u8((pixel >> 8) & 0xFF);
+        s.val[2] = vdup_n_u8((pixel >> 16) & 0xFF);
+        s.val[3] = vdup_n_u8(0);
+
+        while (count >= 8) {
+                memcpy(&m, mask, sizeof(m));
+                if (m != 0) {
+                        a = vld1_u8(mask);
+                        d = vld4_u8((const uint8_t *)dst);
+                        vst4_u8((uint8_t *)dst, neon_blend8(s, d, a));
+                }
+                mask += 8;
+                dst += 8;
+                count -= 8;
+        }
+        scalar_glyph(dst, mask, pixel, count);
+}
+
+static const nsfb_span_fns_t span_neon_fns = {
+        .name = "neon",
+        .fill = neon_fill,
+        .copy = neon_copy,
+        .blend = neon_blend,
+        .glyph = neon_glyph,
+};
+
+#endif /* SPAN_HAVE_NEON */
+
+
+/* exported interface documented in span.h */
+const nsfb_span_fns_t *nsfb_span = &span_scalar_fns;
+
+/* exported interface documented in span.h */
+const nsfb_span_fns_t *nsfb_span_get_fns(enum nsfb_span_impl_e impl)
+{
+        switch (impl) {
+        case NSFB_SPAN_SCALAR:
+                return &span_scalar_fns;
+
+#ifdef SPAN_HAVE_SSE2
+        case NSFB_SPAN_SSE2:
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+                if (!__builtin_cpu_supports("sse2")) {
+                        return NULL;
+                }
+#endif
+                return &span_sse2_fns;
+#endif
+
+#ifdef SPAN_HAVE_NEON
+        case NSFB_SPAN_NEON:
+                return &span_neon_fns;
+#endif
+
+        default:
+                break;
+        }
+
+        return NULL;
+}
+
+/* exported interface documented in span.h */
+void nsfb_span_init(void)
+{
+        const nsfb_span_fns_t *fns;
+        const char *want;
+        int impl;
+
+        want = getenv("NSFB_SPAN");
+
+        /* prefer the most capable available implementation */
+        nsfb_span = &span_scalar_fns;
+        for (impl = NSFB_SPAN_COUNT - 1; impl >= NSFB_SPAN_SCALAR; impl--) {
+                fns = nsfb_span_get_fns(impl);
+                if (fns == NULL) {
+                        continue;
+                }
+                if (want != NULL) {
+                        if (strcmp(want, fns->name) == 0) {
+                                nsfb_span = fns;
+                                return;
+                        }
+                } else if (nsfb_span == &span_scalar_fns) {
+                        nsfb_span = fns;
+                }
+        }
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset:8
+ * End:
+ */
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of libnsfb, http://www.netsurf-browser.org/
+ * Licenced under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ *
+ * Headless span kernel benchmark.
+ *
+ * Checks every available span kernel implementation produces the same
+ * output as the scalar path and times each over a ram surface sized
+ * buffer. Build with:
+ *
+ *   cc -O2 -Iinclude test/spanbench.c plot/span.c -o spanbench
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "span.h"
+
+#define SURFACE_WIDTH 1024
+#define SURFACE_HEIGHT 768
+#define ITERATIONS 50
+
+static uint32_t *surface;
+static uint32_t *reference;
+static uint32_t *source;
+static uint8_t *mask;
+
+enum span_op {
+        OP_FILL,
+        OP_COPY,
+        OP_BLEND,
+        OP_GLYPH,
+        OP_COUNT
+};
+
+static const char *op_name[OP_COUNT] = {
+        "fill", "copy", "blend", "glyph"
+};
+
+static double now(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* fill source with a mix of transparent, opaque and translucent pixels */
+static void generate(void)
+{
+        unsigned int seed = 0x2545F491;
+        size_t idx;
+
+        for (idx = 0; idx < SURFACE_WIDTH * SURFACE_HEIGHT; idx++) {
+                seed = seed * 1103515245 + 12345;
+                source[idx] = seed ^ (seed << 13);
+                switch ((seed >> 20) & 3) {
+                case 0:
+                        source[idx] &= 0x00FFFFFF;
+                        break;
+                case 1:
+                        source[idx] |= 0xFF000000;
+                        break;
+                }
+                mask[idx] = (seed >> 8) & 0xFF;
+                if ((seed & 0x300) == 0) {
+                        mask[idx] = 0;
+                } else if ((seed & 0x300) == 0x100) {
+                        mask[idx] = 0xFF;
+                }
+        }
+}
+
+/* run one operation over the whole surface, row by row */
+static void run(const nsfb_span_fns_t *fns, enum span_op op, uint32_t *dst)
+{
+        int row;
+        /* odd width exercises the scalar tail of vector kernels */
+        int width = SURFACE_WIDTH - 3;
+
+        for (row = 0; row < SURFACE_HEIGHT; row++) {
+                uint32_t *d = dst + row * SURFACE_WIDTH;
+                const uint32_t *s = source + row * SURFACE_WIDTH;
+                const uint8_t *m = mask + row * SURFACE_WIDTH;
+
+                switch (op) {
+                case OP_FILL:
+                        fns->fill(d, 0x00336699, width);
+                        break;
+                case OP_COPY:
+                        fns->copy(d, s, width, true);
+                        break;
+                case OP_BLEND:
+                        fns->blend(d, s, width, true);
+                        break;
+                case OP_GLYPH:
+                        fns->glyph(d, m, 0x00102030, width);
+                        break;
+                default:
+                        break;
+                }
+        }
+}
+
+static void reset(uint32_t *dst)
+{
+        size_t idx;
+
+        for (idx = 0; idx < SURFACE_WIDTH * SURFACE_HEIGHT; idx++) {
+                dst[idx] = (uint32_t)(idx * 2654435761u);
+        }
+}
+
+/* compare ignoring the unused byte of each pixel */
+static bool matches(const uint32_t *a, const uint32_t *b)
+{
+        size_t idx;
+
+        for (idx = 0; idx < SURFACE_WIDTH * SURFACE_HEIGHT; idx++) {
+                if ((a[idx] ^ b[idx]) & 0x00FFFFFF) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+int main(void)
+{
+        const nsfb_span_fns_t *scalar;
+        const nsfb_span_fns_t *fns;
+        int impl;
+        int op;
+        int iter;
+        double start;
+        double elapsed;
+        double base[OP_COUNT];
+        int failed = 0;
+
+        surface = malloc(SURFACE_WIDTH * SURFACE_HEIGHT * sizeof(uint32_t));
+        reference = malloc(SURFACE_WIDTH * SURFACE_HEIGHT * sizeof(uint32_t));
+        source = malloc(SURFACE_WIDTH * SURFACE_HEIGHT * sizeof(uint32_t));
+        mask = malloc(SURFACE_WIDTH * SURFACE_HEIGHT);
+        if (!surface || !reference || !source || !mask) {
+                fprintf(stderr, "Unable to allocate surface\n");
+                return EXIT_FAILURE;
+        }
+
+        generate();
+        scalar = nsfb_span_get_fns(NSFB_SPAN_SCALAR);
+
+        for (impl = NSFB_SPAN_SCALAR; impl < NSFB_SPAN_COUNT; impl++) {
+                fns = nsfb_span_get_fns(impl);
+                if (fns == NULL) {
+                        continue;
+                }
+
+                for (op = 0; op < OP_COUNT; op++) {
+                        reset(reference);
+                        run(scalar, op, reference);
+                        reset(surface);
+                        run(fns, op, surface);
+                        if (!matches(surface, reference)) {
+                                printf("%-8s %-6s MISMATCH\n",
+                                       fns->name, op_name[op]);
+                                failed++;
+                                continue;
+                        }
+
+                        start = now();
+                        for (iter = 0; iter < ITERATIONS; iter++) {
+                                run(fns, op, surface);
+                        }
+                        elapsed = (now() - start) / ITERATIONS;
+                        if (impl == NSFB_SPAN_SCALAR) {
+                                base[op] = elapsed;
+                        }
+
+                        printf("%-8s %-6s %8.3f ms/frame %6.2fx\n",
+                               fns->name, op_name[op], elapsed * 1000,
+                               base[op] / elapsed);
+                }
+        }
+
+        free(surface);
+        free(reference);
+        free(source);
+        free(mask);
+
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
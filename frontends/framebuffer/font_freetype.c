@@ -18,6 +18,8 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <ft2build.h>
 #include FT_CACHE_H
@@ -39,6 +41,12 @@
 /* glyph cache minimum size */
 #define CACHE_MIN_SIZE (100 * 1024)
 
+/* number of glyph slots in each atlas strike */
+#define ATLAS_GLYPHS 512
+
+/* maximum number of atlas strikes held */
+#define ATLAS_MAX_STRIKES 16
+
 #define BOLD_WEIGHT 700
 
 static FT_Library library; 
@@ -75,6 +83,25 @@ enum fb_face_e {
 
 static fb_faceid_t *fb_faces[FB_FACE_COUNT];
 
+/**
+ * Glyph atlas strike.
+ *
+ * Holds pre-rendered coverage masks and advances for a single face
+ * at a single size. Slots are direct mapped on the unicode code point
+ * so the whole of Latin-1 is held without collisions.
+ */
+struct fb_atlas_strike {
+	struct fb_atlas_strike *next; /**< next strike in mru list */
+	FTC_FaceID face_id; /**< face of strike */
+	FT_UInt size; /**< size in 26.6 points */
+	FT_UInt res; /**< resolution in dpi */
+	int load_type; /**< freetype load flags used to render */
+	struct fb_atlas_glyph glyph[ATLAS_GLYPHS]; /**< glyph slots */
+};
+
+/** atlas strikes in most recently used order */
+static struct fb_atlas_strike *fb_atlas;
+
 /**
  * map cache manager handle to face id
  */
@@ -312,10 +339,30 @@ bool fb_font_init(void)
         return true;
 }
 
+/**
+ * Release a glyph atlas strike.
+ */
+static void fb_atlas_strike_free(struct fb_atlas_strike *strike)
+{
+	unsigned int idx;
+
+	for (idx = 0; idx < ATLAS_GLYPHS; idx++) {
+		free(strike->glyph[idx].mask);
+	}
+	free(strike);
+}
+
 /* exported interface documented in framebuffer/font.h */
 bool fb_font_finalise(void)
 {
 	int i, j;
+	struct fb_atlas_strike *strike;
+
+	while (fb_atlas != NULL) {
+		strike = fb_atlas;
+		fb_atlas = strike->next;
+		fb_atlas_strike_free(strike);
+	}
 
         FTC_Manager_Done(ft_cmanager);
         FT_Done_FreeType(library);
@@ -429,6 +476,159 @@ FT_Glyph fb_getglyph(const plot_font_style_t *fstyle, uint32_t ucs4)
 }
 
 
+/* exported interface documented in framebuffer/freetype_font.h */
+struct fb_atlas_strike *fb_atlas_get_strike(const plot_font_style_t *fstyle)
+{
+	FTC_ScalerRec srec;
+	struct fb_atlas_strike *strike;
+	struct fb_atlas_strike *prev = NULL;
+	unsigned int count = 0;
+
+	fb_fill_scalar(fstyle, &srec);
+
+	for (strike = fb_atlas; strike != NULL; strike = strike->next) {
+		if ((strike->face_id == srec.face_id) &&
+		    (strike->size == srec.width) &&
+		    (strike->res == srec.x_res) &&
+		    (strike->load_type == ft_load_type)) {
+			if (prev != NULL) {
+				/* move to front */
+				prev->next = strike->next;
+				strike->next = fb_atlas;
+				fb_atlas = strike;
+			}
+			return strike;
+		}
+		count++;
+		if ((count >= ATLAS_MAX_STRIKES) && (strike->next != NULL)) {
+			/* discard least recently used strike */
+			fb_atlas_strike_free(strike->next);
+			strike->next = NULL;
+		}
+		prev = strike;
+	}
+
+	strike = calloc(1, sizeof(struct fb_atlas_strike));
+	if (strike == NULL) {
+		return NULL;
+	}
+	strike->face_id = srec.face_id;
+	strike->size = srec.width;
+	strike->res = srec.x_res;
+	strike->load_type = ft_load_type;
+
+	strike->next = fb_atlas;
+	fb_atlas = strike;
+
+	return strike;
+}
+
+/**
+ * Render a glyph into an atlas slot.
+ *
+ * Monochrome bitmaps are expanded to 8bpp coverage so all glyphs in
+ * the atlas may be blended the same way.
+ *
+ * \param fstyle The style the strike was created for.
+ * \param ucs4 The unicode code point to render.
+ * \param ag The atlas slot to fill.
+ */
+static void
+fb_atlas_load_glyph(const plot_font_style_t *fstyle,
+		    uint32_t ucs4,
+		    struct fb_atlas_glyph *ag)
+{
+	FT_Glyph glyph;
+	FT_BitmapGlyph bglyph;
+	int row;
+	int col;
+	const uint8_t *src;
+	uint8_t *dst;
+
+	free(ag->mask);
+	ag->mask = NULL;
+	ag->ucs4 = ucs4;
+	ag->loaded = true;
+	ag->advance = 0;
+	ag->left = ag->top = ag->width = ag->rows = 0;
+
+	glyph = fb_getglyph(fstyle, ucs4);
+	if (glyph == NULL) {
+		return;
+	}
+
+	ag->advance = glyph->advance.x >> 16;
+
+	if (glyph->format != FT_GLYPH_FORMAT_BITMAP) {
+		return;
+	}
+	bglyph = (FT_BitmapGlyph)glyph;
+
+	if ((bglyph->bitmap.width == 0) || (bglyph->bitmap.rows == 0)) {
+		return;
+	}
+
+	ag->mask = malloc(bglyph->bitmap.width * bglyph->bitmap.rows);
+	if (ag->mask == NULL) {
+		return;
+	}
+
+	ag->left = bglyph->left;
+	ag->top = bglyph->top;
+	ag->width = bglyph->bitmap.width;
+	ag->rows = bglyph->bitmap.rows;
+
+	for (row = 0; row < ag->rows; row++) {
+		src = bglyph->bitmap.buffer + row * bglyph->bitmap.pitch;
+		dst = ag->mask + row * ag->width;
+		if (bglyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+			for (col = 0; col < ag->width; col++) {
+				dst[col] = (src[col >> 3] &
+					    (0x80 >> (col & 7))) ? 0xff : 0;
+			}
+		} else {
+			memcpy(dst, src, ag->width);
+		}
+	}
+}
+
+/* exported interface documented in framebuffer/freetype_font.h */
+const struct fb_atlas_glyph *
+fb_atlas_get_glyph(struct fb_atlas_strike *strike,
+		   const plot_font_style_t *fstyle,
+		   uint32_t ucs4)
+{
+	struct fb_atlas_glyph *ag;
+
+	ag = &strike->glyph[ucs4 % ATLAS_GLYPHS];
+	if ((ag->loaded == false) || (ag->ucs4 != ucs4)) {
+		fb_atlas_load_glyph(fstyle, ucs4, ag);
+	}
+
+	return ag;
+}
+
+/**
+ * Get the advance of a glyph, using the atlas when available.
+ */
+static inline int
+fb_glyph_advance(struct fb_atlas_strike *strike,
+		 const plot_font_style_t *fstyle,
+		 uint32_t ucs4)
+{
+	FT_Glyph glyph;
+
+	if (strike != NULL) {
+		return fb_atlas_get_glyph(strike, fstyle, ucs4)->advance;
+	}
+
+	glyph = fb_getglyph(fstyle, ucs4);
+	if (glyph == NULL) {
+		return 0;
+	}
+	return glyph->advance.x >> 16;
+}
+
 /* exported interface documented in framebuffer/freetype_font.h */
 nserror
 fb_font_width(const plot_font_style_t *fstyle,
@@ -437,18 +637,16 @@ fb_font_width(const plot_font_style_t *fstyle,
 {
         uint32_t ucs4;
         size_t nxtchr = 0;
-        FT_Glyph glyph;
+        struct fb_atlas_strike *strike;
+
+        strike = fb_atlas_get_strike(fstyle);
 
         *width = 0;
         while (nxtchr < length) {
                 ucs4 = utf8_to_ucs4(string + nxtchr, length - nxtchr);
                 nxtchr = utf8_next(string, length, nxtchr);
 
-                glyph = fb_getglyph(fstyle, ucs4);
-                if (glyph == NULL)
-                        continue;
-
-                *width += glyph->advance.x >> 16;
+                *width += fb_glyph_advance(strike, fstyle, ucs4);
         }
 	return NSERROR_OK;
 }
@@ -462,18 +660,16 @@ fb_font_position(const plot_font_style_t *fstyle,
 {
         uint32_t ucs4;
         size_t nxtchr = 0;
-        FT_Glyph glyph;
         int prev_x = 0;
+        struct fb_atlas_strike *strike;
+
+        strike = fb_atlas_get_strike(fstyle);
 
         *actual_x = 0;
         while (nxtchr < length) {
                 ucs4 = utf8_to_ucs4(string + nxtchr, length - nxtchr);
 
-                glyph = fb_getglyph(fstyle, ucs4);
-                if (glyph == NULL)
-                        continue;
-
-                *actual_x += glyph->advance.x >> 16;
+                *actual_x += fb_glyph_advance(strike, fstyle, ucs4);
                 if (*actual_x > x)
                         break;
 
@@ -521,22 +717,20 @@ fb_font_split(const plot_font_style_t *fstyle,
         size_t nxtchr = 0;
         int last_space_x = 0;
         int last_space_idx = 0;
-        FT_Glyph glyph;
+        struct fb_atlas_strike *strike;
+
+        strike = fb_atlas_get_strike(fstyle);
 
         *actual_x = 0;
         while (nxtchr < length) {
                 ucs4 = utf8_to_ucs4(string + nxtchr, length - nxtchr);
 
-                glyph = fb_getglyph(fstyle, ucs4);
-                if (glyph == NULL)
-                        continue;
-
                 if (ucs4 == 0x20) {
                         last_space_x = *actual_x;
                         last_space_idx = nxtchr;
                 }
 
-                *actual_x += glyph->advance.x >> 16;
+                *actual_x += fb_glyph_advance(strike, fstyle, ucs4);
                 if (*actual_x > x && last_space_idx != 0) {
                         /* string has exceeded available width and we've
                          * found a space; return previous space */
@@ -19,12 +19,51 @@
 #ifndef NETSURF_FB_FONT_FREETYPE_H
 #define NETSURF_FB_FONT_FREETYPE_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <ft2build.h>  
 #include FT_FREETYPE_H 
 #include FT_GLYPH_H
 
 extern int ft_load_type;
 
+struct fb_atlas_strike;
+
+/**
+ * Pre-rendered glyph held in the glyph atlas.
+ */
+struct fb_atlas_glyph {
+	uint32_t ucs4; /**< code point held in this slot */
+	bool loaded; /**< slot has been filled */
+	int advance; /**< horizontal advance in pixels */
+	int left; /**< offset of mask from pen position */
+	int top; /**< offset of mask top from baseline */
+	int width; /**< width of mask in pixels */
+	int rows; /**< height of mask in pixels */
+	uint8_t *mask; /**< 8bpp coverage with pitch of width, or NULL */
+};
+
 FT_Glyph fb_getglyph(const plot_font_style_t *fstyle, uint32_t ucs4);
 
+/**
+ * Get the glyph atlas strike for a font style.
+ *
+ * \param fstyle The font style to get the strike for.
+ * \return The strike or NULL on memory exhaustion.
+ */
+struct fb_atlas_strike *fb_atlas_get_strike(const plot_font_style_t *fstyle);
+
+/**
+ * Get a glyph from an atlas strike rendering it if necessary.
+ *
+ * The returned glyph is only valid until the next atlas operation.
+ *
+ * \param strike The strike obtained for fstyle.
+ * \param fstyle The font style the strike was obtained for.
+ * \param ucs4 The code point to get.
+ * \return The atlas glyph, its mask is NULL if it has no coverage.
+ */
+const struct fb_atlas_glyph *fb_atlas_get_glyph(struct fb_atlas_strike *strike, const plot_font_style_t *fstyle, uint32_t ucs4);
+
 #endif /* NETSURF_FB_FONT_FREETYPE_H */
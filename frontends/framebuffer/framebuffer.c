@@ -22,6 +22,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 #include <libnsfb.h>
 #include <libnsfb_plot.h>
@@ -398,9 +399,70 @@ framebuffer_plot_bitmap(const struct redraw_context *ctx,
 
 
 #ifdef FB_USE_FREETYPE
+
+/* largest text run coverage mask, in pixels, blended in a single pass */
+#define RUN_MASK_MAX (512 * 1024)
+
+/* coverage mask used to compose text runs */
+static uint8_t *run_mask;
+static size_t run_mask_size;
+
+/**
+ * Text plotting one glyph at a time.
+ *
+ * Used when a run is too large to compose into a single coverage mask.
+ *
+ * \param strike The glyph atlas strike for the style.
+ * \param fstyle plot style for this text
+ * \param x x coordinate
+ * \param y y coordinate
+ * \param text UTF-8 string to plot
+ * \param length length of string, in bytes
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+framebuffer_plot_text_glyphs(struct fb_atlas_strike *strike,
+		const struct plot_font_style *fstyle,
+		int x,
+		int y,
+		const char *text,
+		size_t length)
+{
+	uint32_t ucs4;
+	size_t nxtchr = 0;
+	const struct fb_atlas_glyph *ag;
+	nsfb_bbox_t loc;
+
+	while (nxtchr < length) {
+		ucs4 = utf8_to_ucs4(text + nxtchr, length - nxtchr);
+		nxtchr = utf8_next(text, length, nxtchr);
+
+		ag = fb_atlas_get_glyph(strike, fstyle, ucs4);
+		if (ag->mask != NULL) {
+			loc.x0 = x + ag->left;
+			loc.y0 = y - ag->top;
+			loc.x1 = loc.x0 + ag->width;
+			loc.y1 = loc.y0 + ag->rows;
+
+			nsfb_plot_glyph8(nsfb,
+					 &loc,
+					 ag->mask,
+					 ag->width,
+					 fstyle->foreground);
+		}
+		x += ag->advance;
+	}
+
+	return NSERROR_OK;
+}
+
 /**
  * Text plotting.
  *
+ * Glyph coverage for the visible part of the run is composed from the
+ * glyph atlas into a single mask which is then blended onto the
+ * surface in one operation.
+ *
  * \param ctx The current redraw context.
  * \param fstyle plot style for this text
  * \param x x coordinate
@@ -418,47 +480,111 @@ framebuffer_plot_text(const struct redraw_context *ctx,
 		size_t length)
 {
 	uint32_t ucs4;
-	size_t nxtchr = 0;
-	FT_Glyph glyph;
-	FT_BitmapGlyph bglyph;
-	nsfb_bbox_t loc;
+	size_t nxtchr;
+	struct fb_atlas_strike *strike;
+	const struct fb_atlas_glyph *ag;
+	nsfb_bbox_t clip;
+	nsfb_bbox_t run;
+	int pen;
+	int pitch;
+	size_t mask_size;
+	int row;
+	int col;
+	int gx;
+	int gy;
+	const uint8_t *src;
+	uint8_t *dst;
+
+	strike = fb_atlas_get_strike(fstyle);
+	if (strike == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	/* first pass establishes the extent of the run */
+	run.x0 = run.y0 = INT_MAX;
+	run.x1 = run.y1 = INT_MIN;
+	pen = x;
+	nxtchr = 0;
+	while (nxtchr < length) {
+		ucs4 = utf8_to_ucs4(text + nxtchr, length - nxtchr);
+		nxtchr = utf8_next(text, length, nxtchr);
+
+		ag = fb_atlas_get_glyph(strike, fstyle, ucs4);
+		if (ag->mask != NULL) {
+			run.x0 = min(run.x0, pen + ag->left);
+			run.y0 = min(run.y0, y - ag->top);
+			run.x1 = max(run.x1, pen + ag->left + ag->width);
+			run.y1 = max(run.y1, y - ag->top + ag->rows);
+		}
+		pen += ag->advance;
+	}
+
+	/* restrict the run to the visible area */
+	nsfb_plot_get_clip(nsfb, &clip);
+	run.x0 = max(run.x0, clip.x0);
+	run.y0 = max(run.y0, clip.y0);
+	run.x1 = min(run.x1, clip.x1);
+	run.y1 = min(run.y1, clip.y1);
+	if ((run.x1 <= run.x0) || (run.y1 <= run.y0)) {
+		/* nothing visible */
+		return NSERROR_OK;
+	}
+
+	pitch = run.x1 - run.x0;
+	mask_size = (size_t)pitch * (run.y1 - run.y0);
+	if (mask_size > RUN_MASK_MAX) {
+		return framebuffer_plot_text_glyphs(strike, fstyle,
+						    x, y, text, length);
+	}
 
+	if (mask_size > run_mask_size) {
+		dst = realloc(run_mask, mask_size);
+		if (dst == NULL) {
+			return framebuffer_plot_text_glyphs(strike, fstyle,
+							    x, y, text, length);
+		}
+		run_mask = dst;
+		run_mask_size = mask_size;
+	}
+	memset(run_mask, 0, mask_size);
+
+	/* second pass composes glyph coverage into the run mask */
+	pen = x;
+	nxtchr = 0;
 	while (nxtchr < length) {
 		ucs4 = utf8_to_ucs4(text + nxtchr, length - nxtchr);
 		nxtchr = utf8_next(text, length, nxtchr);
 
-		glyph = fb_getglyph(fstyle, ucs4);
-		if (glyph == NULL)
+		ag = fb_atlas_get_glyph(strike, fstyle, ucs4);
+		gx = pen + ag->left;
+		pen += ag->advance;
+
+		if ((ag->mask == NULL) ||
+		    (gx >= run.x1) ||
+		    (gx + ag->width <= run.x0)) {
 			continue;
+		}
 
-		if (glyph->format == FT_GLYPH_FORMAT_BITMAP) {
-			bglyph = (FT_BitmapGlyph)glyph;
-
-			loc.x0 = x + bglyph->left;
-			loc.y0 = y - bglyph->top;
-			loc.x1 = loc.x0 + bglyph->bitmap.width;
-			loc.y1 = loc.y0 + bglyph->bitmap.rows;
-
-			/* now, draw to our target surface */
-			if (bglyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
-			    nsfb_plot_glyph1(nsfb,
-					     &loc,
-					     bglyph->bitmap.buffer,
-					     bglyph->bitmap.pitch,
-					     fstyle->foreground);
-			} else {
-			    nsfb_plot_glyph8(nsfb,
-					     &loc,
-					     bglyph->bitmap.buffer,
-					     bglyph->bitmap.pitch,
-					     fstyle->foreground);
+		gy = y - ag->top;
+		for (row = max(0, run.y0 - gy);
+		     (row < ag->rows) && (gy + row < run.y1);
+		     row++) {
+			src = ag->mask + row * ag->width;
+			dst = run_mask + (gy + row - run.y0) * pitch;
+			for (col = max(0, run.x0 - gx);
+			     (col < ag->width) && (gx + col < run.x1);
+			     col++) {
+				/* overlapping glyphs keep greatest coverage */
+				if (src[col] > dst[gx + col - run.x0]) {
+					dst[gx + col - run.x0] = src[col];
+				}
 			}
 		}
-		x += glyph->advance.x >> 16;
-
 	}
-	return NSERROR_OK;
 
+	nsfb_plot_glyph8(nsfb, &run, run_mask, pitch, fstyle->foreground);
+
+	return NSERROR_OK;
 }
 
 #else
@@ -640,6 +766,11 @@ void
 framebuffer_finalise(void)
 {
     nsfb_free(nsfb);
+#ifdef FB_USE_FREETYPE
+    free(run_mask);
+    run_mask = NULL;
+    run_mask_size = 0;
+#endif
 }
 
 bool
@@ -31,6 +31,7 @@
 #include "netsurf/window.h"
 #include "netsurf/browser_window.h"
 #include "netsurf/plotters.h"
+#include "desktop/browser_history.h"
 
 #include "monkey/output.h"
 #include "monkey/browser.h"
@@ -617,6 +618,34 @@ monkey_window_handle_reload(int argc, char **argv)
 	}
 }
 
+static void
+monkey_window_handle_history(int argc, char **argv, bool back)
+{
+	struct gui_window *gw;
+	nserror err;
+
+	if (argc != 3) {
+		moutf(MOUT_ERROR, "WINDOW %s ARGS BAD\n", argv[1]);
+		return;
+	}
+
+	gw = monkey_find_window_by_num(atoi(argv[2]));
+
+	if (gw == NULL) {
+		moutf(MOUT_ERROR, "WINDOW NUM BAD");
+		return;
+	}
+
+	if (back) {
+		err = browser_window_history_back(gw->bw, false);
+	} else {
+		err = browser_window_history_forward(gw->bw, false);
+	}
+	if (err != NSERROR_OK) {
+		moutf(MOUT_ERROR, "WINDOW %s FAILED", argv[1]);
+	}
+}
+
 static void
 monkey_window_handle_exec(int argc, char **argv)
 {
@@ -697,6 +726,78 @@ monkey_window_handle_click(int argc, char **argv)
 	}
 }
 
+/**
+ * Time taken to reach a page load phase.
+ *
+ * \param times The load times of the window.
+ * \param phase The time the phase was reached, or zero.
+ * \return Milliseconds from the start of the load, or -1 if not reached.
+ */
+static long
+monkey_window_phase_time(const struct browser_window_load_times *times,
+			 uint64_t phase)
+{
+	if ((times->start == 0) || (phase == 0)) {
+		return -1;
+	}
+	return (long)(phase - times->start);
+}
+
+/**
+ * Time taken by the first redraw of a page load.
+ *
+ * \param times The load times of the window.
+ * \return Milliseconds spent redrawing, or -1 if not redrawn.
+ */
+static long
+monkey_window_redraw_time(const struct browser_window_load_times *times)
+{
+	if ((times->redraw_start == 0) || (times->redraw == 0)) {
+		return -1;
+	}
+	return (long)(times->redraw - times->redraw_start);
+}
+
+/**
+ * handle WINDOW TIMES command
+ *
+ * Reports the page load phase times of the last navigation in
+ * milliseconds, for benchmarking.  The redraw is reported as its own
+ * duration since it only happens when the driver requests it.
+ */
+static void
+monkey_window_handle_times(int argc, char **argv)
+{
+	struct gui_window *gw;
+	struct browser_window_load_times times;
+
+	if (argc != 3) {
+		moutf(MOUT_ERROR, "WINDOW TIMES ARGS BAD");
+		return;
+	}
+
+	gw = monkey_find_window_by_num(atoi(argv[2]));
+
+	if (gw == NULL) {
+		moutf(MOUT_ERROR, "WINDOW NUM BAD");
+		return;
+	}
+
+	if (browser_window_get_load_times(gw->bw, &times) != NSERROR_OK) {
+		moutf(MOUT_ERROR, "WINDOW TIMES FAILED");
+		return;
+	}
+
+	moutf(MOUT_WINDOW,
+	      "TIMES WIN %u FETCH %ld CONVERT %ld LAYOUT %ld REDRAW %ld DONE %ld",
+	      gw->win_num,
+	      monkey_window_phase_time(&times, times.fetch),
+	      monkey_window_phase_time(&times, times.convert),
+	      monkey_window_phase_time(&times, times.layout),
+	      monkey_window_redraw_time(&times),
+	      monkey_window_phase_time(&times, times.done));
+}
+
 void
 monkey_window_handle_command(int argc, char **argv)
 {
@@ -715,10 +816,16 @@ monkey_window_handle_command(int argc, char **argv)
 		monkey_window_handle_redraw(argc, argv);
 	} else if (strcmp(argv[1], "RELOAD") == 0) {
 		monkey_window_handle_reload(argc, argv);
+	} else if (strcmp(argv[1], "BACK") == 0) {
+		monkey_window_handle_history(argc, argv, true);
+	} else if (strcmp(argv[1], "FORWARD") == 0) {
+		monkey_window_handle_history(argc, argv, false);
 	} else if (strcmp(argv[1], "EXEC") == 0) {
 		monkey_window_handle_exec(argc, argv);
 	} else if (strcmp(argv[1], "CLICK") == 0) {
 		monkey_window_handle_click(argc, argv);
+	} else if (strcmp(argv[1], "TIMES") == 0) {
+		monkey_window_handle_times(argc, argv);
 	} else {
 		moutf(MOUT_ERROR, "WINDOW COMMAND UNKNOWN %s\n", argv[1]);
 	}
@@ -64,8 +64,11 @@ static nserror
 gui_download_window_data(struct gui_download_window *dw, 
                          const char *data, unsigned int size)
 {
-	moutf(MOUT_DOWNLOAD, "DATA DWIN %u SIZE %u DATA %s",
-		dw->dwin_num, size, data);
+	/* the data is not terminated and may be binary so only the
+	 * size is reported
+	 */
+	moutf(MOUT_DOWNLOAD, "DATA DWIN %u SIZE %u",
+		dw->dwin_num, size);
 	return NSERROR_OK;
 }
 
@@ -77,6 +77,7 @@ void monkey_fetch_filetype_init(const char *mimefile)
 	hash_add(mime_hash, "mng", "image/mng");
 	hash_add(mime_hash, "webp", "image/webp");
 	hash_add(mime_hash, "spr", "image/x-riscos-sprite");
+	hash_add(mime_hash, "bin", "application/octet-stream");
 
 	/* first, check to see if /etc/mime.types in preference */
 	if ((stat("/etc/mime.types", &statbuf) == 0) &&
@@ -26,6 +26,7 @@
 #include <errno.h>
 #include <signal.h>
 
+#include "netsurf/inttypes.h"
 #include "utils/config.h"
 #include "utils/sys_time.h"
 #include "utils/log.h"
@@ -33,12 +34,14 @@
 #include "utils/filepath.h"
 #include "utils/nsoption.h"
 #include "utils/nsurl.h"
+#include "utils/memtrack.h"
 #include "netsurf/misc.h"
 #include "netsurf/netsurf.h"
 #include "netsurf/url_db.h"
 #include "netsurf/cookie_db.h"
 #include "content/fetch.h"
 #include "content/backing_store.h"
+#include "content/hlcache.h"
 
 #include "monkey/output.h"
 #include "monkey/dispatch.h"
@@ -232,6 +235,28 @@ static void quit_handler(int argc, char **argv)
 	monkey_done = true;
 }
 
+static void monkey_memory_handle_command(int argc, char **argv)
+{
+	struct memtrack_stats stats;
+	enum memtrack_subsystem subsystem;
+
+	for (subsystem = 0;
+	     subsystem < MEMTRACK_SUBSYSTEM_COUNT;
+	     subsystem++) {
+		if (memtrack_get_stats(subsystem, &stats) != NSERROR_OK) {
+			moutf(MOUT_GENERIC, "MEMORY DISABLED");
+			return;
+		}
+		moutf(MOUT_GENERIC,
+		      "MEMORY SUBSYSTEM %s CURRENT %"PRIsizet" PEAK %"PRIsizet
+		      " ALLOCS %lu FREES %lu",
+		      memtrack_subsystem_name(subsystem),
+		      stats.current, stats.peak,
+		      stats.allocs, stats.frees);
+	}
+	moutf(MOUT_GENERIC, "MEMORY END");
+}
+
 static void monkey_options_handle_command(int argc, char **argv)
 {
 	nsoption_commandline(&argc, argv, nsoptions);
@@ -484,6 +509,11 @@ main(int argc, char **argv)
 		die("login handler failed to register");
 	}
 
+	ret = monkey_register_handler("MEMORY", monkey_memory_handle_command);
+	if (ret != NSERROR_OK) {
+		die("memory handler failed to register");
+	}
+
 
 	moutf(MOUT_GENERIC, "STARTED");
 	monkey_run();
@@ -491,6 +521,15 @@ main(int argc, char **argv)
 	moutf(MOUT_GENERIC, "CLOSING_DOWN");
 	monkey_kill_browser_windows();
 
+	{
+		unsigned int lookups, probes;
+		unsigned long time_us;
+
+		hlcache_get_lookup_stats(&lookups, &probes, &time_us);
+		moutf(MOUT_GENERIC, "HLCACHE LOOKUPS %u PROBES %u TIME %lu",
+		      lookups, probes, time_us);
+	}
+
 	netsurf_exit();
 	moutf(MOUT_GENERIC, "FINISHED");
 
@@ -26,6 +26,7 @@
 #define NETSURF_BROWSER_WINDOW_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #include "utils/errors.h"
@@ -811,4 +812,36 @@ nserror browser_window_show_cookies(
 nserror browser_window_show_certificates(
 		struct browser_window *bw);
 
+/**
+ * Times at which the phases of a page load were reached.
+ *
+ * All times are monotonic milliseconds as returned by
+ * nsu_getmonotonic_ms(), with zero for phases not yet reached.
+ *
+ * The first redraw happens whenever the frontend asks for it, so only
+ * the interval from redraw_start to redraw reflects the core's work.
+ */
+struct browser_window_load_times {
+	uint64_t start; /**< Navigation started fetching */
+	uint64_t fetch; /**< Document data started arriving */
+	uint64_t convert; /**< Document was converted and became ready */
+	uint64_t layout; /**< First layout of the document completed */
+	uint64_t redraw_start; /**< First redraw of the document started */
+	uint64_t redraw; /**< First redraw of the document completed */
+	uint64_t done; /**< Document and all its objects finished loading */
+};
+
+/**
+ * Get the page load phase times for the last navigation of a window.
+ *
+ * Used by benchmarking frontends to measure load time regressions.
+ *
+ * \param bw  A browser window.
+ * \param times  Updated with the load phase times.
+ * \return NSERROR_OK, or appropriate error otherwise.
+ */
+nserror browser_window_get_load_times(
+		const struct browser_window *bw,
+		struct browser_window_load_times *times);
+
 #endif
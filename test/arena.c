@@ -0,0 +1,244 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Test arena allocator operations.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "utils/arena.h"
+
+#define CHUNK_SIZE 1024
+
+/** number of objects the finaliser has been called for */
+static unsigned int finalised;
+
+static void test_finaliser(void *object)
+{
+	unsigned int *value = object;
+
+	/* each object must only be finalised once */
+	ck_assert_uint_eq(*value, 0);
+	*value = 1;
+	finalised++;
+}
+
+/* Tests */
+
+/**
+ * Test arena creation and destruction
+ */
+START_TEST(arena_create_test)
+{
+	struct arena *a;
+	size_t used, reserved, objects;
+
+	a = arena_create(CHUNK_SIZE, NULL);
+	ck_assert(a != NULL);
+
+	arena_get_stats(a, &used, &reserved, &objects);
+	ck_assert_uint_eq(used, 0);
+	ck_assert_uint_eq(objects, 0);
+
+	arena_destroy(a);
+}
+END_TEST
+
+/**
+ * Test destroying no arena is safe
+ */
+START_TEST(arena_destroy_null_test)
+{
+	arena_destroy(NULL);
+}
+END_TEST
+
+/**
+ * Test allocations are distinct, aligned and writable
+ */
+START_TEST(arena_alloc_test)
+{
+	struct arena *a;
+	unsigned char *blocks[100];
+	size_t used, reserved;
+	int i;
+
+	a = arena_create(CHUNK_SIZE, NULL);
+	ck_assert(a != NULL);
+
+	for (i = 0; i < 100; i++) {
+		blocks[i] = arena_alloc(a, i + 1);
+		ck_assert(blocks[i] != NULL);
+		ck_assert_uint_eq((uintptr_t)blocks[i] % sizeof(void *), 0);
+		memset(blocks[i], i, i + 1);
+	}
+
+	for (i = 0; i < 100; i++) {
+		ck_assert_uint_eq(blocks[i][0], i);
+		ck_assert_uint_eq(blocks[i][i], i);
+	}
+
+	arena_get_stats(a, &used, &reserved, NULL);
+	ck_assert(used >= (100 * 101) / 2);
+	ck_assert(reserved >= used);
+
+	arena_destroy(a);
+}
+END_TEST
+
+/**
+ * Test allocations larger than a chunk
+ */
+START_TEST(arena_alloc_large_test)
+{
+	struct arena *a;
+	char *small, *large;
+
+	a = arena_create(CHUNK_SIZE, NULL);
+	ck_assert(a != NULL);
+
+	small = arena_alloc(a, 16);
+	ck_assert(small != NULL);
+	memset(small, 'a', 16);
+
+	large = arena_alloc(a, CHUNK_SIZE * 4);
+	ck_assert(large != NULL);
+	memset(large, 'b', CHUNK_SIZE * 4);
+
+	ck_assert_int_eq(small[15], 'a');
+
+	arena_destroy(a);
+}
+END_TEST
+
+/**
+ * Test string and memory duplication
+ */
+START_TEST(arena_dup_test)
+{
+	struct arena *a;
+	char *s;
+	int *v;
+	const int data[4] = { 1, 2, 3, 4 };
+
+	a = arena_create(0, NULL);
+	ck_assert(a != NULL);
+
+	s = arena_strdup(a, "NetSurf");
+	ck_assert_str_eq(s, "NetSurf");
+
+	s = arena_strndup(a, "NetSurf", 3);
+	ck_assert_str_eq(s, "Net");
+
+	s = arena_strndup(a, "Net", 30);
+	ck_assert_str_eq(s, "Net");
+
+	s = arena_strdup(a, "");
+	ck_assert_str_eq(s, "");
+
+	v = arena_memdup(a, data, sizeof(data));
+	ck_assert(v != NULL);
+	ck_assert_int_eq(memcmp(v, data, sizeof(data)), 0);
+
+	arena_destroy(a);
+}
+END_TEST
+
+/**
+ * Test finaliser is called once for every registered object
+ */
+START_TEST(arena_finaliser_test)
+{
+	struct arena *a;
+	unsigned int *obj;
+	unsigned int i;
+	size_t objects;
+
+	a = arena_create(CHUNK_SIZE, test_finaliser);
+	ck_assert(a != NULL);
+
+	/* plain allocations are not finalised */
+	ck_assert(arena_alloc(a, 32) != NULL);
+
+	for (i = 0; i < 1000; i++) {
+		obj = arena_alloc_object(a, sizeof(*obj));
+		ck_assert(obj != NULL);
+		*obj = 0;
+	}
+
+	arena_get_stats(a, NULL, NULL, &objects);
+	ck_assert_uint_eq(objects, 1000);
+
+	finalised = 0;
+	arena_destroy(a);
+	ck_assert_uint_eq(finalised, 1000);
+}
+END_TEST
+
+
+/**
+ * Arena API test case
+ */
+static TCase *arena_api_case_create(void)
+{
+	TCase *tc;
+
+	tc = tcase_create("API");
+
+	tcase_add_test(tc, arena_create_test);
+	tcase_add_test(tc, arena_destroy_null_test);
+	tcase_add_test(tc, arena_alloc_test);
+	tcase_add_test(tc, arena_alloc_large_test);
+	tcase_add_test(tc, arena_dup_test);
+	tcase_add_test(tc, arena_finaliser_test);
+
+	return tc;
+}
+
+
+static Suite *arena_suite(void)
+{
+	Suite *s;
+	s = suite_create("Arena allocator");
+
+	suite_add_tcase(s, arena_api_case_create());
+
+	return s;
+}
+
+int main(int argc, char **argv)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = arena_suite();
+
+	sr = srunner_create(s);
+	srunner_run_all(sr, CK_ENV);
+
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,736 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Tests for the filesystem backing store.
+ */
+
+#define _GNU_SOURCE
+
+#include "utils/config.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <check.h>
+
+#include <libwapcaplet/libwapcaplet.h>
+
+#include "utils/errors.h"
+#include "utils/nsurl.h"
+#include "utils/corestrings.h"
+#include "utils/file.h"
+#include "netsurf/misc.h"
+#include "desktop/gui_internal.h"
+#include "desktop/gui_table.h"
+#include "content/backing_store.h"
+
+#define NELEMS(x)  (sizeof(x) / sizeof((x)[0]))
+
+/** number of entries in the synthetic start-up benchmark cache */
+#define BENCH_ENTRIES 100000
+
+/** number of entries looked up after start-up in the benchmark */
+#define BENCH_LOOKUPS 10000
+
+/** number of entries stored by the background write test */
+#define ASYNC_ENTRIES 2000
+
+/** number of entries stored by the eviction test */
+#define EVICT_ENTRIES 4000
+
+/** number of compressible entries stored by the compressed eviction test */
+#define EVICT_COMPRESS_ENTRIES 64
+
+/** maximum number of scheduled callbacks */
+#define MAX_SCHEDULE 8
+
+/* Stubs */
+nserror nslog_set_filter_by_options() { return NSERROR_OK; }
+
+/** set by the backing store when the entries have been written */
+int loading_timeout;
+
+/** scheduled callbacks */
+static struct {
+	void (*callback)(void *p);
+	void *p;
+	int t;
+} schedule_list[MAX_SCHEDULE];
+
+static nserror tst_schedule(int t, void (*callback)(void *p), void *p)
+{
+	unsigned int idx;
+	int slot = -1;
+
+	for (idx = 0; idx < MAX_SCHEDULE; idx++) {
+		if ((schedule_list[idx].callback == callback) &&
+		    (schedule_list[idx].p == p)) {
+			schedule_list[idx].callback = NULL;
+		}
+		if ((slot == -1) && (schedule_list[idx].callback == NULL)) {
+			slot = idx;
+		}
+	}
+
+	if (t >= 0) {
+		ck_assert(slot != -1);
+		schedule_list[slot].callback = callback;
+		schedule_list[slot].p = p;
+		schedule_list[slot].t = t;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * run scheduled callbacks which are due within a second
+ *
+ * Longer running timers such as control data maintenance are left
+ * for finalisation.
+ */
+static void run_schedule(void)
+{
+	void (*callback)(void *p);
+	unsigned int idx;
+
+	for (idx = 0; idx < MAX_SCHEDULE; idx++) {
+		callback = schedule_list[idx].callback;
+		if ((callback != NULL) && (schedule_list[idx].t <= 1000)) {
+			schedule_list[idx].callback = NULL;
+			callback(schedule_list[idx].p);
+		}
+	}
+}
+
+/** thread the tests run on */
+static pthread_t main_thread;
+
+/** flag indicating writes from the main thread are being counted */
+static bool watch_writes;
+
+/** number of writes made from the main thread while watched */
+static unsigned int main_thread_writes;
+
+/* interpose write() to count calls made from the main thread */
+ssize_t write(int fd, const void *buf, size_t count)
+{
+	static ssize_t (*real_write)(int, const void *, size_t);
+
+	if (real_write == NULL) {
+		real_write = dlsym(RTLD_NEXT, "write");
+	}
+	if (pthread_equal(pthread_self(), main_thread) && watch_writes) {
+		main_thread_writes++;
+	}
+	return real_write(fd, buf, count);
+}
+
+/* interpose pwrite() to count calls made from the main thread */
+ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset)
+{
+	static ssize_t (*real_pwrite)(int, const void *, size_t, off_t);
+
+	if (real_pwrite == NULL) {
+		real_pwrite = dlsym(RTLD_NEXT, "pwrite");
+	}
+	if (pthread_equal(pthread_self(), main_thread) && watch_writes) {
+		main_thread_writes++;
+	}
+	return real_pwrite(fd, buf, count, offset);
+}
+
+static struct gui_misc_table tst_misc_table = {
+	.schedule = tst_schedule,
+};
+
+static struct netsurf_table tst_table = {
+	.misc = &tst_misc_table,
+};
+
+struct netsurf_table *guit = &tst_table;
+
+/** path to the backing store used by each test */
+static char store_path[] = "/tmp/fsbstoreXXXXXX";
+
+static struct llcache_store_parameters store_params = {
+	.path = store_path,
+	.limit = 1024 * 1024 * 1024,
+	.hysteresis = 1024 * 1024,
+};
+
+/** small store for eviction */
+static struct llcache_store_parameters evict_params = {
+	.path = store_path,
+	.limit = 16 * 1024,
+	.hysteresis = 4 * 1024,
+};
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void store_create(void)
+{
+	tst_table.file = default_file_table;
+	main_thread = pthread_self();
+
+	strcpy(store_path, "/tmp/fsbstoreXXXXXX");
+	ck_assert(mkdtemp(store_path) != NULL);
+
+	ck_assert(corestrings_init() == NSERROR_OK);
+}
+
+static void store_teardown(void)
+{
+	netsurf_recursive_rm(store_path);
+
+	corestrings_fini();
+}
+
+static nsurl *make_url(const char *fmt, unsigned int n)
+{
+	char url[128];
+	nsurl *nsurl;
+
+	snprintf(url, sizeof(url), fmt, n);
+	ck_assert(nsurl_create(url, &nsurl) == NSERROR_OK);
+
+	return nsurl;
+}
+
+/**
+ * store an element containing its own URL text
+ *
+ * Waits for background writes to complete if too many are
+ * outstanding, as the low level cache would by retrying later.
+ */
+static void store_url(nsurl *url, enum backing_store_flags flags)
+{
+	struct timespec delay = { 0, 1000000 };
+	uint8_t *data;
+	size_t len = nsurl_length(url);
+	nserror ret;
+
+	data = malloc(len);
+	ck_assert(data != NULL);
+	memcpy(data, nsurl_access(url), len);
+
+	while ((ret = filesystem_llcache_table->store(url, flags, data, len)) ==
+	       NSERROR_NOSPACE) {
+		nanosleep(&delay, NULL);
+		run_schedule();
+	}
+	ck_assert(ret == NSERROR_OK);
+	ck_assert(filesystem_llcache_table->release(url, flags) ==
+		  NSERROR_OK);
+}
+
+/**
+ * check an element containing its own URL text
+ */
+static void check_url(nsurl *url, enum backing_store_flags flags)
+{
+	uint8_t *data;
+	size_t len;
+
+	ck_assert(filesystem_llcache_table->fetch(url, flags, &data, &len) ==
+		  NSERROR_OK);
+	ck_assert_uint_eq(len, nsurl_length(url));
+	ck_assert(memcmp(data, nsurl_access(url), len) == 0);
+	ck_assert(filesystem_llcache_table->release(url, flags) ==
+		  NSERROR_OK);
+}
+
+static const char *persist_urls[] = {
+	"http://www.example.org/",
+	"http://www.example.org/style.css",
+	"https://cdn.example.com/js/app.js?v=42",
+	"http://www.example.org/images/logo.png#top",
+};
+
+/**
+ * Entries persist across finalise and initialise
+ */
+START_TEST(store_persist_test)
+{
+	nsurl *url;
+	uint8_t *data;
+	size_t len;
+	unsigned int idx;
+
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	for (idx = 0; idx < NELEMS(persist_urls); idx++) {
+		url = make_url(persist_urls[idx], 0);
+		store_url(url, BACKING_STORE_NONE);
+		store_url(url, BACKING_STORE_META);
+		nsurl_unref(url);
+	}
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	for (idx = 0; idx < NELEMS(persist_urls); idx++) {
+		url = make_url(persist_urls[idx], 0);
+		check_url(url, BACKING_STORE_NONE);
+		check_url(url, BACKING_STORE_META);
+		nsurl_unref(url);
+	}
+
+	/* a URL which was never stored is not found */
+	url = make_url("http://www.example.org/missing", 0);
+	ck_assert(filesystem_llcache_table->fetch(url,
+						  BACKING_STORE_NONE,
+						  &data,
+						  &len) == NSERROR_NOT_FOUND);
+	nsurl_unref(url);
+
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+}
+END_TEST
+
+/**
+ * A damaged entries index is rejected
+ */
+START_TEST(store_corrupt_test)
+{
+	nsurl *url;
+	char fname[64];
+	char byte;
+	int fd;
+
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	url = make_url(persist_urls[0], 0);
+	store_url(url, BACKING_STORE_NONE);
+	nsurl_unref(url);
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+
+	snprintf(fname, sizeof(fname), "%s/entries", store_path);
+	fd = open(fname, O_RDWR);
+	ck_assert(fd != -1);
+	ck_assert(pread(fd, &byte, 1, 40) == 1);
+	byte ^= 0x55;
+	ck_assert(pwrite(fd, &byte, 1, 40) == 1);
+	close(fd);
+
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_INIT_FAILED);
+}
+END_TEST
+
+/**
+ * Storing objects never writes to the disc from the caller's thread
+ */
+START_TEST(store_async_test)
+{
+	nsurl *url;
+	unsigned int idx;
+	const char *fmt = "http://www.example.org/async/%u";
+
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+
+	main_thread_writes = 0;
+	watch_writes = true;
+	for (idx = 0; idx < ASYNC_ENTRIES; idx++) {
+		url = make_url(fmt, idx);
+		store_url(url, BACKING_STORE_NONE);
+		store_url(url, BACKING_STORE_META);
+		nsurl_unref(url);
+		if ((idx % 100) == 0) {
+			run_schedule();
+		}
+	}
+	run_schedule();
+	watch_writes = false;
+
+	ck_assert_uint_eq(main_thread_writes, 0);
+
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+
+	/* everything queued was written by finalise */
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	for (idx = 0; idx < ASYNC_ENTRIES; idx += 97) {
+		url = make_url(fmt, idx);
+		check_url(url, BACKING_STORE_NONE);
+		check_url(url, BACKING_STORE_META);
+		nsurl_unref(url);
+	}
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+}
+END_TEST
+
+/**
+ * Frequently used entries survive eviction of unused ones
+ */
+START_TEST(store_evict_test)
+{
+	nsurl *url;
+	uint8_t *data;
+	size_t len;
+	unsigned int idx;
+	unsigned int use;
+	const char *hot_fmt = "http://www.example.org/hot/%u";
+	const char *cold_fmt = "http://www.example.org/cold/%u";
+
+	ck_assert(filesystem_llcache_table->initialise(&evict_params) ==
+		  NSERROR_OK);
+
+	for (idx = 0; idx < 10; idx++) {
+		url = make_url(hot_fmt, idx);
+		store_url(url, BACKING_STORE_NONE);
+		for (use = 0; use < 3; use++) {
+			check_url(url, BACKING_STORE_NONE);
+		}
+		nsurl_unref(url);
+	}
+
+	for (idx = 0; idx < EVICT_ENTRIES; idx++) {
+		url = make_url(cold_fmt, idx);
+		store_url(url, BACKING_STORE_NONE);
+		nsurl_unref(url);
+		run_schedule();
+	}
+
+	for (idx = 0; idx < 10; idx++) {
+		url = make_url(hot_fmt, idx);
+		check_url(url, BACKING_STORE_NONE);
+		nsurl_unref(url);
+	}
+
+	/* the first unused entries have been evicted */
+	url = make_url(cold_fmt, 0);
+	ck_assert(filesystem_llcache_table->fetch(url,
+						  BACKING_STORE_NONE,
+						  &data,
+						  &len) == NSERROR_NOT_FOUND);
+	nsurl_unref(url);
+
+	url = make_url(cold_fmt, EVICT_ENTRIES - 1);
+	check_url(url, BACKING_STORE_NONE);
+	nsurl_unref(url);
+
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+}
+END_TEST
+
+/**
+ * generate element data which is either textual or random
+ */
+static uint8_t *make_data(size_t len, bool text, unsigned int seed)
+{
+	static const char *words[] = {
+		"<div class=\"", "item", "\">", "</div>\n", "<a href=\"/",
+		"page", "\">", "link", "</a> ", "<p>", "</p>\n", "content",
+	};
+	uint8_t *data;
+	size_t used = 0;
+	size_t wlen;
+
+	data = malloc(len);
+	ck_assert(data != NULL);
+
+	while (used < len) {
+		seed = (seed * 1103515245) + 12345;
+		if (text) {
+			wlen = strlen(words[(seed >> 16) % NELEMS(words)]);
+			if (wlen > (len - used)) {
+				wlen = len - used;
+			}
+			memcpy(data + used,
+			       words[(seed >> 16) % NELEMS(words)],
+			       wlen);
+			used += wlen;
+		} else {
+			data[used++] = seed >> 16;
+		}
+	}
+
+	return data;
+}
+
+static const struct {
+	const char *url; /**< url of element */
+	size_t len; /**< length of element data */
+	bool text; /**< element data is textual */
+	enum backing_store_flags flags; /**< store flags */
+	bool compressed; /**< element is expected to be compressed */
+} compress_elems[] = {
+	{ "http://www.example.org/index.html", 64 * 1024, true,
+	  BACKING_STORE_COMPRESSIBLE, true },
+	{ "http://www.example.org/small.css", 2 * 1024, true,
+	  BACKING_STORE_COMPRESSIBLE, true },
+	{ "http://www.example.org/tiny.js", 200, true,
+	  BACKING_STORE_COMPRESSIBLE, false },
+	{ "http://www.example.org/random.bin", 16 * 1024, false,
+	  BACKING_STORE_COMPRESSIBLE, false },
+	{ "http://www.example.org/image.png", 16 * 1024, true,
+	  BACKING_STORE_NONE, false },
+};
+
+/**
+ * Compressible elements are stored compressed and fetched intact
+ */
+START_TEST(store_compress_test)
+{
+	struct backing_store_stats stats;
+	nsurl *url;
+	uint8_t *data;
+	uint8_t *expect;
+	size_t len;
+	size_t raw = 0;
+	unsigned int count = 0;
+	unsigned int idx;
+
+	ck_assert(filesystem_llcache_table->stats != NULL);
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	for (idx = 0; idx < NELEMS(compress_elems); idx++) {
+		url = make_url(compress_elems[idx].url, 0);
+		data = make_data(compress_elems[idx].len,
+				 compress_elems[idx].text,
+				 idx);
+		ck_assert(filesystem_llcache_table->store(url,
+				compress_elems[idx].flags,
+				data,
+				compress_elems[idx].len) == NSERROR_OK);
+		ck_assert(filesystem_llcache_table->release(url,
+				compress_elems[idx].flags) == NSERROR_OK);
+		nsurl_unref(url);
+
+		raw += compress_elems[idx].len;
+		if (compress_elems[idx].compressed) {
+			count++;
+		}
+	}
+
+	ck_assert(filesystem_llcache_table->stats(&stats) == NSERROR_OK);
+	ck_assert_uint_eq(stats.compress_count, count);
+	ck_assert_uint_eq(stats.raw_alloc, raw);
+	ck_assert(stats.compress_out * 2 < stats.compress_in);
+	ck_assert(stats.total_alloc < stats.raw_alloc);
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+
+	/* elements are decompressed when fetched after a restart */
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	for (idx = 0; idx < NELEMS(compress_elems); idx++) {
+		url = make_url(compress_elems[idx].url, 0);
+		expect = make_data(compress_elems[idx].len,
+				   compress_elems[idx].text,
+				   idx);
+		ck_assert(filesystem_llcache_table->fetch(url,
+				compress_elems[idx].flags,
+				&data,
+				&len) == NSERROR_OK);
+		ck_assert_uint_eq(len, compress_elems[idx].len);
+		ck_assert(memcmp(data, expect, len) == 0);
+		ck_assert(filesystem_llcache_table->release(url,
+				compress_elems[idx].flags) == NSERROR_OK);
+		free(expect);
+		nsurl_unref(url);
+	}
+
+	ck_assert(filesystem_llcache_table->stats(&stats) == NSERROR_OK);
+	ck_assert_uint_eq(stats.decompress_count, count);
+	ck_assert_uint_eq(stats.raw_alloc, raw);
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+}
+END_TEST
+
+/**
+ * Compressed entries are evicted to bring the store within its limit
+ */
+START_TEST(store_evict_compress_test)
+{
+	struct timespec delay = { 0, 1000000 };
+	struct backing_store_stats stats;
+	nsurl *url;
+	uint8_t *data;
+	unsigned int idx;
+	nserror ret;
+	const char *fmt = "http://www.example.org/text/%u.html";
+
+	/* fill a large store with compressed entries */
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	for (idx = 0; idx < EVICT_COMPRESS_ENTRIES; idx++) {
+		url = make_url(fmt, idx);
+		data = make_data(4 * 1024, true, idx);
+		while ((ret = filesystem_llcache_table->store(url,
+				BACKING_STORE_COMPRESSIBLE,
+				data,
+				4 * 1024)) == NSERROR_NOSPACE) {
+			nanosleep(&delay, NULL);
+			run_schedule();
+		}
+		ck_assert(ret == NSERROR_OK);
+		ck_assert(filesystem_llcache_table->release(url,
+				BACKING_STORE_COMPRESSIBLE) == NSERROR_OK);
+		nsurl_unref(url);
+	}
+	ck_assert(filesystem_llcache_table->stats(&stats) == NSERROR_OK);
+	ck_assert_uint_eq(stats.compress_count, EVICT_COMPRESS_ENTRIES);
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+
+	/* reopen the entries in a store far smaller than they occupy */
+	ck_assert(filesystem_llcache_table->initialise(&evict_params) ==
+		  NSERROR_OK);
+	ck_assert(filesystem_llcache_table->stats(&stats) == NSERROR_OK);
+	ck_assert(stats.total_alloc > (evict_params.limit * 2));
+
+	/* each store evicts until the limit is reached */
+	for (idx = 0; idx < EVICT_COMPRESS_ENTRIES; idx++) {
+		url = make_url("http://www.example.org/small/%u", idx);
+		store_url(url, BACKING_STORE_NONE);
+		nsurl_unref(url);
+		run_schedule();
+
+		ck_assert(filesystem_llcache_table->stats(&stats) ==
+			  NSERROR_OK);
+		if (stats.total_alloc < evict_params.limit) {
+			break;
+		}
+	}
+	ck_assert(stats.total_alloc < evict_params.limit);
+
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+}
+END_TEST
+
+/**
+ * Start-up time with a synthetic cache
+ *
+ * Not a pass/fail test; reports the time to initialise a backing
+ * store holding BENCH_ENTRIES entries and to look entries up after.
+ */
+START_TEST(store_startup_bench_test)
+{
+	nsurl *url;
+	unsigned int idx;
+	double start;
+	double elapsed;
+	const char *fmt = "http://www.example.org/images/%u/photo.jpg?size=large";
+
+	/* small elements fit in block files avoiding a file per entry */
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	for (idx = 0; idx < BENCH_ENTRIES; idx++) {
+		url = make_url(fmt, idx);
+		store_url(url, (idx & 1) ? BACKING_STORE_META :
+			  BACKING_STORE_NONE);
+		nsurl_unref(url);
+	}
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+
+	start = bench_now();
+	ck_assert(filesystem_llcache_table->initialise(&store_params) ==
+		  NSERROR_OK);
+	elapsed = bench_now() - start;
+	fprintf(stderr, "start-up with %u entries: %.1f ms\n",
+		BENCH_ENTRIES, elapsed * 1e3);
+
+	start = bench_now();
+	for (idx = 0; idx < BENCH_LOOKUPS; idx++) {
+		url = make_url(fmt, idx * (BENCH_ENTRIES / BENCH_LOOKUPS));
+		check_url(url, ((idx * (BENCH_ENTRIES / BENCH_LOOKUPS)) & 1) ?
+			  BACKING_STORE_META : BACKING_STORE_NONE);
+		nsurl_unref(url);
+	}
+	elapsed = bench_now() - start;
+	fprintf(stderr, "first use of %u entries: %.1f ms\n",
+		BENCH_LOOKUPS, elapsed * 1e3);
+
+	ck_assert(filesystem_llcache_table->finalise() == NSERROR_OK);
+}
+END_TEST
+
+static TCase *store_case_create(void)
+{
+	TCase *tc;
+	tc = tcase_create("Persistence");
+
+	tcase_add_checked_fixture(tc, store_create, store_teardown);
+
+	tcase_add_test(tc, store_persist_test);
+	tcase_add_test(tc, store_corrupt_test);
+	tcase_add_test(tc, store_async_test);
+	tcase_add_test(tc, store_evict_test);
+	tcase_add_test(tc, store_compress_test);
+	tcase_add_test(tc, store_evict_compress_test);
+
+	return tc;
+}
+
+static TCase *store_bench_case_create(void)
+{
+	TCase *tc;
+	tc = tcase_create("Benchmark");
+
+	tcase_add_checked_fixture(tc, store_create, store_teardown);
+
+	tcase_add_test(tc, store_startup_bench_test);
+	tcase_set_timeout(tc, 120);
+
+	return tc;
+}
+
+static Suite *store_suite_create(void)
+{
+	Suite *s;
+	s = suite_create("Filesystem backing store");
+
+	suite_add_tcase(s, store_case_create());
+
+	/* timing is only run on request by make bench */
+	if (getenv("NETSURF_TEST_BENCH") != NULL) {
+		suite_add_tcase(s, store_bench_case_create());
+	}
+
+	return s;
+}
+
+int main(int argc, char **argv)
+{
+	int number_failed;
+	SRunner *sr;
+
+	sr = srunner_create(store_suite_create());
+
+	srunner_run_all(sr, CK_ENV);
+
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
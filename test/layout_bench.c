@@ -0,0 +1,700 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Layout and redraw microbenchmark.
+ *
+ * Loads local HTML documents into html contents and times box
+ * construction, layout at several viewport widths and redraw over a
+ * scroll sweep of the whole document.
+ *
+ * Text is measured with the fixed metrics used by the monkey frontend
+ * and plot operations are counted but not rendered so the results
+ * depend only on the core.  The remaining frontend operations are
+ * provided by the monkey frontend objects this is linked with.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <nsutils/time.h>
+
+#include "utils/errors.h"
+#include "utils/log.h"
+#include "utils/utf8.h"
+#include "utils/file.h"
+#include "utils/filepath.h"
+#include "utils/messages.h"
+#include "utils/nsoption.h"
+#include "utils/nsurl.h"
+#include "netsurf/inttypes.h"
+#include "netsurf/netsurf.h"
+#include "netsurf/misc.h"
+#include "netsurf/layout.h"
+#include "netsurf/plotters.h"
+#include "netsurf/content.h"
+#include "content/fetch.h"
+#include "content/hlcache.h"
+#include "html/html.h"
+
+#include "monkey/browser.h"
+#include "monkey/fetch.h"
+#include "monkey/filetype.h"
+#include "monkey/schedule.h"
+#include "monkey/bitmap.h"
+
+/** Default number of times each document is measured */
+#define BENCH_ITERATIONS 5
+
+/** Maximum number of layout widths */
+#define BENCH_MAX_WIDTHS 8
+
+/** Viewport height used for layout and the redraw sweep */
+#define BENCH_VIEWPORT_HEIGHT 768
+
+/** Time allowed for a document to load */
+#define BENCH_LOAD_TIMEOUT_MS 30000
+
+/** resource search path vector, used by the monkey fetch table */
+char **respaths;
+
+/** Plot operations counted by the benchmark plotter */
+enum bench_plot_op {
+	BENCH_PLOT_CLIP,
+	BENCH_PLOT_ARC,
+	BENCH_PLOT_DISC,
+	BENCH_PLOT_LINE,
+	BENCH_PLOT_RECTANGLE,
+	BENCH_PLOT_POLYGON,
+	BENCH_PLOT_PATH,
+	BENCH_PLOT_BITMAP,
+	BENCH_PLOT_TEXT,
+	BENCH_PLOT_OP_COUNT
+};
+
+/** Counters accumulated by the stub font and plot backends */
+static struct {
+	unsigned long font_calls; /**< text measurement operations */
+	unsigned long plot_ops[BENCH_PLOT_OP_COUNT]; /**< plot operations */
+} bench_counters;
+
+/** State of a document load */
+struct bench_load {
+	bool done; /**< The load has finished */
+	nserror res; /**< Result of the load */
+	int width; /**< Viewport width reported to the document */
+};
+
+
+/* font measurement using the monkey frontend metrics */
+
+static nserror
+bench_font_width(const plot_font_style_t *fstyle,
+		 const char *string, size_t length,
+		 int *width)
+{
+	bench_counters.font_calls++;
+	*width = (fstyle->size * utf8_bounded_length(string, length)) /
+		PLOT_STYLE_SCALE;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_font_position(const plot_font_style_t *fstyle,
+		    const char *string, size_t length,
+		    int x, size_t *char_offset, int *actual_x)
+{
+	bench_counters.font_calls++;
+	*char_offset = x / (fstyle->size / PLOT_STYLE_SCALE);
+	if (*char_offset > length)
+		*char_offset = length;
+	*actual_x = *char_offset * (fstyle->size / PLOT_STYLE_SCALE);
+	return NSERROR_OK;
+}
+
+static nserror
+bench_font_split(const plot_font_style_t *fstyle,
+		 const char *string, size_t length,
+		 int x, size_t *char_offset, int *actual_x)
+{
+	int c_off = *char_offset = x / (fstyle->size / PLOT_STYLE_SCALE);
+
+	bench_counters.font_calls++;
+	if (*char_offset > length) {
+		*char_offset = length;
+	} else {
+		while (*char_offset > 0) {
+			if (string[*char_offset] == ' ')
+				break;
+			(*char_offset)--;
+		}
+		if (*char_offset == 0) {
+			*char_offset = c_off;
+			while (*char_offset < length &&
+			       string[*char_offset] != ' ') {
+				(*char_offset)++;
+			}
+		}
+	}
+	*actual_x = *char_offset * (fstyle->size / PLOT_STYLE_SCALE);
+	return NSERROR_OK;
+}
+
+static struct gui_layout_table bench_layout_table = {
+	.width = bench_font_width,
+	.position = bench_font_position,
+	.split = bench_font_split,
+};
+
+
+/* plotters which only count operations */
+
+static nserror
+bench_plot_clip(const struct redraw_context *ctx, const struct rect *clip)
+{
+	bench_counters.plot_ops[BENCH_PLOT_CLIP]++;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_plot_arc(const struct redraw_context *ctx,
+	       const plot_style_t *style,
+	       int x, int y, int radius, int angle1, int angle2)
+{
+	bench_counters.plot_ops[BENCH_PLOT_ARC]++;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_plot_disc(const struct redraw_context *ctx,
+		const plot_style_t *style,
+		int x, int y, int radius)
+{
+	bench_counters.plot_ops[BENCH_PLOT_DISC]++;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_plot_line(const struct redraw_context *ctx,
+		const plot_style_t *style,
+		const struct rect *line)
+{
+	bench_counters.plot_ops[BENCH_PLOT_LINE]++;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_plot_rectangle(const struct redraw_context *ctx,
+		     const plot_style_t *style,
+		     const struct rect *rect)
+{
+	bench_counters.plot_ops[BENCH_PLOT_RECTANGLE]++;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_plot_polygon(const struct redraw_context *ctx,
+		   const plot_style_t *style,
+		   const int *p,
+		   unsigned int n)
+{
+	bench_counters.plot_ops[BENCH_PLOT_POLYGON]++;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_plot_path(const struct redraw_context *ctx,
+		const plot_style_t *pstyle,
+		const float *p,
+		unsigned int n,
+		const float transform[6])
+{
+	bench_counters.plot_ops[BENCH_PLOT_PATH]++;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_plot_bitmap(const struct redraw_context *ctx,
+		  struct bitmap *bitmap,
+		  int x, int y,
+		  int width,
+		  int height,
+		  colour bg,
+		  bitmap_flags_t flags)
+{
+	bench_counters.plot_ops[BENCH_PLOT_BITMAP]++;
+	return NSERROR_OK;
+}
+
+static nserror
+bench_plot_text(const struct redraw_context *ctx,
+		const struct plot_font_style *fstyle,
+		int x,
+		int y,
+		const char *text,
+		size_t length)
+{
+	bench_counters.plot_ops[BENCH_PLOT_TEXT]++;
+	return NSERROR_OK;
+}
+
+static const struct plotter_table bench_plotters = {
+	.clip = bench_plot_clip,
+	.arc = bench_plot_arc,
+	.disc = bench_plot_disc,
+	.line = bench_plot_line,
+	.rectangle = bench_plot_rectangle,
+	.polygon = bench_plot_polygon,
+	.path = bench_plot_path,
+	.bitmap = bench_plot_bitmap,
+	.text = bench_plot_text,
+	.option_knockout = true,
+};
+
+static struct gui_misc_table bench_misc_table = {
+	.schedule = monkey_schedule,
+};
+
+
+/**
+ * Processor time in microseconds
+ */
+static unsigned long bench_time_us(void)
+{
+	return (unsigned long)((double)clock() * 1000000 / CLOCKS_PER_SEC);
+}
+
+
+/**
+ * Total number of plot operations counted
+ */
+static unsigned long bench_plot_total(void)
+{
+	unsigned long total = 0;
+	int op;
+
+	for (op = 0; op < BENCH_PLOT_OP_COUNT; op++) {
+		total += bench_counters.plot_ops[op];
+	}
+	return total;
+}
+
+
+/**
+ * Callback for document load events
+ */
+static nserror
+bench_content_cb(hlcache_handle *handle,
+		 const hlcache_event *event,
+		 void *pw)
+{
+	struct bench_load *load = pw;
+
+	switch (event->type) {
+	case CONTENT_MSG_DONE:
+		load->done = true;
+		break;
+
+	case CONTENT_MSG_ERROR:
+		load->res = event->data.errordata.errorcode;
+		load->done = true;
+		break;
+
+	case CONTENT_MSG_GETDIMS:
+		*(event->data.getdims.viewport_width) = load->width;
+		*(event->data.getdims.viewport_height) = BENCH_VIEWPORT_HEIGHT;
+		break;
+
+	default:
+		break;
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Run scheduled callbacks and fetches until a load completes
+ *
+ * \param load The load to wait for.
+ * \return NSERROR_OK on completion or NSERROR_TIMEOUT.
+ */
+static nserror bench_run_until_done(struct bench_load *load)
+{
+	fd_set read_fd_set, write_fd_set, exc_fd_set;
+	int max_fd;
+	int schedtm;
+	struct timeval tv;
+	uint64_t start;
+	uint64_t now;
+
+	nsu_getmonotonic_ms(&start);
+
+	while (!load->done) {
+		schedtm = monkey_schedule_run();
+
+		fetch_fdset(&read_fd_set, &write_fd_set, &exc_fd_set, &max_fd);
+
+		/* nothing scheduled; poll in case a fetch is pending */
+		if (schedtm < 0 || schedtm > 10) {
+			schedtm = 10;
+		}
+		tv.tv_sec = 0;
+		tv.tv_usec = schedtm * 1000;
+
+		if (select(max_fd + 1,
+			   &read_fd_set,
+			   &write_fd_set,
+			   &exc_fd_set,
+			   &tv) < 0) {
+			NSLOG(netsurf, CRITICAL,
+			      "Unable to select: %s", strerror(errno));
+			return NSERROR_UNKNOWN;
+		}
+
+		nsu_getmonotonic_ms(&now);
+		if ((now - start) > BENCH_LOAD_TIMEOUT_MS) {
+			return NSERROR_TIMEOUT;
+		}
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Redraw a document as a series of viewports scrolled over its height
+ *
+ * \param h The document to redraw.
+ * \param width The viewport width.
+ * \param ctx The redraw context.
+ * \param viewports Updated with the number of viewports drawn.
+ * \return time taken in microseconds
+ */
+static unsigned long
+bench_redraw_sweep(hlcache_handle *h,
+		   int width,
+		   const struct redraw_context *ctx,
+		   unsigned int *viewports)
+{
+	struct content_redraw_data data;
+	struct rect clip;
+	int height = content_get_height(h);
+	int scroll;
+	unsigned long start;
+
+	*viewports = 0;
+	start = bench_time_us();
+
+	/* scroll by half a viewport so every area is drawn twice in
+	 * different positions, as it would be when scrolling
+	 */
+	for (scroll = 0;
+	     scroll < height || scroll == 0;
+	     scroll += BENCH_VIEWPORT_HEIGHT / 2) {
+		data.x = 0;
+		data.y = -scroll;
+		data.width = width;
+		data.height = height;
+		data.background_colour = 0xFFFFFF;
+		data.scale = 1;
+		data.repeat_x = false;
+		data.repeat_y = false;
+
+		clip.x0 = 0;
+		clip.y0 = 0;
+		clip.x1 = width;
+		clip.y1 = BENCH_VIEWPORT_HEIGHT;
+
+		content_redraw(h, &data, &clip, ctx);
+		(*viewports)++;
+	}
+
+	return bench_time_us() - start;
+}
+
+
+/**
+ * Measure a document
+ *
+ * \param path The path of the document.
+ * \param iterations Number of times to measure the document.
+ * \param widths The layout widths.
+ * \param width_count The number of layout widths.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+bench_document(const char *path,
+	       unsigned int iterations,
+	       const int *widths,
+	       unsigned int width_count)
+{
+	const struct redraw_context ctx = {
+		.interactive = false,
+		.background_images = true,
+		.plot = &bench_plotters,
+	};
+	struct html_perf_stats stats;
+	struct bench_load load;
+	hlcache_handle *h;
+	nsurl *url;
+	nserror res;
+	unsigned int iteration;
+	unsigned int idx;
+	unsigned int viewports;
+	unsigned long layout_us[BENCH_MAX_WIDTHS] = { 0 };
+	unsigned long redraw_us[BENCH_MAX_WIDTHS] = { 0 };
+	unsigned int lines[BENCH_MAX_WIDTHS] = { 0 };
+	unsigned long font_calls[BENCH_MAX_WIDTHS] = { 0 };
+	unsigned long plot_ops[BENCH_MAX_WIDTHS] = { 0 };
+	unsigned long text_ops[BENCH_MAX_WIDTHS] = { 0 };
+	unsigned int sweep[BENCH_MAX_WIDTHS] = { 0 };
+	unsigned long convert_ms = 0;
+	size_t boxes = 0;
+	size_t box_bytes = 0;
+	unsigned long counted;
+	unsigned long text_counted;
+
+	res = netsurf_path_to_nsurl(path, &url);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	for (iteration = 0; iteration < iterations; iteration++) {
+		load.done = false;
+		load.res = NSERROR_OK;
+		load.width = widths[0];
+
+		res = hlcache_handle_retrieve(url, 0, NULL, NULL,
+				bench_content_cb, &load, NULL,
+				CONTENT_HTML, &h);
+		if (res != NSERROR_OK) {
+			break;
+		}
+
+		res = bench_run_until_done(&load);
+		if (res == NSERROR_OK) {
+			res = load.res;
+		}
+		if (res == NSERROR_OK) {
+			res = html_get_perf_stats(h, &stats);
+		}
+		if (res != NSERROR_OK) {
+			hlcache_handle_release(h);
+			break;
+		}
+
+		convert_ms += stats.box_convert_ms;
+		boxes = stats.box_count;
+		box_bytes = stats.box_tree_size;
+
+		for (idx = 0; idx < width_count; idx++) {
+			load.width = widths[idx];
+
+			counted = bench_counters.font_calls;
+			content_reformat(h, false,
+					 widths[idx], BENCH_VIEWPORT_HEIGHT);
+			font_calls[idx] += bench_counters.font_calls - counted;
+
+			html_get_perf_stats(h, &stats);
+			layout_us[idx] += stats.layout_last_us;
+			lines[idx] = stats.layout_lines;
+
+			counted = bench_plot_total();
+			text_counted = bench_counters.plot_ops[BENCH_PLOT_TEXT];
+			redraw_us[idx] += bench_redraw_sweep(h, widths[idx],
+					&ctx, &viewports);
+			plot_ops[idx] += bench_plot_total() - counted;
+			text_ops[idx] += bench_counters.plot_ops[BENCH_PLOT_TEXT] -
+				text_counted;
+			sweep[idx] = viewports;
+		}
+
+		hlcache_handle_release(h);
+	}
+
+	nsurl_unref(url);
+
+	if (res != NSERROR_OK) {
+		fprintf(stderr, "%s: %s\n", path, messages_get_errorcode(res));
+		return res;
+	}
+
+	printf("%s: %"PRIsizet" boxes, %"PRIsizet" bytes, "
+	       "box construction %lums\n",
+	       path, boxes, box_bytes, convert_ms / iterations);
+	for (idx = 0; idx < width_count; idx++) {
+		printf("  width %4d: layout %8luus %6u lines %8lu font calls"
+		       " | redraw %8luus %3u viewports %8lu plot ops"
+		       " %8lu text\n",
+		       widths[idx],
+		       layout_us[idx] / iterations,
+		       lines[idx],
+		       font_calls[idx] / iterations,
+		       redraw_us[idx] / iterations,
+		       sweep[idx],
+		       plot_ops[idx] / iterations,
+		       text_ops[idx] / iterations);
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Parse a comma separated list of layout widths
+ *
+ * \param arg The width list.
+ * \param widths Updated with the widths.
+ * \return The number of widths or 0 if the list was invalid.
+ */
+static unsigned int bench_parse_widths(const char *arg, int *widths)
+{
+	unsigned int count = 0;
+	char *end;
+	long width;
+
+	while (*arg != '\0' && count < BENCH_MAX_WIDTHS) {
+		width = strtol(arg, &end, 10);
+		if (end == arg || width <= 0 || width > 65535) {
+			return 0;
+		}
+		widths[count++] = width;
+		arg = end;
+		if (*arg == ',') {
+			arg++;
+		}
+	}
+
+	return count;
+}
+
+
+static void bench_usage(const char *prog)
+{
+	fprintf(stderr,
+		"Usage: %s [-v] [-n iterations] [-w width[,width...]] file...\n",
+		prog);
+}
+
+
+int main(int argc, char **argv)
+{
+	struct netsurf_table bench_table = {
+		.misc = &bench_misc_table,
+		.window = monkey_window_table,
+		.download = monkey_download_table,
+		.fetch = monkey_fetch_table,
+		.bitmap = monkey_bitmap_table,
+		.layout = &bench_layout_table,
+	};
+	const char * const langv[] = { "C", NULL };
+	int widths[BENCH_MAX_WIDTHS] = { 320, 800, 1280, 1920 };
+	unsigned int width_count = 4;
+	unsigned int iterations = BENCH_ITERATIONS;
+	char buf[PATH_MAX];
+	char **pathv;
+	char *messages;
+	nserror res;
+	int failed = 0;
+	int opt;
+
+	/* initialise logging, allowing -v to enable verbose output */
+	nslog_init(NULL, &argc, argv);
+
+	while ((opt = getopt(argc, argv, "n:w:")) != -1) {
+		switch (opt) {
+		case 'n':
+			iterations = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'w':
+			width_count = bench_parse_widths(optarg, widths);
+			break;
+
+		default:
+			bench_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind >= argc || iterations == 0 || width_count == 0) {
+		bench_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	res = netsurf_register(&bench_table);
+	if (res != NSERROR_OK) {
+		fprintf(stderr, "NetSurf operation table failed registration\n");
+		return EXIT_FAILURE;
+	}
+
+	pathv = filepath_path_to_strvec("${NETSURFRES}:"
+			MONKEY_RESPATH":./frontends/monkey/res");
+	respaths = filepath_generate(pathv, langv);
+	filepath_free_strvec(pathv);
+
+	res = nsoption_init(NULL, &nsoptions, &nsoptions_default);
+	if (res != NSERROR_OK) {
+		fprintf(stderr, "Options failed to initialise\n");
+		return EXIT_FAILURE;
+	}
+
+	/* measure layout and redraw, not script execution */
+	nsoption_set_bool(enable_javascript, false);
+
+	messages = filepath_find(respaths, "Messages");
+	res = messages_add_from_file(messages);
+	if (res != NSERROR_OK) {
+		NSLOG(netsurf, INFO, "Messages failed to load");
+	}
+
+	res = netsurf_init(NULL);
+	free(messages);
+	if (res != NSERROR_OK) {
+		fprintf(stderr, "NetSurf failed to initialise\n");
+		return EXIT_FAILURE;
+	}
+
+	filepath_sfinddef(respaths, buf, "mime.types", "/etc/");
+	monkey_fetch_filetype_init(buf);
+
+	for (; optind < argc; optind++) {
+		res = bench_document(argv[optind], iterations,
+				     widths, width_count);
+		if (res != NSERROR_OK) {
+			failed = 1;
+		}
+	}
+
+	netsurf_exit();
+
+	monkey_fetch_filetype_fin();
+	filepath_free_strvec(respaths);
+	nsoption_finalise(nsoptions, nsoptions_default);
+	nslog_finalise();
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+#!/usr/bin/python3
+#
+# Copyright 2026 The NetSurf Browser Project
+#
+# This file is part of NetSurf, http://www.netsurf-browser.org/
+#
+# NetSurf is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# NetSurf is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+runs a page load benchmark in monkey over a corpus of local pages
+
+Every page of the corpus is loaded a number of times and the time taken
+to reach each load phase is collected.  The redraw phase is the duration
+of the first redraw alone, since monkey only redraws on request.  The
+median and 95th percentile of every phase for every page are printed as
+JSON on stdout.
+"""
+
+# pylint: disable=locally-disabled, missing-docstring
+
+import functools
+import getopt
+import json
+import math
+import os
+import statistics
+import sys
+import threading
+
+from http.server import SimpleHTTPRequestHandler, ThreadingHTTPServer
+
+from monkeyfarmer import Browser
+
+PHASES = ('fetch', 'convert', 'layout', 'redraw', 'done')
+
+
+def print_usage():
+    print('Usage:', file=sys.stderr)
+    print('  ' + sys.argv[0] + ' -m <path to monkey> [-c <corpus directory>]'
+          ' [-n <iterations>] [-W <warmup iterations>] [-s]'
+          ' [-w <wrapper arguments>]', file=sys.stderr)
+    print('    -s serves the corpus over a local HTTP server instead of'
+          ' using file: URLs', file=sys.stderr)
+
+
+def parse_argv(argv):
+    params = {
+        'monkey': '',
+        'corpus': os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                               'bench-corpus'),
+        'iterations': 10,
+        'warmup': 1,
+        'serve': False,
+        'wrapper': None,
+    }
+    try:
+        opts, _args = getopt.getopt(argv, "hm:c:n:W:sw:",
+                                    ["monkey=", "corpus=", "iterations=",
+                                     "warmup=", "serve", "wrapper="])
+    except getopt.GetoptError:
+        print_usage()
+        sys.exit(2)
+    for opt, arg in opts:
+        if opt == '-h':
+            print_usage()
+            sys.exit()
+        elif opt in ("-m", "--monkey"):
+            params['monkey'] = arg
+        elif opt in ("-c", "--corpus"):
+            params['corpus'] = os.path.abspath(arg)
+        elif opt in ("-n", "--iterations"):
+            params['iterations'] = int(arg)
+        elif opt in ("-W", "--warmup"):
+            params['warmup'] = int(arg)
+        elif opt in ("-s", "--serve"):
+            params['serve'] = True
+        elif opt in ("-w", "--wrapper"):
+            if params['wrapper'] is None:
+                params['wrapper'] = []
+            params['wrapper'].extend(arg.split())
+
+    if params['monkey'] == '' or params['iterations'] < 1:
+        print_usage()
+        sys.exit(2)
+
+    return params
+
+
+class CorpusHandler(SimpleHTTPRequestHandler):
+    """
+    Serves the corpus without allowing any caching between iterations.
+    """
+
+    def end_headers(self):
+        self.send_header('Cache-Control', 'no-store')
+        super().end_headers()
+
+    def log_message(self, *args):
+        # pylint: disable=locally-disabled, arguments-differ
+        pass
+
+
+def start_corpus_server(corpus):
+    handler = functools.partial(CorpusHandler, directory=corpus)
+    server = ThreadingHTTPServer(('127.0.0.1', 0), handler)
+    server.daemon_threads = True
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    return server
+
+
+def corpus_pages(corpus):
+    return sorted(name for name in os.listdir(corpus)
+                  if name.endswith('.html'))
+
+
+def load_page(win, url):
+    win.go(url)
+    win.wait_loaded()
+    # monkey does not redraw by itself, the core times this redraw
+    win.redraw()
+    return win.get_load_times()
+
+
+def percentile(values, pct):
+    # nearest rank percentile
+    ordered = sorted(values)
+    rank = max(1, math.ceil(pct / 100 * len(ordered)))
+    return ordered[rank - 1]
+
+
+def summarise(samples):
+    result = {}
+    for phase in PHASES:
+        values = [s[phase] for s in samples if s.get(phase) is not None]
+        if len(values) == 0:
+            result[phase] = None
+            continue
+        result[phase] = {
+            'median': statistics.median(values),
+            'p95': percentile(values, 95),
+            'samples': len(values),
+        }
+    return result
+
+
+def run_benchmark(params):
+    pages = corpus_pages(params['corpus'])
+    if len(pages) == 0:
+        print("No pages in corpus {}".format(params['corpus']),
+              file=sys.stderr)
+        sys.exit(1)
+
+    server = None
+    if params['serve']:
+        server = start_corpus_server(params['corpus'])
+        base = 'http://127.0.0.1:{}/'.format(server.server_address[1])
+    else:
+        base = 'file://' + params['corpus'] + '/'
+
+    browser = Browser(monkey_cmd=[params['monkey']],
+                      quiet=True,
+                      wrapper=params['wrapper'])
+    win = browser.new_window()
+
+    results = {}
+    for page in pages:
+        url = base + page
+        for _ in range(params['warmup']):
+            load_page(win, url)
+        samples = [load_page(win, url)
+                   for _ in range(params['iterations'])]
+        results[page] = summarise(samples)
+        print("{}: {}".format(page, results[page]['done']), file=sys.stderr)
+
+    win.kill()
+    win.wait_until_dead()
+    browser.quit_and_wait()
+
+    if server is not None:
+        server.shutdown()
+        server.server_close()
+
+    return {
+        'iterations': params['iterations'],
+        'transport': 'http' if params['serve'] else 'file',
+        'pages': results,
+    }
+
+
+def main(argv):
+    params = parse_argv(argv)
+    results = run_benchmark(params)
+    print(json.dumps(results, indent=2, sort_keys=True))
+
+
+# Some python weirdness to get to main().
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -25,9 +25,16 @@ runs tests in monkey as defined in a yaml file
 import os
 import sys
 import getopt
+import shutil
+import socket
+import subprocess
+import tempfile
+import threading
 import time
 import yaml
 
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
 from monkeyfarmer import Browser
 
 
@@ -168,11 +175,23 @@ def conds_met(ctx, conds):
             taken = time.time() - ctx['timers'][timer]["start"]
             if taken >= elapsed:
                 return True
+        elif 'downloads' in cond.keys():
+            # every download window has finished
+            status = cond['downloads']
+            assert status == "complete"
+            downloads = ctx['browser'].downloads
+            if downloads and all(dl["done"] or dl["error"] is not None
+                                 for dl in downloads.values()):
+                return True
         elif 'window' in cond.keys():
             status = cond['status']
             window = cond['window']
-            assert status == "complete" or status == "loading"  # TODO: Add more status support?
-            if window == "*all*":
+            assert status in ("complete", "loading", "laid-out")  # TODO: Add more status support?
+            if status == "laid-out":
+                # the new content has been laid out at least once
+                if ctx['windows'][window].laid_out:
+                    return True
+            elif window == "*all*":
                 # all windows must be complete, or any still loading
                 throbbing = False
                 for win in ctx['windows'].items():
@@ -203,6 +222,11 @@ def run_test_step_action_launch(ctx, step):
     monkey_cmd = [ctx["monkey"]]
     for option in step.get('launch-options', []):
         monkey_cmd.append("--{}".format(option))
+    # trust the certificate of a local test server
+    if 'ca-server' in step.keys():
+        server = ctx['servers'].get(step['ca-server'])
+        assert server is not None and server.get('ca') is not None
+        monkey_cmd.append("--ca_bundle={}".format(server['ca']))
     print(get_indent(ctx) + "        " + "Command line: " + repr(monkey_cmd))
 
     # build command environment
@@ -259,6 +283,14 @@ def run_test_step_action_navigate(ctx, step):
     assert_browser(ctx)
     if 'url' in step.keys():
         url = step['url']
+    elif 'file' in step.keys():
+        path = ctx['files'].get(step['file'])
+        assert path is not None
+        url = 'file://' + path
+    elif 'server' in step.keys():
+        server = ctx['servers'].get(step['server'])
+        assert server is not None
+        url = server['url'] + step.get('path', '/')
     elif 'repeaturl' in step.keys():
         repeat = ctx['repeats'].get(step['repeaturl'])
         assert repeat is not None
@@ -292,6 +324,18 @@ def run_test_step_action_reload(ctx, step):
     win.reload()
 
 
+def run_test_step_action_history(ctx, step):
+    print(get_indent(ctx) + "Action: " + step["action"])
+    assert_browser(ctx)
+    tag = step['window']
+    win = ctx['windows'].get(tag)
+    assert win is not None
+    if step["action"] == "back":
+        win.back()
+    else:
+        win.forward()
+
+
 def run_test_step_action_sleep_ms(ctx, step):
     print(get_indent(ctx) + "Action: " + step["action"])
     conds = step.get('conditions', {})
@@ -509,6 +553,12 @@ def run_test_step_action_timer_stop(ctx, step):
     taken = time.time() - ctx['timers'][timer]["start"]
     print("{}        {} took: {:.2f}s".format(get_indent(ctx), timer, taken))
     ctx['timers'][timer]["taken"] = taken
+    if 'throughput' in step.keys():
+        path = ctx['files'].get(step['throughput'])
+        assert path is not None
+        size = os.path.getsize(path)
+        print("{}        {} throughput: {:.2f}MiB/s".format(
+            get_indent(ctx), timer, size / (1024 * 1024) / max(taken, 0.001)))
 
 
 def run_test_step_action_timer_check(ctx, step):
@@ -531,6 +581,264 @@ def run_test_step_action_timer_check(ctx, step):
         assert timer1["taken"] > timer2["taken"]
 
 
+def run_test_step_action_file_create(ctx, step):
+
+    # pylint: disable=locally-disabled, invalid-name
+
+    print(get_indent(ctx) + "Action: " + step["action"])
+    tag = step['file']
+    assert ctx['files'].get(tag) is None
+    size = int(step['size'])
+    kind = step.get('type', 'text')
+    assert kind in ('text', 'html', 'binary')
+    if kind == 'binary':
+        # the .bin suffix makes the browser offer a download
+        suffix = '.bin'
+        head = b''
+        line = bytes(range(256))
+        tail = b''
+    elif kind == 'html':
+        suffix = '.html'
+        head = b'<!DOCTYPE html>\n<html><head><title>' + tag.encode() + \
+            b'</title></head><body>\n'
+        line = b'<p>The quick brown fox jumps over the lazy dog.</p>\n'
+        tail = b'</body></html>\n'
+    else:
+        suffix = '.txt'
+        head = b''
+        line = b'The quick brown fox jumps over the lazy dog.\n'
+        tail = b''
+    fd, path = tempfile.mkstemp(prefix='monkey-', suffix=suffix)
+    with os.fdopen(fd, 'wb') as out:
+        out.write(head)
+        remaining = size - len(head) - len(tail)
+        block = line * max(1, 65536 // len(line))
+        while remaining > 0:
+            out.write(block[:remaining])
+            remaining -= len(block)
+        out.write(tail)
+    print(get_indent(ctx) + "        " + tag + " --> " + path +
+          " ({} bytes)".format(os.path.getsize(path)))
+    ctx['files'][tag] = path
+
+
+# A 1x1 transparent GIF
+SERVER_IMAGE = (b'GIF89a\x01\x00\x01\x00\x80\x00\x00\x00\x00\x00'
+                b'\xff\xff\xff!\xf9\x04\x01\x00\x00\x00\x00,\x00'
+                b'\x00\x00\x00\x01\x00\x01\x00\x00\x02\x02D\x01\x00;')
+
+
+def server_document(params, hint_url=None):
+    """
+    Generate a page referencing images and stylesheets.
+
+    The images are listed before the stylesheets so that a fetch queue
+    which ignores priority starts the slow images first. Connection hints
+    for hint_url are placed ahead of both.
+    """
+    body = ['<!DOCTYPE html>\n<html><head><title>server</title>']
+    if hint_url is not None:
+        if params['preconnect']:
+            body += ['<link rel="preconnect" href="{}">'.format(hint_url)]
+        if params['dns-prefetch']:
+            body += ['<link rel="dns-prefetch" href="{}">'.format(hint_url)]
+    body += ['<img src="/img{}.gif">'.format(i)
+             for i in range(params['images'])]
+    body += ['<link rel="stylesheet" href="/style{}.css">'.format(i)
+             for i in range(params['stylesheets'])]
+    body += ['</head><body><p>Hello</p></body></html>\n']
+    return '\n'.join(body).encode()
+
+
+SERVER_STYLESHEET = b'p { color: black; }\n'
+
+
+class ServerHandler(BaseHTTPRequestHandler):
+    """
+    Serves the generated page and its resources over HTTP/1.1.
+
+    Every connection and request is counted so connections which never
+    carry a request, as made by a preconnect, can be checked.
+    """
+
+    def setup(self):
+        super().setup()
+        with self.server.lock:
+            self.server.connections += 1
+
+    def do_GET(self):
+        # pylint: disable=locally-disabled, invalid-name
+        params = self.server.params
+        with self.server.lock:
+            self.server.requests += 1
+        if self.path == '/':
+            # hints name the server by another host so that they are
+            # not suppressed by the fetch of the page itself
+            hint_url = 'http://localhost:{}/'.format(
+                self.server.server_address[1])
+            self.reply('text/html', server_document(params, hint_url))
+        elif self.path.startswith('/img'):
+            time.sleep(params['image-delay'] / 1000)
+            self.reply('image/gif', SERVER_IMAGE)
+        elif self.path.startswith('/style'):
+            time.sleep(params['stylesheet-delay'] / 1000)
+            self.reply('text/css', SERVER_STYLESHEET)
+        else:
+            self.send_error(404)
+
+    def reply(self, mimetype, data):
+        self.send_response(200)
+        self.send_header('Content-Type', mimetype)
+        self.send_header('Content-Length', str(len(data)))
+        self.send_header('Cache-Control', 'no-store')
+        self.end_headers()
+        self.wfile.write(data)
+
+    def log_message(self, *args):
+        # pylint: disable=locally-disabled, arguments-differ
+        pass
+
+
+def start_http_server(params):
+    server = ThreadingHTTPServer(('127.0.0.1', 0), ServerHandler)
+    server.daemon_threads = True
+    server.params = params
+    server.lock = threading.Lock()
+    server.connections = 0
+    server.requests = 0
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+
+    def stop():
+        server.shutdown()
+        server.server_close()
+
+    def counts():
+        with server.lock:
+            return server.connections, server.requests
+
+    return {
+        'url': 'http://127.0.0.1:{}'.format(server.server_address[1]),
+        'stop': stop,
+        'counts': counts,
+    }
+
+
+def start_h2_server(params):
+    """
+    Serve the generated page over HTTP/2 with TLS using nghttpd.
+
+    A self signed certificate is generated for the server; launch with
+    ca-server set to the server tag for the browser to trust it. The
+    resource delays are not supported.
+    """
+    root = tempfile.mkdtemp(prefix='monkey-h2-')
+    with open(os.path.join(root, 'index.html'), 'wb') as out:
+        out.write(server_document(params))
+    for i in range(params['images']):
+        with open(os.path.join(root, 'img{}.gif'.format(i)), 'wb') as out:
+            out.write(SERVER_IMAGE)
+    for i in range(params['stylesheets']):
+        with open(os.path.join(root, 'style{}.css'.format(i)), 'wb') as out:
+            out.write(SERVER_STYLESHEET)
+
+    key = os.path.join(root, 'key.pem')
+    cert = os.path.join(root, 'cert.pem')
+    subprocess.run(['openssl', 'req', '-x509', '-newkey', 'rsa:2048',
+                    '-nodes', '-days', '1', '-subj', '/CN=localhost',
+                    '-addext', 'subjectAltName=DNS:localhost',
+                    '-keyout', key, '-out', cert],
+                   check=True, stdout=subprocess.DEVNULL,
+                   stderr=subprocess.DEVNULL)
+
+    # find a free port for nghttpd to listen on
+    with socket.socket() as sock:
+        sock.bind(('127.0.0.1', 0))
+        port = sock.getsockname()[1]
+
+    proc = subprocess.Popen(['nghttpd', '--htdocs=' + root,
+                             '--address=127.0.0.1', str(port), key, cert],
+                            stdout=subprocess.DEVNULL,
+                            stderr=subprocess.DEVNULL)
+    deadline = time.time() + 10
+    while True:
+        try:
+            socket.create_connection(('127.0.0.1', port), timeout=1).close()
+            break
+        except OSError:
+            assert proc.poll() is None and time.time() < deadline
+            time.sleep(0.05)
+
+    def stop():
+        proc.terminate()
+        proc.wait()
+        shutil.rmtree(root)
+
+    return {
+        'url': 'https://localhost:{}'.format(port),
+        'stop': stop,
+        'ca': cert,
+    }
+
+
+def run_test_step_action_server_start(ctx, step):
+
+    # pylint: disable=locally-disabled, invalid-name
+
+    print(get_indent(ctx) + "Action: " + step["action"])
+    tag = step['server']
+    assert ctx['servers'].get(tag) is None
+    params = {
+        'images': int(step.get('images', 0)),
+        'stylesheets': int(step.get('stylesheets', 0)),
+        'image-delay': int(step.get('image-delay', 0)),
+        'stylesheet-delay': int(step.get('stylesheet-delay', 0)),
+        'preconnect': bool(step.get('preconnect', False)),
+        'dns-prefetch': bool(step.get('dns-prefetch', False)),
+    }
+    protocol = step.get('protocol', 'http/1.1')
+    assert protocol in ('http/1.1', 'h2')
+    if protocol == 'h2':
+        server = start_h2_server(params)
+    else:
+        server = start_http_server(params)
+    print(get_indent(ctx) + "        " + tag + " --> " + server['url'])
+    ctx['servers'][tag] = server
+
+
+def run_test_step_action_server_check(ctx, step):
+
+    # pylint: disable=locally-disabled, invalid-name
+
+    print(get_indent(ctx) + "Action: " + step["action"])
+    server = ctx['servers'].get(step['server'])
+    assert server is not None and server.get('counts') is not None
+    connections, requests = server['counts']()
+    print(get_indent(ctx) + "        {} connections {} requests".format(
+        connections, requests))
+    # the server closes each connection after one request
+    if 'idle-connections' in step.keys():
+        assert connections - requests == int(step['idle-connections'])
+
+
+def run_test_step_action_memory_check(ctx, step):
+
+    # pylint: disable=locally-disabled, invalid-name
+
+    print(get_indent(ctx) + "Action: " + step["action"])
+    assert_browser(ctx)
+    peak = ctx['browser'].peak_rss()
+    assert peak is not None
+    print(get_indent(ctx) + "        peak RSS {:.1f}MiB".format(
+        peak / (1024 * 1024)))
+    if 'peak-rss-max' in step.keys():
+        assert peak <= int(step['peak-rss-max'])
+    for download in ctx['browser'].downloads.values():
+        assert download['error'] is None
+        if 'download-size' in step.keys():
+            assert download['size'] == int(step['download-size'])
+
+
 def run_test_step_action_add_auth(ctx, step):
     print(get_indent(ctx) + "Action:" + step["action"])
     assert_browser(ctx)
@@ -600,6 +908,14 @@ def run_test_step_action_quit(ctx, step):
     assert_browser(ctx)
     browser = ctx.pop('browser')
     assert browser.quit_and_wait()
+    stats = browser.hlcache_stats
+    if stats is not None:
+        print("{}        hlcache: {} lookups examined {} entries in {:.3f}s".format(
+            get_indent(ctx), stats['lookups'], stats['probes'], stats['time']))
+    if 'hlcache-probes-max' in step.keys():
+        # average number of cache entries examined per content lookup
+        assert stats is not None and stats['lookups'] > 0
+        assert stats['probes'] / stats['lookups'] <= float(step['hlcache-probes-max'])
     # clean up context as all windows have gone away after browser quit
     ctx.pop('windows')
 
@@ -611,6 +927,8 @@ STEP_HANDLERS = {
     "navigate":      run_test_step_action_navigate,
     "reload":        run_test_step_action_reload,
     "stop":          run_test_step_action_stop,
+    "back":          run_test_step_action_history,
+    "forward":       run_test_step_action_history,
     "sleep-ms":      run_test_step_action_sleep_ms,
     "block":         run_test_step_action_block,
     "repeat":        run_test_step_action_repeat,
@@ -621,6 +939,10 @@ STEP_HANDLERS = {
     "plot-check":    run_test_step_action_plot_check,
     "click":         run_test_step_action_click,
     "wait-loading":  run_test_step_action_wait_loading,
+    "file-create":   run_test_step_action_file_create,
+    "server-start":  run_test_step_action_server_start,
+    "server-check":  run_test_step_action_server_check,
+    "memory-check":  run_test_step_action_memory_check,
     "add-auth":      run_test_step_action_add_auth,
     "remove-auth":   run_test_step_action_remove_auth,
     "clear-log":     run_test_step_action_clear_log,
@@ -640,8 +962,16 @@ def walk_test_plan(ctx, plan):
     ctx["depth"] = 0
     ctx["timers"] = dict()
     ctx['repeats'] = dict()
-    for step in plan["steps"]:
-        run_test_step(ctx, step)
+    ctx['files'] = dict()
+    ctx['servers'] = dict()
+    try:
+        for step in plan["steps"]:
+            run_test_step(ctx, step)
+    finally:
+        for path in ctx['files'].values():
+            os.unlink(path)
+        for server in ctx['servers'].values():
+            server['stop']()
 
 
 def run_test_plan(ctx, plan):
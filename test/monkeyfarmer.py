@@ -216,6 +216,10 @@ class Browser:
             wrapper=wrapper)
         self.windows = {}
         self.logins = {}
+        self.downloads = {}
+        self.hlcache_stats = None
+        self.memory_stats = None
+        self.memory_pending = None
         self.current_draw_target = None
         self.started = False
         self.stopped = False
@@ -244,6 +248,15 @@ class Browser:
     def quit(self):
         self.farmer.tell_monkey("QUIT")
 
+    def get_memory_stats(self):
+        # memory accounted to each subsystem, empty if not built in
+        self.memory_stats = None
+        self.memory_pending = {}
+        self.farmer.tell_monkey("MEMORY")
+        while self.memory_stats is None:
+            self.farmer.loop(once=True)
+        return self.memory_stats
+
     def quit_and_wait(self):
         self.quit()
         self.farmer.loop()
@@ -256,6 +269,26 @@ class Browser:
             self.stopped = True
         elif what == 'LAUNCH':
             self.launchurl = args[1]
+        elif what == 'HLCACHE':
+            # LOOKUPS n PROBES n TIME us
+            self.hlcache_stats = {
+                'lookups': int(args[1]),
+                'probes': int(args[3]),
+                'time': int(args[5]) / 1000000,
+            }
+        elif what == 'MEMORY':
+            if args[0] == 'SUBSYSTEM':
+                # SUBSYSTEM name CURRENT n PEAK n ALLOCS n FREES n
+                self.memory_pending[args[1]] = {
+                    'current': int(args[3]),
+                    'peak': int(args[5]),
+                    'allocs': int(args[7]),
+                    'frees': int(args[9]),
+                }
+            elif args[0] == 'END':
+                self.memory_stats = self.memory_pending
+            elif args[0] == 'DISABLED':
+                self.memory_stats = {}
         elif what == 'EXIT':
             if not self.stopped:
                 print("Unexpected exit of monkey process with code {}".format(args[0]))
@@ -274,6 +307,28 @@ class Browser:
             else:
                 win.handle(action, *args)
 
+    def handle_DOWNLOAD(self, action, _dwin, dwinid, *args):
+        if action == "CREATE":
+            self.downloads[dwinid] = {"size": 0, "done": False, "error": None}
+            return
+        download = self.downloads.get(dwinid, None)
+        if download is None:
+            print("    Unknown download window id {}".format(dwinid))
+        elif action == "DATA":
+            download["size"] += int(args[1])
+        elif action == "ERROR":
+            download["error"] = " ".join(args[1:])
+        elif action == "DONE":
+            download["done"] = True
+
+    def peak_rss(self):
+        # peak resident set size of the monkey process in bytes
+        with open("/proc/{}/status".format(self.farmer.monkey.pid)) as status:
+            for line in status:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1]) * 1024
+        return None
+
     def handle_LOGIN(self, action, _lwin, winid, *args):
         if action == "OPEN":
             new_win = LoginWindow(self, winid, *args)
@@ -398,6 +453,7 @@ class BrowserWindow:
         self.scrolly = 0
         self.content_width = 0
         self.content_height = 0
+        self.laid_out = False
         self.status = ""
         self.pointer = ""
         self.scale = 1.0
@@ -406,6 +462,7 @@ class BrowserWindow:
         self.plotting = False
         self.log_entries = []
         self.page_info_state = "UNKNOWN"
+        self.load_times = None
 
     def kill(self):
         self.browser.farmer.tell_monkey("WINDOW DESTROY %s" % self.winid)
@@ -422,6 +479,7 @@ class BrowserWindow:
                 break
 
     def go(self, url, referer=None):
+        self.laid_out = False
         if referer is None:
             self.browser.farmer.tell_monkey("WINDOW GO %s %s" % (
                 self.winid, url))
@@ -438,6 +496,14 @@ class BrowserWindow:
         self.browser.farmer.tell_monkey("WINDOW RELOAD %s%s" % (self.winid, all))
         self.wait_start_loading()
 
+    def back(self):
+        self.laid_out = False
+        self.browser.farmer.tell_monkey("WINDOW BACK %s" % (self.winid))
+
+    def forward(self):
+        self.laid_out = False
+        self.browser.farmer.tell_monkey("WINDOW FORWARD %s" % (self.winid))
+
     def click(self, x, y, button="LEFT", kind="SINGLE"):
         self.browser.farmer.tell_monkey("WINDOW CLICK WIN %s X %s Y %s BUTTON %s KIND %s" % (self.winid, x, y, button, kind))
 
@@ -464,7 +530,7 @@ class BrowserWindow:
         self.height = height
 
     def handle_window_NEW_CONTENT(self):
-        pass
+        self.laid_out = False
 
     def handle_window_NEW_ICON(self):
         pass
@@ -490,6 +556,7 @@ class BrowserWindow:
     def handle_window_UPDATE_EXTENT(self, _width, width, _height, height):
         self.content_width = int(width)
         self.content_height = int(height)
+        self.laid_out = True
 
     def handle_window_SET_STATUS(self, _str, *status):
         self.status = (" ".join(status))
@@ -526,6 +593,16 @@ class BrowserWindow:
     def handle_window_PAGE_STATUS(self, _status, status):
         self.page_info_state = status
 
+    def handle_window_TIMES(self, *args):
+        # FETCH ms CONVERT ms LAYOUT ms REDRAW ms DONE ms
+        # REDRAW is the duration of the first redraw, the rest are
+        # times since the load started
+        times = {}
+        for (phase, value) in zip(args[0::2], args[1::2]):
+            value = int(value)
+            times[phase.lower()] = value if value >= 0 else None
+        self.load_times = times
+
     def load_page(self, url=None, referer=None):
         if url is not None:
             self.go(url, referer)
@@ -555,6 +632,14 @@ class BrowserWindow:
             self.browser.farmer.loop(once=True)
         return self.plotted
 
+    def get_load_times(self):
+        # phase times in ms of the last page load, None if not reached
+        self.load_times = None
+        self.browser.farmer.tell_monkey("WINDOW TIMES %s" % self.winid)
+        while self.load_times is None:
+            self.browser.farmer.loop(once=True)
+        return self.load_times
+
     def clear_log(self):
         self.log_entries = []
 
@@ -0,0 +1,570 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Tests for textarea editing and reflow.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <check.h>
+
+#include "utils/errors.h"
+#include "netsurf/mouse.h"
+#include "netsurf/keypress.h"
+#include "netsurf/layout.h"
+#include "netsurf/clipboard.h"
+#include "desktop/gui_internal.h"
+#include "desktop/gui_table.h"
+#include "desktop/scrollbar.h"
+#include "desktop/textarea.h"
+#include "css/utils.h"
+
+#define NELEMS(x)  (sizeof(x) / sizeof((x)[0]))
+
+/** width in pixels of every character of the test font */
+#define CHAR_WIDTH 8
+
+/** size of the benchmark text */
+#define BENCH_SIZE (1024 * 1024)
+
+/** number of keystrokes timed at each benchmark position */
+#define BENCH_KEYS 500
+
+/** size of the text edited by the reflow cost test */
+#define COST_SIZE (256 * 1024)
+
+/** number of keystrokes made by the reflow cost test */
+#define COST_KEYS 50
+
+/** number of random edits made by the reflow test */
+#define EDIT_COUNT 400
+
+/* Stubs */
+nserror nslog_set_filter_by_options() { return NSERROR_OK; }
+
+css_fixed nscss_screen_dpi = F_90;
+
+struct scrollbar {
+	bool horizontal;
+};
+
+nserror scrollbar_create(bool horizontal, int length, int full_size,
+		int visible_size, void *client_data,
+		scrollbar_client_callback client_callback,
+		struct scrollbar **s)
+{
+	*s = calloc(1, sizeof(struct scrollbar));
+	ck_assert(*s != NULL);
+	(*s)->horizontal = horizontal;
+	return NSERROR_OK;
+}
+
+void scrollbar_destroy(struct scrollbar *s)
+{
+	free(s);
+}
+
+nserror scrollbar_redraw(struct scrollbar *s, int x, int y,
+		const struct rect *clip, float scale,
+		const struct redraw_context *ctx)
+{
+	return NSERROR_OK;
+}
+
+/* the test scrollbars never scroll so caret positions are absolute */
+void scrollbar_set(struct scrollbar *s, int value, bool bar_pos)
+{
+}
+
+bool scrollbar_scroll(struct scrollbar *s, int change)
+{
+	return false;
+}
+
+int scrollbar_get_offset(struct scrollbar *s)
+{
+	return 0;
+}
+
+void scrollbar_set_extents(struct scrollbar *s, int length,
+		int visible_size, int full_size)
+{
+}
+
+scrollbar_mouse_status scrollbar_mouse_action(struct scrollbar *s,
+		browser_mouse_state mouse, int x, int y)
+{
+	return SCROLLBAR_MOUSE_NONE;
+}
+
+void scrollbar_mouse_drag_end(struct scrollbar *s,
+		browser_mouse_state mouse, int x, int y)
+{
+}
+
+void scrollbar_make_pair(struct scrollbar *horizontal,
+		struct scrollbar *vertical)
+{
+}
+
+/** number of calls to split text since last reset */
+static unsigned int split_count;
+
+static nserror tst_width(const struct plot_font_style *fstyle,
+		const char *string, size_t length, int *width)
+{
+	*width = length * CHAR_WIDTH;
+	return NSERROR_OK;
+}
+
+static nserror tst_position(const struct plot_font_style *fstyle,
+		const char *string, size_t length, int x,
+		size_t *char_offset, int *actual_x)
+{
+	size_t offset = (x < 0) ? 0 : (x + CHAR_WIDTH / 2) / CHAR_WIDTH;
+
+	if (offset > length) {
+		offset = length;
+	}
+	*char_offset = offset;
+	*actual_x = offset * CHAR_WIDTH;
+	return NSERROR_OK;
+}
+
+static nserror tst_split(const struct plot_font_style *fstyle,
+		const char *string, size_t length, int x,
+		size_t *char_offset, int *actual_x)
+{
+	size_t idx;
+	size_t last_space = 0;
+
+	split_count++;
+
+	*actual_x = 0;
+	for (idx = 0; idx < length; idx++) {
+		if (string[idx] == ' ') {
+			last_space = idx;
+		}
+		*actual_x += CHAR_WIDTH;
+		if (*actual_x > x && last_space != 0) {
+			*actual_x = last_space * CHAR_WIDTH;
+			*char_offset = last_space;
+			return NSERROR_OK;
+		}
+	}
+	*char_offset = length;
+
+	return NSERROR_OK;
+}
+
+static struct gui_layout_table tst_layout_table = {
+	.width = tst_width,
+	.position = tst_position,
+	.split = tst_split,
+};
+
+static void tst_clipboard_get(char **buffer, size_t *length)
+{
+	*buffer = NULL;
+	*length = 0;
+}
+
+static void tst_clipboard_set(const char *buffer, size_t length,
+		nsclipboard_styles styles[], int n_styles)
+{
+}
+
+static struct gui_clipboard_table tst_clipboard_table = {
+	.get = tst_clipboard_get,
+	.set = tst_clipboard_set,
+};
+
+static struct netsurf_table tst_table = {
+	.layout = &tst_layout_table,
+	.clipboard = &tst_clipboard_table,
+};
+
+struct netsurf_table *guit = &tst_table;
+
+/** caret position last reported by a textarea */
+struct caret {
+	int x;
+	int y;
+};
+
+static void tst_callback(void *data, struct textarea_msg *msg)
+{
+	struct caret *caret = data;
+
+	if (msg->type == TEXTAREA_MSG_CARET_UPDATE &&
+			msg->data.caret.type == TEXTAREA_CARET_SET_POS) {
+		caret->x = msg->data.caret.pos.x;
+		caret->y = msg->data.caret.pos.y;
+	}
+}
+
+static struct textarea *create_textarea(int width, int height,
+		struct caret *caret)
+{
+	textarea_setup setup = {
+		.width = width,
+		.height = height,
+		.pad_top = 2,
+		.pad_right = 2,
+		.pad_bottom = 2,
+		.pad_left = 2,
+		.border_width = 1,
+		.text = {
+			.family = PLOT_FONT_FAMILY_SANS_SERIF,
+			.size = 10 * PLOT_STYLE_SCALE,
+			.weight = 400,
+		},
+	};
+	struct textarea *ta;
+
+	ta = textarea_create(TEXTAREA_MULTILINE, &setup, tst_callback, caret);
+	ck_assert(ta != NULL);
+
+	return ta;
+}
+
+/**
+ * generate text of short words in lines and long wrapped paragraphs
+ */
+static char *make_text(size_t len, unsigned int seed)
+{
+	static const char *words[] = {
+		"the", "quick", "brown", "fox", "jumps", "over", "a", "lazy",
+		"dog", "log", "entry", "error", "at", "line", "of", "code",
+	};
+	char *text;
+	size_t used = 0;
+	size_t wlen;
+	unsigned int para = 0;
+
+	text = malloc(len + 1);
+	ck_assert(text != NULL);
+
+	while (used < len) {
+		seed = (seed * 1103515245) + 12345;
+		if (para > (((seed >> 8) & 7) == 0 ? 400u : 60u)) {
+			text[used++] = '\n';
+			para = 0;
+			continue;
+		}
+		wlen = strlen(words[(seed >> 16) % NELEMS(words)]);
+		if (wlen + 1 > len - used) {
+			wlen = len - used - 1;
+		}
+		memcpy(text + used, words[(seed >> 16) % NELEMS(words)], wlen);
+		used += wlen;
+		para += wlen + 1;
+		if (used < len) {
+			text[used++] = ' ';
+		}
+	}
+	text[len] = '\0';
+
+	return text;
+}
+
+/**
+ * check an edited textarea is laid out as if its text was set afresh
+ *
+ * Compares caret positions at sampled offsets, which differ if any
+ * line start or line index differs.
+ */
+static void check_layout(struct textarea *ta, struct caret *caret,
+		int width, int height)
+{
+	struct textarea *fresh;
+	struct caret fresh_caret;
+	const char *text;
+	unsigned int len;
+	unsigned int off;
+
+	text = textarea_data(ta, &len);
+	fresh = create_textarea(width, height, &fresh_caret);
+	ck_assert(textarea_set_text(fresh, text));
+
+	for (off = 0; off < len; off += 13) {
+		textarea_set_caret(ta, off);
+		textarea_set_caret(fresh, off);
+		ck_assert_int_eq(caret->x, fresh_caret.x);
+		ck_assert_int_eq(caret->y, fresh_caret.y);
+	}
+
+	textarea_destroy(fresh);
+}
+
+/**
+ * Random edits keep the same layout as a complete reflow
+ */
+START_TEST(textarea_reflow_test)
+{
+	static const char *pastes[] = {
+		"pasted\nlines\nof text\n",
+		"\n",
+		"a long pasted run of words which wraps over several lines "
+		"of the textarea when it is inserted into a paragraph",
+	};
+	struct textarea *ta;
+	struct caret caret;
+	const char *data;
+	char *text;
+	unsigned int len;
+	unsigned int edit;
+	unsigned int seed = 42;
+	unsigned int pos;
+
+	/* tall enough to need no vertical scrollbar */
+	ta = create_textarea(400, 1000000, &caret);
+	text = make_text(20000, 1);
+	ck_assert(textarea_set_text(ta, text));
+	free(text);
+
+	for (edit = 0; edit < EDIT_COUNT; edit++) {
+		seed = (seed * 1103515245) + 12345;
+		data = textarea_data(ta, &len);
+		pos = (seed >> 8) % len;
+		textarea_set_caret(ta, pos);
+
+		switch ((seed >> 4) % 6) {
+		case 0:
+			ck_assert(textarea_keypress(ta, 'x'));
+			break;
+		case 1:
+			ck_assert(textarea_keypress(ta, ' '));
+			break;
+		case 2:
+			ck_assert(textarea_keypress(ta, NS_KEY_NL));
+			break;
+		case 3:
+			ck_assert(textarea_keypress(ta, NS_KEY_DELETE_LEFT));
+			break;
+		case 4:
+			ck_assert(textarea_keypress(ta, NS_KEY_DELETE_RIGHT));
+			break;
+		case 5:
+			data = pastes[(seed >> 12) % NELEMS(pastes)];
+			ck_assert(textarea_drop_text(ta, data, strlen(data)));
+			break;
+		}
+
+		if ((edit % 50) == 0) {
+			check_layout(ta, &caret, 400, 1000000);
+		}
+	}
+	check_layout(ta, &caret, 400, 1000000);
+
+	textarea_destroy(ta);
+}
+END_TEST
+
+/**
+ * Text added to a short textarea gains a scrollbar and reflows
+ */
+START_TEST(textarea_scrollbar_test)
+{
+	struct textarea *ta;
+	struct caret caret;
+	char *text;
+	unsigned int idx;
+
+	ta = create_textarea(400, 100, &caret);
+	ck_assert(textarea_set_text(ta, "short\ntext"));
+
+	text = make_text(4000, 7);
+	textarea_set_caret(ta, 5);
+	ck_assert(textarea_drop_text(ta, text, strlen(text)));
+	free(text);
+	check_layout(ta, &caret, 400, 100);
+
+	for (idx = 0; idx < 4000; idx++) {
+		textarea_set_caret(ta, 0);
+		ck_assert(textarea_keypress(ta, NS_KEY_DELETE_RIGHT));
+	}
+	check_layout(ta, &caret, 400, 100);
+
+	textarea_destroy(ta);
+}
+END_TEST
+
+/**
+ * reflow work per keystroke is bounded to the edited paragraph
+ */
+START_TEST(textarea_reflow_cost_test)
+{
+	struct textarea *ta;
+	struct caret caret;
+	char *text;
+	unsigned int key;
+
+	ta = create_textarea(600, 400, &caret);
+	text = make_text(COST_SIZE, 3);
+	ck_assert(textarea_set_text(ta, text));
+	free(text);
+
+	textarea_set_caret(ta, COST_SIZE / 2);
+	split_count = 0;
+
+	for (key = 0; key < COST_KEYS; key++) {
+		ck_assert(textarea_keypress(ta, (key % 6) == 5 ? ' ' : 'x'));
+	}
+	for (key = 0; key < COST_KEYS; key++) {
+		ck_assert(textarea_keypress(ta, NS_KEY_DELETE_LEFT));
+	}
+
+	/* only the edited paragraph is reflowed */
+	ck_assert(split_count < 2 * COST_KEYS * 20);
+
+	textarea_destroy(ta);
+}
+END_TEST
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/**
+ * Keystroke latency editing a large textarea
+ *
+ * Reports the mean time to insert and delete characters near the
+ * start, middle and end of a 1MB text and checks the reflow work
+ * done for each keystroke does not depend on the text size.
+ */
+START_TEST(textarea_keystroke_bench_test)
+{
+	static const struct {
+		const char *name;
+		unsigned int pos;
+	} positions[] = {
+		{ "start", 1000 },
+		{ "middle", BENCH_SIZE / 2 },
+		{ "end", BENCH_SIZE - 1000 },
+	};
+	struct textarea *ta;
+	struct caret caret;
+	char *text;
+	unsigned int idx;
+	unsigned int key;
+	double start;
+	double insert;
+	double delete;
+
+	ta = create_textarea(600, 400, &caret);
+	text = make_text(BENCH_SIZE, 3);
+	ck_assert(textarea_set_text(ta, text));
+	free(text);
+
+	for (idx = 0; idx < NELEMS(positions); idx++) {
+		textarea_set_caret(ta, positions[idx].pos);
+		split_count = 0;
+
+		start = bench_now();
+		for (key = 0; key < BENCH_KEYS; key++) {
+			ck_assert(textarea_keypress(ta,
+					(key % 6) == 5 ? ' ' : 'x'));
+		}
+		insert = bench_now() - start;
+
+		start = bench_now();
+		for (key = 0; key < BENCH_KEYS; key++) {
+			ck_assert(textarea_keypress(ta, NS_KEY_DELETE_LEFT));
+		}
+		delete = bench_now() - start;
+
+		fprintf(stderr, "keystroke near %s of %u byte text: "
+				"insert %.1f us, delete %.1f us, "
+				"%.1f splits\n",
+				positions[idx].name, BENCH_SIZE,
+				insert * 1e6 / BENCH_KEYS,
+				delete * 1e6 / BENCH_KEYS,
+				(double)split_count / (2 * BENCH_KEYS));
+
+		/* only the edited paragraph is reflowed */
+		ck_assert(split_count < 2 * BENCH_KEYS * 20);
+	}
+
+	textarea_destroy(ta);
+}
+END_TEST
+
+static TCase *textarea_case_create(void)
+{
+	TCase *tc;
+	tc = tcase_create("Editing");
+
+	tcase_add_test(tc, textarea_reflow_test);
+	tcase_add_test(tc, textarea_scrollbar_test);
+	tcase_add_test(tc, textarea_reflow_cost_test);
+
+	return tc;
+}
+
+static TCase *textarea_bench_case_create(void)
+{
+	TCase *tc;
+	tc = tcase_create("Benchmark");
+
+	tcase_add_test(tc, textarea_keystroke_bench_test);
+	tcase_set_timeout(tc, 60);
+
+	return tc;
+}
+
+static Suite *textarea_suite_create(void)
+{
+	Suite *s;
+	s = suite_create("Textarea");
+
+	suite_add_tcase(s, textarea_case_create());
+
+	/* timing is only run on request by make bench */
+	if (getenv("NETSURF_TEST_BENCH") != NULL) {
+		suite_add_tcase(s, textarea_bench_case_create());
+	}
+
+	return s;
+}
+
+int main(int argc, char **argv)
+{
+	int number_failed;
+	SRunner *sr;
+
+	sr = srunner_create(textarea_suite_create());
+
+	srunner_run_all(sr, CK_ENV);
+
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
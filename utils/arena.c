@@ -0,0 +1,332 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Arena (bump) allocator implementation.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/arena.h"
+
+/** Default size of arena chunks */
+#define ARENA_DEFAULT_CHUNK_SIZE (32 * 1024)
+
+/** Number of object pointers held by each registry block */
+#define ARENA_OBJECT_BLOCK 64
+
+/** Type with the strictest alignment requirement an allocation needs */
+typedef union {
+	long double ld;
+	long long ll;
+	double d;
+	void *p;
+	void (*fn)(void);
+} arena_align_t;
+
+/** Round a size up to the arena alignment */
+#define ARENA_ROUND(x) \
+	(((x) + sizeof(arena_align_t) - 1) & ~(sizeof(arena_align_t) - 1))
+
+/**
+ * A chunk of memory allocations are carved from.
+ *
+ * The allocatable space starts at the first aligned address after the
+ * chunk header.
+ */
+struct arena_chunk {
+	struct arena_chunk *next; /**< Next chunk in the arena */
+	size_t size; /**< Allocatable bytes in this chunk */
+	size_t used; /**< Bytes handed out from this chunk */
+};
+
+/** Offset of the allocatable space within a chunk */
+#define ARENA_CHUNK_HEADER ARENA_ROUND(sizeof(struct arena_chunk))
+
+/**
+ * A block of registered objects awaiting finalisation.
+ */
+struct arena_objects {
+	struct arena_objects *next; /**< Previously filled block */
+	size_t count; /**< Number of entries used in object */
+	void *object[ARENA_OBJECT_BLOCK]; /**< Registered objects */
+};
+
+/**
+ * An arena.
+ */
+struct arena {
+	struct arena_chunk *chunks; /**< Chunks, current chunk first */
+	size_t chunk_size; /**< Allocatable bytes in a standard chunk */
+	arena_finaliser_t finaliser; /**< Object finaliser */
+	struct arena_objects *objects; /**< Object registry, newest first */
+
+	size_t used; /**< Total bytes handed out */
+	size_t reserved; /**< Total bytes obtained from malloc */
+	size_t object_count; /**< Total number of registered objects */
+
+	bool memtrack; /**< Reserved memory is accounted to a subsystem */
+	enum memtrack_subsystem subsystem; /**< Subsystem accounted to */
+};
+
+
+/**
+ * Allocate a new chunk.
+ *
+ * \param arena The arena the chunk is for.
+ * \param size The allocatable size of the chunk.
+ * \return The new chunk or NULL on memory exhaustion.
+ */
+static struct arena_chunk *arena_chunk_create(struct arena *arena, size_t size)
+{
+	struct arena_chunk *chunk;
+
+	if (size > (size_t)-1 - ARENA_CHUNK_HEADER) {
+		return NULL;
+	}
+
+	chunk = malloc(ARENA_CHUNK_HEADER + size);
+	if (chunk == NULL) {
+		return NULL;
+	}
+
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+
+	arena->reserved += ARENA_CHUNK_HEADER + size;
+	if (arena->memtrack) {
+		memtrack_alloc(arena->subsystem, ARENA_CHUNK_HEADER + size);
+	}
+
+	return chunk;
+}
+
+
+/* exported interface documented in utils/arena.h */
+struct arena *arena_create(size_t chunk_size, arena_finaliser_t finaliser)
+{
+	struct arena *arena;
+
+	arena = malloc(sizeof(*arena));
+	if (arena == NULL) {
+		return NULL;
+	}
+
+	if (chunk_size == 0) {
+		chunk_size = ARENA_DEFAULT_CHUNK_SIZE;
+	}
+
+	arena->chunks = NULL;
+	arena->chunk_size = ARENA_ROUND(chunk_size);
+	arena->finaliser = finaliser;
+	arena->objects = NULL;
+	arena->used = 0;
+	arena->reserved = sizeof(*arena);
+	arena->object_count = 0;
+	arena->memtrack = false;
+	arena->subsystem = MEMTRACK_SUBSYSTEM_COUNT;
+
+	return arena;
+}
+
+
+/* exported interface documented in utils/arena.h */
+void arena_destroy(struct arena *arena)
+{
+	struct arena_objects *objects;
+	struct arena_chunk *chunk;
+	size_t idx;
+
+	if (arena == NULL) {
+		return;
+	}
+
+	/* the registry lives in the arena so must be walked first */
+	if (arena->finaliser != NULL) {
+		for (objects = arena->objects;
+		     objects != NULL;
+		     objects = objects->next) {
+			for (idx = 0; idx < objects->count; idx++) {
+				arena->finaliser(objects->object[idx]);
+			}
+		}
+	}
+
+	while (arena->chunks != NULL) {
+		chunk = arena->chunks;
+		arena->chunks = chunk->next;
+		free(chunk);
+	}
+
+	if (arena->memtrack) {
+		memtrack_free(arena->subsystem, arena->reserved);
+	}
+
+	free(arena);
+}
+
+
+/* exported interface documented in utils/arena.h */
+void *arena_alloc(struct arena *arena, size_t size)
+{
+	struct arena_chunk *chunk = arena->chunks;
+	void *ret;
+
+	if (size == 0) {
+		size = 1;
+	}
+	if (size > (size_t)-1 - sizeof(arena_align_t)) {
+		return NULL;
+	}
+	size = ARENA_ROUND(size);
+
+	if (size > arena->chunk_size / 4) {
+		/* large allocations get a chunk of their own so the
+		 * space remaining in the current chunk is not wasted
+		 */
+		chunk = arena_chunk_create(arena, size);
+		if (chunk == NULL) {
+			return NULL;
+		}
+		chunk->used = size;
+		if (arena->chunks == NULL) {
+			arena->chunks = chunk;
+		} else {
+			chunk->next = arena->chunks->next;
+			arena->chunks->next = chunk;
+		}
+	} else {
+		if (chunk == NULL || chunk->size - chunk->used < size) {
+			chunk = arena_chunk_create(arena, arena->chunk_size);
+			if (chunk == NULL) {
+				return NULL;
+			}
+			chunk->next = arena->chunks;
+			arena->chunks = chunk;
+		}
+		chunk->used += size;
+	}
+
+	arena->used += size;
+
+	ret = (char *)chunk + ARENA_CHUNK_HEADER + chunk->used - size;
+
+	return ret;
+}
+
+
+/* exported interface documented in utils/arena.h */
+void *arena_alloc_object(struct arena *arena, size_t size)
+{
+	struct arena_objects *objects = arena->objects;
+	void *object;
+
+	if (objects == NULL || objects->count == ARENA_OBJECT_BLOCK) {
+		objects = arena_alloc(arena, sizeof(*objects));
+		if (objects == NULL) {
+			return NULL;
+		}
+		objects->next = arena->objects;
+		objects->count = 0;
+		arena->objects = objects;
+	}
+
+	object = arena_alloc(arena, size);
+	if (object == NULL) {
+		return NULL;
+	}
+
+	objects->object[objects->count++] = object;
+	arena->object_count++;
+
+	return object;
+}
+
+
+/* exported interface documented in utils/arena.h */
+void *arena_memdup(struct arena *arena, const void *data, size_t size)
+{
+	void *ret;
+
+	ret = arena_alloc(arena, size);
+	if (ret != NULL) {
+		memcpy(ret, data, size);
+	}
+
+	return ret;
+}
+
+
+/* exported interface documented in utils/arena.h */
+char *arena_strndup(struct arena *arena, const char *s, size_t n)
+{
+	char *ret;
+	size_t len = 0;
+
+	while (len < n && s[len] != '\0') {
+		len++;
+	}
+
+	ret = arena_alloc(arena, len + 1);
+	if (ret != NULL) {
+		memcpy(ret, s, len);
+		ret[len] = '\0';
+	}
+
+	return ret;
+}
+
+
+/* exported interface documented in utils/arena.h */
+char *arena_strdup(struct arena *arena, const char *s)
+{
+	return arena_memdup(arena, s, strlen(s) + 1);
+}
+
+
+/* exported interface documented in utils/arena.h */
+void arena_get_stats(const struct arena *arena,
+		size_t *used, size_t *reserved, size_t *objects)
+{
+	if (used != NULL) {
+		*used = arena->used;
+	}
+	if (reserved != NULL) {
+		*reserved = arena->reserved;
+	}
+	if (objects != NULL) {
+		*objects = arena->object_count;
+	}
+}
+
+
+/* exported interface documented in utils/arena.h */
+void arena_memtrack(struct arena *arena, enum memtrack_subsystem subsystem)
+{
+	if (arena->memtrack) {
+		return;
+	}
+
+	arena->memtrack = true;
+	arena->subsystem = subsystem;
+	memtrack_alloc(subsystem, arena->reserved);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Arena (bump) allocator interface.
+ *
+ * An arena hands out memory from large chunks and releases all of it
+ * at once when the arena is destroyed. Individual allocations cannot
+ * be freed. Objects which hold references that must be dropped when
+ * the arena goes away may be allocated with arena_alloc_object() and
+ * will be passed to the arena's finaliser on destruction.
+ */
+
+#ifndef NETSURF_UTILS_ARENA_H
+#define NETSURF_UTILS_ARENA_H
+
+#include <stddef.h>
+
+#include "utils/memtrack.h"
+
+struct arena;
+
+/**
+ * Finaliser called for each object allocated with arena_alloc_object()
+ * when the arena is destroyed.
+ *
+ * \param object The object being finalised.
+ */
+typedef void (*arena_finaliser_t)(void *object);
+
+/**
+ * Create an arena.
+ *
+ * \param chunk_size Size of the chunks memory is reserved in, or 0
+ *                   for the default.
+ * \param finaliser Finaliser for objects, or NULL if none is required.
+ * \return The new arena or NULL on memory exhaustion.
+ */
+struct arena *arena_create(size_t chunk_size, arena_finaliser_t finaliser);
+
+/**
+ * Destroy an arena, finalising its objects and releasing all memory
+ * allocated from it.
+ *
+ * \param arena The arena to destroy, may be NULL.
+ */
+void arena_destroy(struct arena *arena);
+
+/**
+ * Allocate memory from an arena.
+ *
+ * The returned memory is suitably aligned for any type and is not
+ * initialised.
+ *
+ * \param arena The arena to allocate from.
+ * \param size The number of bytes to allocate.
+ * \return Pointer to the allocation or NULL on memory exhaustion.
+ */
+void *arena_alloc(struct arena *arena, size_t size);
+
+/**
+ * Allocate an object from an arena which is passed to the arena's
+ * finaliser when the arena is destroyed.
+ *
+ * \param arena The arena to allocate from.
+ * \param size The number of bytes to allocate.
+ * \return Pointer to the allocation or NULL on memory exhaustion.
+ */
+void *arena_alloc_object(struct arena *arena, size_t size);
+
+/**
+ * Duplicate a block of memory into an arena.
+ *
+ * \param arena The arena to allocate from.
+ * \param data The data to copy.
+ * \param size The number of bytes to copy.
+ * \return Pointer to the copy or NULL on memory exhaustion.
+ */
+void *arena_memdup(struct arena *arena, const void *data, size_t size);
+
+/**
+ * Duplicate a string into an arena.
+ *
+ * \param arena The arena to allocate from.
+ * \param s The NUL terminated string to copy.
+ * \return Pointer to the copy or NULL on memory exhaustion.
+ */
+char *arena_strdup(struct arena *arena, const char *s);
+
+/**
+ * Duplicate at most n bytes of a string into an arena.
+ *
+ * The copy is always NUL terminated.
+ *
+ * \param arena The arena to allocate from.
+ * \param s The string to copy.
+ * \param n The maximum number of bytes to copy.
+ * \return Pointer to the copy or NULL on memory exhaustion.
+ */
+char *arena_strndup(struct arena *arena, const char *s, size_t n);
+
+/**
+ * Get the allocation statistics of an arena.
+ *
+ * As nothing is released before the arena is destroyed the reserved
+ * size is also the peak footprint of the arena.
+ *
+ * \param arena The arena to query.
+ * \param used Updated with the number of bytes handed out, or NULL.
+ * \param reserved Updated with the number of bytes reserved from the
+ *                 system allocator, or NULL.
+ * \param objects Updated with the number of finalised objects, or NULL.
+ */
+void arena_get_stats(const struct arena *arena,
+		size_t *used, size_t *reserved, size_t *objects);
+
+/**
+ * Account the memory reserved by an arena to a subsystem.
+ *
+ * Memory already reserved and all later reservations are accounted
+ * until the arena is destroyed.
+ *
+ * \param arena The arena to account.
+ * \param subsystem The subsystem the arena belongs to.
+ */
+void arena_memtrack(struct arena *arena, enum memtrack_subsystem subsystem);
+
+#endif
@@ -142,6 +142,12 @@ char *realpath(const char *path, char *resolved_path);
 #undef HAVE_MMAP
 #endif
 
+/* POSIX threads for background work */
+#define HAVE_PTHREADS
+#if (defined(_WIN32) || defined(__riscos__) || defined(__amigaos4__) || defined(__AMIGA__) || defined(__MINT__))
+#undef HAVE_PTHREADS
+#endif
+
 #define HAVE_SCANDIR
 #if (defined(_WIN32) ||				\
      defined(__serenity__) || \
@@ -169,6 +175,11 @@ char *realpath(const char *path, char *resolved_path);
 #define HAVE_EXECINFO
 #endif
 
+/* Linux procfs and cgroup v2 memory usage and pressure information */
+#if defined(__linux__)
+#define HAVE_LINUX_MEMSTAT
+#endif
+
 /* This section toggles build options on and off.
  * Simply undefine a symbol to turn the relevant feature off.
  *
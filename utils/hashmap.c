@@ -20,6 +20,7 @@
 #include <string.h>
 
 #include "utils/hashmap.h"
+#include "utils/memtrack.h"
 
 /**
  * The default number of buckets in the hashmaps we create.
@@ -83,6 +84,9 @@ hashmap_create(hashmap_parameters_t *params)
 
 	memset(ret->buckets, 0, ret->bucket_count * sizeof(hashmap_entry_t *));
 
+	memtrack_alloc(MEMTRACK_HASHMAP, sizeof(hashmap_t) +
+		       ret->bucket_count * sizeof(hashmap_entry_t *));
+
 	return ret;
 }
 
@@ -99,11 +103,15 @@ hashmap_destroy(hashmap_t *hashmap)
 			hashmap_entry_t *next = entry->next;
 			hashmap->params->value_destroy(entry->value);
 			hashmap->params->key_destroy(entry->key);
+			memtrack_free(MEMTRACK_HASHMAP, sizeof(*entry));
 			free(entry);
 			entry = next;
 		}
 	}
 
+	memtrack_free(MEMTRACK_HASHMAP, sizeof(hashmap_t) +
+		      hashmap->bucket_count * sizeof(hashmap_entry_t *));
+
 	free(hashmap->buckets);
 	free(hashmap);
 }
@@ -167,6 +175,7 @@ hashmap_insert(hashmap_t *hashmap, void *key)
 	}
 	
 	memset(entry, 0, sizeof(*entry));
+	memtrack_alloc(MEMTRACK_HASHMAP, sizeof(*entry));
 
 	entry->key = hashmap->params->key_clone(key);
 	if (entry->key == NULL) {
@@ -196,6 +205,7 @@ err:
 		hashmap->params->value_destroy(entry->value);
 	if (entry->key != NULL)
 		hashmap->params->key_destroy(entry->key);
+	memtrack_free(MEMTRACK_HASHMAP, sizeof(*entry));
 	free(entry);
 
 	return NULL;
@@ -218,6 +228,7 @@ hashmap_remove(hashmap_t *hashmap, void *key)
 					entry->next->prevptr = entry->prevptr;
 				}
 				*entry->prevptr = entry->next;
+				memtrack_free(MEMTRACK_HASHMAP, sizeof(*entry));
 				free(entry);
 				hashmap->entry_count--;
 				return true;
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Heap allocation accounting implementation.
+ */
+
+#include "utils/config.h"
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "utils/memtrack.h"
+
+/** Subsystem names, indexed by enum memtrack_subsystem */
+static const char *memtrack_names[MEMTRACK_SUBSYSTEM_COUNT] = {
+	[MEMTRACK_LLCACHE] = "llcache",
+	[MEMTRACK_IMAGE_CACHE] = "image_cache",
+	[MEMTRACK_BOX] = "box",
+	[MEMTRACK_JAVASCRIPT] = "javascript",
+	[MEMTRACK_HASHMAP] = "hashmap",
+	[MEMTRACK_CURL] = "curl",
+};
+
+#ifdef WITH_MEMTRACK
+
+/** Statistics for each subsystem */
+static struct memtrack_stats memtrack_stats[MEMTRACK_SUBSYSTEM_COUNT];
+
+#ifdef HAVE_PTHREADS
+/**
+ * Protects memtrack_stats.
+ *
+ * Library allocators, such as curl's threaded resolver, report from
+ * threads other than the main one.
+ */
+static pthread_mutex_t memtrack_lock = PTHREAD_MUTEX_INITIALIZER;
+#define MEMTRACK_LOCK() pthread_mutex_lock(&memtrack_lock)
+#define MEMTRACK_UNLOCK() pthread_mutex_unlock(&memtrack_lock)
+#else
+#define MEMTRACK_LOCK()
+#define MEMTRACK_UNLOCK()
+#endif
+
+
+/**
+ * Account an allocation with the statistics lock held
+ */
+static void
+memtrack_alloc_locked(struct memtrack_stats *stats, size_t size)
+{
+	stats->allocs++;
+	stats->current += size;
+	if (stats->current > stats->peak) {
+		stats->peak = stats->current;
+	}
+}
+
+
+/**
+ * Account a release with the statistics lock held
+ */
+static void
+memtrack_free_locked(struct memtrack_stats *stats, size_t size)
+{
+	stats->frees++;
+	if (size > stats->current) {
+		/* released more than was accounted, never wrap */
+		stats->current = 0;
+	} else {
+		stats->current -= size;
+	}
+}
+
+
+/* exported interface documented in utils/memtrack.h */
+void memtrack_alloc(enum memtrack_subsystem subsystem, size_t size)
+{
+	MEMTRACK_LOCK();
+	memtrack_alloc_locked(&memtrack_stats[subsystem], size);
+	MEMTRACK_UNLOCK();
+}
+
+
+/* exported interface documented in utils/memtrack.h */
+void memtrack_free(enum memtrack_subsystem subsystem, size_t size)
+{
+	MEMTRACK_LOCK();
+	memtrack_free_locked(&memtrack_stats[subsystem], size);
+	MEMTRACK_UNLOCK();
+}
+
+
+/* exported interface documented in utils/memtrack.h */
+void memtrack_resize(enum memtrack_subsystem subsystem,
+		size_t old_size, size_t new_size)
+{
+	struct memtrack_stats *stats = &memtrack_stats[subsystem];
+
+	if (old_size == new_size) {
+		return;
+	}
+
+	MEMTRACK_LOCK();
+	if (old_size == 0) {
+		memtrack_alloc_locked(stats, new_size);
+	} else if (new_size == 0) {
+		memtrack_free_locked(stats, old_size);
+	} else if (new_size > old_size) {
+		stats->current += new_size - old_size;
+		if (stats->current > stats->peak) {
+			stats->peak = stats->current;
+		}
+	} else if (old_size - new_size > stats->current) {
+		stats->current = 0;
+	} else {
+		stats->current -= old_size - new_size;
+	}
+	MEMTRACK_UNLOCK();
+}
+
+
+/* exported interface documented in utils/memtrack.h */
+nserror memtrack_get_stats(enum memtrack_subsystem subsystem,
+		struct memtrack_stats *stats)
+{
+	if ((unsigned int)subsystem >= MEMTRACK_SUBSYSTEM_COUNT) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	MEMTRACK_LOCK();
+	*stats = memtrack_stats[subsystem];
+	MEMTRACK_UNLOCK();
+
+	return NSERROR_OK;
+}
+
+#else
+
+/* exported interface documented in utils/memtrack.h */
+nserror memtrack_get_stats(enum memtrack_subsystem subsystem,
+		struct memtrack_stats *stats)
+{
+	return NSERROR_NOT_IMPLEMENTED;
+}
+
+#endif
+
+
+/* exported interface documented in utils/memtrack.h */
+const char *memtrack_subsystem_name(enum memtrack_subsystem subsystem)
+{
+	if ((unsigned int)subsystem >= MEMTRACK_SUBSYSTEM_COUNT) {
+		return "unknown";
+	}
+
+	return memtrack_names[subsystem];
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026 The NetSurf Browser Project
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Heap allocation accounting interface.
+ *
+ * The main allocation sites of several subsystems report the memory
+ * they allocate and release so heap usage can be attributed to them.
+ * Accounting is only compiled in when building with WITH_MEMTRACK
+ * (NETSURF_USE_MEMTRACK := YES), otherwise the reporting calls compile
+ * to nothing and no statistics are available.
+ *
+ * The reporting calls are serialised with a mutex when the build has
+ * POSIX threads (HAVE_PTHREADS) and may then be made from any thread.
+ * Without threads they must only be made from the main thread.
+ */
+
+#ifndef NETSURF_UTILS_MEMTRACK_H
+#define NETSURF_UTILS_MEMTRACK_H
+
+#include <stddef.h>
+
+#include "utils/errors.h"
+
+/**
+ * Subsystems memory is accounted to
+ */
+enum memtrack_subsystem {
+	MEMTRACK_LLCACHE, /**< Low level cache objects and source data */
+	MEMTRACK_IMAGE_CACHE, /**< Image cache entries and bitmaps */
+	MEMTRACK_BOX, /**< HTML box trees */
+	MEMTRACK_JAVASCRIPT, /**< Javascript heaps */
+	MEMTRACK_HASHMAP, /**< Hashmap tables and entries */
+	MEMTRACK_CURL, /**< curl library allocations */
+	MEMTRACK_SUBSYSTEM_COUNT
+};
+
+/**
+ * Memory accounted to a subsystem
+ */
+struct memtrack_stats {
+	size_t current; /**< Bytes currently allocated */
+	size_t peak; /**< Largest number of bytes allocated at once */
+	unsigned long allocs; /**< Number of allocations */
+	unsigned long frees; /**< Number of releases */
+};
+
+#ifdef WITH_MEMTRACK
+
+/**
+ * Account an allocation to a subsystem
+ *
+ * \param subsystem The subsystem making the allocation.
+ * \param size The number of bytes allocated.
+ */
+void memtrack_alloc(enum memtrack_subsystem subsystem, size_t size);
+
+/**
+ * Account a release of memory by a subsystem
+ *
+ * \param subsystem The subsystem releasing the memory.
+ * \param size The number of bytes released.
+ */
+void memtrack_free(enum memtrack_subsystem subsystem, size_t size);
+
+/**
+ * Account a change in size of an allocation
+ *
+ * Resizing from or to zero is counted as an allocation or release.
+ *
+ * \param subsystem The subsystem owning the allocation.
+ * \param old_size The previous size of the allocation.
+ * \param new_size The new size of the allocation.
+ */
+void memtrack_resize(enum memtrack_subsystem subsystem,
+		size_t old_size, size_t new_size);
+
+#else
+
+#define memtrack_alloc(subsystem, size) \
+	do { (void)(subsystem); (void)(size); } while (0)
+#define memtrack_free(subsystem, size) \
+	do { (void)(subsystem); (void)(size); } while (0)
+#define memtrack_resize(subsystem, old_size, new_size) \
+	do { (void)(subsystem); (void)(old_size); (void)(new_size); } while (0)
+
+#endif
+
+/**
+ * Get the memory accounted to a subsystem
+ *
+ * \param subsystem The subsystem to report.
+ * \param stats Updated with the subsystem statistics.
+ * \return NSERROR_OK on success, NSERROR_NOT_IMPLEMENTED if accounting
+ *         is not compiled in or NSERROR_BAD_PARAMETER if the subsystem
+ *         is not valid.
+ */
+nserror memtrack_get_stats(enum memtrack_subsystem subsystem,
+		struct memtrack_stats *stats);
+
+/**
+ * Get the name of a subsystem
+ *
+ * \param subsystem The subsystem to name.
+ * \return The subsystem name.
+ */
+const char *memtrack_subsystem_name(enum memtrack_subsystem subsystem);
+
+#endif
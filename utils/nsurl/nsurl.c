@@ -65,6 +65,72 @@
 
 
 
+/**
+ * Number of chains in the URL intern table.
+ *
+ * Prime, in the same manner as libwapcaplet's string table.
+ */
+#define NSURL_INTERN_BUCKETS 4091
+
+/** Table of all live URLs, keyed on their complete string */
+static nsurl *nsurl__intern_table[NSURL_INTERN_BUCKETS];
+
+
+/**
+ * Hash a complete URL string.
+ *
+ * Fowler Noll Vo over the whole string, including any fragment.
+ */
+static inline uint32_t nsurl__string_hash(const char *s, size_t len)
+{
+	uint32_t z = 0x811c9dc5;
+
+	while (len-- > 0) {
+		z *= 0x01000193;
+		z ^= (uint8_t)*s++;
+	}
+
+	return z;
+}
+
+
+/* exported interface, documented in nsurl/private.h */
+void nsurl__intern(nsurl **url)
+{
+	nsurl *new_url = *url;
+	nsurl **chain;
+	nsurl *cur;
+	uint32_t hash;
+
+	hash = nsurl__string_hash(new_url->string, new_url->length);
+	chain = &nsurl__intern_table[hash % NSURL_INTERN_BUCKETS];
+
+	for (cur = *chain; cur != NULL; cur = cur->intern_next) {
+		if (cur->intern_hash == hash &&
+				cur->length == new_url->length &&
+				memcmp(cur->string, new_url->string,
+						cur->length) == 0) {
+			/* Already live; share the existing object */
+			nsurl__components_destroy(&new_url->components);
+			free(new_url);
+
+			cur->count++;
+			*url = cur;
+			return;
+		}
+	}
+
+	/* Add to head of chain */
+	new_url->intern_hash = hash;
+	new_url->intern_next = *chain;
+	if (*chain != NULL) {
+		(*chain)->intern_prevp = &new_url->intern_next;
+	}
+	new_url->intern_prevp = chain;
+	*chain = new_url;
+}
+
+
 /******************************************************************************
  * NetSurf URL Public API                                                     *
  ******************************************************************************/
@@ -89,6 +155,12 @@ void nsurl_unref(nsurl *url)
 	if (--url->count > 0)
 		return;
 
+	/* Remove from intern table */
+	*url->intern_prevp = url->intern_next;
+	if (url->intern_next != NULL) {
+		url->intern_next->intern_prevp = url->intern_prevp;
+	}
+
 	/* Release lwc strings */
 	nsurl__components_destroy(&url->components);
 
@@ -105,6 +177,19 @@ bool nsurl_compare(const nsurl *url1, const nsurl *url2, nsurl_component parts)
 	assert(url1 != NULL);
 	assert(url2 != NULL);
 
+	/* URLs are interned, so the same object means the same URL */
+	if (url1 == url2)
+		return true;
+
+	/* ...and distinct objects always differ somewhere */
+	if ((parts & NSURL_WITH_FRAGMENT) == NSURL_WITH_FRAGMENT)
+		return false;
+
+	/* The hash covers every component except the fragment */
+	if ((parts & NSURL_COMPLETE) == NSURL_COMPLETE &&
+			url1->hash != url2->hash)
+		return false;
+
 	/* Compare URL components */
 
 	/* Path, host and query first, since they're most likely to differ */
@@ -508,6 +593,8 @@ nserror nsurl_defragment(const nsurl *url, nsurl **no_frag)
 	/* Give the URL a reference */
 	(*no_frag)->count = 1;
 
+	nsurl__intern(no_frag);
+
 	return NSERROR_OK;
 }
 
@@ -576,6 +663,8 @@ nserror nsurl_refragment(const nsurl *url, lwc_string *frag, nsurl **new_url)
 	/* Give the URL a reference */
 	(*new_url)->count = 1;
 
+	nsurl__intern(new_url);
+
 	return NSERROR_OK;
 }
 
@@ -673,6 +762,8 @@ nserror nsurl_replace_query(const nsurl *url, const char *query,
 	/* Give the URL a reference */
 	(*new_url)->count = 1;
 
+	nsurl__intern(new_url);
+
 	return NSERROR_OK;
 }
 
@@ -760,6 +851,8 @@ nserror nsurl_replace_scheme(const nsurl *url, lwc_string *scheme,
 	/* Give the URL a reference */
 	(*new_url)->count = 1;
 
+	nsurl__intern(new_url);
+
 	return NSERROR_OK;
 }
 
@@ -963,6 +1056,8 @@ nserror nsurl_parent(const nsurl *url, nsurl **new_url)
 	/* Give the URL a reference */
 	(*new_url)->count = 1;
 
+	nsurl__intern(new_url);
+
 	return NSERROR_OK;
 }
 
@@ -48,6 +48,15 @@
 #include "utils/nsurl/private.h"
 #include "utils/utils.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define NSURL_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && \
+	(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#include <arm_neon.h>
+#define NSURL_SIMD_NEON
+#endif
+
 
 /** Marker set, indicating positions of sections within a URL string */
 struct url_markers {
@@ -189,6 +198,98 @@ static bool nsurl__is_no_escape(unsigned char c)
 }
 
 
+/* exported interface, documented in nsurl/private.h */
+size_t nsurl__plain_run(const char *pos, const char *end, bool lower)
+{
+	const char *start = pos;
+
+#if defined(NSURL_SIMD_SSE2)
+	while (end - pos >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(const void *)pos);
+		__m128i bad;
+		unsigned int mask;
+
+		if (lower) {
+			/* 'A' to 'Z' or '%' */
+			bad = _mm_and_si128(
+					_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+					_mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+			bad = _mm_or_si128(bad,
+					_mm_cmpeq_epi8(v, _mm_set1_epi8('%')));
+		} else {
+			/* outside '!' to '~' (bytes >= 0x80 are negative) */
+			bad = _mm_andnot_si128(
+					_mm_cmplt_epi8(v, _mm_set1_epi8(0x7f)),
+					_mm_set1_epi8(-1));
+			bad = _mm_or_si128(bad,
+					_mm_cmplt_epi8(v, _mm_set1_epi8('!')));
+			/* or one of the printable characters to escape */
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('%')));
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('<')));
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('>')));
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('^')));
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('`')));
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('{')));
+			bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8('}')));
+		}
+
+		mask = (unsigned int)_mm_movemask_epi8(bad);
+		if (mask != 0) {
+			return (pos - start) + __builtin_ctz(mask);
+		}
+		pos += 16;
+	}
+#elif defined(NSURL_SIMD_NEON)
+	while (end - pos >= 16) {
+		uint8x16_t v = vld1q_u8((const uint8_t *)pos);
+		uint8x16_t bad;
+		uint64_t mask;
+
+		if (lower) {
+			/* 'A' to 'Z' or '%' */
+			bad = vcltq_u8(vsubq_u8(v, vdupq_n_u8('A')),
+					vdupq_n_u8(26));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('%')));
+		} else {
+			/* outside '!' to '~' */
+			bad = vcgeq_u8(vsubq_u8(v, vdupq_n_u8('!')),
+					vdupq_n_u8('~' - '!' + 1));
+			/* or one of the printable characters to escape */
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('"')));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('%')));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('<')));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('>')));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('\\')));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('^')));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('`')));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('{')));
+			bad = vorrq_u8(bad, vceqq_u8(v, vdupq_n_u8('}')));
+		}
+
+		/* narrow to four bits per byte */
+		mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(
+				vreinterpretq_u16_u8(bad), 4)), 0);
+		if (mask != 0) {
+			return (pos - start) + (__builtin_ctzll(mask) >> 2);
+		}
+		pos += 16;
+	}
+#endif
+
+	if (lower) {
+		while (pos < end && *pos != '%' && !ascii_is_alpha_upper(*pos))
+			pos++;
+	} else {
+		while (pos < end && nsurl__is_no_escape(*pos))
+			pos++;
+	}
+
+	return pos - start;
+}
+
+
 /**
  * Obtains a set of markers delimiting sections in a URL string
  *
@@ -366,6 +467,12 @@ static void nsurl__get_string_markers(const char * const url_s,
 
 		/* Need to get (or complete) the authority */
 		while (*pos != '\0') {
+			/* Skip to the next delimiter of interest */
+			pos += strcspn(pos, "/?#:@");
+			if (*pos == '\0') {
+				break;
+			}
+
 			if (*pos == '/' || *pos == '?' || *pos == '#') {
 				/* End of the authority */
 				break;
@@ -405,32 +512,25 @@ static void nsurl__get_string_markers(const char * const url_s,
 	 */
 	if (*pos == '/' || ((marker.path == marker.authority) &&
 			(*pos != '?') && (*pos != '#') && (*pos != '\0'))) {
-		while (*(++pos) != '\0') {
-			if (*pos == '?' || *pos == '#') {
-				/* End of the path */
-				break;
-			}
-		}
+		/* End of the path */
+		pos++;
+		pos += strcspn(pos, "?#");
 	}
 
 	marker.query = pos - url_s;
 
 	/* Get query */
 	if (*pos == '?') {
-		while (*(++pos) != '\0') {
-			if (*pos == '#') {
-				/* End of the query */
-				break;
-			}
-		}
+		/* End of the query */
+		pos++;
+		pos += strcspn(pos, "#");
 	}
 
 	marker.fragment = pos - url_s;
 
 	/* Get fragment */
 	if (*pos == '#') {
-		while (*(++pos) != '\0')
-			;
+		pos += strlen(pos);
 	}
 
 	/* We got to the end of url_s.
@@ -640,6 +740,7 @@ static nserror nsurl__create_from_section(const char * const url_s,
 	char *norm_start = pos_norm;
 	char *host;
 	size_t copy_len;
+	size_t length_run;
 	size_t length;
 	size_t host_len;
 	enum {
@@ -695,6 +796,16 @@ static nserror nsurl__create_from_section(const char * const url_s,
 	pos = pos_url_s = url_s + start;
 	copy_len = 0;
 	for (; pos < url_s + end; pos++) {
+		/* Characters which need no normalising are copied in runs */
+		length_run = nsurl__plain_run(pos, url_s + end,
+				(section == URL_SCHEME || section == URL_HOST));
+		if (length_run > 0) {
+			copy_len += length_run;
+			pos += length_run;
+			if (pos >= url_s + end)
+				break;
+		}
+
 		if (*pos == '%' && (pos + 2 < url_s + end)) {
 			/* Might be an escaped character needing unescaped */
 
@@ -1330,6 +1441,8 @@ nserror nsurl_create(const char * const url_s, nsurl **url)
 	/* Give the URL a reference */
 	(*url)->count = 1;
 
+	nsurl__intern(url);
+
 	return NSERROR_OK;
 }
 
@@ -1568,5 +1681,7 @@ nserror nsurl_join(const nsurl *base, const char *rel, nsurl **joined)
 	/* Give the URL a reference */
 	(*joined)->count = 1;
 
+	nsurl__intern(joined);
+
 	return NSERROR_OK;
 }
@@ -60,6 +60,10 @@ struct nsurl {
 	int count;	/* Number of references to NetSurf URL object */
 	uint32_t hash;	/* Hash value for nsurl identification */
 
+	struct nsurl *intern_next;	/* Next URL in intern table chain */
+	struct nsurl **intern_prevp;	/* Link to this URL in its chain */
+	uint32_t intern_hash;	/* Hash of the complete string */
+
 	size_t length;	/* Length of string */
 	char string[FLEX_ARRAY_LEN_DECL];	/* Full URL as a string */
 };
@@ -127,6 +131,34 @@ nserror nsurl__components_to_string(
  */
 void nsurl__calc_hash(nsurl *url);
 
+/**
+ * Intern a newly created URL
+ *
+ * If a live URL with the same complete string already exists the new
+ * URL is destroyed and replaced by a new reference to the existing
+ * one, so equal URLs always share a single object.
+ *
+ * \param url	Newly created NetSurf URL object, updated on exit
+ */
+void nsurl__intern(nsurl **url);
+
+/**
+ * Find the length of a run of characters needing no normalisation.
+ *
+ * For most sections these are the characters which need no escaping.
+ * For the scheme and host they are characters which are neither upper
+ * case (and so need lower casing) nor a '%' escape.
+ *
+ * Runs are classified sixteen bytes at a time where SSE2 or NEON are
+ * available, as URL strings are usually long runs of such characters.
+ *
+ * \param pos		Start of run
+ * \param end		End of section
+ * \param lower		True to classify for scheme and host sections
+ * \return number of characters that may be copied unchanged
+ */
+size_t nsurl__plain_run(const char *pos, const char *end, bool lower);
+
 
 
 